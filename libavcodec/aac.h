@@ -262,6 +262,8 @@ typedef struct SingleChannelElement {
     DECLARE_ALIGNED(32, INTFLOAT, coeffs)[1024];    ///< coefficients for IMDCT, maybe processed
     DECLARE_ALIGNED(32, INTFLOAT, saved)[1536];     ///< overlap
     DECLARE_ALIGNED(32, INTFLOAT, ret_buf)[2048];   ///< PCM output buffer
+    DECLARE_ALIGNED(32, INTFLOAT, buf_mdct)[1024];  ///< IMDCT output, also used by LTP (used by decoder)
+    DECLARE_ALIGNED(32, INTFLOAT, temp)[128];       ///< windowing scratch (used by decoder)
     DECLARE_ALIGNED(16, INTFLOAT, ltp_state)[3072]; ///< time signal for LTP
     DECLARE_ALIGNED(32, AAC_FLOAT, lcoeffs)[1024];  ///< MDCT of LTP coefficients (used by encoder)
     DECLARE_ALIGNED(32, AAC_FLOAT, prcoeffs)[1024]; ///< Main prediction coefs (used by encoder)
@@ -308,14 +310,6 @@ struct AACContext {
     int warned_remapping_once;
     /** @} */
 
-    /**
-     * @name temporary aligned temporary buffers
-     * (We do not want to have these on the stack.)
-     * @{
-     */
-    DECLARE_ALIGNED(32, INTFLOAT, buf_mdct)[1024];
-    /** @} */
-
     /**
      * @name Computed / set up during initialization
      * @{
@@ -349,11 +343,21 @@ struct AACContext {
     int dmono_mode;      ///< 0->not dmono, 1->use first channel, 2->use second channel
     /** @} */
 
-    DECLARE_ALIGNED(32, INTFLOAT, temp)[128];
-
     OutputConfiguration oc[2];
     int warned_num_aac_frames;
 
+    /**
+     * @name Slice threading
+     * Channel elements are independent once coupling is out of the way,
+     * so spectral_to_sample() may hand them out as execute2() jobs.
+     * @{
+     */
+    ChannelElement *job_che[4 * MAX_ELEM_ID];
+    int job_type[4 * MAX_ELEM_ID];
+    int job_samples;
+    void (*job_imdct_and_window)(AACContext *ac, SingleChannelElement *sce);
+    /** @} */
+
     /* aacdec functions pointers */
     void (*imdct_and_windowing)(AACContext *ac, SingleChannelElement *sce);
     void (*apply_ltp)(AACContext *ac, SingleChannelElement *sce);
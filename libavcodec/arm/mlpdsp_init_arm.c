@@ -41,6 +41,15 @@ void ff_mlp_rematrix_channel_arm(int32_t *samples,
                                  int access_unit_size_pow2,
                                  int32_t mask);
 
+static void mlp_filter_channels_arm(ChannelParams *cp,
+                                    const uint8_t *quant_step_size,
+                                    int nb_channels, int blocksize,
+                                    int32_t *sample_buffer)
+{
+    ff_mlp_filter_channels(cp, quant_step_size, nb_channels, blocksize,
+                           sample_buffer, ff_mlp_filter_channel_arm);
+}
+
 #define DECLARE_PACK(order,channels,shift) \
     int32_t ff_mlp_pack_output_##order##order_##channels##ch_##shift##shift_armv6(int32_t, uint16_t, int32_t (*)[], void *, uint8_t*, int8_t *, uint8_t, int);
 #define ENUMERATE_PACK(order,channels,shift) \
@@ -139,6 +148,7 @@ av_cold void ff_mlpdsp_init_arm(MLPDSPContext *c)
 
     if (have_armv5te(cpu_flags)) {
         c->mlp_filter_channel = ff_mlp_filter_channel_arm;
+        c->mlp_filter_channels = mlp_filter_channels_arm;
         c->mlp_rematrix_channel = ff_mlp_rematrix_channel_arm;
     }
     if (have_armv6(cpu_flags))
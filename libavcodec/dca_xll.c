@@ -624,43 +624,102 @@ static av_cold void chs_clear_band_data(DCAXllDecoder *s, DCAXllChSet *c, int ba
     }
 }
 
-static void chs_filter_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band)
+static void chs_inverse_prediction(DCAXllDecoder *s, DCAXllChSet *c, int band, int ch)
 {
     DCAXllBand *b = &c->bands[band];
+    int32_t *buf = b->msb_sample_buffer[ch];
     int nsamples = s->nframesamples;
-    int i, j, k;
-
-    // Inverse adaptive or fixed prediction
-    for (i = 0; i < c->nchannels; i++) {
-        int32_t *buf = b->msb_sample_buffer[i];
-        int order = b->adapt_pred_order[i];
-        if (order > 0) {
-            int coeff[DCA_XLL_ADAPT_PRED_ORDER_MAX];
-            // Conversion from reflection coefficients to direct form coefficients
-            for (j = 0; j < order; j++) {
-                int rc = b->adapt_refl_coeff[i][j];
-                for (k = 0; k < (j + 1) / 2; k++) {
-                    int tmp1 = coeff[    k    ];
-                    int tmp2 = coeff[j - k - 1];
-                    coeff[    k    ] = tmp1 + mul16(rc, tmp2);
-                    coeff[j - k - 1] = tmp2 + mul16(rc, tmp1);
-                }
-                coeff[j] = rc;
+    int order = b->adapt_pred_order[ch];
+    int j, k;
+
+    if (order > 0) {
+        int coeff[DCA_XLL_ADAPT_PRED_ORDER_MAX];
+        // Conversion from reflection coefficients to direct form coefficients
+        for (j = 0; j < order; j++) {
+            int rc = b->adapt_refl_coeff[ch][j];
+            for (k = 0; k < (j + 1) / 2; k++) {
+                int tmp1 = coeff[    k    ];
+                int tmp2 = coeff[j - k - 1];
+                coeff[    k    ] = tmp1 + mul16(rc, tmp2);
+                coeff[j - k - 1] = tmp2 + mul16(rc, tmp1);
             }
-            // Inverse adaptive prediction
-            for (j = 0; j < nsamples - order; j++) {
-                int64_t err = 0;
-                for (k = 0; k < order; k++)
-                    err += (int64_t)buf[j + k] * coeff[order - k - 1];
-                buf[j + k] -= clip23(norm16(err));
+            coeff[j] = rc;
+        }
+        // Inverse adaptive prediction
+        for (j = 0; j < nsamples - order; j++) {
+            int64_t err = 0;
+            for (k = 0; k < order; k++)
+                err += (int64_t)buf[j + k] * coeff[order - k - 1];
+            buf[j + k] -= clip23(norm16(err));
+        }
+    } else {
+        // Inverse fixed coefficient prediction
+        for (j = 0; j < b->fixed_pred_order[ch]; j++)
+            for (k = 1; k < nsamples; k++)
+                buf[k] += buf[k - 1];
+    }
+}
+
+static int chs_inverse_prediction_job(AVCodecContext *avctx, void *arg,
+                                      int jobnr, int threadnr)
+{
+    DCAXllDecoder *s = arg;
+    int i, nb_jobs = FFMIN(avctx->thread_count, s->nb_pred_jobs);
+    int start = s->nb_pred_jobs *  jobnr      / nb_jobs;
+    int end   = s->nb_pred_jobs * (jobnr + 1) / nb_jobs;
+
+    for (i = start; i < end; i++) {
+        DCAXllPredJob *job = &s->pred_job[i];
+        chs_inverse_prediction(s, &s->chset[job->chset], job->band, job->ch);
+    }
+    return 0;
+}
+
+// Minimum number of samples, summed over the channels and frequency bands of
+// the active channel sets, in a frame for inverse prediction to be threaded.
+// A 512 sample 7.1 frame at 48 kHz takes less time to predict than waking up
+// the slice threads.
+#define MIN_THREADED_SAMPLES    8192
+
+// Inverse prediction of every channel in every frequency band is independent,
+// run it for all active channel sets at once using slice threads. Each thread
+// gets one contiguous range of channels, as a single channel is too little
+// work to pay for a job. Returns 0 without predicting anything if the frame
+// is too small to be worth threading.
+static int filter_prediction_threaded(DCAXllDecoder *s)
+{
+    DCAXllChSet *c;
+    int i, band, ch, nb_jobs = 0;
+
+    for (i = 0, c = s->chset; i < s->nactivechsets; i++, c++) {
+        for (band = 0; band < c->nfreqbands; band++) {
+            for (ch = 0; ch < c->nchannels; ch++) {
+                DCAXllPredJob *job = &s->pred_job[nb_jobs++];
+                job->chset = i;
+                job->band  = band;
+                job->ch    = ch;
             }
-        } else {
-            // Inverse fixed coefficient prediction
-            for (j = 0; j < b->fixed_pred_order[i]; j++)
-                for (k = 1; k < nsamples; k++)
-                    buf[k] += buf[k - 1];
         }
     }
+    if (nb_jobs * s->nframesamples < MIN_THREADED_SAMPLES)
+        return 0;
+    s->nb_pred_jobs = nb_jobs;
+
+    s->avctx->execute2(s->avctx, chs_inverse_prediction_job, s, NULL,
+                       FFMIN(s->avctx->thread_count, nb_jobs));
+    return 1;
+}
+
+static void chs_filter_band_data(DCAXllDecoder *s, DCAXllChSet *c, int band, int predicted)
+{
+    DCAXllBand *b = &c->bands[band];
+    int nsamples = s->nframesamples;
+    int i;
+
+    // Inverse adaptive or fixed prediction
+    if (!predicted)
+        for (i = 0; i < c->nchannels; i++)
+            chs_inverse_prediction(s, c, band, i);
 
     // Inverse pairwise channel decorrellation
     if (b->decor_enabled) {
@@ -1326,7 +1385,7 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
     DCAExssAsset *asset = &dca->exss.assets[0];
     DCAXllChSet *p = &s->chset[0], *c;
     enum AVMatrixEncoding matrix_encoding = AV_MATRIX_ENCODING_NONE;
-    int i, j, k, ret, shift, nsamples, request_mask;
+    int i, j, k, ret, shift, nsamples, request_mask, threaded;
     int ch_remap[DCA_SPEAKER_COUNT];
 
     // Force lossy downmixed output during recovery
@@ -1344,9 +1403,12 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
     }
 
     // Filter frequency bands for active channel sets
+    threaded = (avctx->active_thread_type & FF_THREAD_SLICE) &&
+               filter_prediction_threaded(s);
+
     s->output_mask = 0;
     for (i = 0, c = s->chset; i < s->nactivechsets; i++, c++) {
-        chs_filter_band_data(s, c, 0);
+        chs_filter_band_data(s, c, 0, threaded);
 
         if (c->residual_encode != (1 << c->nchannels) - 1
             && (ret = combine_residual_frame(s, c)) < 0)
@@ -1356,7 +1418,7 @@ int ff_dca_xll_filter_frame(DCAXllDecoder *s, AVFrame *frame)
             chs_assemble_msbs_lsbs(s, c, 0);
 
         if (c->nfreqbands > 1) {
-            chs_filter_band_data(s, c, 1);
+            chs_filter_band_data(s, c, 1, threaded);
             chs_assemble_msbs_lsbs(s, c, 1);
         }
 
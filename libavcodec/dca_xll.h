@@ -102,6 +102,10 @@ typedef struct DCAXllChSet {
     int32_t         *sample_buffer[DCA_XLL_SAMPLE_BUFFERS_MAX];
 } DCAXllChSet;
 
+typedef struct DCAXllPredJob {
+    uint8_t chset, band, ch;
+} DCAXllPredJob;
+
 typedef struct DCAXllDecoder {
     AVCodecContext  *avctx;
     GetBitContext   gb;
@@ -139,6 +143,9 @@ typedef struct DCAXllDecoder {
 
     int     output_mask;
     int32_t *output_samples[DCA_SPEAKER_COUNT];
+
+    DCAXllPredJob   pred_job[DCA_XLL_CHSETS_MAX * DCA_XLL_BANDS_MAX * DCA_XLL_CHANNELS_MAX];
+    int             nb_pred_jobs;
 } DCAXllDecoder;
 
 int ff_dca_xll_parse(DCAXllDecoder *s, uint8_t *data, DCAExssAsset *asset);
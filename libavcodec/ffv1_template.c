@@ -29,25 +29,32 @@ static inline int RENAME(predict)(TYPE *src, TYPE *last)
     return mid_pred(L, L + T - LT, T);
 }
 
-static inline int RENAME(get_context)(PlaneContext *p, TYPE *src,
-                                      TYPE *last, TYPE *last2)
+static av_always_inline int RENAME(get_context_quant)(const int16_t quant_table[MAX_CONTEXT_INPUTS][256],
+                                                     int large_context, TYPE *src,
+                                                     TYPE *last, TYPE *last2)
 {
     const int LT = last[-1];
     const int T  = last[0];
     const int RT = last[1];
     const int L  = src[-1];
 
-    if (p->quant_table[3][127]) {
+    if (large_context) {
         const int TT = last2[0];
         const int LL = src[-2];
-        return p->quant_table[0][(L - LT) & 0xFF] +
-               p->quant_table[1][(LT - T) & 0xFF] +
-               p->quant_table[2][(T - RT) & 0xFF] +
-               p->quant_table[3][(LL - L) & 0xFF] +
-               p->quant_table[4][(TT - T) & 0xFF];
+        return quant_table[0][(L - LT) & 0xFF] +
+               quant_table[1][(LT - T) & 0xFF] +
+               quant_table[2][(T - RT) & 0xFF] +
+               quant_table[3][(LL - L) & 0xFF] +
+               quant_table[4][(TT - T) & 0xFF];
     } else
-        return p->quant_table[0][(L - LT) & 0xFF] +
-               p->quant_table[1][(LT - T) & 0xFF] +
-               p->quant_table[2][(T - RT) & 0xFF];
+        return quant_table[0][(L - LT) & 0xFF] +
+               quant_table[1][(LT - T) & 0xFF] +
+               quant_table[2][(T - RT) & 0xFF];
 }
 
+static inline int RENAME(get_context)(PlaneContext *p, TYPE *src,
+                                      TYPE *last, TYPE *last2)
+{
+    return RENAME(get_context_quant)(p->quant_table, p->quant_table[3][127],
+                                     src, last, last2);
+}
@@ -20,9 +20,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
-static av_always_inline void RENAME(decode_line)(FFV1Context *s, int w,
-                                                 TYPE *sample[2],
-                                                 int plane_index, int bits)
+/**
+ * Decode one line with the coder type and context size known at compile time,
+ * so that the per-sample loop does not have to test them.
+ */
+static av_always_inline void RENAME(decode_line_internal)(FFV1Context *s, int w,
+                                                          TYPE *sample[2],
+                                                          int plane_index, int bits,
+                                                          int ac, int large_context)
 {
     PlaneContext *const p = &s->plane[plane_index];
     RangeCoder *const c   = &s->c;
@@ -31,23 +36,11 @@ static av_always_inline void RENAME(decode_line)(FFV1Context *s, int w,
     int run_mode  = 0;
     int run_index = s->run_index;
 
-    if (s->slice_coding_mode == 1) {
-        int i;
-        for (x = 0; x < w; x++) {
-            int v = 0;
-            for (i=0; i<bits; i++) {
-                uint8_t state = 128;
-                v += v + get_rac(c, &state);
-            }
-            sample[1][x] = v;
-        }
-        return;
-    }
-
     for (x = 0; x < w; x++) {
         int diff, context, sign;
 
-        context = RENAME(get_context)(p, sample[1] + x, sample[0] + x, sample[1] + x);
+        context = RENAME(get_context_quant)(p->quant_table, large_context,
+                                            sample[1] + x, sample[0] + x, sample[1] + x);
         if (context < 0) {
             context = -context;
             sign    = 1;
@@ -56,7 +49,7 @@ static av_always_inline void RENAME(decode_line)(FFV1Context *s, int w,
 
         av_assert2(context < p->context_count);
 
-        if (s->ac != AC_GOLOMB_RICE) {
+        if (ac) {
             diff = get_symbol_inline(c, p->state[context], 1);
         } else {
             if (context == 0 && run_mode == 0)
@@ -103,6 +96,40 @@ static av_always_inline void RENAME(decode_line)(FFV1Context *s, int w,
     s->run_index = run_index;
 }
 
+static av_always_inline void RENAME(decode_line)(FFV1Context *s, int w,
+                                                 TYPE *sample[2],
+                                                 int plane_index, int bits)
+{
+    PlaneContext *const p = &s->plane[plane_index];
+    RangeCoder *const c   = &s->c;
+    int x;
+
+    if (s->slice_coding_mode == 1) {
+        int i;
+        for (x = 0; x < w; x++) {
+            int v = 0;
+            for (i=0; i<bits; i++) {
+                uint8_t state = 128;
+                v += v + get_rac(c, &state);
+            }
+            sample[1][x] = v;
+        }
+        return;
+    }
+
+    if (s->ac != AC_GOLOMB_RICE) {
+        if (p->quant_table[3][127])
+            RENAME(decode_line_internal)(s, w, sample, plane_index, bits, 1, 1);
+        else
+            RENAME(decode_line_internal)(s, w, sample, plane_index, bits, 1, 0);
+    } else {
+        if (p->quant_table[3][127])
+            RENAME(decode_line_internal)(s, w, sample, plane_index, bits, 0, 1);
+        else
+            RENAME(decode_line_internal)(s, w, sample, plane_index, bits, 0, 0);
+    }
+}
+
 static void RENAME(decode_rgb_frame)(FFV1Context *s, uint8_t *src[3], int w, int h, int stride[3])
 {
     int x, y, p;
@@ -96,8 +96,22 @@ static const int dwt_norms[2][4][10] = { // [dwt_type][band][rlevel] (multiplied
      { 7186,  9218, 15860, 30430,  60190, 120100, 240000, 479700,  959300}}
 };
 
+/**
+ * code block to be tier-1 coded, with its position in the tile-component
+ * after the DWT
+ */
+typedef struct {
+    Jpeg2000Component *comp;
+    Jpeg2000Band *band;
+    Jpeg2000Cblk *cblk;
+    int x0, y0, x1, y1;
+    int bandpos, lev;
+} Jpeg2000CblkTask;
+
 typedef struct {
    Jpeg2000Component *comp;
+   Jpeg2000CblkTask *cblk_task;
+   int nb_cblk_tasks;
 } Jpeg2000Tile;
 
 typedef struct {
@@ -125,6 +139,9 @@ typedef struct {
 
     Jpeg2000Tile *tile;
 
+    Jpeg2000T1Context *t1; ///< one tier-1 context per slice thread
+    int nb_t1;
+
     int format;
     int pred;
 } Jpeg2000EncoderContext;
@@ -394,6 +411,85 @@ static uint8_t *put_sot(Jpeg2000EncoderContext *s, int tileno)
     return psotptr;
 }
 
+/**
+ * list the code blocks of a tile in coding order, so that tier-1 coding
+ * can be spread over the slice threads
+ */
+static int init_cblk_tasks(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
+{
+    int compno, reslevelno, bandno, nb_tasks = 0;
+    Jpeg2000CodingStyle *codsty = &s->codsty;
+    Jpeg2000CblkTask *task;
+
+    for (compno = 0; compno < s->ncomponents; compno++){
+        Jpeg2000Component *comp = tile->comp + compno;
+        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
+            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
+                Jpeg2000Band *band = reslevel->band + bandno;
+                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                    continue;
+                nb_tasks += band->prec->nb_codeblocks_width * band->prec->nb_codeblocks_height;
+            }
+        }
+    }
+
+    tile->cblk_task = task = av_malloc_array(nb_tasks, sizeof(*tile->cblk_task));
+    if (!tile->cblk_task)
+        return AVERROR(ENOMEM);
+    tile->nb_cblk_tasks = nb_tasks;
+
+    for (compno = 0; compno < s->ncomponents; compno++){
+        Jpeg2000Component *comp = tile->comp + compno;
+
+        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
+            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
+                Jpeg2000Band *band = reslevel->band + bandno;
+                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1;
+                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+                y0 = yy0;
+                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                            band->coord[1][1]) - band->coord[1][0] + yy0;
+
+                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                    continue;
+
+                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
+                    if (reslevelno == 0 || bandno == 1)
+                        xx0 = 0;
+                    else
+                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+                    x0 = xx0;
+                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                                band->coord[0][1]) - band->coord[0][0] + xx0;
+
+                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
+                        task->comp    = comp;
+                        task->band    = band;
+                        task->cblk    = prec->cblk + cblkno;
+                        task->x0      = xx0;
+                        task->y0      = yy0;
+                        task->x1      = xx1;
+                        task->y1      = yy1;
+                        task->bandpos = bandno + (reslevelno > 0);
+                        task->lev     = codsty->nreslevels - reslevelno - 1;
+                        task++;
+
+                        xx0 = xx1;
+                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
+                    }
+                    yy0 = yy1;
+                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
 /**
  * compute the sizes of tiles, resolution levels, bands, etc.
  * allocate memory for them
@@ -401,7 +497,7 @@ static uint8_t *put_sot(Jpeg2000EncoderContext *s, int tileno)
  */
 static int init_tiles(Jpeg2000EncoderContext *s)
 {
-    int tileno, tilex, tiley, compno;
+    int tileno, tilex, tiley, compno, ret;
     Jpeg2000CodingStyle *codsty = &s->codsty;
     Jpeg2000QuantStyle  *qntsty = &s->qntsty;
 
@@ -420,7 +516,7 @@ static int init_tiles(Jpeg2000EncoderContext *s)
                 return AVERROR(ENOMEM);
             for (compno = 0; compno < s->ncomponents; compno++){
                 Jpeg2000Component *comp = tile->comp + compno;
-                int ret, i, j;
+                int i, j;
 
                 comp->coord[0][0] = comp->coord_o[0][0] = tilex * s->tile_width;
                 comp->coord[0][1] = comp->coord_o[0][1] = FFMIN((tilex+1)*s->tile_width, s->width);
@@ -441,6 +537,8 @@ static int init_tiles(Jpeg2000EncoderContext *s)
                                                )) < 0)
                     return ret;
             }
+            if ((ret = init_cblk_tasks(s, tile)) < 0)
+                return ret;
         }
     return 0;
 }
@@ -876,83 +974,67 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+static int dwt_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
-    Jpeg2000T1Context t1;
-    Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
+    Jpeg2000Tile *tile = arg;
+    Jpeg2000Component *comp = tile->comp + jobnr;
 
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
-
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
-
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
-
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
-
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
-
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
+    return ff_dwt_encode(&comp->dwt, comp->i_data);
+}
 
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] << NMSEDEC_FRACBITS;
-                                }
-                            }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
-                            }
-                        }
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
-                    }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
-                }
+static int encode_cblk_job(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000Tile *tile = arg;
+    Jpeg2000CblkTask *task = tile->cblk_task + jobnr;
+    Jpeg2000Component *comp = task->comp;
+    Jpeg2000T1Context *t1 = s->t1 + threadnr;
+    int width = comp->coord[0][1] - comp->coord[0][0];
+    int y, x;
+
+    t1->stride = (1 << s->codsty.log2_cblk_width) + 2;
+
+    if (s->codsty.transform == FF_DWT53){
+        for (y = task->y0; y < task->y1; y++){
+            int *ptr = t1->data + (y - task->y0) * t1->stride;
+            for (x = task->x0; x < task->x1; x++){
+                *ptr++ = comp->i_data[width * y + x] << NMSEDEC_FRACBITS;
+            }
+        }
+    } else{
+        for (y = task->y0; y < task->y1; y++){
+            int *ptr = t1->data + (y - task->y0) * t1->stride;
+            for (x = task->x0; x < task->x1; x++){
+                *ptr = (comp->i_data[width * y + x]);
+                *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / task->band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                ptr++;
             }
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
     }
+    encode_cblk(s, t1, task->cblk, tile, task->x1 - task->x0, task->y1 - task->y0,
+                task->bandpos, task->lev);
+    return 0;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int compno, ret[4];
+
+    av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
+    s->avctx->execute2(s->avctx, dwt_job, tile, ret, s->ncomponents);
+    for (compno = 0; compno < s->ncomponents; compno++)
+        if (ret[compno] < 0)
+            return ret[compno];
+    av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
+
+    // code blocks are independent, their coded data does not depend on the order
+    s->avctx->execute2(s->avctx, encode_cblk_job, tile, NULL, tile->nb_cblk_tasks);
+    av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     truncpasses(s, tile);
-    if ((ret = encode_packets(s, tile, tileno)) < 0)
-        return ret;
+    if ((ret[0] = encode_packets(s, tile, tileno)) < 0)
+        return ret[0];
     av_log(s->avctx, AV_LOG_DEBUG, "after rate control\n");
     return 0;
 }
@@ -968,8 +1050,10 @@ static void cleanup(Jpeg2000EncoderContext *s)
             ff_jpeg2000_cleanup(comp, codsty);
         }
         av_freep(&s->tile[tileno].comp);
+        av_freep(&s->tile[tileno].cblk_task);
     }
     av_freep(&s->tile);
+    av_freep(&s->t1);
 }
 
 static void reinit(Jpeg2000EncoderContext *s)
@@ -1162,6 +1246,11 @@ FF_ENABLE_DEPRECATION_WARNINGS
     if ((ret=init_tiles(s)) < 0)
         return ret;
 
+    s->nb_t1 = FFMAX(avctx->thread_count, 1);
+    s->t1 = av_malloc_array(s->nb_t1, sizeof(*s->t1));
+    if (!s->t1)
+        return AVERROR(ENOMEM);
+
     av_log(s->avctx, AV_LOG_DEBUG, "after init\n");
 
     return 0;
@@ -1214,5 +1303,7 @@ AVCodec ff_jpeg2000_encoder = {
         AV_PIX_FMT_YUV410P, AV_PIX_FMT_YUV411P,
         AV_PIX_FMT_NONE
     },
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY,
     .priv_class     = &j2k_class,
 };
@@ -85,6 +85,15 @@ typedef struct Jpeg2000Tile {
     int coord[2][2];                    // border coordinates {{x0, x1}, {y0, y1}}
 } Jpeg2000Tile;
 
+/* code block of a tile, as decoded by one job of the intra-tile threading */
+typedef struct Jpeg2000CblkJob {
+    Jpeg2000Component   *comp;
+    Jpeg2000CodingStyle *codsty;
+    Jpeg2000Band        *band;
+    Jpeg2000Cblk        *cblk;
+    int                 bandpos;
+} Jpeg2000CblkJob;
+
 typedef struct Jpeg2000DecoderContext {
     AVClass         *class;
     AVCodecContext  *avctx;
@@ -118,6 +127,15 @@ typedef struct Jpeg2000DecoderContext {
     Jpeg2000Tile    *tile;
     Jpeg2000DSPContext dsp;
 
+    /* intra-tile threading, used when there are fewer tiles than threads */
+    Jpeg2000T1Context *t1;
+    unsigned        t1_size;
+    Jpeg2000CblkJob *cblk_job;
+    unsigned        cblk_job_size;
+    int             *dwt_ret;
+    unsigned        dwt_ret_size;
+    int             dwt_pass;
+
     /*options parameters*/
     int             reduction_factor;
 } Jpeg2000DecoderContext;
@@ -1630,6 +1648,32 @@ static inline void mct_decode(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile)
     s->dsp.mct_decode[tile->codsty[0].transform](src[0], src[1], src[2], csize);
 }
 
+static void decode_cblk_and_dequantize(Jpeg2000DecoderContext *s,
+                                       Jpeg2000Component *comp,
+                                       Jpeg2000CodingStyle *codsty,
+                                       Jpeg2000Band *band, Jpeg2000Cblk *cblk,
+                                       Jpeg2000T1Context *t1, int bandpos)
+{
+    int x, y;
+
+    t1->stride = (1<<codsty->log2_cblk_width) + 2;
+
+    decode_cblk(s, codsty, t1, cblk,
+                cblk->coord[0][1] - cblk->coord[0][0],
+                cblk->coord[1][1] - cblk->coord[1][0],
+                bandpos);
+
+    x = cblk->coord[0][0] - band->coord[0][0];
+    y = cblk->coord[1][0] - band->coord[1][0];
+
+    if (codsty->transform == FF_DWT97)
+        dequantization_float(x, y, cblk, comp, t1, band);
+    else if (codsty->transform == FF_DWT97_INT)
+        dequantization_int_97(x, y, cblk, comp, t1, band);
+    else
+        dequantization_int(x, y, cblk, comp, t1, band);
+}
+
 static inline void tile_codeblocks(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile)
 {
     Jpeg2000T1Context t1;
@@ -1641,8 +1685,6 @@ static inline void tile_codeblocks(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile
         Jpeg2000Component *comp     = tile->comp + compno;
         Jpeg2000CodingStyle *codsty = tile->codsty + compno;
 
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
-
         /* Loop on resolution levels */
         for (reslevelno = 0; reslevelno < codsty->nreslevels2decode; reslevelno++) {
             Jpeg2000ResLevel *rlevel = comp->reslevel + reslevelno;
@@ -1667,22 +1709,8 @@ static inline void tile_codeblocks(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile
                     for (cblkno = 0;
                          cblkno < prec->nb_codeblocks_width * prec->nb_codeblocks_height;
                          cblkno++) {
-                        int x, y;
-                        Jpeg2000Cblk *cblk = prec->cblk + cblkno;
-                        decode_cblk(s, codsty, &t1, cblk,
-                                    cblk->coord[0][1] - cblk->coord[0][0],
-                                    cblk->coord[1][1] - cblk->coord[1][0],
-                                    bandpos);
-
-                        x = cblk->coord[0][0] - band->coord[0][0];
-                        y = cblk->coord[1][0] - band->coord[1][0];
-
-                        if (codsty->transform == FF_DWT97)
-                            dequantization_float(x, y, cblk, comp, &t1, band);
-                        else if (codsty->transform == FF_DWT97_INT)
-                            dequantization_int_97(x, y, cblk, comp, &t1, band);
-                        else
-                            dequantization_int(x, y, cblk, comp, &t1, band);
+                        decode_cblk_and_dequantize(s, comp, codsty, band,
+                                                   prec->cblk + cblkno, &t1, bandpos);
                    } /* end cblk */
                 } /*end prec */
             } /* end band */
@@ -1755,16 +1783,11 @@ WRITE_FRAME(16, uint16_t)
 
 #undef WRITE_FRAME
 
-static int jpeg2000_decode_tile(AVCodecContext *avctx, void *td,
-                                int jobnr, int threadnr)
+static void output_tile(Jpeg2000DecoderContext *s, Jpeg2000Tile *tile,
+                        AVFrame *picture)
 {
-    Jpeg2000DecoderContext *s = avctx->priv_data;
-    AVFrame *picture = td;
-    Jpeg2000Tile *tile = s->tile + jobnr;
     int x;
 
-    tile_codeblocks(s, tile);
-
     /* inverse MCT transformation */
     if (tile->codsty[0].mct)
         mct_decode(s, tile);
@@ -1790,6 +1813,125 @@ static int jpeg2000_decode_tile(AVCodecContext *avctx, void *td,
 
         write_frame_16(s, tile, picture, precision);
     }
+}
+
+static int jpeg2000_decode_tile(AVCodecContext *avctx, void *td,
+                                int jobnr, int threadnr)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+    AVFrame *picture = td;
+    Jpeg2000Tile *tile = s->tile + jobnr;
+
+    tile_codeblocks(s, tile);
+    output_tile(s, tile, picture);
+
+    return 0;
+}
+
+static int jpeg2000_decode_cblk_job(AVCodecContext *avctx, void *td,
+                                    int jobnr, int threadnr)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+    Jpeg2000CblkJob *job = s->cblk_job + jobnr;
+
+    decode_cblk_and_dequantize(s, job->comp, job->codsty, job->band, job->cblk,
+                               s->t1 + threadnr, job->bandpos);
+    return 0;
+}
+
+static int jpeg2000_dwt_job(AVCodecContext *avctx, void *td,
+                            int jobnr, int threadnr)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+    Jpeg2000Tile *tile = td;
+    int nb_jobs = avctx->thread_count;
+    Jpeg2000Component *comp = tile->comp + jobnr / nb_jobs;
+    Jpeg2000CodingStyle *codsty = tile->codsty + jobnr / nb_jobs;
+
+    if (s->dwt_pass >= ff_dwt_decode_passes(&comp->dwt))
+        return 0;
+
+    return ff_dwt_decode_thread(&comp->dwt,
+                                codsty->transform == FF_DWT97 ? (void*)comp->f_data : (void*)comp->i_data,
+                                s->dwt_pass, jobnr % nb_jobs, nb_jobs, threadnr);
+}
+
+/**
+ * Decode a single tile using all slice threads: the code blocks are decoded
+ * in parallel, then each pass of the inverse DWT is split over the threads.
+ */
+static int jpeg2000_decode_tile_threaded(AVCodecContext *avctx, Jpeg2000Tile *tile,
+                                         AVFrame *picture)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+    int compno, reslevelno, bandno, precno, cblkno, jobnr;
+    int nb_cblks = 0, nb_passes = 0, nb_dwt_jobs, ret;
+
+    for (compno = 0; compno < s->ncomponents; compno++) {
+        Jpeg2000Component *comp = tile->comp + compno;
+
+        if ((ret = ff_dwt_decode_thread_init(&comp->dwt, avctx->thread_count)) < 0)
+            return ret;
+        nb_passes = FFMAX(nb_passes, ff_dwt_decode_passes(&comp->dwt));
+
+        for (reslevelno = 0; reslevelno < tile->codsty[compno].nreslevels2decode; reslevelno++) {
+            Jpeg2000ResLevel *rlevel = comp->reslevel + reslevelno;
+            for (bandno = 0; bandno < rlevel->nbands; bandno++) {
+                Jpeg2000Band *band = rlevel->band + bandno;
+                if (band->coord[0][0] == band->coord[0][1] ||
+                    band->coord[1][0] == band->coord[1][1])
+                    continue;
+                for (precno = 0; precno < rlevel->num_precincts_x * rlevel->num_precincts_y; precno++)
+                    nb_cblks += band->prec[precno].nb_codeblocks_width *
+                                band->prec[precno].nb_codeblocks_height;
+            }
+        }
+    }
+
+    av_fast_malloc(&s->cblk_job, &s->cblk_job_size, nb_cblks * sizeof(*s->cblk_job));
+    av_fast_malloc(&s->t1, &s->t1_size, avctx->thread_count * sizeof(*s->t1));
+    nb_dwt_jobs = s->ncomponents * avctx->thread_count;
+    av_fast_malloc(&s->dwt_ret, &s->dwt_ret_size, nb_dwt_jobs * sizeof(*s->dwt_ret));
+    if (!s->cblk_job || !s->t1 || !s->dwt_ret)
+        return AVERROR(ENOMEM);
+
+    nb_cblks = 0;
+    for (compno = 0; compno < s->ncomponents; compno++) {
+        Jpeg2000Component *comp     = tile->comp + compno;
+        Jpeg2000CodingStyle *codsty = tile->codsty + compno;
+
+        for (reslevelno = 0; reslevelno < codsty->nreslevels2decode; reslevelno++) {
+            Jpeg2000ResLevel *rlevel = comp->reslevel + reslevelno;
+            for (bandno = 0; bandno < rlevel->nbands; bandno++) {
+                Jpeg2000Band *band = rlevel->band + bandno;
+                if (band->coord[0][0] == band->coord[0][1] ||
+                    band->coord[1][0] == band->coord[1][1])
+                    continue;
+                for (precno = 0; precno < rlevel->num_precincts_x * rlevel->num_precincts_y; precno++) {
+                    Jpeg2000Prec *prec = band->prec + precno;
+                    for (cblkno = 0; cblkno < prec->nb_codeblocks_width * prec->nb_codeblocks_height; cblkno++) {
+                        Jpeg2000CblkJob *job = s->cblk_job + nb_cblks++;
+                        job->comp    = comp;
+                        job->codsty  = codsty;
+                        job->band    = band;
+                        job->cblk    = prec->cblk + cblkno;
+                        job->bandpos = bandno + (reslevelno > 0);
+                    }
+                }
+            }
+        }
+    }
+
+    avctx->execute2(avctx, jpeg2000_decode_cblk_job, tile, NULL, nb_cblks);
+
+    for (s->dwt_pass = 0; s->dwt_pass < nb_passes; s->dwt_pass++) {
+        avctx->execute2(avctx, jpeg2000_dwt_job, tile, s->dwt_ret, nb_dwt_jobs);
+        for (jobnr = 0; jobnr < nb_dwt_jobs; jobnr++)
+            if (s->dwt_ret[jobnr] < 0)
+                return s->dwt_ret[jobnr];
+    }
+
+    output_tile(s, tile, picture);
 
     return 0;
 }
@@ -2117,7 +2259,14 @@ static int jpeg2000_decode_frame(AVCodecContext *avctx, void *data,
     if (ret = jpeg2000_read_bitstream_packets(s))
         goto end;
 
-    avctx->execute2(avctx, jpeg2000_decode_tile, picture, NULL, s->numXtiles * s->numYtiles);
+    if (avctx->active_thread_type & FF_THREAD_SLICE &&
+        s->numXtiles * s->numYtiles < avctx->thread_count) {
+        int tileno;
+        for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++)
+            if ((ret = jpeg2000_decode_tile_threaded(avctx, s->tile + tileno, picture)) < 0)
+                goto end;
+    } else
+        avctx->execute2(avctx, jpeg2000_decode_tile, picture, NULL, s->numXtiles * s->numYtiles);
 
     jpeg2000_dec_cleanup(s);
 
@@ -2133,6 +2282,18 @@ end:
     return ret;
 }
 
+static av_cold int jpeg2000_decode_end(AVCodecContext *avctx)
+{
+    Jpeg2000DecoderContext *s = avctx->priv_data;
+
+    av_freep(&s->t1);
+    av_freep(&s->cblk_job);
+    av_freep(&s->dwt_ret);
+    s->t1_size = s->cblk_job_size = s->dwt_ret_size = 0;
+
+    return 0;
+}
+
 static av_cold void jpeg2000_init_static_data(AVCodec *codec)
 {
     ff_jpeg2000_init_tier1_luts();
@@ -2165,6 +2326,7 @@ AVCodec ff_jpeg2000_decoder = {
     .init_static_data = jpeg2000_init_static_data,
     .init             = jpeg2000_decode_init,
     .decode           = jpeg2000_decode_frame,
+    .close            = jpeg2000_decode_end,
     .priv_class       = &jpeg2000_class,
     .max_lowres       = 5,
     .profiles         = NULL_IF_CONFIG_SMALL(ff_jpeg2000_profiles)
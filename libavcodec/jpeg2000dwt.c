@@ -25,27 +25,14 @@
  * Discrete wavelet transform
  */
 
+#include "config.h"
+#include "libavutil/attributes.h"
 #include "libavutil/avassert.h"
 #include "libavutil/common.h"
 #include "libavutil/mem.h"
 #include "jpeg2000dwt.h"
 #include "internal.h"
 
-/* Defines for 9/7 DWT lifting parameters.
- * Parameters are in float. */
-#define F_LFTG_ALPHA  1.586134342059924f
-#define F_LFTG_BETA   0.052980118572961f
-#define F_LFTG_GAMMA  0.882911075530934f
-#define F_LFTG_DELTA  0.443506852043971f
-
-/* Lifting parameters in integer format.
- * Computed as param = (float param) * (1 << 16) */
-#define I_LFTG_ALPHA  103949ll
-#define I_LFTG_BETA     3472ll
-#define I_LFTG_GAMMA   57862ll
-#define I_LFTG_DELTA   29066ll
-#define I_LFTG_K       80621ll
-#define I_LFTG_X       53274ll
 #define I_PRESHIFT 8
 
 static inline void extend53(int *p, int i0, int i1)
@@ -305,233 +292,339 @@ static void dwt_encode97_int(DWTContext *s, int *t)
         t[i] = (t[i] + ((1<<I_PRESHIFT)>>1)) >> I_PRESHIFT;
 }
 
-static void sr_1d53(int *p, int i0, int i1)
+/* The inverse transform runs FF_DWT_LANES rows or columns at once through
+ * the line buffer, interleaved as line[i * FF_DWT_LANES + lane], so that the
+ * lifting steps are the same operation on all lanes. */
+#define LANE(p, i) ((p) + (i) * FF_DWT_LANES)
+#define COPY_LANES(p, dst, src) \
+    memcpy(LANE(p, dst), LANE(p, src), FF_DWT_LANES * sizeof(*(p)))
+
+static inline void extend53_lanes(int *p, int i0, int i1)
+{
+    COPY_LANES(p, i0 - 1, i0 + 1);
+    COPY_LANES(p, i1,     i1 - 2);
+    COPY_LANES(p, i0 - 2, i0 + 2);
+    COPY_LANES(p, i1 + 1, i1 - 3);
+}
+
+static inline void extend97_float_lanes(float *p, int i0, int i1)
 {
     int i;
 
-    if (i1 <= i0 + 1) {
-        if (i0 == 1)
-            p[1] >>= 1;
-        return;
+    for (i = 1; i <= 4; i++) {
+        COPY_LANES(p, i0 - i,     i0 + i);
+        COPY_LANES(p, i1 + i - 1, i1 - i - 1);
     }
+}
 
-    extend53(p, i0, i1);
+static inline void extend97_int_lanes(int32_t *p, int i0, int i1)
+{
+    int i;
+
+    for (i = 1; i <= 4; i++) {
+        COPY_LANES(p, i0 - i,     i0 + i);
+        COPY_LANES(p, i1 + i - 1, i1 - i - 1);
+    }
+}
+
+static void sr_1d53_c(int32_t *p, int i0, int i1)
+{
+    int i, k;
 
     for (i = (i0 >> 1); i < (i1 >> 1) + 1; i++)
-        p[2 * i] -= (p[2 * i - 1] + p[2 * i + 1] + 2) >> 2;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i)[k] -= (LANE(p, 2 * i - 1)[k] + LANE(p, 2 * i + 1)[k] + 2) >> 2;
     for (i = (i0 >> 1); i < (i1 >> 1); i++)
-        p[2 * i + 1] += (p[2 * i] + p[2 * i + 2]) >> 1;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i + 1)[k] += (LANE(p, 2 * i)[k] + LANE(p, 2 * i + 2)[k]) >> 1;
 }
 
-static void dwt_decode53(DWTContext *s, int *t)
+static void sr_1d53(const DWTDSPContext *dsp, int *p, int i0, int i1)
 {
-    int lev;
-    int w     = s->linelen[s->ndeclevels - 1][0];
-    int32_t *line = s->i_linebuf;
-    line += 3;
+    int k;
 
-    for (lev = 0; lev < s->ndeclevels; lev++) {
-        int lh = s->linelen[lev][0],
-            lv = s->linelen[lev][1],
-            mh = s->mod[lev][0],
-            mv = s->mod[lev][1],
-            lp;
-        int *l;
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (k = 0; k < FF_DWT_LANES; k++)
+                LANE(p, 1)[k] >>= 1;
+        return;
+    }
 
+    extend53_lanes(p, i0, i1);
+    dsp->sr_1d53(p, i0, i1);
+}
+
+static void dwt_decode53_lines(DWTContext *s, int *t, int32_t *line,
+                               int lev, int ver, int start, int end)
+{
+    int w  = s->linelen[s->ndeclevels - 1][0],
+        lh = s->linelen[lev][0],
+        lv = s->linelen[lev][1],
+        mh = s->mod[lev][0],
+        mv = s->mod[lev][1],
+        lp, k;
+    int *l;
+    line += 3 * FF_DWT_LANES;
+
+    if (!ver) {
         // HOR_SD
-        l = line + mh;
-        for (lp = 0; lp < lv; lp++) {
+        l = LANE(line, mh);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -3), 0, (lh + 6) * FF_DWT_LANES * sizeof(*line));
             // copy with interleaving
             for (i = mh; i < lh; i += 2, j++)
-                l[i] = t[w * lp + j];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = t[w * (lp + k) + j];
             for (i = 1 - mh; i < lh; i += 2, j++)
-                l[i] = t[w * lp + j];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = t[w * (lp + k) + j];
 
-            sr_1d53(line, mh, mh + lh);
+            sr_1d53(&s->dsp, line, mh, mh + lh);
 
             for (i = 0; i < lh; i++)
-                t[w * lp + i] = l[i];
+                for (k = 0; k < n; k++)
+                    t[w * (lp + k) + i] = LANE(l, i)[k];
         }
-
+    } else {
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
+        l = LANE(line, mv);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -3), 0, (lv + 6) * FF_DWT_LANES * sizeof(*line));
             // copy with interleaving
             for (i = mv; i < lv; i += 2, j++)
-                l[i] = t[w * j + lp];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = t[w * j + lp + k];
             for (i = 1 - mv; i < lv; i += 2, j++)
-                l[i] = t[w * j + lp];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = t[w * j + lp + k];
 
-            sr_1d53(line, mv, mv + lv);
+            sr_1d53(&s->dsp, line, mv, mv + lv);
 
             for (i = 0; i < lv; i++)
-                t[w * i + lp] = l[i];
+                for (k = 0; k < n; k++)
+                    t[w * i + lp + k] = LANE(l, i)[k];
         }
     }
 }
 
-static void sr_1d97_float(float *p, int i0, int i1)
+static void sr_1d97_float_c(float *p, int i0, int i1)
 {
-    int i;
-
-    if (i1 <= i0 + 1) {
-        if (i0 == 1)
-            p[1] *= F_LFTG_K/2;
-        else
-            p[0] *= F_LFTG_X;
-        return;
-    }
-
-    extend97_float(p, i0, i1);
+    int i, k;
 
     for (i = (i0 >> 1) - 1; i < (i1 >> 1) + 2; i++)
-        p[2 * i]     -= F_LFTG_DELTA * (p[2 * i - 1] + p[2 * i + 1]);
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i)[k]     -= F_LFTG_DELTA * (LANE(p, 2 * i - 1)[k] + LANE(p, 2 * i + 1)[k]);
     /* step 4 */
     for (i = (i0 >> 1) - 1; i < (i1 >> 1) + 1; i++)
-        p[2 * i + 1] -= F_LFTG_GAMMA * (p[2 * i]     + p[2 * i + 2]);
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i + 1)[k] -= F_LFTG_GAMMA * (LANE(p, 2 * i)[k]     + LANE(p, 2 * i + 2)[k]);
     /*step 5*/
     for (i = (i0 >> 1); i < (i1 >> 1) + 1; i++)
-        p[2 * i]     += F_LFTG_BETA  * (p[2 * i - 1] + p[2 * i + 1]);
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i)[k]     += F_LFTG_BETA  * (LANE(p, 2 * i - 1)[k] + LANE(p, 2 * i + 1)[k]);
     /* step 6 */
     for (i = (i0 >> 1); i < (i1 >> 1); i++)
-        p[2 * i + 1] += F_LFTG_ALPHA * (p[2 * i]     + p[2 * i + 2]);
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i + 1)[k] += F_LFTG_ALPHA * (LANE(p, 2 * i)[k]     + LANE(p, 2 * i + 2)[k]);
 }
 
-static void dwt_decode97_float(DWTContext *s, float *t)
+static void sr_1d97_float(const DWTDSPContext *dsp, float *p, int i0, int i1)
 {
-    int lev;
-    int w       = s->linelen[s->ndeclevels - 1][0];
-    float *line = s->f_linebuf;
-    float *data = t;
+    int k;
+
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (k = 0; k < FF_DWT_LANES; k++)
+                LANE(p, 1)[k] *= F_LFTG_K/2;
+        else
+            for (k = 0; k < FF_DWT_LANES; k++)
+                LANE(p, 0)[k] *= F_LFTG_X;
+        return;
+    }
+
+    extend97_float_lanes(p, i0, i1);
+    dsp->sr_1d97_float(p, i0, i1);
+}
+
+static void dwt_decode97_float_lines(DWTContext *s, float *data, float *line,
+                                     int lev, int ver, int start, int end)
+{
+    int w  = s->linelen[s->ndeclevels - 1][0],
+        lh = s->linelen[lev][0],
+        lv = s->linelen[lev][1],
+        mh = s->mod[lev][0],
+        mv = s->mod[lev][1],
+        lp, k;
+    float *l;
     /* position at index O of line range [0-5,w+5] cf. extend function */
-    line += 5;
+    line += 5 * FF_DWT_LANES;
 
-    for (lev = 0; lev < s->ndeclevels; lev++) {
-        int lh = s->linelen[lev][0],
-            lv = s->linelen[lev][1],
-            mh = s->mod[lev][0],
-            mv = s->mod[lev][1],
-            lp;
-        float *l;
+    if (!ver) {
         // HOR_SD
-        l = line + mh;
-        for (lp = 0; lp < lv; lp++) {
+        l = LANE(line, mh);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -5), 0, (lh + 10) * FF_DWT_LANES * sizeof(*line));
             // copy with interleaving
             for (i = mh; i < lh; i += 2, j++)
-                l[i] = data[w * lp + j];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * (lp + k) + j];
             for (i = 1 - mh; i < lh; i += 2, j++)
-                l[i] = data[w * lp + j];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * (lp + k) + j];
 
-            sr_1d97_float(line, mh, mh + lh);
+            sr_1d97_float(&s->dsp, line, mh, mh + lh);
 
             for (i = 0; i < lh; i++)
-                data[w * lp + i] = l[i];
+                for (k = 0; k < n; k++)
+                    data[w * (lp + k) + i] = LANE(l, i)[k];
         }
-
+    } else {
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
+        l = LANE(line, mv);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -5), 0, (lv + 10) * FF_DWT_LANES * sizeof(*line));
             // copy with interleaving
             for (i = mv; i < lv; i += 2, j++)
-                l[i] = data[w * j + lp];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * j + lp + k];
             for (i = 1 - mv; i < lv; i += 2, j++)
-                l[i] = data[w * j + lp];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * j + lp + k];
 
-            sr_1d97_float(line, mv, mv + lv);
+            sr_1d97_float(&s->dsp, line, mv, mv + lv);
 
             for (i = 0; i < lv; i++)
-                data[w * i + lp] = l[i];
+                for (k = 0; k < n; k++)
+                    data[w * i + lp + k] = LANE(l, i)[k];
         }
     }
 }
 
-static void sr_1d97_int(int32_t *p, int i0, int i1)
+static void sr_1d97_int_c(int32_t *p, int i0, int i1)
 {
-    int i;
-
-    if (i1 <= i0 + 1) {
-        if (i0 == 1)
-            p[1] = (p[1] * I_LFTG_K + (1<<16)) >> 17;
-        else
-            p[0] = (p[0] * I_LFTG_X + (1<<15)) >> 16;
-        return;
-    }
-
-    extend97_int(p, i0, i1);
+    int i, k;
 
     for (i = (i0 >> 1) - 1; i < (i1 >> 1) + 2; i++)
-        p[2 * i]     -= (I_LFTG_DELTA * (p[2 * i - 1] + p[2 * i + 1]) + (1 << 15)) >> 16;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i)[k]     -= (I_LFTG_DELTA * (LANE(p, 2 * i - 1)[k] + LANE(p, 2 * i + 1)[k]) + (1 << 15)) >> 16;
     /* step 4 */
     for (i = (i0 >> 1) - 1; i < (i1 >> 1) + 1; i++)
-        p[2 * i + 1] -= (I_LFTG_GAMMA * (p[2 * i]     + p[2 * i + 2]) + (1 << 15)) >> 16;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i + 1)[k] -= (I_LFTG_GAMMA * (LANE(p, 2 * i)[k]     + LANE(p, 2 * i + 2)[k]) + (1 << 15)) >> 16;
     /*step 5*/
     for (i = (i0 >> 1); i < (i1 >> 1) + 1; i++)
-        p[2 * i]     += (I_LFTG_BETA  * (p[2 * i - 1] + p[2 * i + 1]) + (1 << 15)) >> 16;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i)[k]     += (I_LFTG_BETA  * (LANE(p, 2 * i - 1)[k] + LANE(p, 2 * i + 1)[k]) + (1 << 15)) >> 16;
     /* step 6 */
     for (i = (i0 >> 1); i < (i1 >> 1); i++)
-        p[2 * i + 1] += (I_LFTG_ALPHA * (p[2 * i]     + p[2 * i + 2]) + (1 << 15)) >> 16;
+        for (k = 0; k < FF_DWT_LANES; k++)
+            LANE(p, 2 * i + 1)[k] += (I_LFTG_ALPHA * (LANE(p, 2 * i)[k]     + LANE(p, 2 * i + 2)[k]) + (1 << 15)) >> 16;
 }
 
-static void dwt_decode97_int(DWTContext *s, int32_t *t)
+static void sr_1d97_int(const DWTDSPContext *dsp, int32_t *p, int i0, int i1)
 {
-    int lev;
-    int w       = s->linelen[s->ndeclevels - 1][0];
-    int h       = s->linelen[s->ndeclevels - 1][1];
-    int i;
-    int32_t *line = s->i_linebuf;
-    int32_t *data = t;
-    /* position at index O of line range [0-5,w+5] cf. extend function */
-    line += 5;
+    int k;
 
-    for (i = 0; i < w * h; i++)
-        data[i] <<= I_PRESHIFT;
+    if (i1 <= i0 + 1) {
+        if (i0 == 1)
+            for (k = 0; k < FF_DWT_LANES; k++)
+                LANE(p, 1)[k] = (LANE(p, 1)[k] * I_LFTG_K + (1<<16)) >> 17;
+        else
+            for (k = 0; k < FF_DWT_LANES; k++)
+                LANE(p, 0)[k] = (LANE(p, 0)[k] * I_LFTG_X + (1<<15)) >> 16;
+        return;
+    }
 
-    for (lev = 0; lev < s->ndeclevels; lev++) {
-        int lh = s->linelen[lev][0],
-            lv = s->linelen[lev][1],
-            mh = s->mod[lev][0],
-            mv = s->mod[lev][1],
-            lp;
-        int32_t *l;
+    extend97_int_lanes(p, i0, i1);
+    dsp->sr_1d97_int(p, i0, i1);
+}
+
+static void dwt_decode97_int_lines(DWTContext *s, int32_t *data, int32_t *line,
+                                   int lev, int ver, int start, int end)
+{
+    int w  = s->linelen[s->ndeclevels - 1][0],
+        lh = s->linelen[lev][0],
+        lv = s->linelen[lev][1],
+        mh = s->mod[lev][0],
+        mv = s->mod[lev][1],
+        lp, k;
+    int32_t *l;
+    /* position at index O of line range [0-5,w+5] cf. extend function */
+    line += 5 * FF_DWT_LANES;
+
+    if (!ver) {
         // HOR_SD
-        l = line + mh;
-        for (lp = 0; lp < lv; lp++) {
+        l = LANE(line, mh);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -5), 0, (lh + 10) * FF_DWT_LANES * sizeof(*line));
             // rescale with interleaving
             for (i = mh; i < lh; i += 2, j++)
-                l[i] = ((data[w * lp + j] * I_LFTG_K) + (1 << 15)) >> 16;
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = ((data[w * (lp + k) + j] * I_LFTG_K) + (1 << 15)) >> 16;
             for (i = 1 - mh; i < lh; i += 2, j++)
-                l[i] = data[w * lp + j];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * (lp + k) + j];
 
-            sr_1d97_int(line, mh, mh + lh);
+            sr_1d97_int(&s->dsp, line, mh, mh + lh);
 
             for (i = 0; i < lh; i++)
-                data[w * lp + i] = l[i];
+                for (k = 0; k < n; k++)
+                    data[w * (lp + k) + i] = LANE(l, i)[k];
         }
-
+    } else {
         // VER_SD
-        l = line + mv;
-        for (lp = 0; lp < lh; lp++) {
+        l = LANE(line, mv);
+        for (lp = start; lp < end; lp += FF_DWT_LANES) {
+            int n = FFMIN(end - lp, FF_DWT_LANES);
             int i, j = 0;
+
+            if (n < FF_DWT_LANES)
+                memset(LANE(line, -5), 0, (lv + 10) * FF_DWT_LANES * sizeof(*line));
             // rescale with interleaving
             for (i = mv; i < lv; i += 2, j++)
-                l[i] = ((data[w * j + lp] * I_LFTG_K) + (1 << 15)) >> 16;
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = ((data[w * j + lp + k] * I_LFTG_K) + (1 << 15)) >> 16;
             for (i = 1 - mv; i < lv; i += 2, j++)
-                l[i] = data[w * j + lp];
+                for (k = 0; k < n; k++)
+                    LANE(l, i)[k] = data[w * j + lp + k];
 
-            sr_1d97_int(line, mv, mv + lv);
+            sr_1d97_int(&s->dsp, line, mv, mv + lv);
 
             for (i = 0; i < lv; i++)
-                data[w * i + lp] = l[i];
+                for (k = 0; k < n; k++)
+                    data[w * i + lp + k] = LANE(l, i)[k];
         }
     }
+}
 
-    for (i = 0; i < w * h; i++)
-        data[i] = (data[i] + ((1<<I_PRESHIFT)>>1)) >> I_PRESHIFT;
+av_cold void ff_dwtdsp_init(DWTDSPContext *c)
+{
+    c->sr_1d97_float = sr_1d97_float_c;
+    c->sr_1d97_int   = sr_1d97_int_c;
+    c->sr_1d53       = sr_1d53_c;
+
+    if (ARCH_X86)
+        ff_dwtdsp_init_x86(c);
 }
 
 int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
@@ -556,6 +649,10 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
             for (j = 0; j < 2; j++)
                 b[i][j] = (b[i][j] + 1) >> 1;
         }
+    /* the encoder uses a single line; the buffers of FF_DWT_LANES lines
+     * of the inverse transform are only allocated when it is run */
+    s->linebuf_size = (maxlen + (type == FF_DWT53 ? 6 : 12)) * FF_DWT_LANES;
+    s->nb_linebufs  = 0;
     switch (type) {
     case FF_DWT97:
         s->f_linebuf = av_malloc_array((maxlen + 12), sizeof(*s->f_linebuf));
@@ -575,6 +672,29 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
     default:
         return -1;
     }
+    ff_dwtdsp_init(&s->dsp);
+    return 0;
+}
+
+int ff_dwt_decode_thread_init(DWTContext *s, int nb_threads)
+{
+    if (nb_threads <= s->nb_linebufs)
+        return 0;
+
+    if (s->type == FF_DWT97) {
+        float *buf = av_realloc_array(s->f_linebuf, nb_threads * s->linebuf_size,
+                                      sizeof(*s->f_linebuf));
+        if (!buf)
+            return AVERROR(ENOMEM);
+        s->f_linebuf = buf;
+    } else {
+        int32_t *buf = av_realloc_array(s->i_linebuf, nb_threads * s->linebuf_size,
+                                        sizeof(*s->i_linebuf));
+        if (!buf)
+            return AVERROR(ENOMEM);
+        s->i_linebuf = buf;
+    }
+    s->nb_linebufs = nb_threads;
     return 0;
 }
 
@@ -596,20 +716,58 @@ int ff_dwt_encode(DWTContext *s, void *t)
     return 0;
 }
 
-int ff_dwt_decode(DWTContext *s, void *t)
+int ff_dwt_decode_passes(const DWTContext *s)
 {
-    if (s->ndeclevels == 0)
+    return s->ndeclevels ? 2 * s->ndeclevels + 2 : 0;
+}
+
+int ff_dwt_decode_thread(DWTContext *s, void *t, int pass,
+                         int jobnr, int nb_jobs, int threadnr)
+{
+    int w = s->linelen[s->ndeclevels - 1][0];
+    int h = s->linelen[s->ndeclevels - 1][1];
+    int lev, ver, lines, start, end;
+
+    if (pass < 0 || pass >= ff_dwt_decode_passes(s) || threadnr >= s->nb_linebufs)
+        return AVERROR(EINVAL);
+
+    if (pass == 0 || pass == 2 * s->ndeclevels + 1) {
+        /* the integer 9/7 transform works on upscaled coefficients */
+        if (s->type == FF_DWT97_INT) {
+            int32_t *data = t;
+            int i;
+
+            start = (int64_t)h *  jobnr      / nb_jobs * w;
+            end   = (int64_t)h * (jobnr + 1) / nb_jobs * w;
+            if (pass == 0) {
+                for (i = start; i < end; i++)
+                    data[i] <<= I_PRESHIFT;
+            } else {
+                for (i = start; i < end; i++)
+                    data[i] = (data[i] + ((1<<I_PRESHIFT)>>1)) >> I_PRESHIFT;
+            }
+        }
         return 0;
+    }
+
+    lev   = (pass - 1) >> 1;
+    ver   = (pass - 1) & 1;
+    lines = s->linelen[lev][!ver];
+    start = lines *  jobnr      / nb_jobs;
+    end   = lines * (jobnr + 1) / nb_jobs;
 
     switch (s->type) {
     case FF_DWT97:
-        dwt_decode97_float(s, t);
+        dwt_decode97_float_lines(s, t, s->f_linebuf + threadnr * s->linebuf_size,
+                                 lev, ver, start, end);
         break;
     case FF_DWT97_INT:
-        dwt_decode97_int(s, t);
+        dwt_decode97_int_lines(s, t, s->i_linebuf + threadnr * s->linebuf_size,
+                               lev, ver, start, end);
         break;
     case FF_DWT53:
-        dwt_decode53(s, t);
+        dwt_decode53_lines(s, t, s->i_linebuf + threadnr * s->linebuf_size,
+                           lev, ver, start, end);
         break;
     default:
         return -1;
@@ -617,6 +775,18 @@ int ff_dwt_decode(DWTContext *s, void *t)
     return 0;
 }
 
+int ff_dwt_decode(DWTContext *s, void *t)
+{
+    int pass, ret;
+
+    if ((ret = ff_dwt_decode_thread_init(s, 1)) < 0)
+        return ret;
+    for (pass = 0; pass < ff_dwt_decode_passes(s); pass++)
+        if ((ret = ff_dwt_decode_thread(s, t, pass, 0, 1, 0)) < 0)
+            return ret;
+    return 0;
+}
+
 void ff_dwt_destroy(DWTContext *s)
 {
     av_freep(&s->f_linebuf);
@@ -33,6 +33,24 @@
 #define F_LFTG_K      1.230174104914001f
 #define F_LFTG_X      0.812893066115961f
 
+/* Defines for 9/7 DWT lifting parameters.
+ * Parameters are in float. */
+#define F_LFTG_ALPHA  1.586134342059924f
+#define F_LFTG_BETA   0.052980118572961f
+#define F_LFTG_GAMMA  0.882911075530934f
+#define F_LFTG_DELTA  0.443506852043971f
+
+/* Lifting parameters in integer format.
+ * Computed as param = (float param) * (1 << 16) */
+#define I_LFTG_ALPHA  103949ll
+#define I_LFTG_BETA     3472ll
+#define I_LFTG_GAMMA   57862ll
+#define I_LFTG_DELTA   29066ll
+#define I_LFTG_K       80621ll
+#define I_LFTG_X       53274ll
+
+#define FF_DWT_LANES 8 ///< number of lines run through the inverse lifting at once
+
 enum DWTType {
     FF_DWT97,
     FF_DWT53,
@@ -40,6 +58,18 @@ enum DWTType {
     FF_DWT_NB
 };
 
+typedef struct DWTDSPContext {
+    /**
+     * Inverse lifting steps of FF_DWT_LANES lines at once, stored interleaved
+     * as p[i * FF_DWT_LANES + lane], for the samples i0 <= i < i1 of each
+     * line, with i1 > i0 + 1.
+     * The samples outside of [i0, i1) must already be symmetrically extended.
+     */
+    void (*sr_1d97_float)(float *p, int i0, int i1);
+    void (*sr_1d97_int)(int32_t *p, int i0, int i1);
+    void (*sr_1d53)(int32_t *p, int i0, int i1);
+} DWTDSPContext;
+
 typedef struct DWTContext {
     /// line lengths { horizontal, vertical } in consecutive decomposition levels
     int linelen[FF_DWT_MAX_DECLVLS][2];
@@ -48,8 +78,14 @@ typedef struct DWTContext {
     uint8_t type;                        ///< 0 for 9/7; 1 for 5/3
     int32_t *i_linebuf;                  ///< int buffer used by transform
     float   *f_linebuf;                  ///< float buffer used by transform
+    int linebuf_size;                    ///< size of a line buffer in elements
+    int nb_linebufs;                     ///< number of line buffers, one per thread
+    DWTDSPContext dsp;
 } DWTContext;
 
+void ff_dwtdsp_init(DWTDSPContext *c);
+void ff_dwtdsp_init_x86(DWTDSPContext *c);
+
 /**
  * Initialize DWT.
  * @param s                 DWT context
@@ -63,6 +99,29 @@ int ff_jpeg2000_dwt_init(DWTContext *s, int border[2][2],
 int ff_dwt_encode(DWTContext *s, void *t);
 int ff_dwt_decode(DWTContext *s, void *t);
 
+/**
+ * Allocate line buffers for running the inverse transform with
+ * ff_dwt_decode_thread() on up to nb_threads threads at once.
+ */
+int ff_dwt_decode_thread_init(DWTContext *s, int nb_threads);
+
+/**
+ * @return the number of passes of the inverse transform
+ */
+int ff_dwt_decode_passes(const DWTContext *s);
+
+/**
+ * Run one slice of a pass of the inverse transform.
+ * The slices of a pass are independent of each other, but all of them must
+ * have finished before the next pass is started.
+ * @param pass      pass index, 0 <= pass < ff_dwt_decode_passes(s)
+ * @param jobnr     slice index, 0 <= jobnr < nb_jobs
+ * @param threadnr  index of the line buffer to use,
+ *                  as set up by ff_dwt_decode_thread_init()
+ */
+int ff_dwt_decode_thread(DWTContext *s, void *t, int pass,
+                         int jobnr, int nb_jobs, int threadnr);
+
 void ff_dwt_destroy(DWTContext *s);
 
 #endif /* AVCODEC_JPEG2000DWT_H */
@@ -70,6 +70,9 @@
 #define FIR 0
 #define IIR 1
 
+/** mask keeping the bits of a sample above a quantization step size */
+#define MSB_MASK(bits)  (-1u << (bits))
+
 /** filter data */
 typedef struct FilterParams {
     uint8_t     order; ///< number of taps in filter
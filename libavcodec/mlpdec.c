@@ -124,6 +124,14 @@ typedef struct SubStream {
     /// Running XOR of all output samples.
     int32_t     lossless_check_data;
 
+    /// Set if the matrices/filters changed in the current access unit.
+    int         matrix_changed;
+    int         filter_changed[MAX_CHANNELS][NUM_FILTERS];
+
+    /// Buffers the substream is decoded into for the current access unit.
+    int8_t      (*bypassed_lsbs)[MAX_CHANNELS];
+    int32_t     (*sample_buffer)[MAX_CHANNELS];
+
 } SubStream;
 
 typedef struct MLPDecodeContext {
@@ -154,13 +162,20 @@ typedef struct MLPDecodeContext {
 
     SubStream   substream[MAX_SUBSTREAMS];
 
-    int         matrix_changed;
-    int         filter_changed[MAX_CHANNELS][NUM_FILTERS];
-
     int8_t      noise_buffer[MAX_BLOCKSIZE_POW2];
     int8_t      bypassed_lsbs[MAX_BLOCKSIZE][MAX_CHANNELS];
     DECLARE_ALIGNED(32, int32_t, sample_buffer)[MAX_BLOCKSIZE][MAX_CHANNELS];
 
+    /// Scratch buffers for lower substreams decoded concurrently with the
+    /// output substream when slice threading is active.
+    int8_t      substream_lsbs[MAX_SUBSTREAMS - 1][MAX_BLOCKSIZE][MAX_CHANNELS];
+    DECLARE_ALIGNED(32, int32_t, substream_samples)[MAX_SUBSTREAMS - 1][MAX_BLOCKSIZE][MAX_CHANNELS];
+
+    /// Per-substream input for the current access unit.
+    const uint8_t *substream_buf[MAX_SUBSTREAMS];
+    uint16_t    substream_data_len[MAX_SUBSTREAMS];
+    uint8_t     substream_parity_present[MAX_SUBSTREAMS];
+
     MLPDSPContext dsp;
 } MLPDecodeContext;
 
@@ -244,7 +259,7 @@ static inline int read_huff_channels(MLPDecodeContext *m, GetBitContext *gbp,
 
     for (mat = 0; mat < s->num_primitive_matrices; mat++)
         if (s->lsb_bypass[mat])
-            m->bypassed_lsbs[pos + s->blockpos][mat] = get_bits1(gbp);
+            s->bypassed_lsbs[pos + s->blockpos][mat] = get_bits1(gbp);
 
     for (channel = s->min_channel; channel <= s->max_channel; channel++) {
         ChannelParams *cp = &s->channel_params[channel];
@@ -266,7 +281,7 @@ static inline int read_huff_channels(MLPDecodeContext *m, GetBitContext *gbp,
         result  += cp->sign_huff_offset;
         result <<= quant_step_size;
 
-        m->sample_buffer[pos + s->blockpos][channel] = result;
+        s->sample_buffer[pos + s->blockpos][channel] = result;
     }
 
     return 0;
@@ -648,7 +663,7 @@ static int read_filter_params(MLPDecodeContext *m, GetBitContext *gbp,
     // Filter is 0 for FIR, 1 for IIR.
     av_assert0(filter < 2);
 
-    if (m->filter_changed[channel][filter]++ > 1) {
+    if (s->filter_changed[channel][filter]++ > 1) {
         av_log(m->avctx, AV_LOG_ERROR, "Filters may change only once per access unit.\n");
         return AVERROR_INVALIDDATA;
     }
@@ -718,7 +733,7 @@ static int read_matrix_params(MLPDecodeContext *m, unsigned int substr, GetBitCo
                                      ? MAX_MATRICES_MLP
                                      : MAX_MATRICES_TRUEHD;
 
-    if (m->matrix_changed++ > 1) {
+    if (s->matrix_changed++ > 1) {
         av_log(m->avctx, AV_LOG_ERROR, "Matrices may change only once per access unit.\n");
         return AVERROR_INVALIDDATA;
     }
@@ -887,43 +902,13 @@ static int read_decoding_params(MLPDecodeContext *m, GetBitContext *gbp,
     return 0;
 }
 
-#define MSB_MASK(bits)  (-1u << (bits))
-
-/** Generate PCM samples using the prediction filters and residual values
- *  read from the data stream, and update the filter state. */
-
-static void filter_channel(MLPDecodeContext *m, unsigned int substr,
-                           unsigned int channel)
-{
-    SubStream *s = &m->substream[substr];
-    const int32_t *fircoeff = s->channel_params[channel].coeff[FIR];
-    int32_t state_buffer[NUM_FILTERS][MAX_BLOCKSIZE + MAX_FIR_ORDER];
-    int32_t *firbuf = state_buffer[FIR] + MAX_BLOCKSIZE;
-    int32_t *iirbuf = state_buffer[IIR] + MAX_BLOCKSIZE;
-    FilterParams *fir = &s->channel_params[channel].filter_params[FIR];
-    FilterParams *iir = &s->channel_params[channel].filter_params[IIR];
-    unsigned int filter_shift = fir->shift;
-    int32_t mask = MSB_MASK(s->quant_step_size[channel]);
-
-    memcpy(firbuf, fir->state, MAX_FIR_ORDER * sizeof(int32_t));
-    memcpy(iirbuf, iir->state, MAX_IIR_ORDER * sizeof(int32_t));
-
-    m->dsp.mlp_filter_channel(firbuf, fircoeff,
-                              fir->order, iir->order,
-                              filter_shift, mask, s->blocksize,
-                              &m->sample_buffer[s->blockpos][channel]);
-
-    memcpy(fir->state, firbuf - s->blocksize, MAX_FIR_ORDER * sizeof(int32_t));
-    memcpy(iir->state, iirbuf - s->blocksize, MAX_IIR_ORDER * sizeof(int32_t));
-}
-
 /** Read a block of PCM residual data (or actual if no filtering active). */
 
 static int read_block_data(MLPDecodeContext *m, GetBitContext *gbp,
                            unsigned int substr)
 {
     SubStream *s = &m->substream[substr];
-    unsigned int i, ch, expected_stream_pos = 0;
+    unsigned int i, expected_stream_pos = 0;
     int ret;
 
     if (s->data_check_present) {
@@ -938,15 +923,18 @@ static int read_block_data(MLPDecodeContext *m, GetBitContext *gbp,
         return AVERROR_INVALIDDATA;
     }
 
-    memset(&m->bypassed_lsbs[s->blockpos][0], 0,
-           s->blocksize * sizeof(m->bypassed_lsbs[0]));
+    memset(&s->bypassed_lsbs[s->blockpos][0], 0,
+           s->blocksize * sizeof(s->bypassed_lsbs[0]));
 
     for (i = 0; i < s->blocksize; i++)
         if ((ret = read_huff_channels(m, gbp, substr, i)) < 0)
             return ret;
 
-    for (ch = s->min_channel; ch <= s->max_channel; ch++)
-        filter_channel(m, substr, ch);
+    m->dsp.mlp_filter_channels(&s->channel_params[s->min_channel],
+                               &s->quant_step_size[s->min_channel],
+                               s->max_channel - s->min_channel + 1,
+                               s->blocksize,
+                               &s->sample_buffer[s->blockpos][s->min_channel]);
 
     s->blockpos += s->blocksize;
 
@@ -1094,6 +1082,171 @@ static int output_data(MLPDecodeContext *m, unsigned int substr,
     return 0;
 }
 
+/** Decode the block data of one substream of the current access unit into
+ *  the substream's sample buffer.
+ *  @return negative on error, 0 otherwise. */
+
+static int read_substream(MLPDecodeContext *m, unsigned int substr)
+{
+    SubStream *s = &m->substream[substr];
+    const uint8_t *buf = m->substream_buf[substr];
+    unsigned int data_len = m->substream_data_len[substr];
+    GetBitContext gb;
+    int ret;
+
+    init_get_bits(&gb, buf, data_len * 8);
+
+    s->matrix_changed = 0;
+    memset(s->filter_changed, 0, sizeof(s->filter_changed));
+
+    s->blockpos = 0;
+    do {
+        if (get_bits1(&gb)) {
+            if (get_bits1(&gb)) {
+                /* A restart header should be present. */
+                if (read_restart_header(m, &gb, buf, substr) < 0)
+                    goto next_substr;
+                s->restart_seen = 1;
+            }
+
+            if (!s->restart_seen)
+                goto next_substr;
+            if (read_decoding_params(m, &gb, substr) < 0)
+                goto next_substr;
+        }
+
+        if (!s->restart_seen)
+            goto next_substr;
+
+        if ((ret = read_block_data(m, &gb, substr)) < 0)
+            return ret;
+
+        if (get_bits_count(&gb) >= data_len * 8)
+            goto substream_length_mismatch;
+
+    } while (!get_bits1(&gb));
+
+    skip_bits(&gb, (-get_bits_count(&gb)) & 15);
+
+    if (data_len * 8 - get_bits_count(&gb) >= 32) {
+        int shorten_by;
+
+        if (get_bits(&gb, 16) != 0xD234)
+            return AVERROR_INVALIDDATA;
+
+        shorten_by = get_bits(&gb, 16);
+        if      (m->avctx->codec_id == AV_CODEC_ID_TRUEHD && shorten_by  & 0x2000)
+            s->blockpos -= FFMIN(shorten_by & 0x1FFF, s->blockpos);
+        else if (m->avctx->codec_id == AV_CODEC_ID_MLP    && shorten_by != 0xD234)
+            return AVERROR_INVALIDDATA;
+
+        if (substr == m->max_decoded_substream)
+            av_log(m->avctx, AV_LOG_INFO, "End of stream indicated.\n");
+    }
+
+    if (m->substream_parity_present[substr]) {
+        uint8_t parity, checksum;
+
+        if (data_len * 8 - get_bits_count(&gb) != 16)
+            goto substream_length_mismatch;
+
+        parity   = ff_mlp_calculate_parity(buf, data_len - 2);
+        checksum = ff_mlp_checksum8       (buf, data_len - 2);
+
+        if ((get_bits(&gb, 8) ^ parity) != 0xa9    )
+            av_log(m->avctx, AV_LOG_ERROR, "Substream %d parity check failed.\n", substr);
+        if ( get_bits(&gb, 8)           != checksum)
+            av_log(m->avctx, AV_LOG_ERROR, "Substream %d checksum failed.\n"    , substr);
+    }
+
+    if (data_len * 8 != get_bits_count(&gb))
+        goto substream_length_mismatch;
+
+next_substr:
+    if (!s->restart_seen)
+        av_log(m->avctx, AV_LOG_ERROR,
+               "No restart header present in substream %d.\n", substr);
+
+    return 0;
+
+substream_length_mismatch:
+    av_log(m->avctx, AV_LOG_ERROR, "substream %d length mismatch\n", substr);
+    return AVERROR_INVALIDDATA;
+}
+
+static int read_substream_job(AVCodecContext *avctx, void *arg,
+                              int jobnr, int threadnr)
+{
+    return read_substream(avctx->priv_data, jobnr);
+}
+
+/** Minimum number of samples, summed over the channels of the decoded
+ *  substreams, in an access unit for the substreams to be decoded
+ *  concurrently. Smaller access units (e.g. 40 samples of 7.1 at 48 kHz)
+ *  take less time to decode than waking up the slice threads. */
+#define MIN_THREADED_SAMPLES 2048
+
+/** Check whether the substreams of the current access unit can be decoded
+ *  concurrently. Every substream keeps its own coding state, so this is only
+ *  prevented by a lower substream that could select itself as the output
+ *  substream (downmix extraction) while the others are being decoded. */
+
+static int can_decode_substreams_threaded(MLPDecodeContext *m)
+{
+    AVCodecContext *avctx = m->avctx;
+    unsigned int substr, nb_samples = 0;
+
+    if (!(avctx->active_thread_type & FF_THREAD_SLICE) ||
+        !m->max_decoded_substream)
+        return 0;
+
+    for (substr = 0; substr <= m->max_decoded_substream; substr++) {
+        SubStream *s = &m->substream[substr];
+        if (s->restart_seen)
+            nb_samples += (s->max_channel - s->min_channel + 1) *
+                          m->access_unit_size;
+    }
+    if (nb_samples < MIN_THREADED_SAMPLES)
+        return 0;
+
+    if (avctx->request_channel_layout)
+        for (substr = 0; substr < m->max_decoded_substream; substr++)
+            if ((m->substream[substr].ch_layout & avctx->request_channel_layout) ==
+                avctx->request_channel_layout)
+                return 0;
+
+    return 1;
+}
+
+/** Copy the channels coded only in lower substreams, which were decoded into
+ *  scratch buffers, into the sample buffer used for output. Channels also
+ *  coded in a higher substream are overridden by it, as in serial decoding. */
+
+static void merge_substream_samples(MLPDecodeContext *m)
+{
+    unsigned int substr, higher, ch, i;
+
+    for (substr = 0; substr < m->max_decoded_substream; substr++) {
+        SubStream *s = &m->substream[substr];
+
+        if (!s->restart_seen)
+            continue;
+
+        for (ch = s->min_channel; ch <= s->max_channel; ch++) {
+            for (higher = substr + 1; higher <= m->max_decoded_substream; higher++) {
+                SubStream *h = &m->substream[higher];
+                if (h->restart_seen && ch >= h->min_channel && ch <= h->max_channel)
+                    break;
+            }
+            if (higher <= m->max_decoded_substream)
+                continue;
+
+            for (i = 0; i < s->blockpos; i++)
+                m->sample_buffer[i][ch] = s->sample_buffer[i][ch];
+        }
+    }
+}
+
 /** Read an access unit from the stream.
  *  @return negative on error, 0 if not enough data is present in the input stream,
  *  otherwise the number of bytes consumed. */
@@ -1201,81 +1354,37 @@ static int read_access_unit(AVCodecContext *avctx, void* data,
     buf += header_size + substr_header_size;
 
     for (substr = 0; substr <= m->max_decoded_substream; substr++) {
-        SubStream *s = &m->substream[substr];
-        init_get_bits(&gb, buf, substream_data_len[substr] * 8);
-
-        m->matrix_changed = 0;
-        memset(m->filter_changed, 0, sizeof(m->filter_changed));
-
-        s->blockpos = 0;
-        do {
-            if (get_bits1(&gb)) {
-                if (get_bits1(&gb)) {
-                    /* A restart header should be present. */
-                    if (read_restart_header(m, &gb, buf, substr) < 0)
-                        goto next_substr;
-                    s->restart_seen = 1;
-                }
-
-                if (!s->restart_seen)
-                    goto next_substr;
-                if (read_decoding_params(m, &gb, substr) < 0)
-                    goto next_substr;
-            }
-
-            if (!s->restart_seen)
-                goto next_substr;
-
-            if ((ret = read_block_data(m, &gb, substr)) < 0)
-                return ret;
-
-            if (get_bits_count(&gb) >= substream_data_len[substr] * 8)
-                goto substream_length_mismatch;
-
-        } while (!get_bits1(&gb));
-
-        skip_bits(&gb, (-get_bits_count(&gb)) & 15);
-
-        if (substream_data_len[substr] * 8 - get_bits_count(&gb) >= 32) {
-            int shorten_by;
-
-            if (get_bits(&gb, 16) != 0xD234)
-                return AVERROR_INVALIDDATA;
+        m->substream_buf[substr]            = buf;
+        m->substream_data_len[substr]       = substream_data_len[substr];
+        m->substream_parity_present[substr] = substream_parity_present[substr];
+        buf += substream_data_len[substr];
+    }
 
-            shorten_by = get_bits(&gb, 16);
-            if      (m->avctx->codec_id == AV_CODEC_ID_TRUEHD && shorten_by  & 0x2000)
-                s->blockpos -= FFMIN(shorten_by & 0x1FFF, s->blockpos);
-            else if (m->avctx->codec_id == AV_CODEC_ID_MLP    && shorten_by != 0xD234)
-                return AVERROR_INVALIDDATA;
+    if (can_decode_substreams_threaded(m)) {
+        int rets[MAX_SUBSTREAMS];
 
-            if (substr == m->max_decoded_substream)
-                av_log(m->avctx, AV_LOG_INFO, "End of stream indicated.\n");
+        for (substr = 0; substr < m->max_decoded_substream; substr++) {
+            m->substream[substr].bypassed_lsbs = m->substream_lsbs[substr];
+            m->substream[substr].sample_buffer = m->substream_samples[substr];
         }
+        m->substream[substr].bypassed_lsbs = m->bypassed_lsbs;
+        m->substream[substr].sample_buffer = m->sample_buffer;
 
-        if (substream_parity_present[substr]) {
-            uint8_t parity, checksum;
-
-            if (substream_data_len[substr] * 8 - get_bits_count(&gb) != 16)
-                goto substream_length_mismatch;
+        avctx->execute2(avctx, read_substream_job, NULL, rets,
+                        m->max_decoded_substream + 1);
 
-            parity   = ff_mlp_calculate_parity(buf, substream_data_len[substr] - 2);
-            checksum = ff_mlp_checksum8       (buf, substream_data_len[substr] - 2);
+        for (substr = 0; substr <= m->max_decoded_substream; substr++)
+            if (rets[substr] < 0)
+                return rets[substr];
 
-            if ((get_bits(&gb, 8) ^ parity) != 0xa9    )
-                av_log(m->avctx, AV_LOG_ERROR, "Substream %d parity check failed.\n", substr);
-            if ( get_bits(&gb, 8)           != checksum)
-                av_log(m->avctx, AV_LOG_ERROR, "Substream %d checksum failed.\n"    , substr);
+        merge_substream_samples(m);
+    } else {
+        for (substr = 0; substr <= m->max_decoded_substream; substr++) {
+            m->substream[substr].bypassed_lsbs = m->bypassed_lsbs;
+            m->substream[substr].sample_buffer = m->sample_buffer;
+            if ((ret = read_substream(m, substr)) < 0)
+                return ret;
         }
-
-        if (substream_data_len[substr] * 8 != get_bits_count(&gb))
-            goto substream_length_mismatch;
-
-next_substr:
-        if (!s->restart_seen)
-            av_log(m->avctx, AV_LOG_ERROR,
-                   "No restart header present in substream %d.\n", substr);
-
-        buf += substream_data_len[substr];
     }
 
     if ((ret = output_data(m, m->max_decoded_substream, data, got_frame_ptr)) < 0)
@@ -1283,10 +1392,6 @@ next_substr:
 
     return length;
 
-substream_length_mismatch:
-    av_log(m->avctx, AV_LOG_ERROR, "substream %d length mismatch\n", substr);
-    return AVERROR_INVALIDDATA;
-
 error:
     m->params_valid = 0;
     return AVERROR_INVALIDDATA;
@@ -1301,7 +1406,7 @@ AVCodec ff_mlp_decoder = {
     .priv_data_size = sizeof(MLPDecodeContext),
     .init           = mlp_decode_init,
     .decode         = read_access_unit,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
 };
 #endif
 #if CONFIG_TRUEHD_DECODER
@@ -1313,6 +1418,6 @@ AVCodec ff_truehd_decoder = {
     .priv_data_size = sizeof(MLPDecodeContext),
     .init           = mlp_decode_init,
     .decode         = read_access_unit,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
 };
 #endif /* CONFIG_TRUEHD_DECODER */
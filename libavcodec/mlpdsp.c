@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include "config.h"
 #include "libavutil/attributes.h"
 #include "mlpdsp.h"
@@ -57,6 +59,47 @@ static void mlp_filter_channel(int32_t *state, const int32_t *coeff,
     }
 }
 
+void ff_mlp_filter_channels(ChannelParams *cp,
+                            const uint8_t *quant_step_size,
+                            int nb_channels, int blocksize,
+                            int32_t *sample_buffer,
+                            void (*filter_channel)(int32_t *state,
+                                                   const int32_t *coeff,
+                                                   int firorder, int iirorder,
+                                                   unsigned int filter_shift,
+                                                   int32_t mask, int blocksize,
+                                                   int32_t *sample_buffer))
+{
+    int ch;
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        int32_t state_buffer[NUM_FILTERS][MAX_BLOCKSIZE + MAX_FIR_ORDER];
+        int32_t *firbuf = state_buffer[FIR] + MAX_BLOCKSIZE;
+        int32_t *iirbuf = state_buffer[IIR] + MAX_BLOCKSIZE;
+        FilterParams *fir = &cp[ch].filter_params[FIR];
+        FilterParams *iir = &cp[ch].filter_params[IIR];
+
+        memcpy(firbuf, fir->state, MAX_FIR_ORDER * sizeof(int32_t));
+        memcpy(iirbuf, iir->state, MAX_IIR_ORDER * sizeof(int32_t));
+
+        filter_channel(firbuf, cp[ch].coeff[FIR], fir->order, iir->order,
+                       fir->shift, MSB_MASK(quant_step_size[ch]),
+                       blocksize, sample_buffer + ch);
+
+        memcpy(fir->state, firbuf - blocksize, MAX_FIR_ORDER * sizeof(int32_t));
+        memcpy(iir->state, iirbuf - blocksize, MAX_IIR_ORDER * sizeof(int32_t));
+    }
+}
+
+static void mlp_filter_channels(ChannelParams *cp,
+                                const uint8_t *quant_step_size,
+                                int nb_channels, int blocksize,
+                                int32_t *sample_buffer)
+{
+    ff_mlp_filter_channels(cp, quant_step_size, nb_channels, blocksize,
+                           sample_buffer, mlp_filter_channel);
+}
+
 void ff_mlp_rematrix_channel(int32_t *samples,
                              const int32_t *coeffs,
                              const uint8_t *bypassed_lsbs,
@@ -128,6 +171,7 @@ int32_t ff_mlp_pack_output(int32_t lossless_check_data,
 av_cold void ff_mlpdsp_init(MLPDSPContext *c)
 {
     c->mlp_filter_channel = mlp_filter_channel;
+    c->mlp_filter_channels = mlp_filter_channels;
     c->mlp_rematrix_channel = ff_mlp_rematrix_channel;
     c->mlp_select_pack_output = mlp_select_pack_output;
     c->mlp_pack_output = ff_mlp_pack_output;
@@ -46,11 +46,36 @@ int32_t ff_mlp_pack_output(int32_t lossless_check_data,
                            uint8_t max_matrix_channel,
                            int is32);
 
+void ff_mlp_filter_channels(ChannelParams *cp,
+                            const uint8_t *quant_step_size,
+                            int nb_channels, int blocksize,
+                            int32_t *sample_buffer,
+                            void (*filter_channel)(int32_t *state,
+                                                   const int32_t *coeff,
+                                                   int firorder, int iirorder,
+                                                   unsigned int filter_shift,
+                                                   int32_t mask, int blocksize,
+                                                   int32_t *sample_buffer));
+
 typedef struct MLPDSPContext {
     void (*mlp_filter_channel)(int32_t *state, const int32_t *coeff,
                                int firorder, int iirorder,
                                unsigned int filter_shift, int32_t mask,
                                int blocksize, int32_t *sample_buffer);
+    /**
+     * Generate the PCM samples of nb_channels adjacent channels of a block
+     * from their residuals, as mlp_filter_channel() does for one channel,
+     * and update the filter state of each channel.
+     *
+     * @param cp              parameters of the first channel
+     * @param quant_step_size quantization step size of the first channel
+     * @param sample_buffer   first sample of the first channel, in rows of
+     *                        MAX_CHANNELS samples
+     */
+    void (*mlp_filter_channels)(ChannelParams *cp,
+                                const uint8_t *quant_step_size,
+                                int nb_channels, int blocksize,
+                                int32_t *sample_buffer);
     void (*mlp_rematrix_channel)(int32_t *samples,
                                  const int32_t *coeffs,
                                  const uint8_t *bypassed_lsbs,
@@ -18,8 +18,10 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libavcodec/dcadsp.h"
+#include "libavcodec/dcamath.h"
 
 #define LFE_FIR_FLOAT_FUNC(opt)                                               \
 void ff_lfe_fir0_float_##opt(float *pcm_samples, int32_t *lfe_samples,         \
@@ -33,6 +35,202 @@ LFE_FIR_FLOAT_FUNC(sse3)
 LFE_FIR_FLOAT_FUNC(avx)
 LFE_FIR_FLOAT_FUNC(fma3)
 
+#if HAVE_AVX2_INLINE && ARCH_X86_64
+
+/* ymm0 = mulN(src[i], coeff) for 8 samples: the even and odd dwords are
+ * multiplied to qwords separately and rounded; bits is at most 23, so a
+ * logical shift gives the same low dword as the arithmetic one. */
+#define MUL_ROUND(src)                                          \
+        "vmovdqu   "src", %%ymm0                        \n\t"   \
+        "vpsrlq                $32, %%ymm0, %%ymm1      \n\t"   \
+        "vpmuldq            %%ymm7, %%ymm0, %%ymm0      \n\t"   \
+        "vpmuldq            %%ymm7, %%ymm1, %%ymm1      \n\t"   \
+        "vpaddq             %%ymm6, %%ymm0, %%ymm0      \n\t"   \
+        "vpaddq             %%ymm6, %%ymm1, %%ymm1      \n\t"   \
+        "vpsrlq             %%xmm5, %%ymm0, %%ymm0      \n\t"   \
+        "vpsllq             %%xmm4, %%ymm1, %%ymm1      \n\t"   \
+        "vpblendd     $0xaa, %%ymm1, %%ymm0, %%ymm0     \n\t"
+
+#define MUL_SETUP                                               \
+        "vmovd          %[coeff], %%xmm7                \n\t"   \
+        "vpbroadcastd       %%xmm7, %%ymm7              \n\t"   \
+        "vmovq            %[rnd], %%xmm6                \n\t"   \
+        "vpbroadcastq       %%xmm6, %%ymm6              \n\t"   \
+        "vmovq           %[shift], %%xmm5               \n\t"   \
+        "vmovq          %[shift2], %%xmm4               \n\t"
+
+#define MUL_OPERANDS(bits)                                      \
+          [coeff]"r"(coeff),                                    \
+          [rnd]"r"((x86_reg)1 << ((bits) - 1)),                 \
+          [shift]"r"((x86_reg)(bits)),                          \
+          [shift2]"r"((x86_reg)(32 - (bits)))
+
+#define MUL_CLOBBERS                                            \
+        XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm4",        \
+                     "%xmm5", "%xmm6", "%xmm7",)                \
+        "memory"
+
+#define MUL_OP_SUB                                              \
+        "vmovdqu      (%[dst],%[i]), %%ymm1             \n\t"   \
+        "vpsubd             %%ymm0, %%ymm1, %%ymm0      \n\t"
+#define MUL_OP_ADD                                              \
+        "vpaddd       (%[dst],%[i]), %%ymm0, %%ymm0     \n\t"
+#define MUL_OP_SET
+
+#define MUL_LOOP(OP, bits)                                      \
+    __asm__ volatile (                                          \
+        MUL_SETUP                                               \
+        "1:                                             \n\t"   \
+        MUL_ROUND("(%[src],%[i])")                              \
+        OP                                                      \
+        "vmovdqu            %%ymm0, (%[dst],%[i])       \n\t"   \
+        "add                   $32, %[i]                \n\t"   \
+        "jl 1b                                          \n\t"   \
+        "vzeroupper                                     \n\t"   \
+        : [i]"+r"(i)                                            \
+        : [dst]"r"(dst + len8), [src]"r"(src + len8),           \
+          MUL_OPERANDS(bits)                                    \
+        : MUL_CLOBBERS                                          \
+    )
+
+#define MUL_FUNC(name, OP, bits, tail)                                      \
+static void name##_avx2(int32_t *dst, const int32_t *src, int coeff,        \
+                        ptrdiff_t len)                                      \
+{                                                                           \
+    ptrdiff_t len8 = len & ~7;                                              \
+    x86_reg i = -len8 * (x86_reg)sizeof(*dst);                              \
+                                                                            \
+    if (len8)                                                               \
+        MUL_LOOP(OP, bits);                                                 \
+    for (i = len8; i < len; i++)                                            \
+        tail;                                                               \
+}
+
+MUL_FUNC(dmix_sub, MUL_OP_SUB, 15, dst[i] -= mul15(src[i], coeff))
+MUL_FUNC(dmix_add, MUL_OP_ADD, 15, dst[i] += mul15(src[i], coeff))
+MUL_FUNC(filter0,  MUL_OP_SUB, 22, dst[i] -= mul22(src[i], coeff))
+MUL_FUNC(filter1,  MUL_OP_SUB, 23, dst[i] -= mul23(src[i], coeff))
+MUL_FUNC(scale15,  MUL_OP_SET, 15, dst[i]  = mul15(src[i], coeff))
+MUL_FUNC(scale16,  MUL_OP_SET, 16, dst[i]  = mul16(src[i], coeff))
+
+static void dmix_scale_avx2(int32_t *dst, int scale, ptrdiff_t len)
+{
+    scale15_avx2(dst, dst, scale, len);
+}
+
+static void dmix_scale_inv_avx2(int32_t *dst, int scale_inv, ptrdiff_t len)
+{
+    scale16_avx2(dst, dst, scale_inv, len);
+}
+
+static void dmix_sub_xch_avx2(int32_t *dst1, int32_t *dst2,
+                              const int32_t *src, ptrdiff_t len)
+{
+    const int coeff = 5931520; /* M_SQRT1_2 * (1 << 23) */
+    ptrdiff_t len8 = len & ~7;
+    x86_reg i = -len8 * (x86_reg)sizeof(*src);
+
+    if (len8)
+        __asm__ volatile (
+            MUL_SETUP
+            "1:                                             \n\t"
+            MUL_ROUND("(%[src],%[i])")
+            "vmovdqu     (%[dst1],%[i]), %%ymm1             \n\t"
+            "vmovdqu     (%[dst2],%[i]), %%ymm2             \n\t"
+            "vpsubd             %%ymm0, %%ymm1, %%ymm1      \n\t"
+            "vpsubd             %%ymm0, %%ymm2, %%ymm2      \n\t"
+            "vmovdqu            %%ymm1, (%[dst1],%[i])      \n\t"
+            "vmovdqu            %%ymm2, (%[dst2],%[i])      \n\t"
+            "add                   $32, %[i]                \n\t"
+            "jl 1b                                          \n\t"
+            "vzeroupper                                     \n\t"
+            : [i]"+r"(i)
+            : [dst1]"r"(dst1 + len8), [dst2]"r"(dst2 + len8),
+              [src]"r"(src + len8), MUL_OPERANDS(23)
+            : MUL_CLOBBERS
+        );
+    for (i = len8; i < len; i++) {
+        int32_t cs = mul23(src[i], coeff);
+        dst1[i] -= cs;
+        dst2[i] -= cs;
+    }
+}
+
+static void decor_avx2(int32_t *dst, const int32_t *src, int coeff, ptrdiff_t len)
+{
+    ptrdiff_t len8 = len & ~7;
+    x86_reg i = -len8 * (x86_reg)sizeof(*src);
+
+    if (len8)
+        __asm__ volatile (
+            "vmovd          %[coeff], %%xmm7                \n\t"
+            "vpbroadcastd       %%xmm7, %%ymm7              \n\t"
+            "vpcmpeqd           %%ymm6, %%ymm6, %%ymm6      \n\t"
+            "vpsrld                $31, %%ymm6, %%ymm6      \n\t"
+            "vpslld                 $2, %%ymm6, %%ymm6      \n\t"
+            "1:                                             \n\t"
+            "vpmulld      (%[src],%[i]), %%ymm7, %%ymm0     \n\t"
+            "vpaddd             %%ymm6, %%ymm0, %%ymm0      \n\t"
+            "vpsrad                 $3, %%ymm0, %%ymm0      \n\t"
+            "vpaddd       (%[dst],%[i]), %%ymm0, %%ymm0     \n\t"
+            "vmovdqu            %%ymm0, (%[dst],%[i])       \n\t"
+            "add                   $32, %[i]                \n\t"
+            "jl 1b                                          \n\t"
+            "vzeroupper                                     \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len8), [src]"r"(src + len8), [coeff]"r"(coeff)
+            : XMM_CLOBBERS("%xmm0", "%xmm6", "%xmm7",) "memory"
+        );
+    for (i = len8; i < len; i++)
+        dst[i] += src[i] * coeff + (1 << 2) >> 3;
+}
+
+static void assemble_freq_bands_avx2(int32_t *dst, int32_t *src0, int32_t *src1,
+                                     const int32_t *coeff, ptrdiff_t len)
+{
+    ptrdiff_t len8 = len & ~7;
+    x86_reg i;
+
+    filter0_avx2(src0, src1, coeff[0], len);
+    filter0_avx2(src1, src0, coeff[1], len);
+    filter0_avx2(src0, src1, coeff[2], len);
+    filter0_avx2(src1, src0, coeff[3], len);
+
+    for (i = 0; i < 8; i++, src0--) {
+        filter1_avx2(src0, src1, coeff[i +  4], len);
+        filter1_avx2(src1, src0, coeff[i + 12], len);
+        filter1_avx2(src0, src1, coeff[i +  4], len);
+    }
+
+    /* interleave src1[i] and src0[i + 1] */
+    i = -len8 * (x86_reg)sizeof(*src0);
+    if (len8)
+        __asm__ volatile (
+            "1:                                             \n\t"
+            "vmovdqu      (%[src1],%[i]), %%ymm0            \n\t"
+            "vmovdqu     4(%[src0],%[i]), %%ymm1            \n\t"
+            "vpunpckldq         %%ymm1, %%ymm0, %%ymm2      \n\t"
+            "vpunpckhdq         %%ymm1, %%ymm0, %%ymm3      \n\t"
+            "vperm2i128   $0x20, %%ymm3, %%ymm2, %%ymm0     \n\t"
+            "vperm2i128   $0x31, %%ymm3, %%ymm2, %%ymm1     \n\t"
+            "vmovdqu            %%ymm0,   (%[dst],%[i],2)   \n\t"
+            "vmovdqu            %%ymm1, 32(%[dst],%[i],2)   \n\t"
+            "add                   $32, %[i]                \n\t"
+            "jl 1b                                          \n\t"
+            "vzeroupper                                     \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + 2 * len8), [src0]"r"(src0 + len8),
+              [src1]"r"(src1 + len8)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",) "memory"
+        );
+    for (i = len8; i < len; i++) {
+        dst[2 * i]     = src1[i];
+        dst[2 * i + 1] = src0[i + 1];
+    }
+}
+
+#endif /* HAVE_AVX2_INLINE && ARCH_X86_64 */
+
 av_cold void ff_dcadsp_init_x86(DCADSPContext *s)
 {
     int cpu_flags = av_get_cpu_flags();
@@ -49,4 +247,15 @@ av_cold void ff_dcadsp_init_x86(DCADSPContext *s)
     }
     if (EXTERNAL_FMA3(cpu_flags))
         s->lfe_fir_float[0] = ff_lfe_fir0_float_fma3;
+#if HAVE_AVX2_INLINE && ARCH_X86_64
+    if (INLINE_AVX2(cpu_flags)) {
+        s->decor               = decor_avx2;
+        s->dmix_sub_xch        = dmix_sub_xch_avx2;
+        s->dmix_sub            = dmix_sub_avx2;
+        s->dmix_add            = dmix_add_avx2;
+        s->dmix_scale          = dmix_scale_avx2;
+        s->dmix_scale_inv      = dmix_scale_inv_avx2;
+        s->assemble_freq_bands = assemble_freq_bands_avx2;
+    }
+#endif
 }
@@ -0,0 +1,350 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavcodec/jpeg2000dwt.h"
+
+/* The FF_DWT_LANES = 8 interleaved lines of a sample are 32 bytes, so each
+ * lifting step is a vertical operation on one ymm or two xmm registers per
+ * sample, with the neighbours at -32 and +32 bytes.  The steps are done in
+ * the same order as the C code; the float subtractions are done as additions
+ * of the negated coefficient, which rounds identically. */
+
+#define LANE(p, i) ((p) + (i) * FF_DWT_LANES)
+
+#if HAVE_SSE2_INLINE || HAVE_AVX_INLINE || HAVE_AVX2_INLINE
+DECLARE_ALIGNED(16, static const float, dwt_coeffs_float)[4][4] = {
+    { -F_LFTG_DELTA, -F_LFTG_DELTA, -F_LFTG_DELTA, -F_LFTG_DELTA },
+    { -F_LFTG_GAMMA, -F_LFTG_GAMMA, -F_LFTG_GAMMA, -F_LFTG_GAMMA },
+    {  F_LFTG_BETA,   F_LFTG_BETA,   F_LFTG_BETA,   F_LFTG_BETA  },
+    {  F_LFTG_ALPHA,  F_LFTG_ALPHA,  F_LFTG_ALPHA,  F_LFTG_ALPHA },
+};
+
+/* 64-bit multipliers of the integer 9/7 steps and their rounding term */
+DECLARE_ALIGNED(32, static const uint64_t, dwt_coeffs_int)[5][4] = {
+    { I_LFTG_DELTA, I_LFTG_DELTA, I_LFTG_DELTA, I_LFTG_DELTA },
+    { I_LFTG_GAMMA, I_LFTG_GAMMA, I_LFTG_GAMMA, I_LFTG_GAMMA },
+    { I_LFTG_BETA,  I_LFTG_BETA,  I_LFTG_BETA,  I_LFTG_BETA  },
+    { I_LFTG_ALPHA, I_LFTG_ALPHA, I_LFTG_ALPHA, I_LFTG_ALPHA },
+    { 1 << 15, 1 << 15, 1 << 15, 1 << 15 },
+};
+
+/* rounding terms of the two 5/3 steps */
+DECLARE_ALIGNED(32, static const int32_t, dwt_rnd53)[2][8] = {
+    { 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+};
+#endif
+
+#if HAVE_SSE2_INLINE
+/* pmuludq is unsigned: a negative sum s adds c << 32 to the product, which
+ * is c << 16 after the shift, so that is subtracted back for those lanes */
+#define CORR(c) (uint32_t)((c) << 16)
+DECLARE_ALIGNED(16, static const uint32_t, dwt_corr_int)[4][4] = {
+    { CORR(I_LFTG_DELTA), CORR(I_LFTG_DELTA), CORR(I_LFTG_DELTA), CORR(I_LFTG_DELTA) },
+    { CORR(I_LFTG_GAMMA), CORR(I_LFTG_GAMMA), CORR(I_LFTG_GAMMA), CORR(I_LFTG_GAMMA) },
+    { CORR(I_LFTG_BETA),  CORR(I_LFTG_BETA),  CORR(I_LFTG_BETA),  CORR(I_LFTG_BETA)  },
+    { CORR(I_LFTG_ALPHA), CORR(I_LFTG_ALPHA), CORR(I_LFTG_ALPHA), CORR(I_LFTG_ALPHA) },
+};
+
+/* p[2k] += c * (p[2k - 1] + p[2k + 1]) for 0 <= k < n */
+static av_always_inline void lift_float_sse2(float *p, int n, const float *c)
+{
+    x86_reg i = -(x86_reg)n * 64;
+
+    __asm__ volatile (
+        "movaps (%[c]), %%xmm4              \n\t"
+        "1:                                 \n\t"
+        "movups -32(%[p],%[i]), %%xmm0      \n\t"
+        "movups -16(%[p],%[i]), %%xmm1      \n\t"
+        "movups  32(%[p],%[i]), %%xmm2      \n\t"
+        "movups  48(%[p],%[i]), %%xmm3      \n\t"
+        "addps  %%xmm2, %%xmm0              \n\t"
+        "addps  %%xmm3, %%xmm1              \n\t"
+        "mulps  %%xmm4, %%xmm0              \n\t"
+        "mulps  %%xmm4, %%xmm1              \n\t"
+        "movups    (%[p],%[i]), %%xmm2      \n\t"
+        "movups  16(%[p],%[i]), %%xmm3      \n\t"
+        "addps  %%xmm0, %%xmm2              \n\t"
+        "addps  %%xmm1, %%xmm3              \n\t"
+        "movups %%xmm2,    (%[p],%[i])      \n\t"
+        "movups %%xmm3,  16(%[p],%[i])      \n\t"
+        "add $64, %[i]                      \n\t"
+        "jl 1b                              \n\t"
+        : [i]"+r"(i)
+        : [p]"r"(LANE(p, 2 * n)), [c]"r"(c)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",) "memory"
+    );
+}
+
+static void sr_1d97_float_sse2(float *p, int i0, int i1)
+{
+    lift_float_sse2(LANE(p, 2 * (i0 >> 1) - 2), (i1 >> 1) - (i0 >> 1) + 3, dwt_coeffs_float[0]);
+    lift_float_sse2(LANE(p, 2 * (i0 >> 1) - 1), (i1 >> 1) - (i0 >> 1) + 2, dwt_coeffs_float[1]);
+    lift_float_sse2(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1, dwt_coeffs_float[2]);
+    lift_float_sse2(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),     dwt_coeffs_float[3]);
+}
+
+/* p[2k] op= (p[2k - 1] + p[2k + 1] + rnd) >> shift for 0 <= k < n */
+#define LIFT53_SSE2(name, op)                                               \
+static av_always_inline void name(int32_t *p, int n,                        \
+                                  const int32_t *rnd, int shift)            \
+{                                                                           \
+    x86_reg i = -(x86_reg)n * 64;                                           \
+                                                                            \
+    __asm__ volatile (                                                      \
+        "movdqa (%[rnd]), %%xmm4            \n\t"                           \
+        "movd   %[shift], %%xmm5            \n\t"                           \
+        "1:                                 \n\t"                           \
+        "movdqu -32(%[p],%[i]), %%xmm0      \n\t"                           \
+        "movdqu -16(%[p],%[i]), %%xmm1      \n\t"                           \
+        "movdqu  32(%[p],%[i]), %%xmm2      \n\t"                           \
+        "movdqu  48(%[p],%[i]), %%xmm3      \n\t"                           \
+        "paddd  %%xmm2, %%xmm0              \n\t"                           \
+        "paddd  %%xmm3, %%xmm1              \n\t"                           \
+        "paddd  %%xmm4, %%xmm0              \n\t"                           \
+        "paddd  %%xmm4, %%xmm1              \n\t"                           \
+        "psrad  %%xmm5, %%xmm0              \n\t"                           \
+        "psrad  %%xmm5, %%xmm1              \n\t"                           \
+        "movdqu    (%[p],%[i]), %%xmm2      \n\t"                           \
+        "movdqu  16(%[p],%[i]), %%xmm3      \n\t"                           \
+        op"     %%xmm0, %%xmm2              \n\t"                           \
+        op"     %%xmm1, %%xmm3              \n\t"                           \
+        "movdqu %%xmm2,    (%[p],%[i])      \n\t"                           \
+        "movdqu %%xmm3,  16(%[p],%[i])      \n\t"                           \
+        "add $64, %[i]                      \n\t"                           \
+        "jl 1b                              \n\t"                           \
+        : [i]"+r"(i)                                                        \
+        : [p]"r"(LANE(p, 2 * n)), [rnd]"r"(rnd), [shift]"r"(shift)          \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",)     \
+          "memory"                                                          \
+    );                                                                      \
+}
+
+LIFT53_SSE2(lift53_sub_sse2, "psubd")
+LIFT53_SSE2(lift53_add_sse2, "paddd")
+
+static void sr_1d53_sse2(int32_t *p, int i0, int i1)
+{
+    lift53_sub_sse2(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1, dwt_rnd53[0], 2);
+    lift53_add_sse2(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),     dwt_rnd53[1], 1);
+}
+
+/* 4 lanes of p[2k] op= (c * (p[2k - 1] + p[2k + 1]) + (1 << 15)) >> 16,
+ * keeping bits 16..47 of the 64-bit products of the even and odd lanes */
+#define LIFT97_INT_HALF_SSE2(off, op)                                       \
+        "movdqu "#off"-32(%[p],%[i]), %%xmm0    \n\t"                       \
+        "movdqu "#off"+32(%[p],%[i]), %%xmm1    \n\t"                       \
+        "paddd  %%xmm1, %%xmm0                  \n\t"                       \
+        "movdqa %%xmm0, %%xmm1                  \n\t"                       \
+        "movdqa %%xmm0, %%xmm2                  \n\t"                       \
+        "psrlq  $32, %%xmm1                     \n\t"                       \
+        "psrad  $31, %%xmm2                     \n\t"                       \
+        "pand   %%xmm7, %%xmm2                  \n\t"                       \
+        "pmuludq %%xmm6, %%xmm0                 \n\t"                       \
+        "pmuludq %%xmm6, %%xmm1                 \n\t"                       \
+        "paddq  %%xmm5, %%xmm0                  \n\t"                       \
+        "paddq  %%xmm5, %%xmm1                  \n\t"                       \
+        "psllq  $16, %%xmm0                     \n\t"                       \
+        "psrlq  $16, %%xmm1                     \n\t"                       \
+        "psrlq  $32, %%xmm0                     \n\t"                       \
+        "psllq  $32, %%xmm1                     \n\t"                       \
+        "por    %%xmm1, %%xmm0                  \n\t"                       \
+        "psubd  %%xmm2, %%xmm0                  \n\t"                       \
+        "movdqu "#off"(%[p],%[i]), %%xmm3       \n\t"                       \
+        op"     %%xmm0, %%xmm3                  \n\t"                       \
+        "movdqu %%xmm3, "#off"(%[p],%[i])       \n\t"
+
+#define LIFT97_INT_SSE2(name, op)                                           \
+static av_always_inline void name(int32_t *p, int n,                        \
+                                  const uint64_t *c, const uint32_t *corr)  \
+{                                                                           \
+    x86_reg i = -(x86_reg)n * 64;                                           \
+                                                                            \
+    __asm__ volatile (                                                      \
+        "movdqa (%[rnd]), %%xmm5                \n\t"                       \
+        "movdqa (%[c]), %%xmm6                  \n\t"                       \
+        "movdqa (%[corr]), %%xmm7               \n\t"                       \
+        "1:                                     \n\t"                       \
+        LIFT97_INT_HALF_SSE2(0, op)                                         \
+        LIFT97_INT_HALF_SSE2(16, op)                                        \
+        "add $64, %[i]                          \n\t"                       \
+        "jl 1b                                  \n\t"                       \
+        : [i]"+r"(i)                                                        \
+        : [p]"r"(LANE(p, 2 * n)), [c]"r"(c), [corr]"r"(corr),               \
+          [rnd]"r"(dwt_coeffs_int[4])                                       \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",                      \
+                       "xmm5", "xmm6", "xmm7",) "memory"                    \
+    );                                                                      \
+}
+
+LIFT97_INT_SSE2(lift97_int_sub_sse2, "psubd")
+LIFT97_INT_SSE2(lift97_int_add_sse2, "paddd")
+
+static void sr_1d97_int_sse2(int32_t *p, int i0, int i1)
+{
+    lift97_int_sub_sse2(LANE(p, 2 * (i0 >> 1) - 2), (i1 >> 1) - (i0 >> 1) + 3,
+                        dwt_coeffs_int[0], dwt_corr_int[0]);
+    lift97_int_sub_sse2(LANE(p, 2 * (i0 >> 1) - 1), (i1 >> 1) - (i0 >> 1) + 2,
+                        dwt_coeffs_int[1], dwt_corr_int[1]);
+    lift97_int_add_sse2(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1,
+                        dwt_coeffs_int[2], dwt_corr_int[2]);
+    lift97_int_add_sse2(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),
+                        dwt_coeffs_int[3], dwt_corr_int[3]);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX_INLINE
+static av_always_inline void lift_float_avx(float *p, int n, const float *c)
+{
+    x86_reg i = -(x86_reg)n * 64;
+
+    __asm__ volatile (
+        "vbroadcastss (%[c]), %%ymm1                \n\t"
+        "1:                                         \n\t"
+        "vmovups -32(%[p],%[i]), %%ymm0             \n\t"
+        "vaddps   32(%[p],%[i]), %%ymm0, %%ymm0     \n\t"
+        "vmulps  %%ymm1, %%ymm0, %%ymm0             \n\t"
+        "vaddps    (%[p],%[i]), %%ymm0, %%ymm0      \n\t"
+        "vmovups %%ymm0, (%[p],%[i])                \n\t"
+        "add $64, %[i]                              \n\t"
+        "jl 1b                                      \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i)
+        : [p]"r"(LANE(p, 2 * n)), [c]"r"(c)
+        : XMM_CLOBBERS("xmm0", "xmm1",) "memory"
+    );
+}
+
+static void sr_1d97_float_avx(float *p, int i0, int i1)
+{
+    lift_float_avx(LANE(p, 2 * (i0 >> 1) - 2), (i1 >> 1) - (i0 >> 1) + 3, dwt_coeffs_float[0]);
+    lift_float_avx(LANE(p, 2 * (i0 >> 1) - 1), (i1 >> 1) - (i0 >> 1) + 2, dwt_coeffs_float[1]);
+    lift_float_avx(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1, dwt_coeffs_float[2]);
+    lift_float_avx(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),     dwt_coeffs_float[3]);
+}
+#endif /* HAVE_AVX_INLINE */
+
+#if HAVE_AVX2_INLINE
+#define LIFT53_AVX2(name, op)                                               \
+static av_always_inline void name(int32_t *p, int n,                        \
+                                  const int32_t *rnd, int shift)            \
+{                                                                           \
+    x86_reg i = -(x86_reg)n * 64;                                           \
+                                                                            \
+    __asm__ volatile (                                                      \
+        "vmovdqa (%[rnd]), %%ymm2                   \n\t"                   \
+        "vmovd   %[shift], %%xmm3                   \n\t"                   \
+        "1:                                         \n\t"                   \
+        "vmovdqu -32(%[p],%[i]), %%ymm0             \n\t"                   \
+        "vpaddd   32(%[p],%[i]), %%ymm0, %%ymm0     \n\t"                   \
+        "vpaddd  %%ymm2, %%ymm0, %%ymm0             \n\t"                   \
+        "vpsrad  %%xmm3, %%ymm0, %%ymm0             \n\t"                   \
+        "vmovdqu   (%[p],%[i]), %%ymm1              \n\t"                   \
+        op"      %%ymm0, %%ymm1, %%ymm1             \n\t"                   \
+        "vmovdqu %%ymm1, (%[p],%[i])                \n\t"                   \
+        "add $64, %[i]                              \n\t"                   \
+        "jl 1b                                      \n\t"                   \
+        "vzeroupper                                 \n\t"                   \
+        : [i]"+r"(i)                                                        \
+        : [p]"r"(LANE(p, 2 * n)), [rnd]"r"(rnd), [shift]"r"(shift)          \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "memory"            \
+    );                                                                      \
+}
+
+LIFT53_AVX2(lift53_sub_avx2, "vpsubd")
+LIFT53_AVX2(lift53_add_avx2, "vpaddd")
+
+static void sr_1d53_avx2(int32_t *p, int i0, int i1)
+{
+    lift53_sub_avx2(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1, dwt_rnd53[0], 2);
+    lift53_add_avx2(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),     dwt_rnd53[1], 1);
+}
+
+/* vpmuldq is signed, so no correction is needed here; the logical shifts
+ * leave bits 16..47 of the products in the even and odd dwords */
+#define LIFT97_INT_AVX2(name, op)                                           \
+static av_always_inline void name(int32_t *p, int n, const uint64_t *c)     \
+{                                                                           \
+    x86_reg i = -(x86_reg)n * 64;                                           \
+                                                                            \
+    __asm__ volatile (                                                      \
+        "vmovdqa (%[rnd]), %%ymm4                   \n\t"                   \
+        "vmovdqa (%[c]), %%ymm5                     \n\t"                   \
+        "1:                                         \n\t"                   \
+        "vmovdqu -32(%[p],%[i]), %%ymm0             \n\t"                   \
+        "vpaddd   32(%[p],%[i]), %%ymm0, %%ymm0     \n\t"                   \
+        "vpsrlq  $32, %%ymm0, %%ymm1                \n\t"                   \
+        "vpmuldq %%ymm5, %%ymm0, %%ymm0             \n\t"                   \
+        "vpmuldq %%ymm5, %%ymm1, %%ymm1             \n\t"                   \
+        "vpaddq  %%ymm4, %%ymm0, %%ymm0             \n\t"                   \
+        "vpaddq  %%ymm4, %%ymm1, %%ymm1             \n\t"                   \
+        "vpsrlq  $16, %%ymm0, %%ymm0                \n\t"                   \
+        "vpsllq  $16, %%ymm1, %%ymm1                \n\t"                   \
+        "vpblendd $0xaa, %%ymm1, %%ymm0, %%ymm0     \n\t"                   \
+        "vmovdqu   (%[p],%[i]), %%ymm1              \n\t"                   \
+        op"      %%ymm0, %%ymm1, %%ymm1             \n\t"                   \
+        "vmovdqu %%ymm1, (%[p],%[i])                \n\t"                   \
+        "add $64, %[i]                              \n\t"                   \
+        "jl 1b                                      \n\t"                   \
+        "vzeroupper                                 \n\t"                   \
+        : [i]"+r"(i)                                                        \
+        : [p]"r"(LANE(p, 2 * n)), [c]"r"(c), [rnd]"r"(dwt_coeffs_int[4])    \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm4", "xmm5",) "memory"            \
+    );                                                                      \
+}
+
+LIFT97_INT_AVX2(lift97_int_sub_avx2, "vpsubd")
+LIFT97_INT_AVX2(lift97_int_add_avx2, "vpaddd")
+
+static void sr_1d97_int_avx2(int32_t *p, int i0, int i1)
+{
+    lift97_int_sub_avx2(LANE(p, 2 * (i0 >> 1) - 2), (i1 >> 1) - (i0 >> 1) + 3, dwt_coeffs_int[0]);
+    lift97_int_sub_avx2(LANE(p, 2 * (i0 >> 1) - 1), (i1 >> 1) - (i0 >> 1) + 2, dwt_coeffs_int[1]);
+    lift97_int_add_avx2(LANE(p, 2 * (i0 >> 1)),     (i1 >> 1) - (i0 >> 1) + 1, dwt_coeffs_int[2]);
+    lift97_int_add_avx2(LANE(p, 2 * (i0 >> 1) + 1), (i1 >> 1) - (i0 >> 1),     dwt_coeffs_int[3]);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_dwtdsp_init_x86(DWTDSPContext *c)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        c->sr_1d97_float = sr_1d97_float_sse2;
+        c->sr_1d97_int   = sr_1d97_int_sse2;
+        c->sr_1d53       = sr_1d53_sse2;
+    }
+#endif
+#if HAVE_AVX_INLINE
+    if (INLINE_AVX(cpu_flags))
+        c->sr_1d97_float = sr_1d97_float_avx;
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        c->sr_1d97_int   = sr_1d97_int_avx2;
+        c->sr_1d53       = sr_1d53_avx2;
+    }
+#endif
+}
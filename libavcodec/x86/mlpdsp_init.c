@@ -19,8 +19,12 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include "libavutil/attributes.h"
 #include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
 #include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libavcodec/mlpdsp.h"
@@ -188,14 +192,295 @@ static void mlp_filter_channel_x86(int32_t *state, const int32_t *coeff,
     );
 }
 
+static void mlp_filter_channels_x86(ChannelParams *cp,
+                                    const uint8_t *quant_step_size,
+                                    int nb_channels, int blocksize,
+                                    int32_t *sample_buffer)
+{
+    ff_mlp_filter_channels(cp, quant_step_size, nb_channels, blocksize,
+                           sample_buffer, mlp_filter_channel_x86);
+}
+
 #endif /* HAVE_7REGS && HAVE_INLINE_ASM */
 
+#if HAVE_AVX2_INLINE && ARCH_X86_64
+
+DECLARE_ASM_CONST(32, int32_t, even_dwords)[8] = { 0, 2, 4, 6, 0, 0, 0, 0 };
+
+/* One tap of the filters of 4 channels: each history entry and coefficient
+ * row holds one qword per channel, with the value in the low dword. */
+#define FILTER_TAP(hist, k, c)                                  \
+        "vmovdqa   "#k"*32(%["#hist"]), %%ymm3          \n\t"   \
+        "vpmuldq   "#c"*32(%[coeff]), %%ymm3, %%ymm3    \n\t"   \
+        "vpaddq             %%ymm3, %%ymm0, %%ymm0      \n\t"
+
+#define LOAD_RESIDUALS_4                                        \
+        "vpmovzxdq  (%[smp],%[i]), %%ymm3               \n\t"
+#define STORE_SAMPLES_4                                         \
+        "vmovdqu            %%xmm3, (%[smp],%[i])       \n\t"
+#define LOAD_RESIDUALS_MASKED                                   \
+        "vpmaskmovd (%[smp],%[i]), %%xmm5, %%xmm3       \n\t"   \
+        "vpmovzxdq          %%xmm3, %%ymm3              \n\t"
+#define STORE_SAMPLES_MASKED                                    \
+        "vpmaskmovd         %%xmm3, %%xmm5, (%[smp],%[i]) \n\t"
+
+/* The newest FIR and IIR history entries are kept in ymm1 and ymm2, so the
+ * loop carried dependency does not go through memory. */
+#define FILTER_QUAD(LOAD, STORE)                                \
+    __asm__ volatile (                                          \
+        "vmovdqa            (%[fir]), %%ymm1            \n\t"   \
+        "vmovdqa            (%[iir]), %%ymm2            \n\t"   \
+        "vmovdqa            %[perm], %%ymm4             \n\t"   \
+        "vmovdqa          (%[lanes]), %%xmm5            \n\t"   \
+        "vmovdqa            (%[par]), %%ymm6            \n\t"   \
+        "vmovdqa          32(%[par]), %%ymm7            \n\t"   \
+        "1:                                             \n\t"   \
+        "vmovdqa          32(%[fir]), %%ymm0            \n\t"   \
+        "vpmuldq        32(%[coeff]), %%ymm0, %%ymm0    \n\t"   \
+        FILTER_TAP(fir, 2,  2)                                  \
+        FILTER_TAP(fir, 3,  3)                                  \
+        FILTER_TAP(fir, 4,  4)                                  \
+        FILTER_TAP(fir, 5,  5)                                  \
+        FILTER_TAP(fir, 6,  6)                                  \
+        FILTER_TAP(fir, 7,  7)                                  \
+        FILTER_TAP(iir, 1,  9)                                  \
+        FILTER_TAP(iir, 2, 10)                                  \
+        FILTER_TAP(iir, 3, 11)                                  \
+        "vpmuldq          (%[coeff]), %%ymm1, %%ymm1    \n\t"   \
+        "vpmuldq       256(%[coeff]), %%ymm2, %%ymm2    \n\t"   \
+        "vpaddq             %%ymm1, %%ymm0, %%ymm0      \n\t"   \
+        "vpaddq             %%ymm2, %%ymm0, %%ymm0      \n\t"   \
+        "vpsrlvq            %%ymm6, %%ymm0, %%ymm0      \n\t"   \
+        LOAD                                                    \
+        "vpaddd             %%ymm3, %%ymm0, %%ymm1      \n\t"   \
+        "vpand              %%ymm7, %%ymm1, %%ymm1      \n\t"   \
+        "vpsubd             %%ymm0, %%ymm1, %%ymm2      \n\t"   \
+        "sub                   $32, %[fir]              \n\t"   \
+        "sub                   $32, %[iir]              \n\t"   \
+        "vmovdqa            %%ymm1, (%[fir])            \n\t"   \
+        "vmovdqa            %%ymm2, (%[iir])            \n\t"   \
+        "vpermd             %%ymm1, %%ymm4, %%ymm3      \n\t"   \
+        STORE                                                   \
+        "add                   $32, %[i]                \n\t"   \
+        "jl 1b                                          \n\t"   \
+        "vzeroupper                                     \n\t"   \
+        : [fir]"+r"(fir), [iir]"+r"(iir), [i]"+r"(i)            \
+        : [smp]"r"(sample_buffer + blocksize * MAX_CHANNELS),   \
+          [coeff]"r"(coeff), [par]"r"(par), [lanes]"r"(lanes),  \
+          [perm]"m"(even_dwords)                                \
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",      \
+                       "%xmm4", "%xmm5", "%xmm6", "%xmm7",)     \
+          "memory"                                              \
+    )
+
+/**
+ * Filter up to 4 adjacent channels at once, one qword lane per channel.
+ * Coefficients past the order of a channel are zero, so all lanes run
+ * MAX_FIR_ORDER + MAX_IIR_ORDER taps. The filter shift is at most 15, so
+ * a logical shift gives the same low dword as the arithmetic one.
+ */
+static void mlp_filter_quad_avx2(ChannelParams *cp,
+                                 const uint8_t *quant_step_size,
+                                 int nb_channels, int blocksize,
+                                 int32_t *sample_buffer)
+{
+    LOCAL_ALIGNED_32(int64_t, firbuf, [(MAX_BLOCKSIZE + MAX_FIR_ORDER) * 4]);
+    LOCAL_ALIGNED_32(int64_t, iirbuf, [(MAX_BLOCKSIZE + MAX_IIR_ORDER) * 4]);
+    LOCAL_ALIGNED_32(int64_t, coeff,  [(MAX_FIR_ORDER + MAX_IIR_ORDER) * 4]);
+    LOCAL_ALIGNED_32(int64_t, par,    [2 * 4]);
+    LOCAL_ALIGNED_16(int32_t, lanes,  [4]);
+    int64_t *fir = firbuf + blocksize * 4;
+    int64_t *iir = iirbuf + blocksize * 4;
+    x86_reg i = -blocksize * MAX_CHANNELS * (x86_reg)sizeof(int32_t);
+    int ch, k;
+
+    memset(fir,   0, MAX_FIR_ORDER * 4 * sizeof(*fir));
+    memset(iir,   0, MAX_IIR_ORDER * 4 * sizeof(*iir));
+    memset(coeff, 0, (MAX_FIR_ORDER + MAX_IIR_ORDER) * 4 * sizeof(*coeff));
+    memset(par,   0, 2 * 4 * sizeof(*par));
+    memset(lanes, 0, 4 * sizeof(*lanes));
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        FilterParams *fp = cp[ch].filter_params;
+
+        for (k = 0; k < MAX_FIR_ORDER; k++)
+            fir[k * 4 + ch] = fp[FIR].state[k];
+        for (k = 0; k < MAX_IIR_ORDER; k++)
+            iir[k * 4 + ch] = fp[IIR].state[k];
+        for (k = 0; k < fp[FIR].order; k++)
+            coeff[k * 4 + ch] = cp[ch].coeff[FIR][k];
+        for (k = 0; k < fp[IIR].order; k++)
+            coeff[(MAX_FIR_ORDER + k) * 4 + ch] = cp[ch].coeff[IIR][k];
+        par[ch]     = fp[FIR].shift;
+        par[4 + ch] = (uint32_t)MSB_MASK(quant_step_size[ch]);
+        lanes[ch]   = -1;
+    }
+
+    if (nb_channels == 4)
+        FILTER_QUAD(LOAD_RESIDUALS_4, STORE_SAMPLES_4);
+    else
+        FILTER_QUAD(LOAD_RESIDUALS_MASKED, STORE_SAMPLES_MASKED);
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        FilterParams *fp = cp[ch].filter_params;
+
+        for (k = 0; k < MAX_FIR_ORDER; k++)
+            fp[FIR].state[k] = fir[k * 4 + ch];
+        for (k = 0; k < MAX_IIR_ORDER; k++)
+            fp[IIR].state[k] = iir[k * 4 + ch];
+    }
+}
+
+static void mlp_filter_channels_avx2(ChannelParams *cp,
+                                     const uint8_t *quant_step_size,
+                                     int nb_channels, int blocksize,
+                                     int32_t *sample_buffer)
+{
+    int ch;
+
+    if (blocksize <= 0)
+        return;
+
+    for (ch = 0; ch < nb_channels; ch += 4)
+        mlp_filter_quad_avx2(cp + ch, quant_step_size + ch,
+                             FFMIN(nb_channels - ch, 4), blocksize,
+                             sample_buffer + ch);
+}
+
+#define PACK_OUTPUT_32                                          \
+        "vpslld                 $8, %%ymm0, %%ymm0      \n\t"   \
+        "vmovdqu            %%ymm0, (%[dst])            \n\t"
+#define PACK_OUTPUT_16                                          \
+        "vpslld                 $8, %%ymm0, %%ymm0      \n\t"   \
+        "vpsrad                $16, %%ymm0, %%ymm0      \n\t"   \
+        "vpackssdw          %%ymm0, %%ymm0, %%ymm0      \n\t"   \
+        "vpermq              $0x08, %%ymm0, %%ymm0      \n\t"   \
+        "vmovdqu            %%xmm0, (%[dst])            \n\t"
+
+/* Each row is reordered with vpermd and stored as a full vector, the next
+ * row overwriting the unused tail. Lanes past the last channel have a
+ * check shift of 32, so they do not contribute to the lossless check. */
+#define PACK_ROWS(PACK)                                         \
+    __asm__ volatile (                                          \
+        "vmovdqa            (%[idx]), %%ymm5            \n\t"   \
+        "vmovdqa          (%[shift]), %%ymm6            \n\t"   \
+        "vmovdqa          (%[check]), %%ymm7            \n\t"   \
+        "vpcmpeqd           %%ymm3, %%ymm3, %%ymm3      \n\t"   \
+        "vpsrld                 $8, %%ymm3, %%ymm3      \n\t"   \
+        "vpxor              %%ymm4, %%ymm4, %%ymm4      \n\t"   \
+        "1:                                             \n\t"   \
+        "vpermd             (%[src]), %%ymm5, %%ymm0    \n\t"   \
+        "vpsllvd            %%ymm6, %%ymm0, %%ymm0      \n\t"   \
+        "vpand              %%ymm3, %%ymm0, %%ymm1      \n\t"   \
+        "vpsllvd            %%ymm7, %%ymm1, %%ymm1      \n\t"   \
+        "vpxor              %%ymm1, %%ymm4, %%ymm4      \n\t"   \
+        PACK                                                    \
+        "add                   $32, %[src]              \n\t"   \
+        "add             %[stride], %[dst]              \n\t"   \
+        "sub                    $1, %[rows]             \n\t"   \
+        "jg 1b                                          \n\t"   \
+        "vextracti128           $1, %%ymm4, %%xmm1      \n\t"   \
+        "vpxor              %%xmm1, %%xmm4, %%xmm4      \n\t"   \
+        "vpshufd             $0x4e, %%xmm4, %%xmm1      \n\t"   \
+        "vpxor              %%xmm1, %%xmm4, %%xmm4      \n\t"   \
+        "vpshufd             $0xb1, %%xmm4, %%xmm1      \n\t"   \
+        "vpxor              %%xmm1, %%xmm4, %%xmm4      \n\t"   \
+        "vmovd              %%xmm4, %[sum]              \n\t"   \
+        "vzeroupper                                     \n\t"   \
+        : [src]"+r"(src), [dst]"+r"(dst), [rows]"+r"(rows),     \
+          [sum]"=r"(check_data)                                 \
+        : [idx]"r"(idx), [shift]"r"(shift), [check]"r"(check),  \
+          [stride]"r"((x86_reg)(nb_channels * size))            \
+        : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm3", "%xmm4",      \
+                       "%xmm5", "%xmm6", "%xmm7",)              \
+          "memory"                                              \
+    )
+
+static int32_t mlp_pack_output_avx2(int32_t lossless_check_data,
+                                    uint16_t blockpos,
+                                    int32_t (*sample_buffer)[MAX_CHANNELS],
+                                    void *data,
+                                    uint8_t *ch_assign,
+                                    int8_t *output_shift,
+                                    uint8_t max_matrix_channel,
+                                    int is32)
+{
+    LOCAL_ALIGNED_32(int32_t, idx,   [MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(int32_t, shift, [MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(int32_t, check, [MAX_CHANNELS]);
+    int nb_channels = max_matrix_channel + 1;
+    int size = is32 ? 4 : 2;
+    const int32_t *src = sample_buffer[0];
+    uint8_t *dst = data;
+    x86_reg rows;
+    int32_t check_data;
+    int ch;
+
+    if (nb_channels > MAX_CHANNELS)
+        goto tail;
+
+    for (ch = 0; ch < MAX_CHANNELS; ch++) {
+        if (ch < nb_channels) {
+            int mat_ch = ch_assign[ch];
+            if (mat_ch >= MAX_CHANNELS || output_shift[mat_ch] < 0)
+                goto tail;
+            idx[ch]   = mat_ch;
+            shift[ch] = output_shift[mat_ch];
+            check[ch] = mat_ch;
+        } else {
+            idx[ch]   = 0;
+            shift[ch] = 0;
+            check[ch] = 32;
+        }
+    }
+
+    /* rows whose full vector store stays inside the output */
+    rows = blockpos - (MAX_CHANNELS + nb_channels - 1) / nb_channels + 1;
+    if (rows > 0) {
+        int done = rows;
+
+        if (is32)
+            PACK_ROWS(PACK_OUTPUT_32);
+        else
+            PACK_ROWS(PACK_OUTPUT_16);
+
+        lossless_check_data ^= check_data;
+        sample_buffer       += done;
+        blockpos            -= done;
+        data                 = dst;
+    }
+
+tail:
+    return ff_mlp_pack_output(lossless_check_data, blockpos, sample_buffer,
+                              data, ch_assign, output_shift,
+                              max_matrix_channel, is32);
+}
+
+static int32_t (*mlp_select_pack_output_avx2(uint8_t *ch_assign,
+                                             int8_t *output_shift,
+                                             uint8_t max_matrix_channel,
+                                             int is32))(int32_t, uint16_t, int32_t (*)[], void *, uint8_t*, int8_t *, uint8_t, int)
+{
+    return mlp_pack_output_avx2;
+}
+
+#endif /* HAVE_AVX2_INLINE && ARCH_X86_64 */
+
 av_cold void ff_mlpdsp_init_x86(MLPDSPContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
 #if HAVE_7REGS && HAVE_INLINE_ASM && HAVE_INLINE_ASM_NONLOCAL_LABELS
-    if (INLINE_MMX(cpu_flags))
-        c->mlp_filter_channel = mlp_filter_channel_x86;
+    if (INLINE_MMX(cpu_flags)) {
+        c->mlp_filter_channel  = mlp_filter_channel_x86;
+        c->mlp_filter_channels = mlp_filter_channels_x86;
+    }
+#endif
+#if HAVE_AVX2_INLINE && ARCH_X86_64
+    if (INLINE_AVX2(cpu_flags)) {
+        c->mlp_filter_channels    = mlp_filter_channels_avx2;
+        c->mlp_select_pack_output = mlp_select_pack_output_avx2;
+        c->mlp_pack_output        = mlp_pack_output_avx2;
+    }
 #endif
     if (ARCH_X86_64 && EXTERNAL_SSE4(cpu_flags))
         c->mlp_rematrix_channel = ff_mlp_rematrix_channel_sse4;
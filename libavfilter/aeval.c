@@ -69,6 +69,7 @@ typedef struct {
     int64_t duration;
     uint64_t n;
     double var_values[VAR_VARS_NB];
+    double *n_values, *t_values; ///< per sample values of n and t
     double *channel_values;
     int64_t out_channel_layout;
 } EvalContext;
@@ -217,6 +218,8 @@ static av_cold void uninit(AVFilterContext *ctx)
         eval->expr[i] = NULL;
     }
     av_freep(&eval->expr);
+    av_freep(&eval->n_values);
+    av_freep(&eval->t_values);
     av_freep(&eval->channel_values);
 }
 
@@ -275,26 +278,36 @@ static int request_frame(AVFilterLink *outlink)
 {
     EvalContext *eval = outlink->src->priv;
     AVFrame *samplesref;
+    const double *arrays[VAR_VARS_NB] = { NULL };
     int i, j;
     int64_t t = av_rescale(eval->n, AV_TIME_BASE, eval->sample_rate);
 
     if (eval->duration >= 0 && t >= eval->duration)
         return AVERROR_EOF;
 
+    if (!eval->n_values) {
+        eval->n_values = av_malloc_array(eval->nb_samples, sizeof(*eval->n_values));
+        eval->t_values = av_malloc_array(eval->nb_samples, sizeof(*eval->t_values));
+        if (!eval->n_values || !eval->t_values)
+            return AVERROR(ENOMEM);
+    }
+
     samplesref = ff_get_audio_buffer(outlink, eval->nb_samples);
     if (!samplesref)
         return AVERROR(ENOMEM);
 
-    /* evaluate expression for each single sample and for each channel */
     for (i = 0; i < eval->nb_samples; i++, eval->n++) {
-        eval->var_values[VAR_N] = eval->n;
-        eval->var_values[VAR_T] = eval->var_values[VAR_N] * (double)1/eval->sample_rate;
-
-        for (j = 0; j < eval->nb_channels; j++) {
-            *((double *) samplesref->extended_data[j] + i) =
-                av_expr_eval(eval->expr[j], eval->var_values, NULL);
-        }
+        eval->var_values[VAR_N] = eval->n_values[i] = eval->n;
+        eval->var_values[VAR_T] = eval->t_values[i] = eval->var_values[VAR_N] * (double)1/eval->sample_rate;
     }
+    arrays[VAR_N] = eval->n_values;
+    arrays[VAR_T] = eval->t_values;
+
+    /* evaluate expression for each single sample and for each channel;
+     * the channels use distinct expressions, so their order does not matter */
+    for (j = 0; j < eval->nb_channels; j++)
+        av_expr_eval_array(eval->expr[j], (double *)samplesref->extended_data[j],
+                           eval->nb_samples, eval->var_values, arrays, NULL);
 
     samplesref->pts = eval->pts;
     samplesref->sample_rate = eval->sample_rate;
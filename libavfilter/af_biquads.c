@@ -63,11 +63,16 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "af_biquads.h"
 #include "internal.h"
 
+/* samples per channel converted to and from the interleaved layout at once */
+#define BIQUADS_BLOCK 256
+
 enum FilterType {
     biquad,
     equalizer,
@@ -92,6 +97,7 @@ enum WidthType {
 typedef struct ChanCache {
     double i1, i2;
     double o1, o2;
+    int clippings;
 } ChanCache;
 
 typedef struct BiquadsContext {
@@ -111,10 +117,17 @@ typedef struct BiquadsContext {
 
     ChanCache *cache;
     int clippings;
+    int nb_threads;
+
+    double coeffs[5];
+    BiquadsDSPContext dsp;
 
     void (*filter)(struct BiquadsContext *s, const void *ibuf, void *obuf, int len,
                    double *i1, double *i2, double *o1, double *o2,
-                   double b0, double b1, double b2, double a1, double a2);
+                   double b0, double b1, double b2, double a1, double a2,
+                   int *clippings);
+    void (*filter_lanes)(struct BiquadsContext *s, uint8_t **src, uint8_t **dst,
+                         int nb_channels, int len, ChanCache *cache, double *buf);
 } BiquadsContext;
 
 static av_cold int init(AVFilterContext *ctx)
@@ -165,13 +178,62 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_samplerates(ctx, formats);
 }
 
+void ff_biquads_filter_c(double *buf, int len, double *state, const double *coeffs)
+{
+    const double b0 = coeffs[0];
+    const double b1 = coeffs[1];
+    const double b2 = coeffs[2];
+    const double a1 = coeffs[3];
+    const double a2 = coeffs[4];
+    int c, i;
+
+    for (c = 0; c < BIQUADS_LANES; c++) {
+        double *b = buf + c;
+        double i1 = state[c];
+        double i2 = state[c +     BIQUADS_LANES];
+        double o1 = state[c + 2 * BIQUADS_LANES];
+        double o2 = state[c + 3 * BIQUADS_LANES];
+
+        for (i = 0; i+1 < len; i++) {
+            o2 = i2 * b2 + i1 * b1 + b[i * BIQUADS_LANES] * b0 + o2 * a2 + o1 * a1;
+            i2 = b[i * BIQUADS_LANES];
+            b[i * BIQUADS_LANES] = o2;
+            i++;
+            o1 = i1 * b2 + i2 * b1 + b[i * BIQUADS_LANES] * b0 + o1 * a2 + o2 * a1;
+            i1 = b[i * BIQUADS_LANES];
+            b[i * BIQUADS_LANES] = o1;
+        }
+        if (i < len) {
+            double o0 = b[i * BIQUADS_LANES] * b0 + i1 * b1 + i2 * b2 + o1 * a1 + o2 * a2;
+            i2 = i1;
+            i1 = b[i * BIQUADS_LANES];
+            o2 = o1;
+            o1 = o0;
+            b[i * BIQUADS_LANES] = o0;
+        }
+
+        state[c                    ] = i1;
+        state[c +     BIQUADS_LANES] = i2;
+        state[c + 2 * BIQUADS_LANES] = o1;
+        state[c + 3 * BIQUADS_LANES] = o2;
+    }
+}
+
+av_cold void ff_biquads_init_dsp(BiquadsDSPContext *dsp)
+{
+    dsp->filter = ff_biquads_filter_c;
+
+    if (ARCH_X86)
+        ff_biquads_init_x86(dsp);
+}
+
 #define BIQUAD_FILTER(name, type, min, max, need_clipping)                    \
 static void biquad_## name (BiquadsContext *s,                                \
                             const void *input, void *output, int len,         \
                             double *in1, double *in2,                         \
                             double *out1, double *out2,                       \
                             double b0, double b1, double b2,                  \
-                            double a1, double a2)                             \
+                            double a1, double a2, int *clippings)             \
 {                                                                             \
     const type *ibuf = input;                                                 \
     type *obuf = output;                                                      \
@@ -187,10 +249,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o2 = i2 * b2 + i1 * b1 + ibuf[i] * b0 + o2 * a2 + o1 * a1;            \
         i2 = ibuf[i];                                                         \
         if (need_clipping && o2 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o2 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o2;                                                     \
@@ -199,10 +261,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o1 = i1 * b2 + i2 * b1 + ibuf[i] * b0 + o1 * a2 + o2 * a1;            \
         i1 = ibuf[i];                                                         \
         if (need_clipping && o1 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o1 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o1;                                                     \
@@ -215,10 +277,10 @@ static void biquad_## name (BiquadsContext *s,                                \
         o2 = o1;                                                              \
         o1 = o0;                                                              \
         if (need_clipping && o0 < min) {                                      \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = min;                                                    \
         } else if (need_clipping && o0 > max) {                               \
-            s->clippings++;                                                   \
+            (*clippings)++;                                                   \
             obuf[i] = max;                                                    \
         } else {                                                              \
             obuf[i] = o0;                                                     \
@@ -228,6 +290,62 @@ static void biquad_## name (BiquadsContext *s,                                \
     *in2  = i2;                                                               \
     *out1 = o1;                                                               \
     *out2 = o2;                                                               \
+}                                                                             \
+                                                                              \
+static void biquad_## name ##_lanes(BiquadsContext *s,                        \
+                                    uint8_t **src, uint8_t **dst,             \
+                                    int nb_channels, int len,                 \
+                                    ChanCache *cache, double *buf)            \
+{                                                                             \
+    double state[4 * BIQUADS_LANES] = { 0 };                                  \
+    int c, i, start;                                                          \
+                                                                              \
+    for (c = 0; c < nb_channels; c++) {                                       \
+        state[c                    ] = cache[c].i1;                           \
+        state[c +     BIQUADS_LANES] = cache[c].i2;                           \
+        state[c + 2 * BIQUADS_LANES] = cache[c].o1;                           \
+        state[c + 3 * BIQUADS_LANES] = cache[c].o2;                           \
+    }                                                                         \
+    if (nb_channels < BIQUADS_LANES)                                          \
+        memset(buf, 0, BIQUADS_BLOCK * BIQUADS_LANES * sizeof(*buf));         \
+                                                                              \
+    for (start = 0; start < len; start += BIQUADS_BLOCK) {                    \
+        const int n = FFMIN(len - start, BIQUADS_BLOCK);                      \
+                                                                              \
+        for (c = 0; c < nb_channels; c++) {                                   \
+            const type *ibuf = (const type *)src[c] + start;                  \
+                                                                              \
+            for (i = 0; i < n; i++)                                           \
+                buf[i * BIQUADS_LANES + c] = ibuf[i];                         \
+        }                                                                     \
+                                                                              \
+        s->dsp.filter(buf, n, state, s->coeffs);                              \
+                                                                              \
+        for (c = 0; c < nb_channels; c++) {                                   \
+            type *obuf = (type *)dst[c] + start;                              \
+                                                                              \
+            for (i = 0; i < n; i++) {                                         \
+                const double o0 = buf[i * BIQUADS_LANES + c];                 \
+                                                                              \
+                if (need_clipping && o0 < min) {                              \
+                    cache[c].clippings++;                                     \
+                    obuf[i] = min;                                            \
+                } else if (need_clipping && o0 > max) {                       \
+                    cache[c].clippings++;                                     \
+                    obuf[i] = max;                                            \
+                } else {                                                      \
+                    obuf[i] = o0;                                             \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+    }                                                                         \
+                                                                              \
+    for (c = 0; c < nb_channels; c++) {                                       \
+        cache[c].i1 = state[c                    ];                           \
+        cache[c].i2 = state[c +     BIQUADS_LANES];                           \
+        cache[c].o1 = state[c + 2 * BIQUADS_LANES];                           \
+        cache[c].o2 = state[c + 3 * BIQUADS_LANES];                           \
+    }                                                                         \
 }
 
 BIQUAD_FILTER(s16, int16_t, INT16_MIN, INT16_MAX, 1)
@@ -375,22 +493,80 @@ static int config_output(AVFilterLink *outlink)
     s->b1 /= s->a0;
     s->b2 /= s->a0;
 
+    s->coeffs[0] =  s->b0;
+    s->coeffs[1] =  s->b1;
+    s->coeffs[2] =  s->b2;
+    s->coeffs[3] = -s->a1;
+    s->coeffs[4] = -s->a2;
+    ff_biquads_init_dsp(&s->dsp);
+    s->nb_threads = ctx->graph->nb_threads;
+
     s->cache = av_realloc_f(s->cache, sizeof(ChanCache), inlink->channels);
     if (!s->cache)
         return AVERROR(ENOMEM);
     memset(s->cache, 0, sizeof(ChanCache) * inlink->channels);
 
     switch (inlink->format) {
-    case AV_SAMPLE_FMT_S16P: s->filter = biquad_s16; break;
-    case AV_SAMPLE_FMT_S32P: s->filter = biquad_s32; break;
-    case AV_SAMPLE_FMT_FLTP: s->filter = biquad_flt; break;
-    case AV_SAMPLE_FMT_DBLP: s->filter = biquad_dbl; break;
+    case AV_SAMPLE_FMT_S16P:
+        s->filter       = biquad_s16;
+        s->filter_lanes = biquad_s16_lanes;
+        break;
+    case AV_SAMPLE_FMT_S32P:
+        s->filter       = biquad_s32;
+        s->filter_lanes = biquad_s32_lanes;
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        s->filter       = biquad_flt;
+        s->filter_lanes = biquad_flt_lanes;
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        s->filter       = biquad_dbl;
+        s->filter_lanes = biquad_dbl_lanes;
+        break;
     default: av_assert0(0);
     }
 
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BiquadsContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int channels = av_frame_get_channels(td->in);
+    const int nb_groups = (channels + BIQUADS_LANES - 1) / BIQUADS_LANES;
+    const int start = (nb_groups *  jobnr     ) / nb_jobs;
+    const int end   = (nb_groups * (jobnr + 1)) / nb_jobs;
+    LOCAL_ALIGNED_32(double, buf, [BIQUADS_BLOCK * BIQUADS_LANES]);
+    int g;
+
+    for (g = start; g < end; g++) {
+        const int ch = g * BIQUADS_LANES;
+        const int nb_channels = FFMIN(channels - ch, BIQUADS_LANES);
+        int c;
+
+        /* the interleaving only pays off if several lanes are filtered at
+         * once, so a lone channel, or all of them without SIMD, stay scalar */
+        if (nb_channels > 1 && s->dsp.filter != ff_biquads_filter_c) {
+            s->filter_lanes(s, td->in->extended_data + ch, td->out->extended_data + ch,
+                            nb_channels, td->in->nb_samples, s->cache + ch, buf);
+            continue;
+        }
+        for (c = ch; c < ch + nb_channels; c++)
+            s->filter(s, td->in->extended_data[c], td->out->extended_data[c],
+                      td->in->nb_samples,
+                      &s->cache[c].i1, &s->cache[c].i2,
+                      &s->cache[c].o1, &s->cache[c].o2,
+                      s->b0, s->b1, s->b2, s->a1, s->a2, &s->cache[c].clippings);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
 {
     AVFilterContext  *ctx = inlink->dst;
@@ -398,6 +574,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out_buf;
     int nb_samples = buf->nb_samples;
+    int channels = av_frame_get_channels(buf);
+    ThreadData td;
     int ch;
 
     if (av_frame_is_writable(buf)) {
@@ -411,12 +589,15 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *buf)
         av_frame_copy_props(out_buf, buf);
     }
 
-    for (ch = 0; ch < av_frame_get_channels(buf); ch++)
-        s->filter(s, buf->extended_data[ch],
-                  out_buf->extended_data[ch], nb_samples,
-                  &s->cache[ch].i1, &s->cache[ch].i2,
-                  &s->cache[ch].o1, &s->cache[ch].o2,
-                  s->b0, s->b1, s->b2, s->a1, s->a2);
+    td.in  = buf;
+    td.out = out_buf;
+    ctx->internal->execute(ctx, filter_channels, &td, NULL,
+                           FFMIN((channels + BIQUADS_LANES - 1) / BIQUADS_LANES, s->nb_threads));
+
+    for (ch = 0; ch < channels; ch++) {
+        s->clippings += s->cache[ch].clippings;
+        s->cache[ch].clippings = 0;
+    }
 
     if (s->clippings > 0)
         av_log(ctx, AV_LOG_WARNING, "clipping %d times. Please reduce gain.\n", s->clippings);
@@ -475,6 +656,7 @@ AVFilter ff_af_##name_ = {                         \
     .inputs        = inputs,                             \
     .outputs       = outputs,                            \
     .priv_class    = &name_##_class,                     \
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,        \
 }
 
 #if CONFIG_EQUALIZER_FILTER
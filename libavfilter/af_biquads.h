@@ -0,0 +1,42 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_BIQUADS_H
+#define AVFILTER_BIQUADS_H
+
+/* number of channels filtered together, interleaved sample by sample */
+#define BIQUADS_LANES 4
+
+typedef struct BiquadsDSPContext {
+    /**
+     * Run the direct form I recursion in place over len samples of
+     * BIQUADS_LANES interleaved channels, buf[i * BIQUADS_LANES + lane].
+     *
+     * @param state  i1, i2, o1 and o2 of every lane, each as an array of
+     *               BIQUADS_LANES doubles, updated on return
+     * @param coeffs b0, b1, b2, -a1 and -a2
+     */
+    void (*filter)(double *buf, int len, double *state, const double *coeffs);
+} BiquadsDSPContext;
+
+void ff_biquads_filter_c(double *buf, int len, double *state, const double *coeffs);
+
+void ff_biquads_init_dsp(BiquadsDSPContext *dsp);
+void ff_biquads_init_x86(BiquadsDSPContext *dsp);
+
+#endif /* AVFILTER_BIQUADS_H */
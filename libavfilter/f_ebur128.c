@@ -40,25 +40,12 @@
 #include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "f_ebur128.h"
 #include "formats.h"
 #include "internal.h"
 
 #define MAX_CHANNELS 63
 
-/* pre-filter coefficients */
-#define PRE_B0  1.53512485958697
-#define PRE_B1 -2.69169618940638
-#define PRE_B2  1.19839281085285
-#define PRE_A1 -1.69065929318241
-#define PRE_A2  0.73248077421585
-
-/* RLB-filter coefficients */
-#define RLB_B0  1.0
-#define RLB_B1 -2.0
-#define RLB_B2  1.0
-#define RLB_A1 -1.99004745483398
-#define RLB_A2  0.99007225036621
-
 #define ABS_THRES    -70            ///< silence gate: we discard anything below this absolute (LUFS) threshold
 #define ABS_UP_THRES  10            ///< upper loud limit to consider (ABS_THRES being the minimum)
 #define HIST_GRAIN   100            ///< defines histogram precision
@@ -78,10 +65,6 @@ struct hist_entry {
 };
 
 struct integrator {
-    double *cache[MAX_CHANNELS];    ///< window of filtered samples (N ms)
-    int cache_pos;                  ///< focus on the last added bin in the cache array
-    double sum[MAX_CHANNELS];       ///< sum of the last N ms filtered samples (cache content)
-    int filled;                     ///< 1 if the cache is completely filled, 0 otherwise
     double rel_threshold;           ///< relative threshold
     double sum_kept_powers;         ///< sum of the powers (weighted sums) above absolute threshold
     int nb_kept_powers;             ///< number of sum above absolute threshold
@@ -121,14 +104,21 @@ typedef struct {
     double *ch_weighting;           ///< channel weighting mapping
     int sample_count;               ///< sample count used for refresh frequency, reset at refresh
 
-    /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double x[MAX_CHANNELS * 3];     ///< 3 input samples cache for each channel
-    double y[MAX_CHANNELS * 3];     ///< 3 pre-filter samples cache for each channel
-    double z[MAX_CHANNELS * 3];     ///< 3 RLB-filter samples cache for each channel
+    /* Filter caches */
+    double state[MAX_CHANNELS * EBUR128_STATE_SIZE]; ///< pre and RLB-filter history for each channel
+    EBUR128DSPContext dsp;
 
+    /* The integration windows are made of the 100ms blocks between two
+     * refreshes, so only the energy of each block needs to be kept. */
+#define BLOCK_SAMPLES (48000 / 10)
 #define I400_BINS  (48000 * 4 / 10)
 #define I3000_BINS (48000 * 3)
+#define I400_BLOCKS  (I400_BINS  / BLOCK_SAMPLES)
+#define I3000_BLOCKS (I3000_BINS / BLOCK_SAMPLES)
+    double energy[MAX_CHANNELS];    ///< sum of the filtered samples powers in the current block for each channel
+    double blocks[I3000_BLOCKS];    ///< weighted energy of the last blocks
+    int block_pos;                  ///< position of the next block in the blocks array
+    int nb_blocks;                  ///< number of complete blocks, up to I3000_BLOCKS
     struct integrator i400;         ///< 400ms integrator, used for Momentary loudness  (M), and Integrated loudness (I)
     struct integrator i3000;        ///<    3s integrator, used for Short term loudness (S), and Loudness Range      (LRA)
 
@@ -390,17 +380,10 @@ static int config_audio_output(AVFilterLink *outlink)
         } else {
             ebur128->ch_weighting[i] = 1.0;
         }
-
-        if (!ebur128->ch_weighting[i])
-            continue;
-
-        /* bins buffer for the two integration window (400ms and 3s) */
-        ebur128->i400.cache[i]  = av_calloc(I400_BINS,  sizeof(*ebur128->i400.cache[0]));
-        ebur128->i3000.cache[i] = av_calloc(I3000_BINS, sizeof(*ebur128->i3000.cache[0]));
-        if (!ebur128->i400.cache[i] || !ebur128->i3000.cache[i])
-            return AVERROR(ENOMEM);
     }
 
+    ff_ebur128_init_dsp(&ebur128->dsp);
+
 #if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS) {
         int ret;
@@ -538,9 +521,53 @@ static int gate_update(struct integrator *integ, double power,
     return gate_hist_pos;
 }
 
+void ff_ebur128_filter_c(const double *samples, int len, int stride, int nb_channels,
+                         double *state, double *energy)
+{
+    int ch, i;
+
+    for (ch = 0; ch < nb_channels; ch++) {
+        const double *src = samples + ch;
+        double *st = state + ch * EBUR128_STATE_SIZE;
+        double x1 = st[0], x2 = st[1];
+        double y1 = st[2], y2 = st[3];
+        double z1 = st[4], z2 = st[5];
+        double sum = energy[ch];
+
+        for (i = 0; i < len; i++) {
+            const double x0 = src[i * stride];
+            double y0, z0;
+
+            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+            y0 = x0*PRE_B0 + x1*PRE_B1 + x2*PRE_B2 - y1*PRE_A1 - y2*PRE_A2;
+            z0 = y0*RLB_B0 + y1*RLB_B1 + y2*RLB_B2 - z1*RLB_A1 - z2*RLB_A2;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            z2 = z1;
+            z1 = z0;
+            sum += z0 * z0;
+        }
+
+        st[0] = x1; st[1] = x2;
+        st[2] = y1; st[3] = y2;
+        st[4] = z1; st[5] = z2;
+        energy[ch] = sum;
+    }
+}
+
+av_cold void ff_ebur128_init_dsp(EBUR128DSPContext *dsp)
+{
+    dsp->filter = ff_ebur128_filter_c;
+
+    if (ARCH_X86)
+        ff_ebur128_init_x86(dsp);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
-    int i, ch, idx_insample;
+    int i, ch, idx_insample, nb_block_samples;
     AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
     const int nb_channels = ebur128->nb_channels;
@@ -568,78 +595,56 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     }
 #endif
 
-    for (idx_insample = 0; idx_insample < nb_samples; idx_insample++) {
-        const int bin_id_400  = ebur128->i400.cache_pos;
-        const int bin_id_3000 = ebur128->i3000.cache_pos;
+    for (idx_insample = 0; idx_insample < nb_samples; idx_insample += nb_block_samples) {
+        nb_block_samples = FFMIN(nb_samples - idx_insample,
+                                 BLOCK_SAMPLES - ebur128->sample_count);
 
-#define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
-    ebur128->i##time.cache_pos++;                           \
-    if (ebur128->i##time.cache_pos == I##time##_BINS) {     \
-        ebur128->i##time.filled    = 1;                     \
-        ebur128->i##time.cache_pos = 0;                     \
-    }                                                       \
-} while (0)
-
-        MOVE_TO_NEXT_CACHED_ENTRY(400);
-        MOVE_TO_NEXT_CACHED_ENTRY(3000);
-
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
-
-            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(*samples));
-
-            ebur128->x[ch * 3] = *samples++; // set X[i]
-
-            if (!ebur128->ch_weighting[ch])
-                continue;
-
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, name) do {                                                 \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*name##_B0 + src[1]*name##_B1 + src[2]*name##_B2     \
-                                      - dst[1]*name##_A1 - dst[2]*name##_A2;    \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, PRE);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, RLB);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
-            /* add the new value, and limit the sum to the cache size (400ms or 3s)
-             * by removing the oldest one */
-            ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
-            ebur128->i3000.sum[ch] = ebur128->i3000.sum[ch] + bin - ebur128->i3000.cache[ch][bin_id_3000];
+        if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS) {
+            for (ch = 0; ch < nb_channels; ch++) {
+                double peak = ebur128->sample_peaks[ch];
 
-            /* override old cache entry with the new value */
-            ebur128->i400.cache [ch][bin_id_400 ] = bin;
-            ebur128->i3000.cache[ch][bin_id_3000] = bin;
+                for (i = 0; i < nb_block_samples; i++)
+                    peak = FFMAX(peak, fabs(samples[i * nb_channels + ch]));
+                ebur128->sample_peaks[ch] = peak;
+            }
         }
 
+        ebur128->dsp.filter(samples, nb_block_samples, nb_channels, nb_channels,
+                            ebur128->state, ebur128->energy);
+        samples += nb_block_samples * nb_channels;
+
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
-        if (++ebur128->sample_count == 4800) {
+        ebur128->sample_count += nb_block_samples;
+        if (ebur128->sample_count == BLOCK_SAMPLES) {
             double loudness_400, loudness_3000;
             double power_400 = 1e-12, power_3000 = 1e-12;
+            double block_energy = 0;
             AVFilterLink *outlink = ctx->outputs[0];
             const int64_t pts = insamples->pts +
-                av_rescale_q(idx_insample, (AVRational){ 1, inlink->sample_rate },
+                av_rescale_q(idx_insample + nb_block_samples - 1,
+                             (AVRational){ 1, inlink->sample_rate },
                              outlink->time_base);
 
             ebur128->sample_count = 0;
 
+            /* weight the energy of the block, and push it in the last blocks */
+            for (ch = 0; ch < nb_channels; ch++) {
+                if (ebur128->ch_weighting[ch])
+                    block_energy += ebur128->ch_weighting[ch] * ebur128->energy[ch];
+                ebur128->energy[ch] = 0;
+            }
+            ebur128->blocks[ebur128->block_pos] = block_energy;
+            ebur128->block_pos = (ebur128->block_pos + 1) % I3000_BLOCKS;
+            ebur128->nb_blocks = FFMIN(ebur128->nb_blocks + 1, I3000_BLOCKS);
+
 #define COMPUTE_LOUDNESS(m, time) do {                                              \
-    if (ebur128->i##time.filled) {                                                  \
+    if (ebur128->nb_blocks >= I##time##_BLOCKS) {                                   \
         /* weighting sum of the last <time> ms */                                   \
-        for (ch = 0; ch < nb_channels; ch++)                                        \
-            power_##time += ebur128->ch_weighting[ch] * ebur128->i##time.sum[ch];   \
+        for (i = 1; i <= I##time##_BLOCKS; i++)                                     \
+            power_##time += ebur128->blocks[(ebur128->block_pos + I3000_BLOCKS - i) \
+                                            % I3000_BLOCKS];                        \
         power_##time /= I##time##_BINS;                                             \
     }                                                                               \
     loudness_##time = LOUDNESS(power_##time);                                       \
@@ -913,10 +918,6 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&ebur128->true_peaks_per_frame);
     av_freep(&ebur128->i400.histogram);
     av_freep(&ebur128->i3000.histogram);
-    for (i = 0; i < ebur128->nb_channels; i++) {
-        av_freep(&ebur128->i400.cache[i]);
-        av_freep(&ebur128->i3000.cache[i]);
-    }
     for (i = 0; i < ctx->nb_outputs; i++)
         av_freep(&ctx->output_pads[i].name);
     av_frame_free(&ebur128->outpicref);
@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_F_EBUR128_H
+#define AVFILTER_F_EBUR128_H
+
+/* pre-filter coefficients */
+#define PRE_B0  1.53512485958697
+#define PRE_B1 -2.69169618940638
+#define PRE_B2  1.19839281085285
+#define PRE_A1 -1.69065929318241
+#define PRE_A2  0.73248077421585
+
+/* RLB-filter coefficients */
+#define RLB_B0  1.0
+#define RLB_B1 -2.0
+#define RLB_B2  1.0
+#define RLB_A1 -1.99004745483398
+#define RLB_A2  0.99007225036621
+
+/* X[i-1], X[i-2], Y[i-1], Y[i-2], Z[i-1] and Z[i-2] */
+#define EBUR128_STATE_SIZE 6
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the pre-filter and the RLB-filter (K-weighting) to len samples
+     * of nb_channels channels, samples[i * stride + ch], and add the sum of
+     * the squared filtered samples of each channel to energy[ch].
+     *
+     * @param state filter history of each channel, as EBUR128_STATE_SIZE
+     *              doubles starting at state[ch * EBUR128_STATE_SIZE],
+     *              updated on return
+     */
+    void (*filter)(const double *samples, int len, int stride, int nb_channels,
+                   double *state, double *energy);
+} EBUR128DSPContext;
+
+void ff_ebur128_filter_c(const double *samples, int len, int stride, int nb_channels,
+                         double *state, double *energy);
+
+void ff_ebur128_init_dsp(EBUR128DSPContext *dsp);
+void ff_ebur128_init_x86(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_F_EBUR128_H */
@@ -25,12 +25,21 @@
 #include <stdint.h>
 
 typedef struct SSIMDSPContext {
+    /**
+     * Sums of the w 4x4 blocks of a line, from 8-bit samples or from
+     * 16-bit samples of up to 12 significant bits.
+     */
     void (*ssim_4x4_line)(const uint8_t *buf, ptrdiff_t buf_stride,
                           const uint8_t *ref, ptrdiff_t ref_stride,
                           int (*sums)[4], int w);
     float (*ssim_end_line)(const int (*sum0)[4], const int (*sum1)[4], int w);
 } SSIMDSPContext;
 
-void ff_ssim_init_x86(SSIMDSPContext *dsp);
+void ff_ssim_4x4_line_16bit_c(const uint8_t *buf, ptrdiff_t buf_stride,
+                              const uint8_t *ref, ptrdiff_t ref_stride,
+                              int (*sums)[4], int w);
+
+void ff_ssim_init_dsp(SSIMDSPContext *dsp, int bpp);
+void ff_ssim_init_x86(SSIMDSPContext *dsp, int bpp);
 
 #endif /* AVFILTER_SSIM_H */
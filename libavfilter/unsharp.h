@@ -65,9 +65,32 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
 } UnsharpFilterParam;
 
+typedef struct UnsharpDSPContext {
+    /**
+     * One horizontal pass of the matrix: buf[x] += buf[x - 1], for x from
+     * len - 1 down to 1.
+     */
+    void (*hsum)(uint32_t *buf, int len);
+
+    /**
+     * The vertical passes of the matrix, width columns at a time. Each of the
+     * nb_stages (> 0) rows of sc, stride elements apart, holds the previous input
+     * of its stage; sum is the input of the first stage and gets the output
+     * of the last one.
+     */
+    void (*vsum)(uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                 int nb_stages, int width);
+
+    /**
+     * dst[x] = clip(src[x] + ((src[x] - ((sum[x] + halfscale) >> scalebits)) *
+     *                         amount >> 16)), with scalebits < 32.
+     */
+    void (*sharpen)(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                    int width, int amount, int scalebits, uint32_t halfscale);
+} UnsharpDSPContext;
+
 typedef struct UnsharpContext {
     const AVClass *class;
     int lmsize_x, lmsize_y, cmsize_x, cmsize_y;
@@ -75,6 +98,10 @@ typedef struct UnsharpContext {
     UnsharpFilterParam luma;   ///< luma parameters (width, height, amount)
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
+    int nb_threads;
+    uint32_t *sc;              ///< per-job finite state machine storage
+    int sc_size;               ///< size of sc for each job, in elements
+    UnsharpDSPContext dsp;
     int opencl;
 #if CONFIG_OPENCL
     UnsharpOpenclContext opencl_ctx;
@@ -82,4 +109,13 @@ typedef struct UnsharpContext {
     int (* apply_unsharp)(AVFilterContext *ctx, AVFrame *in, AVFrame *out);
 } UnsharpContext;
 
+void ff_unsharp_hsum_c(uint32_t *buf, int len);
+void ff_unsharp_vsum_c(uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                       int nb_stages, int width);
+void ff_unsharp_sharpen_c(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                          int width, int amount, int scalebits, uint32_t halfscale);
+
+void ff_unsharp_init_dsp(UnsharpDSPContext *dsp);
+void ff_unsharp_init_x86(UnsharpDSPContext *dsp);
+
 #endif /* AVFILTER_UNSHARP_H */
@@ -28,12 +28,15 @@
 #include "libavutil/avstring.h"
 #include "libavutil/common.h"
 #include "libavutil/eval.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_boxblur.h"
 
 static const char *const var_names[] = {
     "w",
@@ -70,9 +73,15 @@ typedef struct BoxBlurContext {
     int hsub, vsub;
     int radius[4];
     int power[4];
-    uint8_t *temp[2]; ///< temporary buffer used in blur_power()
+    int nb_threads;
+    int temp_size;    ///< size of each temporary buffer
+    uint8_t *temp;    ///< per-job pairs of temporary buffers used in blur_power()
+    BoxBlurDSPContext dsp;
 } BoxBlurContext;
 
+/* width of the column strips the vertical blur is run on */
+#define VBLUR_STRIP 64
+
 #define Y 0
 #define U 1
 #define V 2
@@ -111,8 +120,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     BoxBlurContext *s = ctx->priv;
 
-    av_freep(&s->temp[0]);
-    av_freep(&s->temp[1]);
+    av_freep(&s->temp);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -143,8 +151,10 @@ static int config_input(AVFilterLink *inlink)
     char *expr;
     int ret;
 
-    if (!(s->temp[0] = av_malloc(2*FFMAX(w, h))) ||
-        !(s->temp[1] = av_malloc(2*FFMAX(w, h))))
+    s->nb_threads = ctx->graph->nb_threads;
+    s->temp_size  = 2*FFMAX(w, h*VBLUR_STRIP);
+    av_freep(&s->temp);
+    if (!(s->temp = av_malloc_array(s->nb_threads, 2*s->temp_size)))
         return AVERROR(ENOMEM);
 
     s->hsub = desc->log2_chroma_w;
@@ -201,6 +211,8 @@ static int config_input(AVFilterLink *inlink)
     s->power[U] = s->power[V] = s->chroma_param.power;
     s->power[A] = s->alpha_param.power;
 
+    ff_boxblur_init_dsp(&s->dsp, desc->comp[0].depth);
+
     return 0;
 }
 
@@ -252,6 +264,34 @@ BLUR(uint16_t, 16)
 
 #undef BLUR
 
+#define VBLUR_ROW_C(type, depth)                                            \
+void ff_boxblur_vblur_row ## depth ## _c(uint8_t *dst8, const uint8_t *add8, \
+                                         const uint8_t *sub8, int *sums,    \
+                                         int width, int inv)                \
+{                                                                           \
+    type *dst = (type *)dst8;                                               \
+    const type *add = (const type *)add8, *sub = (const type *)sub8;        \
+    int x;                                                                  \
+                                                                            \
+    for (x = 0; x < width; x++) {                                           \
+        sums[x] += (add[x] - sub[x])*inv;                                   \
+        dst[x] = sums[x]>>16;                                               \
+    }                                                                       \
+}
+
+VBLUR_ROW_C(uint8_t,   8)
+VBLUR_ROW_C(uint16_t, 16)
+
+#undef VBLUR_ROW_C
+
+av_cold void ff_boxblur_init_dsp(BoxBlurDSPContext *dsp, int depth)
+{
+    dsp->vblur_row = depth > 8 ? ff_boxblur_vblur_row16_c : ff_boxblur_vblur_row8_c;
+
+    if (ARCH_X86)
+        ff_boxblur_init_x86(dsp, depth);
+}
+
 static inline void blur(uint8_t *dst, int dst_step, const uint8_t *src, int src_step,
                         int len, int radius, int pixsize)
 {
@@ -306,17 +346,127 @@ static void hblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_li
                    w, radius, power, temp, pixsize);
 }
 
-static void vblur(uint8_t *dst, int dst_linesize, const uint8_t *src, int src_linesize,
-                  int w, int h, int radius, int power, uint8_t *temp[2], int pixsize)
+#define VBLUR_ROW(add, sub) \
+    s->dsp.vblur_row(dst + y*dst_linesize, src + (add)*src_linesize, \
+                     src + (sub)*src_linesize, sums, w, inv)
+
+/* Same running sums as blur(), run down w columns at once. */
+static void vblur_strip(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                        const uint8_t *src, int src_linesize,
+                        int w, int h, int radius, int pixsize, int *sums)
+{
+    const int length = radius*2 + 1;
+    const int inv = ((1<<16) + length/2)/length;
+    int x, y;
+
+    for (x = 0; x < w; x++) {
+        int sum;
+        if (pixsize == 1) {
+            sum = src[radius*src_linesize + x];
+            for (y = 0; y < radius; y++)
+                sum += src[y*src_linesize + x]<<1;
+        } else {
+            sum = AV_RN16A(src + radius*src_linesize + 2*x);
+            for (y = 0; y < radius; y++)
+                sum += AV_RN16A(src + y*src_linesize + 2*x)<<1;
+        }
+        sums[x] = sum*inv + (1<<15);
+    }
+
+    for (y = 0; y <= radius; y++)
+        VBLUR_ROW(radius+y, radius-y);
+    for (; y < h-radius; y++)
+        VBLUR_ROW(radius+y, y-radius-1);
+    for (; y < h; y++)
+        VBLUR_ROW(2*h-radius-y-1, y-radius-1);
+}
+
+static void vblur_power(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                        const uint8_t *src, int src_linesize, int w, int h,
+                        int radius, int power, uint8_t *temp[2], int pixsize)
+{
+    LOCAL_ALIGNED_32(int, sums, [VBLUR_STRIP]);
+    const int temp_linesize = VBLUR_STRIP*pixsize;
+    uint8_t *a = temp[0], *b = temp[1];
+
+    if (radius && power) {
+        vblur_strip(s, a, temp_linesize, src, src_linesize, w, h, radius, pixsize, sums);
+        for (; power > 2; power--) {
+            uint8_t *c;
+            vblur_strip(s, b, temp_linesize, a, temp_linesize, w, h, radius, pixsize, sums);
+            c = a; a = b; b = c;
+        }
+        if (power > 1)
+            vblur_strip(s, dst, dst_linesize, a, temp_linesize, w, h, radius, pixsize, sums);
+        else
+            av_image_copy_plane(dst, dst_linesize, a, temp_linesize, w*pixsize, h);
+    } else if (dst != src) {
+        av_image_copy_plane(dst, dst_linesize, src, src_linesize, w*pixsize, h);
+    }
+}
+
+static void vblur(BoxBlurContext *s, uint8_t *dst, int dst_linesize,
+                  const uint8_t *src, int src_linesize, int w, int h,
+                  int radius, int power, uint8_t *temp[2], int pixsize)
 {
     int x;
 
     if (radius == 0 && dst == src)
         return;
 
-    for (x = 0; x < w; x++)
-        blur_power(dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
-                   h, radius, power, temp, pixsize);
+    for (x = 0; x < w; x += VBLUR_STRIP)
+        vblur_power(s, dst + x*pixsize, dst_linesize, src + x*pixsize, src_linesize,
+                    FFMIN(w - x, VBLUR_STRIP), h, radius, power, temp, pixsize);
+}
+
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int w[4], h[4];
+    int pixsize;
+} ThreadData;
+
+static int hblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    uint8_t *temp[2] = { s->temp + 2*jobnr*s->temp_size,
+                         s->temp + (2*jobnr + 1)*s->temp_size };
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->h[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (td->h[plane] * (jobnr + 1)) / nb_jobs;
+
+        hblur(out->data[plane] + slice_start*out->linesize[plane], out->linesize[plane],
+              in ->data[plane] + slice_start*in ->linesize[plane], in ->linesize[plane],
+              td->w[plane], slice_end - slice_start, s->radius[plane], s->power[plane],
+              temp, td->pixsize);
+    }
+
+    return 0;
+}
+
+static int vblur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    BoxBlurContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    uint8_t *temp[2] = { s->temp + 2*jobnr*s->temp_size,
+                         s->temp + (2*jobnr + 1)*s->temp_size };
+    int plane;
+
+    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++) {
+        const int slice_start = (td->w[plane] *  jobnr     ) / nb_jobs;
+        const int slice_end   = (td->w[plane] * (jobnr + 1)) / nb_jobs;
+        uint8_t *dst = out->data[plane] + slice_start*td->pixsize;
+
+        vblur(s, dst, out->linesize[plane], dst, out->linesize[plane],
+              slice_end - slice_start, td->h[plane], s->radius[plane], s->power[plane],
+              temp, td->pixsize);
+    }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
@@ -325,13 +475,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     BoxBlurContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
-    int plane;
+    ThreadData td;
     int cw = AV_CEIL_RSHIFT(inlink->w, s->hsub), ch = AV_CEIL_RSHIFT(in->height, s->vsub);
-    int w[4] = { inlink->w, cw, cw, inlink->w };
-    int h[4] = { in->height, ch, ch, in->height };
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     const int depth = desc->comp[0].depth;
-    const int pixsize = (depth+7)/8;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -340,17 +487,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        hblur(out->data[plane], out->linesize[plane],
-              in ->data[plane], in ->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    td.in  = in;
+    td.out = out;
+    td.w[0] = td.w[3] = inlink->w;
+    td.w[1] = td.w[2] = cw;
+    td.h[0] = td.h[3] = in->height;
+    td.h[1] = td.h[2] = ch;
+    td.pixsize = (depth+7)/8;
 
-    for (plane = 0; plane < 4 && in->data[plane] && in->linesize[plane]; plane++)
-        vblur(out->data[plane], out->linesize[plane],
-              out->data[plane], out->linesize[plane],
-              w[plane], h[plane], s->radius[plane], s->power[plane],
-              s->temp, pixsize);
+    ctx->internal->execute(ctx, hblur_slice, &td, NULL, FFMIN(ch, s->nb_threads));
+    ctx->internal->execute(ctx, vblur_slice, &td, NULL, FFMIN(cw, s->nb_threads));
 
     av_frame_free(&in);
 
@@ -409,5 +555,5 @@ AVFilter ff_vf_boxblur = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_boxblur_inputs,
     .outputs       = avfilter_vf_boxblur_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
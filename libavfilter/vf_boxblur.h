@@ -0,0 +1,42 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_BOXBLUR_H
+#define AVFILTER_BOXBLUR_H
+
+#include <stdint.h>
+
+typedef struct BoxBlurDSPContext {
+    /**
+     * One output row of the vertical running sums, for width samples of the
+     * bit depth given to ff_boxblur_init_dsp():
+     * sums[x] += (add[x] - sub[x]) * inv; dst[x] = sums[x] >> 16.
+     */
+    void (*vblur_row)(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                      int *sums, int width, int inv);
+} BoxBlurDSPContext;
+
+void ff_boxblur_vblur_row8_c(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                             int *sums, int width, int inv);
+void ff_boxblur_vblur_row16_c(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                              int *sums, int width, int inv);
+
+void ff_boxblur_init_dsp(BoxBlurDSPContext *dsp, int depth);
+void ff_boxblur_init_x86(BoxBlurDSPContext *dsp, int depth);
+
+#endif /* AVFILTER_BOXBLUR_H */
@@ -21,12 +21,14 @@
 
 #include "libavutil/avstring.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/mathematics.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_convolution.h"
 
 typedef struct ConvolutionContext {
     const AVClass *class;
@@ -38,13 +40,20 @@ typedef struct ConvolutionContext {
     int bstride;
     uint8_t *buffer;
     int nb_planes;
+    int nb_threads;
     int planewidth[4];
     int planeheight[4];
     int matrix[4][25];
     int matrix_length[4];
     int copy[4];
-
-    void (*filter[4])(struct ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane);
+    int hcoef[4][5];            ///< horizontal factor of a separable 5x5 matrix
+    int vcoef[4][5];            ///< vertical factor of a separable 5x5 matrix
+
+    ConvolutionDSPContext dsp;
+    void (*filter_row[4])(uint8_t *dst, int width, float rdiv, float bias,
+                          const int *matrix, const uint8_t *c[], int nb_taps);
+    void (*filter[4])(struct ConvolutionContext *s, AVFrame *in, AVFrame *out,
+                      int plane, int jobnr, int nb_jobs);
 } ConvolutionContext;
 
 #define OFFSET(x) offsetof(ConvolutionContext, x)
@@ -96,7 +105,8 @@ static int query_formats(AVFilterContext *ctx)
 
 static int config_input(AVFilterLink *inlink)
 {
-    ConvolutionContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    ConvolutionContext *s = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     int ret;
 
@@ -107,9 +117,12 @@ static int config_input(AVFilterLink *inlink)
     s->planeheight[0] = s->planeheight[3] = inlink->h;
 
     s->nb_planes = av_pix_fmt_count_planes(inlink->format);
+    s->nb_threads = ctx->graph->nb_threads;
 
-    s->bstride = s->planewidth[0] + 32;
-    s->buffer = av_malloc(5 * s->bstride);
+    /* per job: 5 lines of pixels and 5 lines of separable filter output */
+    s->bstride = FFALIGN(s->planewidth[0] + 32, 32);
+    av_freep(&s->buffer);
+    s->buffer = av_malloc_array(s->nb_threads, 15 * s->bstride);
     if (!s->buffer)
         return AVERROR(ENOMEM);
 
@@ -128,114 +141,200 @@ static inline void line_copy8(uint8_t *line, const uint8_t *srcp, int width, int
     }
 }
 
-static void filter_3x3(ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane)
+/**
+ * Mirror row y of a plane with height rows at the top and bottom edges.
+ */
+static inline int mirror_row(int y, int height)
+{
+    if (y < 0)
+        y = -y;
+    else if (y >= height)
+        y = 2 * (height - 1) - y;
+    return av_clip(y, 0, height - 1);
+}
+
+void ff_convolution_filter_row_c(uint8_t *dst, int width, float rdiv, float bias,
+                                 const int *matrix, const uint8_t *c[], int nb_taps)
+{
+    int x, i;
+
+    for (x = 0; x < width; x++) {
+        int sum = 0;
+
+        for (i = 0; i < nb_taps; i++)
+            sum += c[i][x] * matrix[i];
+        sum = (int)(sum * rdiv + bias + 0.5f);
+        dst[x] = av_clip_uint8(sum);
+    }
+}
+
+void ff_convolution_hfilter_row5_c(int16_t *dst, const uint8_t *src, int width,
+                                   const int *coef)
+{
+    int x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = src[x - 2] * coef[0] + src[x - 1] * coef[1] +
+                 src[x    ] * coef[2] +
+                 src[x + 1] * coef[3] + src[x + 2] * coef[4];
+}
+
+void ff_convolution_vfilter_row5_c(uint8_t *dst, int width, float rdiv, float bias,
+                                   const int *coef, const int16_t *c[])
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        int sum = c[0][x] * coef[0] + c[1][x] * coef[1] +
+                  c[2][x] * coef[2] +
+                  c[3][x] * coef[3] + c[4][x] * coef[4];
+        sum = (int)(sum * rdiv + bias + 0.5f);
+        dst[x] = av_clip_uint8(sum);
+    }
+}
+
+av_cold void ff_convolution_init_dsp(ConvolutionDSPContext *dsp)
+{
+    dsp->filter_row   = ff_convolution_filter_row_c;
+    dsp->hfilter_row5 = ff_convolution_hfilter_row5_c;
+    dsp->vfilter_row5 = ff_convolution_vfilter_row5_c;
+
+    if (ARCH_X86)
+        ff_convolution_init_x86(dsp);
+}
+
+/**
+ * Filter the rows of slice jobnr with a 3x3 or 5x5 matrix, keeping the
+ * lines around the current row in the buffer of the job.
+ */
+static void filter_matrix(ConvolutionContext *s, AVFrame *in, AVFrame *out,
+                          int plane, int jobnr, int nb_jobs)
 {
     const uint8_t *src = in->data[plane];
-    uint8_t *dst = out->data[plane];
     const int stride = in->linesize[plane];
     const int bstride = s->bstride;
     const int height = s->planeheight[plane];
     const int width  = s->planewidth[plane];
-    uint8_t *p0 = s->buffer + 16;
-    uint8_t *p1 = p0 + bstride;
-    uint8_t *p2 = p1 + bstride;
-    uint8_t *orig = p0, *end = p2;
-    const int *matrix = s->matrix[plane];
-    const float rdiv = s->rdiv[plane];
-    const float bias = s->bias[plane];
-    int y, x;
-
-    line_copy8(p0, src + stride, width, 1);
-    line_copy8(p1, src, width, 1);
-
-    for (y = 0; y < height; y++) {
-        src += stride * (y < height - 1 ? 1 : -1);
-        line_copy8(p2, src, width, 1);
-
-        for (x = 0; x < width; x++) {
-            int sum = p0[x - 1] * matrix[0] +
-                      p0[x] *     matrix[1] +
-                      p0[x + 1] * matrix[2] +
-                      p1[x - 1] * matrix[3] +
-                      p1[x] *     matrix[4] +
-                      p1[x + 1] * matrix[5] +
-                      p2[x - 1] * matrix[6] +
-                      p2[x] *     matrix[7] +
-                      p2[x + 1] * matrix[8];
-            sum = (int)(sum * rdiv + bias + 0.5f);
-            dst[x] = av_clip_uint8(sum);
-        }
-
-        p0 = p1;
-        p1 = p2;
-        p2 = (p2 == end) ? orig: p2 + bstride;
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    const int radius = s->matrix_length[plane] == 9 ? 1 : 2;
+    const int size = 2 * radius + 1;
+    uint8_t *dst = out->data[plane] + slice_start * out->linesize[plane];
+    uint8_t *buffer = s->buffer + jobnr * 15 * bstride + 16;
+    uint8_t *lines[5];
+    const uint8_t *array[25];
+    int y, i, j;
+
+    for (i = 0; i < size; i++)
+        lines[i] = buffer + i * bstride;
+    for (i = 0; i < size - 1; i++)
+        line_copy8(lines[i], src + mirror_row(slice_start - radius + i, height) * stride,
+                   width, radius);
+
+    for (y = slice_start; y < slice_end; y++) {
+        uint8_t *first = lines[0];
+
+        line_copy8(lines[size - 1], src + mirror_row(y + radius, height) * stride,
+                   width, radius);
+
+        for (i = 0; i < size; i++)
+            for (j = 0; j < size; j++)
+                array[i * size + j] = lines[i] + j - radius;
+
+        s->filter_row[plane](dst, width, s->rdiv[plane], s->bias[plane],
+                             s->matrix[plane], array, size * size);
+
+        for (i = 0; i < size - 1; i++)
+            lines[i] = lines[i + 1];
+        lines[size - 1] = first;
         dst += out->linesize[plane];
     }
 }
 
-static void filter_5x5(ConvolutionContext *s, AVFrame *in, AVFrame *out, int plane)
+/**
+ * Filter the rows of slice jobnr with a separable 5x5 matrix, as a
+ * horizontal pass into 5 lines of 16-bit sums followed by a vertical pass.
+ */
+static void filter_separable(ConvolutionContext *s, AVFrame *in, AVFrame *out,
+                             int plane, int jobnr, int nb_jobs)
 {
     const uint8_t *src = in->data[plane];
-    uint8_t *dst = out->data[plane];
     const int stride = in->linesize[plane];
     const int bstride = s->bstride;
     const int height = s->planeheight[plane];
     const int width  = s->planewidth[plane];
-    uint8_t *p0 = s->buffer + 16;
-    uint8_t *p1 = p0 + bstride;
-    uint8_t *p2 = p1 + bstride;
-    uint8_t *p3 = p2 + bstride;
-    uint8_t *p4 = p3 + bstride;
-    uint8_t *orig = p0, *end = p4;
-    const int *matrix = s->matrix[plane];
-    float rdiv = s->rdiv[plane];
-    float bias = s->bias[plane];
-    int y, x, i;
-
-    line_copy8(p0, src + 2 * stride, width, 2);
-    line_copy8(p1, src + stride, width, 2);
-    line_copy8(p2, src, width, 2);
-    src += stride;
-    line_copy8(p3, src, width, 2);
-
-
-    for (y = 0; y < height; y++) {
-        uint8_t *array[] = {
-            p0 - 2, p0 - 1, p0, p0 + 1, p0 + 2,
-            p1 - 2, p1 - 1, p1, p1 + 1, p1 + 2,
-            p2 - 2, p2 - 1, p2, p2 + 1, p2 + 2,
-            p3 - 2, p3 - 1, p3, p3 + 1, p3 + 2,
-            p4 - 2, p4 - 1, p4, p4 + 1, p4 + 2
-        };
-
-        src += stride * (y < height - 2 ? 1 : -1);
-        line_copy8(p4, src, width, 2);
-
-        for (x = 0; x < width; x++) {
-            int sum = 0;
-
-            for (i = 0; i < 25; i++) {
-                sum += *(array[i] + x) * matrix[i];
-            }
-            sum = (int)(sum * rdiv + bias + 0.5f);
-            dst[x] = av_clip_uint8(sum);
-        }
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    const int *hcoef = s->hcoef[plane];
+    uint8_t *dst = out->data[plane] + slice_start * out->linesize[plane];
+    uint8_t *line = s->buffer + jobnr * 15 * bstride + 16;
+    int16_t *buffer = (int16_t *)(line - 16 + 5 * bstride);
+    int16_t *lines[5];
+    int y, i;
+
+    for (i = 0; i < 5; i++)
+        lines[i] = buffer + i * bstride;
+    for (i = 0; i < 4; i++) {
+        line_copy8(line, src + mirror_row(slice_start - 2 + i, height) * stride, width, 2);
+        s->dsp.hfilter_row5(lines[i], line, width, hcoef);
+    }
+
+    for (y = slice_start; y < slice_end; y++) {
+        int16_t *first = lines[0];
+
+        line_copy8(line, src + mirror_row(y + 2, height) * stride, width, 2);
+        s->dsp.hfilter_row5(lines[4], line, width, hcoef);
 
-        p0 = p1;
-        p1 = p2;
-        p2 = p3;
-        p3 = p4;
-        p4 = (p4 == end) ? orig: p4 + bstride;
+        s->dsp.vfilter_row5(dst, width, s->rdiv[plane], s->bias[plane],
+                            s->vcoef[plane], (const int16_t **)lines);
+
+        for (i = 0; i < 4; i++)
+            lines[i] = lines[i + 1];
+        lines[4] = first;
         dst += out->linesize[plane];
     }
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ConvolutionContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    int plane;
+
+    for (plane = 0; plane < s->nb_planes; plane++) {
+        const int height = s->planeheight[plane];
+        const int slice_start = (height *  jobnr     ) / nb_jobs;
+        const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+
+        if (s->copy[plane]) {
+            av_image_copy_plane(out->data[plane] + slice_start * out->linesize[plane],
+                                out->linesize[plane],
+                                in->data[plane] + slice_start * in->linesize[plane],
+                                in->linesize[plane],
+                                s->planewidth[plane],
+                                slice_end - slice_start);
+            continue;
+        }
+
+        s->filter[plane](s, in, out, plane, jobnr, nb_jobs);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
-    ConvolutionContext *s = inlink->dst->priv;
-    AVFilterLink *outlink = inlink->dst->outputs[0];
+    AVFilterContext *ctx = inlink->dst;
+    ConvolutionContext *s = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    ThreadData td;
     AVFrame *out;
-    int plane;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -244,27 +343,71 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    for (plane = 0; plane < s->nb_planes; plane++) {
-        if (s->copy[plane]) {
-            av_image_copy_plane(out->data[plane], out->linesize[plane],
-                                in->data[plane], in->linesize[plane],
-                                s->planewidth[plane],
-                                s->planeheight[plane]);
-            continue;
-        }
-
-        s->filter[plane](s, in, out, plane);
-    }
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, filter_slice, &td, NULL,
+                           FFMIN(s->planeheight[1], s->nb_threads));
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
 }
 
+/**
+ * Find integer vectors with matrix[i * 5 + j] == v[i] * h[j], small enough
+ * for the horizontal sums to fit in 16 bits and the vertical ones in 32.
+ */
+static int find_separable5(const int *matrix, int *h, int *v)
+{
+    int i, j, k, sum = 0;
+    int64_t g = 0, vsum = 0;
+
+    for (k = 0; k < 25 && !matrix[k]; k++);
+    if (k == 25)
+        return 0;
+
+    for (j = 0; j < 5; j++)
+        g = av_gcd(g, FFABS(matrix[k / 5 * 5 + j]));
+    for (j = 0; j < 5; j++) {
+        h[j] = matrix[k / 5 * 5 + j] / g;
+        sum += FFABS(h[j]);
+    }
+    if (sum * 255 > INT16_MAX)
+        return 0;
+
+    for (i = 0; i < 5; i++) {
+        const int m = matrix[i * 5 + k % 5];
+
+        if (m % h[k % 5])
+            return 0;
+        v[i] = m / h[k % 5];
+        if (FFABS(v[i]) > INT16_MAX)
+            return 0;
+        vsum += FFABS(v[i]);
+        for (j = 0; j < 5; j++)
+            if (matrix[i * 5 + j] != (int64_t)v[i] * h[j])
+                return 0;
+    }
+
+    return vsum * sum * 255 <= INT_MAX;
+}
+
+static int fits_int16(const int *matrix, int length)
+{
+    int i;
+
+    for (i = 0; i < length; i++)
+        if (matrix[i] < INT16_MIN || matrix[i] > INT16_MAX)
+            return 0;
+    return 1;
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     ConvolutionContext *s = ctx->priv;
     int i;
 
+    ff_convolution_init_dsp(&s->dsp);
+
     for (i = 0; i < 4; i++) {
         int *matrix = (int *)s->matrix[i];
         char *p, *arg, *saveptr = NULL;
@@ -283,15 +426,20 @@ static av_cold int init(AVFilterContext *ctx)
             if (!memcmp(matrix, same3x3, sizeof(same3x3)))
                 s->copy[i] = 1;
             else
-                s->filter[i] = filter_3x3;
+                s->filter[i] = filter_matrix;
         } else if (s->matrix_length[i] == 25) {
             if (!memcmp(matrix, same5x5, sizeof(same5x5)))
                 s->copy[i] = 1;
+            else if (find_separable5(matrix, s->hcoef[i], s->vcoef[i]))
+                s->filter[i] = filter_separable;
             else
-                s->filter[i] = filter_5x5;
+                s->filter[i] = filter_matrix;
         } else {
             return AVERROR(EINVAL);
         }
+
+        s->filter_row[i] = fits_int16(matrix, s->matrix_length[i]) ?
+                           s->dsp.filter_row : ff_convolution_filter_row_c;
     }
 
     return 0;
@@ -332,5 +480,5 @@ AVFilter ff_vf_convolution = {
     .query_formats = query_formats,
     .inputs        = convolution_inputs,
     .outputs       = convolution_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,60 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_CONVOLUTION_H
+#define AVFILTER_CONVOLUTION_H
+
+#include <stdint.h>
+
+/**
+ * All functions round and clip as (int)(sum * rdiv + bias + 0.5f) and may
+ * read up to 16 bytes (8-bit rows) or 16 samples (16-bit rows) starting at
+ * any x < width. Coefficients must fit in int16_t.
+ */
+typedef struct ConvolutionDSPContext {
+    /**
+     * dst[x] = sum of c[i][x] * matrix[i] for i < nb_taps, with nb_taps <= 25
+     */
+    void (*filter_row)(uint8_t *dst, int width, float rdiv, float bias,
+                       const int *matrix, const uint8_t *c[], int nb_taps);
+
+    /**
+     * Horizontal pass of a separable 5x5 kernel:
+     * dst[x] = sum of src[x + j - 2] * coef[j], which must fit in int16_t.
+     */
+    void (*hfilter_row5)(int16_t *dst, const uint8_t *src, int width, const int *coef);
+
+    /**
+     * Vertical pass of a separable 5x5 kernel:
+     * dst[x] = sum of c[i][x] * coef[i], rounded and clipped.
+     */
+    void (*vfilter_row5)(uint8_t *dst, int width, float rdiv, float bias,
+                         const int *coef, const int16_t *c[]);
+} ConvolutionDSPContext;
+
+void ff_convolution_filter_row_c(uint8_t *dst, int width, float rdiv, float bias,
+                                 const int *matrix, const uint8_t *c[], int nb_taps);
+void ff_convolution_hfilter_row5_c(int16_t *dst, const uint8_t *src, int width,
+                                   const int *coef);
+void ff_convolution_vfilter_row5_c(uint8_t *dst, int width, float rdiv, float bias,
+                                   const int *coef, const int16_t *c[]);
+
+void ff_convolution_init_dsp(ConvolutionDSPContext *dsp);
+void ff_convolution_init_x86(ConvolutionDSPContext *dsp);
+
+#endif /* AVFILTER_CONVOLUTION_H */
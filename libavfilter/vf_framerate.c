@@ -38,6 +38,7 @@
 #include "avfilter.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_framerate.h"
 
 #define N_SRCE 3
 
@@ -73,10 +74,11 @@ typedef struct FrameRateContext {
     int64_t srce_pts_dest[N_SRCE];      ///< pts for source frames scaled to output timebase
     int64_t pts;                        ///< pts of frame we are working on
 
-    int (*blend_frames)(AVFilterContext *ctx, float interpolate,
-                        AVFrame *copy_src1, AVFrame *copy_src2);
+    FrameRateDSPContext dsp;
     int max;
     int bitdepth;
+    int nb_threads;
+    int64_t *sad_sums;                  ///< sum of absolute differences of each job (scene detect only)
     AVFrame *work;
 } FrameRateContext;
 
@@ -120,56 +122,91 @@ static void next_source(AVFilterContext *ctx)
     s->srce[s->frst] = NULL;
 }
 
-static av_always_inline int64_t sad_8x8_16(const uint16_t *src1, ptrdiff_t stride1,
-                                           const uint16_t *src2, ptrdiff_t stride2)
+void ff_framerate_blend_row8_c(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                               int width, int factor1, int factor2, int half, int shift)
 {
-    int sum = 0;
-    int x, y;
+    int x;
 
-    for (y = 0; y < 8; y++) {
-        for (x = 0; x < 8; x++)
-            sum += FFABS(src1[x] - src2[x]);
-        src1 += stride1;
-        src2 += stride2;
-    }
+    for (x = 0; x < width; x++)
+        dst[x] = (src1[x] * factor1 + src2[x] * factor2 + half) >> shift;
+}
+
+void ff_framerate_blend_row16_c(uint8_t *dst8, const uint8_t *src18, const uint8_t *src28,
+                                int width, int factor1, int factor2, int half, int shift)
+{
+    uint16_t *dst = (uint16_t *)dst8;
+    const uint16_t *src1 = (const uint16_t *)src18;
+    const uint16_t *src2 = (const uint16_t *)src28;
+    int x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = (src1[x] * factor1 + src2[x] * factor2 + half) >> shift;
+}
+
+int64_t ff_framerate_sad_row16_c(const uint16_t *src1, const uint16_t *src2, int width)
+{
+    int64_t sum = 0;
+    int x;
+
+    for (x = 0; x < width; x++)
+        sum += FFABS(src1[x] - src2[x]);
     return sum;
 }
 
-static double get_scene_score16(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next)
+av_cold void ff_framerate_init_dsp(FrameRateDSPContext *dsp, int bitdepth)
 {
-    FrameRateContext *s = ctx->priv;
-    double ret = 0;
+    dsp->blend_row = bitdepth == 8 ? ff_framerate_blend_row8_c : ff_framerate_blend_row16_c;
+    dsp->sad_row16 = ff_framerate_sad_row16_c;
 
-    ff_dlog(ctx, "get_scene_score16()\n");
+    if (ARCH_X86)
+        ff_framerate_init_x86(dsp, bitdepth);
+}
 
-    if (crnt &&
-        crnt->height == next->height &&
-        crnt->width  == next->width) {
-        int x, y;
-        int64_t sad;
-        double mafd, diff;
-        const uint16_t *p1 = (const uint16_t *)crnt->data[0];
-        const uint16_t *p2 = (const uint16_t *)next->data[0];
-        const int p1_linesize = crnt->linesize[0] / 2;
-        const int p2_linesize = next->linesize[0] / 2;
+typedef struct ThreadData {
+    AVFrame *copy_src1, *copy_src2;
+    uint16_t src1_factor, src2_factor;
+} ThreadData;
 
-        ff_dlog(ctx, "get_scene_score16() process\n");
+/**
+ * Sum the absolute differences of the luma of the rows of 8x8 blocks of
+ * slice jobnr, over the whole linesize.
+ */
+static int sad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FrameRateContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *crnt = td->copy_src1;
+    const AVFrame *next = td->copy_src2;
+    const int nb_rows = (crnt->height + 7) >> 3;
+    const int slice_start = 8 * ((nb_rows *  jobnr     ) / nb_jobs);
+    const int slice_end   = 8 * ((nb_rows * (jobnr + 1)) / nb_jobs);
+    const uint8_t *p1 = crnt->data[0];
+    const uint8_t *p2 = next->data[0];
+    const int p1_linesize = crnt->linesize[0];
+    const int p2_linesize = next->linesize[0];
+    int64_t sad = 0;
+    int x, y;
 
-        for (sad = y = 0; y < crnt->height; y += 8) {
+    if (s->bitdepth == 8) {
+        for (y = slice_start; y < slice_end; y += 8) {
             for (x = 0; x < p1_linesize; x += 8) {
-                sad += sad_8x8_16(p1 + y * p1_linesize + x,
-                                  p1_linesize,
-                                  p2 + y * p2_linesize + x,
-                                  p2_linesize);
+                sad += s->sad(p1 + y * p1_linesize + x,
+                              p1_linesize,
+                              p2 + y * p2_linesize + x,
+                              p2_linesize);
             }
         }
-        mafd = sad / (crnt->height * crnt->width * 3);
-        diff = fabs(mafd - s->prev_mafd);
-        ret  = av_clipf(FFMIN(mafd, diff), 0, 100.0);
-        s->prev_mafd = mafd;
+        emms_c();
+    } else {
+        for (y = slice_start; y < slice_end; y++) {
+            sad += s->dsp.sad_row16((const uint16_t *)(p1 + y * p1_linesize),
+                                    (const uint16_t *)(p2 + y * p2_linesize),
+                                    FFALIGN(p1_linesize / 2, 8));
+        }
     }
-    ff_dlog(ctx, "get_scene_score16() result is:%f\n", ret);
-    return ret;
+    s->sad_sums[jobnr] = sad;
+
+    return 0;
 }
 
 static double get_scene_score(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next)
@@ -182,100 +219,66 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *crnt, AVFrame *next
     if (crnt &&
         crnt->height == next->height &&
         crnt->width  == next->width) {
-        int x, y;
-        int64_t sad;
+        ThreadData td;
+        int i, nb_jobs;
+        int64_t sad = 0;
         double mafd, diff;
-        uint8_t *p1 = crnt->data[0];
-        uint8_t *p2 = next->data[0];
-        const int p1_linesize = crnt->linesize[0];
-        const int p2_linesize = next->linesize[0];
 
         ff_dlog(ctx, "get_scene_score() process\n");
 
-        for (sad = y = 0; y < crnt->height; y += 8) {
-            for (x = 0; x < p1_linesize; x += 8) {
-                sad += s->sad(p1 + y * p1_linesize + x,
-                              p1_linesize,
-                              p2 + y * p2_linesize + x,
-                              p2_linesize);
-            }
-        }
-        emms_c();
+        td.copy_src1 = crnt;
+        td.copy_src2 = next;
+        nb_jobs = FFMIN((crnt->height + 7) >> 3, s->nb_threads);
+        ctx->internal->execute(ctx, sad_slice, &td, NULL, nb_jobs);
+        for (i = 0; i < nb_jobs; i++)
+            sad += s->sad_sums[i];
+
         mafd = sad / (crnt->height * crnt->width * 3);
         diff = fabs(mafd - s->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff), 0, 100.0);
         s->prev_mafd = mafd;
     }
-        ff_dlog(ctx, "get_scene_score() result is:%f\n", ret);
+    ff_dlog(ctx, "get_scene_score() result is:%f\n", ret);
     return ret;
 }
 
-static int blend_frames16(AVFilterContext *ctx, float interpolate,
-                          AVFrame *copy_src1, AVFrame *copy_src2)
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     FrameRateContext *s = ctx->priv;
-    AVFilterLink *outlink = ctx->outputs[0];
-    double interpolate_scene_score = 0;
-
-    if ((s->flags & FRAMERATE_FLAG_SCD) && copy_src2) {
-        interpolate_scene_score = get_scene_score16(ctx, copy_src1, copy_src2);
-        ff_dlog(ctx, "blend_frames16() interpolate scene score:%f\n", interpolate_scene_score);
-    }
-    // decide if the shot-change detection allows us to blend two frames
-    if (interpolate_scene_score < s->scene_score && copy_src2) {
-        uint16_t src2_factor = fabsf(interpolate) * (1 << (s->bitdepth - 8));
-        uint16_t src1_factor = s->max - src2_factor;
-        const int half = s->max / 2;
-        const int uv = (s->max + 1) * half;
-        const int shift = s->bitdepth;
-        int plane, line, pixel;
-
-        // get work-space for output frame
-        s->work = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-        if (!s->work)
-            return AVERROR(ENOMEM);
-
-        av_frame_copy_props(s->work, s->srce[s->crnt]);
-
-        ff_dlog(ctx, "blend_frames16() INTERPOLATE to create work frame\n");
-        for (plane = 0; plane < 4 && copy_src1->data[plane] && copy_src2->data[plane]; plane++) {
-            int cpy_line_width = s->line_size[plane];
-            const uint16_t *cpy_src1_data = (const uint16_t *)copy_src1->data[plane];
-            int cpy_src1_line_size = copy_src1->linesize[plane] / 2;
-            const uint16_t *cpy_src2_data = (const uint16_t *)copy_src2->data[plane];
-            int cpy_src2_line_size = copy_src2->linesize[plane] / 2;
-            int cpy_src_h = (plane > 0 && plane < 3) ? (copy_src1->height >> s->vsub) : (copy_src1->height);
-            uint16_t *cpy_dst_data = (uint16_t *)s->work->data[plane];
-            int cpy_dst_line_size = s->work->linesize[plane] / 2;
-
-            if (plane <1 || plane >2) {
-                // luma or alpha
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++)
-                        cpy_dst_data[pixel] = ((cpy_src1_data[pixel] * src1_factor) + (cpy_src2_data[pixel] * src2_factor) + half) >> shift;
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            } else {
-                // chroma
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        cpy_dst_data[pixel] = (((cpy_src1_data[pixel] - half) * src1_factor) + ((cpy_src2_data[pixel] - half) * src2_factor) + uv) >> shift;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            }
+    ThreadData *td = arg;
+    // (src1 - half) * src1_factor + (src2 - half) * src2_factor + (max + 1) * half,
+    // which the chroma planes were blended with, is the same as the luma blending
+    // since src1_factor + src2_factor = max
+    const int half = s->max / 2;
+    const int shift = s->bitdepth;
+    int plane, line;
+
+    for (plane = 0; plane < 4 && td->copy_src1->data[plane] && td->copy_src2->data[plane]; plane++) {
+        const int cpy_line_width = s->line_size[plane] >> (s->bitdepth > 8);
+        const int cpy_src_h = (plane > 0 && plane < 3) ? (td->copy_src1->height >> s->vsub) : (td->copy_src1->height);
+        const int slice_start = (cpy_src_h *  jobnr     ) / nb_jobs;
+        const int slice_end   = (cpy_src_h * (jobnr + 1)) / nb_jobs;
+        const int cpy_src1_line_size = td->copy_src1->linesize[plane];
+        const int cpy_src2_line_size = td->copy_src2->linesize[plane];
+        const int cpy_dst_line_size = s->work->linesize[plane];
+        const uint8_t *cpy_src1_data = td->copy_src1->data[plane] + slice_start * cpy_src1_line_size;
+        const uint8_t *cpy_src2_data = td->copy_src2->data[plane] + slice_start * cpy_src2_line_size;
+        uint8_t *cpy_dst_data = s->work->data[plane] + slice_start * cpy_dst_line_size;
+
+        for (line = slice_start; line < slice_end; line++) {
+            s->dsp.blend_row(cpy_dst_data, cpy_src1_data, cpy_src2_data, cpy_line_width,
+                             td->src1_factor, td->src2_factor, half, shift);
+            cpy_src1_data += cpy_src1_line_size;
+            cpy_src2_data += cpy_src2_line_size;
+            cpy_dst_data += cpy_dst_line_size;
         }
-        return 1;
     }
+
     return 0;
 }
 
-static int blend_frames8(AVFilterContext *ctx, float interpolate,
-                         AVFrame *copy_src1, AVFrame *copy_src2)
+static int blend_frames(AVFilterContext *ctx, float interpolate,
+                        AVFrame *copy_src1, AVFrame *copy_src2)
 {
     FrameRateContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
@@ -283,13 +286,16 @@ static int blend_frames8(AVFilterContext *ctx, float interpolate,
 
     if ((s->flags & FRAMERATE_FLAG_SCD) && copy_src2) {
         interpolate_scene_score = get_scene_score(ctx, copy_src1, copy_src2);
-        ff_dlog(ctx, "blend_frames8() interpolate scene score:%f\n", interpolate_scene_score);
+        ff_dlog(ctx, "blend_frames() interpolate scene score:%f\n", interpolate_scene_score);
     }
     // decide if the shot-change detection allows us to blend two frames
     if (interpolate_scene_score < s->scene_score && copy_src2) {
-        uint16_t src2_factor = fabsf(interpolate);
-        uint16_t src1_factor = 256 - src2_factor;
-        int plane, line, pixel;
+        ThreadData td;
+
+        td.copy_src1 = copy_src1;
+        td.copy_src2 = copy_src2;
+        td.src2_factor = fabsf(interpolate) * (1 << (s->bitdepth - 8));
+        td.src1_factor = s->max - td.src2_factor;
 
         // get work-space for output frame
         s->work = ff_get_video_buffer(outlink, outlink->w, outlink->h);
@@ -298,44 +304,9 @@ static int blend_frames8(AVFilterContext *ctx, float interpolate,
 
         av_frame_copy_props(s->work, s->srce[s->crnt]);
 
-        ff_dlog(ctx, "blend_frames8() INTERPOLATE to create work frame\n");
-        for (plane = 0; plane < 4 && copy_src1->data[plane] && copy_src2->data[plane]; plane++) {
-            int cpy_line_width = s->line_size[plane];
-            uint8_t *cpy_src1_data = copy_src1->data[plane];
-            int cpy_src1_line_size = copy_src1->linesize[plane];
-            uint8_t *cpy_src2_data = copy_src2->data[plane];
-            int cpy_src2_line_size = copy_src2->linesize[plane];
-            int cpy_src_h = (plane > 0 && plane < 3) ? (copy_src1->height >> s->vsub) : (copy_src1->height);
-            uint8_t *cpy_dst_data = s->work->data[plane];
-            int cpy_dst_line_size = s->work->linesize[plane];
-            if (plane <1 || plane >2) {
-                // luma or alpha
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        // integer version of (src1 * src1_factor) + (src2 + src2_factor) + 0.5
-                        // 0.5 is for rounding
-                        // 128 is the integer representation of 0.5 << 8
-                        cpy_dst_data[pixel] = ((cpy_src1_data[pixel] * src1_factor) + (cpy_src2_data[pixel] * src2_factor) + 128) >> 8;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            } else {
-                // chroma
-                for (line = 0; line < cpy_src_h; line++) {
-                    for (pixel = 0; pixel < cpy_line_width; pixel++) {
-                        // as above
-                        // because U and V are based around 128 we have to subtract 128 from the components.
-                        // 32896 is the integer representation of 128.5 << 8
-                        cpy_dst_data[pixel] = (((cpy_src1_data[pixel] - 128) * src1_factor) + ((cpy_src2_data[pixel] - 128) * src2_factor) + 32896) >> 8;
-                    }
-                    cpy_src1_data += cpy_src1_line_size;
-                    cpy_src2_data += cpy_src2_line_size;
-                    cpy_dst_data += cpy_dst_line_size;
-                }
-            }
-        }
+        ff_dlog(ctx, "blend_frames() INTERPOLATE to create work frame\n");
+        ctx->internal->execute(ctx, blend_slice, &td, NULL,
+                               FFMIN(FFMAX(copy_src1->height >> s->vsub, 1), s->nb_threads));
         return 1;
     }
     return 0;
@@ -411,7 +382,7 @@ static int process_work_frame(AVFilterContext *ctx, int stop)
             ff_dlog(ctx, "process_work_frame() interpolate source is:PREV\n");
             copy_src2 = s->srce[s->prev];
         }
-        if (s->blend_frames(ctx, interpolate, copy_src1, copy_src2))
+        if (blend_frames(ctx, interpolate, copy_src1, copy_src2))
             goto copy_done;
         else
             ff_dlog(ctx, "process_work_frame() CUT - DON'T INTERPOLATE\n");
@@ -531,6 +502,7 @@ static av_cold void uninit(AVFilterContext *ctx)
             av_frame_free(&s->srce[i]);
     }
     av_frame_free(&s->srce[s->last]);
+    av_freep(&s->sad_sums);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -575,11 +547,14 @@ static int config_input(AVFilterLink *inlink)
 
     s->srce_time_base = inlink->time_base;
 
-    if (s->bitdepth == 8)
-        s->blend_frames = blend_frames8;
-    else
-        s->blend_frames = blend_frames16;
     s->max = 1 << (s->bitdepth);
+    ff_framerate_init_dsp(&s->dsp, s->bitdepth);
+
+    s->nb_threads = ctx->graph->nb_threads;
+    av_freep(&s->sad_sums);
+    s->sad_sums = av_calloc(s->nb_threads, sizeof(*s->sad_sums));
+    if (!s->sad_sums)
+        return AVERROR(ENOMEM);
 
     return 0;
 }
@@ -728,4 +703,5 @@ AVFilter ff_vf_framerate = {
     .query_formats = query_formats,
     .inputs        = framerate_inputs,
     .outputs       = framerate_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_FRAMERATE_H
+#define AVFILTER_FRAMERATE_H
+
+#include <stdint.h>
+
+typedef struct FrameRateDSPContext {
+    /**
+     * dst[x] = (src1[x] * factor1 + src2[x] * factor2 + half) >> shift
+     * for width samples of the bit depth given to ff_framerate_init_dsp(),
+     * with factor1 + factor2 = 1 << shift = 1 << max(depth, 8).
+     */
+    void (*blend_row)(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                      int width, int factor1, int factor2, int half, int shift);
+
+    /**
+     * Sum of |src1[x] - src2[x]| for width samples of up to 12 bits.
+     */
+    int64_t (*sad_row16)(const uint16_t *src1, const uint16_t *src2, int width);
+} FrameRateDSPContext;
+
+void ff_framerate_blend_row8_c(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                               int width, int factor1, int factor2, int half, int shift);
+void ff_framerate_blend_row16_c(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                                int width, int factor1, int factor2, int half, int shift);
+int64_t ff_framerate_sad_row16_c(const uint16_t *src1, const uint16_t *src2, int width);
+
+void ff_framerate_init_dsp(FrameRateDSPContext *dsp, int bitdepth);
+void ff_framerate_init_x86(FrameRateDSPContext *dsp, int bitdepth);
+
+#endif /* AVFILTER_FRAMERATE_H */
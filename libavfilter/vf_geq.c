@@ -101,6 +101,15 @@ static double alpha(void *priv, double x, double y) { return getpix(priv, x, y,
 static const char *const var_names[] = {   "X",   "Y",   "W",   "H",   "N",   "SW",   "SH",   "T",        NULL };
 enum                                   { VAR_X, VAR_Y, VAR_W, VAR_H, VAR_N, VAR_SW, VAR_SH, VAR_T, VAR_VARS_NB };
 
+#define BLOCK_SIZE 256
+
+typedef struct ThreadData {
+    AVFrame *out;
+    int plane;
+    int w, h;
+    const double *values;
+} ThreadData;
+
 static av_cold int geq_init(AVFilterContext *ctx)
 {
     GEQContext *geq = ctx->priv;
@@ -201,10 +210,44 @@ static int geq_config_props(AVFilterLink *inlink)
     return 0;
 }
 
+static int slice_geq_filter(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    GEQContext *geq = ctx->priv;
+    ThreadData *td = arg;
+    const int plane = td->plane;
+    const int w = td->w;
+    const int slice_start = (td->h *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr + 1)) / nb_jobs;
+    const int linesize = td->out->linesize[plane];
+    uint8_t *dst = td->out->data[plane] + slice_start * linesize;
+    double values[VAR_VARS_NB], xs[BLOCK_SIZE], res[BLOCK_SIZE];
+    const double *arrays[VAR_VARS_NB] = { [VAR_X] = xs };
+    int x, y, i;
+
+    memcpy(values, td->values, sizeof(values));
+
+    for (y = slice_start; y < slice_end; y++) {
+        values[VAR_Y] = y;
+        for (x = 0; x < w; x += BLOCK_SIZE) {
+            const int n = FFMIN(w - x, BLOCK_SIZE);
+
+            for (i = 0; i < n; i++)
+                xs[i] = x + i;
+            av_expr_eval_array(geq->e[plane], res, n, values, arrays, geq);
+            for (i = 0; i < n; i++)
+                dst[x + i] = res[i];
+        }
+        dst += linesize;
+    }
+
+    return 0;
+}
+
 static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     int plane;
-    GEQContext *geq = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    GEQContext *geq = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
     double values[VAR_VARS_NB] = {
@@ -221,25 +264,18 @@ static int geq_filter_frame(AVFilterLink *inlink, AVFrame *in)
     av_frame_copy_props(out, in);
 
     for (plane = 0; plane < geq->planes && out->data[plane]; plane++) {
-        int x, y;
-        uint8_t *dst = out->data[plane];
-        const int linesize = out->linesize[plane];
         const int w = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->w, geq->hsub) : inlink->w;
         const int h = (plane == 1 || plane == 2) ? AV_CEIL_RSHIFT(inlink->h, geq->vsub) : inlink->h;
+        ThreadData td = { .out = out, .plane = plane, .w = w, .h = h, .values = values };
 
         values[VAR_W]  = w;
         values[VAR_H]  = h;
         values[VAR_SW] = w / (double)inlink->w;
         values[VAR_SH] = h / (double)inlink->h;
 
-        for (y = 0; y < h; y++) {
-            values[VAR_Y] = y;
-            for (x = 0; x < w; x++) {
-                values[VAR_X] = x;
-                dst[x] = av_expr_eval(geq->e[plane], values, geq);
-            }
-            dst += linesize;
-        }
+        /* expressions with side effects must see the pixels in raster order */
+        ctx->internal->execute(ctx, slice_geq_filter, &td, NULL,
+                               av_expr_is_pure(geq->e[plane]) ? FFMIN(h, ctx->graph->nb_threads) : 1);
     }
 
     av_frame_free(&geq->picref);
@@ -283,5 +319,5 @@ AVFilter ff_vf_geq = {
     .inputs        = geq_inputs,
     .outputs       = geq_outputs,
     .priv_class    = &geq_class,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -33,6 +33,9 @@ typedef struct HistogramContext {
     const AVClass *class;               ///< AVClass context for log and options purpose
     unsigned       histogram[256*256];
     int            histogram_size;
+    unsigned      *histograms;          ///< per-job partial histograms
+    int            histograms_stride;
+    int            nb_threads;
     int            mult;
     int            ncomp;
     uint8_t        bg_color[4];
@@ -190,13 +193,24 @@ static const uint8_t white_gbrp_color[4] = { 255, 255, 255, 255 };
 
 static int config_input(AVFilterLink *inlink)
 {
-    HistogramContext *h = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    HistogramContext *h = ctx->priv;
 
     h->desc  = av_pix_fmt_desc_get(inlink->format);
     h->ncomp = h->desc->nb_components;
     h->histogram_size = 1 << h->desc->comp[0].depth;
     h->mult = h->histogram_size / 256;
 
+    /* each job counts into 4 interleaved tables, so that runs of equal
+     * samples do not serialize on a single counter; the extra bin collects
+     * samples above the nominal depth, which are not displayed */
+    h->nb_threads = ctx->graph->nb_threads;
+    h->histograms_stride = h->histogram_size + 1;
+    av_freep(&h->histograms);
+    h->histograms = av_malloc_array(h->nb_threads, 4 * h->histograms_stride * sizeof(*h->histograms));
+    if (!h->histograms)
+        return AVERROR(ENOMEM);
+
     switch (inlink->format) {
     case AV_PIX_FMT_GBRP12:
     case AV_PIX_FMT_GBRP10:
@@ -241,13 +255,68 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in;
+    int plane;
+} ThreadData;
+
+static int histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HistogramContext *h = ctx->priv;
+    ThreadData *td = arg;
+    const int p = td->plane;
+    const int height = h->planeheight[p];
+    const int width = h->planewidth[p];
+    const int slice_start = (height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (height * (jobnr + 1)) / nb_jobs;
+    const int stride = h->histograms_stride;
+    const int limit = h->histogram_size;
+    unsigned *hist0 = h->histograms + jobnr * 4 * stride;
+    unsigned *hist1 = hist0 + stride;
+    unsigned *hist2 = hist1 + stride;
+    unsigned *hist3 = hist2 + stride;
+    int i, j;
+
+    memset(hist0, 0, 4 * stride * sizeof(*hist0));
+
+    if (h->histogram_size <= 256) {
+        for (i = slice_start; i < slice_end; i++) {
+            const uint8_t *src = td->in->data[p] + i * td->in->linesize[p];
+
+            for (j = 0; j < width - 3; j += 4) {
+                hist0[src[j    ]]++;
+                hist1[src[j + 1]]++;
+                hist2[src[j + 2]]++;
+                hist3[src[j + 3]]++;
+            }
+            for (; j < width; j++)
+                hist0[src[j]]++;
+        }
+    } else {
+        for (i = slice_start; i < slice_end; i++) {
+            const uint16_t *src = (const uint16_t *)(td->in->data[p] + i * td->in->linesize[p]);
+
+            for (j = 0; j < width - 3; j += 4) {
+                hist0[FFMIN(src[j    ], limit)]++;
+                hist1[FFMIN(src[j + 1], limit)]++;
+                hist2[FFMIN(src[j + 2], limit)]++;
+                hist3[FFMIN(src[j + 3], limit)]++;
+            }
+            for (; j < width; j++)
+                hist0[FFMIN(src[j], limit)]++;
+        }
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     HistogramContext *h   = inlink->dst->priv;
     AVFilterContext *ctx  = inlink->dst;
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out;
-    int i, j, k, l, m;
+    int i, j, k, l, m, nb_jobs;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -281,7 +350,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     for (m = 0, k = 0; k < h->ncomp; k++) {
         const int p = h->desc->comp[k].plane;
         const int height = h->planeheight[p];
-        const int width = h->planewidth[p];
+        ThreadData td;
         double max_hval_log;
         unsigned max_hval = 0;
         int start;
@@ -290,18 +359,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
             continue;
         start = m++ * (h->level_height + h->scale_height) * h->display_mode;
 
-        if (h->histogram_size <= 256) {
-            for (i = 0; i < height; i++) {
-                const uint8_t *src = in->data[p] + i * in->linesize[p];
-                for (j = 0; j < width; j++)
-                    h->histogram[src[j]]++;
-            }
-        } else {
-            for (i = 0; i < height; i++) {
-                const uint16_t *src = (const uint16_t *)(in->data[p] + i * in->linesize[p]);
-                for (j = 0; j < width; j++)
-                    h->histogram[src[j]]++;
-            }
+        td.in    = in;
+        td.plane = p;
+        nb_jobs  = FFMIN(height, h->nb_threads);
+        ctx->internal->execute(ctx, histogram_slice, &td, NULL, nb_jobs);
+
+        memcpy(h->histogram, h->histograms, h->histogram_size * sizeof(*h->histogram));
+        for (j = 1; j < 4 * nb_jobs; j++) {
+            const unsigned *src = h->histograms + j * h->histograms_stride;
+
+            for (i = 0; i < h->histogram_size; i++)
+                h->histogram[i] += src[i];
         }
 
         for (i = 0; i < h->histogram_size; i++)
@@ -342,14 +410,19 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
                     AV_WN16(out->data[p] + (j + start) * out->linesize[p] + i * 2, i);
             }
         }
-
-        memset(h->histogram, 0, h->histogram_size * sizeof(unsigned));
     }
 
     av_frame_free(&in);
     return ff_filter_frame(outlink, out);
 }
 
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    HistogramContext *h = ctx->priv;
+
+    av_freep(&h->histograms);
+}
+
 static const AVFilterPad inputs[] = {
     {
         .name         = "default",
@@ -374,7 +447,9 @@ AVFilter ff_vf_histogram = {
     .description   = NULL_IF_CONFIG_SMALL("Compute and draw a histogram."),
     .priv_size     = sizeof(HistogramContext),
     .query_formats = query_formats,
+    .uninit        = uninit,
     .inputs        = inputs,
     .outputs       = outputs,
     .priv_class    = &histogram_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -121,26 +121,24 @@ static void denoise_spatial(HQDN3DContext *s,
 }
 
 av_always_inline
-static int denoise_depth(HQDN3DContext *s,
-                         uint8_t *src, uint8_t *dst,
-                         uint16_t *line_ant, uint16_t **frame_ant_ptr,
-                         int w, int h, int sstride, int dstride,
-                         int16_t *spatial, int16_t *temporal, int depth)
+static void denoise_depth(HQDN3DContext *s,
+                          uint8_t *src, uint8_t *dst,
+                          uint16_t *line_ant, uint16_t *frame_ant,
+                          int w, int h, int sstride, int dstride,
+                          int16_t *spatial, int16_t *temporal,
+                          int first, int depth)
 {
     // FIXME: For 16-bit depth, frame_ant could be a pointer to the previous
     // filtered frame rather than a separate buffer.
     long x, y;
-    uint16_t *frame_ant = *frame_ant_ptr;
-    if (!frame_ant) {
+    if (first) {
         uint8_t *frame_src = src;
-        *frame_ant_ptr = frame_ant = av_malloc_array(w, h*sizeof(uint16_t));
-        if (!frame_ant)
-            return AVERROR(ENOMEM);
+        uint16_t *frame_dst = frame_ant;
         for (y = 0; y < h; y++, src += sstride, frame_ant += w)
             for (x = 0; x < w; x++)
                 frame_ant[x] = LOAD(x);
         src = frame_src;
-        frame_ant = *frame_ant_ptr;
+        frame_ant = frame_dst;
     }
 
     if (spatial[0])
@@ -150,26 +148,63 @@ static int denoise_depth(HQDN3DContext *s,
         denoise_temporal(src, dst, frame_ant,
                          w, h, sstride, dstride, temporal, depth);
     emms_c();
-    return 0;
 }
 
 #define denoise(...)                                                          \
     do {                                                                      \
-        int ret = AVERROR_BUG;                                                \
         switch (s->depth) {                                                   \
-            case  8: ret = denoise_depth(__VA_ARGS__,  8); break;             \
-            case  9: ret = denoise_depth(__VA_ARGS__,  9); break;             \
-            case 10: ret = denoise_depth(__VA_ARGS__, 10); break;             \
-            case 16: ret = denoise_depth(__VA_ARGS__, 16); break;             \
-        }                                                                     \
-        if (ret < 0) {                                                        \
-            av_frame_free(&out);                                              \
-            if (!direct)                                                      \
-                av_frame_free(&in);                                           \
-            return ret;                                                       \
+            case  8: denoise_depth(__VA_ARGS__,  8); break;                   \
+            case  9: denoise_depth(__VA_ARGS__,  9); break;                   \
+            case 10: denoise_depth(__VA_ARGS__, 10); break;                   \
+            case 16: denoise_depth(__VA_ARGS__, 16); break;                   \
         }                                                                     \
     } while (0)
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int first;
+} ThreadData;
+
+/* The spatial filter is recursive in both directions, so a plane using it is
+ * processed as a whole by a single job; the temporal-only filter depends on
+ * the previous frame alone and is split by rows. */
+static int denoise_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in, *out = td->out;
+    int c;
+
+    for (c = 0; c < 3; c++) {
+        const int w = AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub));
+        const int h = AV_CEIL_RSHIFT(in->height, (!!c * s->vsub));
+        int16_t *spatial  = s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL];
+        int16_t *temporal = s->coefs[c ? CHROMA_TMP     : LUMA_TMP];
+        int slice_start, slice_end;
+
+        if (spatial[0]) {
+            if (FFMIN(c, nb_jobs - 1) != jobnr)
+                continue;
+            slice_start = 0;
+            slice_end   = h;
+        } else {
+            slice_start = (h *  jobnr     ) / nb_jobs;
+            slice_end   = (h * (jobnr + 1)) / nb_jobs;
+        }
+        if (slice_start == slice_end)
+            continue;
+
+        denoise(s, in ->data[c] + slice_start * in ->linesize[c],
+                   out->data[c] + slice_start * out->linesize[c],
+                s->line[c], s->frame_prev[c] + slice_start * w,
+                w, slice_end - slice_start,
+                in->linesize[c], out->linesize[c],
+                spatial, temporal, td->first);
+    }
+
+    return 0;
+}
+
 static int16_t *precalc_coefs(double dist25, int depth)
 {
     int i;
@@ -223,7 +258,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->coefs[1]);
     av_freep(&s->coefs[2]);
     av_freep(&s->coefs[3]);
-    av_freep(&s->line);
+    av_freep(&s->line[0]);
+    av_freep(&s->line[1]);
+    av_freep(&s->line[2]);
     av_freep(&s->frame_prev[0]);
     av_freep(&s->frame_prev[1]);
     av_freep(&s->frame_prev[2]);
@@ -261,19 +298,22 @@ static int query_formats(AVFilterContext *ctx)
 
 static int config_input(AVFilterLink *inlink)
 {
-    HQDN3DContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    HQDN3DContext *s = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
     int i;
 
-    uninit(inlink->dst);
+    uninit(ctx);
 
     s->hsub  = desc->log2_chroma_w;
     s->vsub  = desc->log2_chroma_h;
     s->depth = desc->comp[0].depth;
 
-    s->line = av_malloc_array(inlink->w, sizeof(*s->line));
-    if (!s->line)
-        return AVERROR(ENOMEM);
+    for (i = 0; i < 3; i++) {
+        s->line[i] = av_malloc_array(inlink->w, sizeof(*s->line[i]));
+        if (!s->line[i])
+            return AVERROR(ENOMEM);
+    }
 
     for (i = 0; i < 4; i++) {
         s->coefs[i] = precalc_coefs(s->strength[i], s->depth);
@@ -281,6 +321,8 @@ static int config_input(AVFilterLink *inlink)
             return AVERROR(ENOMEM);
     }
 
+    s->nb_threads = ctx->graph->nb_threads;
+
     if (ARCH_X86)
         ff_hqdn3d_init_x86(s);
 
@@ -294,6 +336,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     AVFilterLink *outlink = ctx->outputs[0];
 
     AVFrame *out;
+    ThreadData td;
     int c, direct = av_frame_is_writable(in) && !ctx->is_disabled;
 
     if (direct) {
@@ -308,16 +351,27 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
-    for (c = 0; c < 3; c++) {
-        denoise(s, in->data[c], out->data[c],
-                s->line, &s->frame_prev[c],
-                AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
-                AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
-                in->linesize[c], out->linesize[c],
-                s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
-                s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+    td.first = !s->frame_prev[0];
+    for (c = 0; c < 3 && td.first; c++) {
+        s->frame_prev[c] = av_malloc_array(AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
+                                           AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)) *
+                                           sizeof(*s->frame_prev[c]));
+        if (!s->frame_prev[c]) {
+            av_freep(&s->frame_prev[0]);
+            av_freep(&s->frame_prev[1]);
+            if (!direct)
+                av_frame_free(&out);
+            av_frame_free(&in);
+            return AVERROR(ENOMEM);
+        }
     }
 
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, denoise_slice, &td, NULL,
+                           FFMIN(FFMAX(AV_CEIL_RSHIFT(in->height, s->vsub), 3),
+                                 s->nb_threads));
+
     if (ctx->is_disabled) {
         av_frame_free(&out);
         return ff_filter_frame(outlink, in);
@@ -370,5 +424,5 @@ AVFilter ff_vf_hqdn3d = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_hqdn3d_inputs,
     .outputs       = avfilter_vf_hqdn3d_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -30,6 +30,7 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_nnedi.h"
 
 typedef struct FrameData {
     uint8_t *paddedp[3];
@@ -43,8 +44,10 @@ typedef struct FrameData {
     int field[3];
 
     int32_t *lcount[3];
-    float *input;
-    float *temp;
+    float *input;               ///< per-job scratch, input_stride floats each
+    float *temp;                ///< per-job scratch, temp_stride bytes each
+    int input_stride;
+    int temp_stride;
 } FrameData;
 
 typedef struct NNEDIContext {
@@ -60,6 +63,7 @@ typedef struct NNEDIContext {
 
     AVFloatDSPContext *fdsp;
     int nb_planes;
+    int nb_threads;
     int linesize[4];
     int planeheight[4];
 
@@ -84,8 +88,8 @@ typedef struct NNEDIContext {
     int max_value;
 
     void (*copy_pad)(const AVFrame *, FrameData *, struct NNEDIContext *, int);
-    void (*evalfunc_0)(struct NNEDIContext *, FrameData *);
-    void (*evalfunc_1)(struct NNEDIContext *, FrameData *);
+    void (*evalfunc_0)(struct NNEDIContext *, FrameData *, int jobnr, int nb_jobs);
+    void (*evalfunc_1)(struct NNEDIContext *, FrameData *, int jobnr, int nb_jobs);
 
     // Functions used in evalfunc_0
     void (*readpixels)(const uint8_t *, const int, float *);
@@ -94,9 +98,8 @@ typedef struct NNEDIContext {
 
     // Functions used in evalfunc_1
     void (*extract)(const uint8_t *, const int, const int, const int, float *, float *);
-    void (*dot_prod)(struct NNEDIContext *, const float *, const float *, float *, const int, const int, const float *);
-    void (*expfunc)(float *, const int);
-    void (*wae5)(const float *, const int, float *);
+    void (*dot_prod)(const float *, const float *, float *, const int, const int, const float);
+    NNEDIDSPContext dsp;
 
     FrameData frame_data;
 } NNEDIContext;
@@ -161,6 +164,8 @@ static int config_input(AVFilterLink *inlink)
     s->planeheight[1] = s->planeheight[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
     s->planeheight[0] = s->planeheight[3] = inlink->h;
 
+    s->nb_threads = ctx->graph->nb_threads;
+
     return 0;
 }
 
@@ -278,7 +283,21 @@ static void dot_prod(NNEDIContext *s, const float *data, const float *weights, f
     }
 }
 
-static void dot_prods(NNEDIContext *s, const float *dataf, const float *weightsf, float *vals, const int n, const int len, const float *scale)
+void ff_nnedi_dot_prod_c(const float *data, const float *weights, float *vals, const int n, const int len, const float scale)
+{
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+        float sum = 0.0f;
+
+        for (j = 0; j < len; j++)
+            sum += data[j] * weights[i * len + j];
+
+        vals[i] = sum * scale + weights[n * len + i];
+    }
+}
+
+void ff_nnedi_dot_prod_i16_c(const float *dataf, const float *weightsf, float *vals, const int n, const int len, const float scale)
 {
     const int16_t *data = (int16_t *)dataf;
     const int16_t *weights = (int16_t *)weightsf;
@@ -290,7 +309,7 @@ static void dot_prods(NNEDIContext *s, const float *dataf, const float *weightsf
         for (j = 0; j < len; j++)
             sum += data[j] * weights[i * len + j];
 
-        vals[i] = sum * wf[off] * scale[0] + wf[off + 4];
+        vals[i] = sum * wf[off] * scale + wf[off + 4];
     }
 }
 
@@ -316,7 +335,7 @@ static void compute_network0_i16(NNEDIContext *s, const float *inputf, const flo
     const float *wf = weightsf + 2 * 48;
     float t, temp[12], scale = 1.0f;
 
-    dot_prods(s, inputf, weightsf, temp, 4, 48, &scale);
+    ff_nnedi_dot_prod_i16_c(inputf, weightsf, temp, 4, 48, scale);
     t = temp[0];
     elliott(temp, 4);
     temp[0] = t;
@@ -415,12 +434,23 @@ static void compute_network0new(NNEDIContext *s, const float *datai, const float
     ((int *)d)[0] = mask;
 }
 
-static void evalfunc_0(NNEDIContext *s, FrameData *frame_data)
+/**
+ * Get the range [*start, *stop) of the lines first, first + 2, ... below end
+ * belonging to slice jobnr.
+ */
+static void slice_lines(int first, int end, int jobnr, int nb_jobs, int *start, int *stop)
 {
-    float *input = frame_data->input;
+    const int count = FFMAX(end - first + 1, 0) / 2;
+
+    *start = first + 2 * (count *  jobnr      / nb_jobs);
+    *stop  = first + 2 * (count * (jobnr + 1) / nb_jobs);
+}
+
+static void evalfunc_0(NNEDIContext *s, FrameData *frame_data, int jobnr, int nb_jobs)
+{
+    float *input = frame_data->input + jobnr * frame_data->input_stride;
     const float *weights0 = s->weights0;
-    float *temp = frame_data->temp;
-    uint8_t *tempu = (uint8_t *)temp;
+    uint8_t *tempu = (uint8_t *)frame_data->temp + jobnr * frame_data->temp_stride;
     int plane, x, y;
 
     // And now the actual work.
@@ -440,15 +470,17 @@ static void evalfunc_0(NNEDIContext *s, FrameData *frame_data)
         if (!(s->process_plane & (1 << plane)))
             continue;
 
-        for (y = 1 - frame_data->field[plane]; y < height - 12; y += 2) {
+        slice_lines(1 - frame_data->field[plane], height - 12, jobnr, nb_jobs, &ystart, &ystop);
+        for (y = ystart; y < ystop; y += 2) {
             memcpy(dstp + y * dst_stride,
                    srcp + 32 + (6 + y) * src_stride,
                    (width - 64) * sizeof(uint8_t));
 
         }
 
-        ystart = 6 + frame_data->field[plane];
-        ystop = height - 6;
+        slice_lines(frame_data->field[plane], height - 12, jobnr, nb_jobs, &ystart, &ystop);
+        ystart += 6;
+        ystop  += 6;
         srcp += ystart * src_stride;
         dstp += (ystart - 6) * dst_stride - 32;
         src3p = srcp - src_stride * 3;
@@ -575,10 +607,10 @@ static void weighted_avg_elliott_mul5_m16(const float *w, const int n, float *ms
 }
 
 
-static void evalfunc_1(NNEDIContext *s, FrameData *frame_data)
+static void evalfunc_1(NNEDIContext *s, FrameData *frame_data, int jobnr, int nb_jobs)
 {
-    float *input = frame_data->input;
-    float *temp = frame_data->temp;
+    float *input = frame_data->input + jobnr * frame_data->input_stride;
+    float *temp = (float *)((uint8_t *)frame_data->temp + jobnr * frame_data->temp_stride);
     float **weights1 = s->weights1;
     const int qual = s->qual;
     const int asize = s->asize;
@@ -599,13 +631,14 @@ static void evalfunc_1(NNEDIContext *s, FrameData *frame_data)
         uint8_t *dstp = (uint8_t *)frame_data->dstp[plane];
         const int dst_stride = frame_data->dst_stride[plane] / sizeof(uint8_t);
 
-        const int ystart = frame_data->field[plane];
-        const int ystop = height - 12;
         const uint8_t *srcpp;
+        int ystart, ystop;
 
         if (!(s->process_plane & (1 << plane)))
             continue;
 
+        slice_lines(frame_data->field[plane], height - 12, jobnr, nb_jobs, &ystart, &ystop);
+
         srcp += (ystart + 6) * src_stride;
         dstp += ystart * dst_stride - 32;
         srcpp = srcp - (ydia - 1) * src_stride - xdiad2m1;
@@ -619,9 +652,9 @@ static void evalfunc_1(NNEDIContext *s, FrameData *frame_data)
 
                 s->extract((const uint8_t *)(srcpp + x), src_stride, xdia, ydia, mstd, input);
                 for (i = 0; i < qual; i++) {
-                    s->dot_prod(s, input, weights1[i], temp, nns * 2, asize, mstd + 2);
-                    s->expfunc(temp, nns);
-                    s->wae5(temp, nns, mstd);
+                    s->dot_prod(input, weights1[i], temp, nns * 2, asize, mstd[2]);
+                    s->dsp.expfunc(temp, nns);
+                    s->dsp.wae5(temp, nns, mstd);
                 }
 
                 dstp[x] = FFMIN(FFMAX((int)(mstd[3] * scale + 0.5f), 0), s->max_value);
@@ -666,17 +699,24 @@ static void select_functions(NNEDIContext *s)
     }
 
     // evalfunc_1
-    s->wae5 = weighted_avg_elliott_mul5_m16;
-
     if (s->fapprox & 2) { // use int16 dot products
         s->extract = extract_m8_i16;
-        s->dot_prod = dot_prods;
+        s->dot_prod = s->dsp.dot_prod_i16;
     } else { // use float dot products
         s->extract = extract_m8;
-        s->dot_prod = dot_prod;
+        s->dot_prod = s->dsp.dot_prod;
     }
+}
+
+av_cold void ff_nnedi_init_dsp(NNEDIDSPContext *dsp)
+{
+    dsp->dot_prod     = ff_nnedi_dot_prod_c;
+    dsp->dot_prod_i16 = ff_nnedi_dot_prod_i16_c;
+    dsp->expfunc      = e2_m16;
+    dsp->wae5         = weighted_avg_elliott_mul5_m16;
 
-    s->expfunc = e2_m16;
+    if (ARCH_X86)
+        ff_nnedi_init_x86(dsp);
 }
 
 static int modnpf(const int m, const int n)
@@ -686,6 +726,20 @@ static int modnpf(const int m, const int n)
     return m + n - (m % n);
 }
 
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    NNEDIContext *s = ctx->priv;
+    FrameData *frame_data = arg;
+
+    // Handles prescreening and the cubic interpolation.
+    s->evalfunc_0(s, frame_data, jobnr, nb_jobs);
+
+    // The rest.
+    s->evalfunc_1(s, frame_data, jobnr, nb_jobs);
+
+    return 0;
+}
+
 static int get_frame(AVFilterContext *ctx, int is_second)
 {
     NNEDIContext *s = ctx->priv;
@@ -766,15 +820,17 @@ static int get_frame(AVFilterContext *ctx, int is_second)
     }
 
     if (!frame_data->input) {
-        frame_data->input = av_malloc(512 * sizeof(float));
+        frame_data->input_stride = 512;
+        frame_data->input = av_malloc_array(s->nb_threads, frame_data->input_stride * sizeof(float));
         if (!frame_data->input)
             return AVERROR(ENOMEM);
     }
     // evalfunc_0 requires at least padded_width[0] bytes.
     // evalfunc_1 requires at least 512 floats.
     if (!frame_data->temp) {
-        temp_size = FFMAX(frame_data->padded_width[0], 512 * sizeof(float));
-        frame_data->temp = av_malloc(temp_size);
+        temp_size = FFALIGN(FFMAX(frame_data->padded_width[0], 512 * sizeof(float)), 64);
+        frame_data->temp_stride = temp_size;
+        frame_data->temp = av_malloc_array(s->nb_threads, temp_size);
         if (!frame_data->temp)
             return AVERROR(ENOMEM);
     }
@@ -782,11 +838,8 @@ static int get_frame(AVFilterContext *ctx, int is_second)
     // Copy src to a padded "frame" in frame_data and mirror the edges.
     s->copy_pad(src, frame_data, s, field_n);
 
-    // Handles prescreening and the cubic interpolation.
-    s->evalfunc_0(s, frame_data);
-
-    // The rest.
-    s->evalfunc_1(s, frame_data);
+    ctx->internal->execute(ctx, filter_slice, frame_data, NULL,
+                           FFMIN(s->planeheight[1], s->nb_threads));
 
     return 0;
 }
@@ -1145,6 +1198,7 @@ static av_cold int init(AVFilterContext *ctx)
 
     s->max_value = 65535 >> 8;
 
+    ff_nnedi_init_dsp(&s->dsp);
     select_functions(s);
 
     s->fdsp = avpriv_float_dsp_alloc(0);
@@ -1207,5 +1261,5 @@ AVFilter ff_vf_nnedi = {
     .query_formats = query_formats,
     .inputs        = inputs,
     .outputs       = outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,61 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_NNEDI_H
+#define AVFILTER_NNEDI_H
+
+/**
+ * Kernels of the predictor network. n is the number of neurons (a multiple
+ * of 8) and len the number of inputs (a multiple of 16).
+ */
+typedef struct NNEDIDSPContext {
+    /**
+     * vals[i] = dot(data, weights[i * len]) * scale + weights[n * len + i]
+     */
+    void (*dot_prod)(const float *data, const float *weights, float *vals,
+                     const int n, const int len, const float scale);
+
+    /**
+     * Same as dot_prod, with data and weights holding int16_t and the
+     * per-neuron scale and bias stored as floats after the weights,
+     * interleaved in groups of 4.
+     */
+    void (*dot_prod_i16)(const float *data, const float *weights, float *vals,
+                         const int n, const int len, const float scale);
+
+    /**
+     * s[i] = exp(s[i]), with the argument clipped to [-80, 80].
+     */
+    void (*expfunc)(float *s, const int n);
+
+    /**
+     * Average the elliott outputs w[n + i] weighted by w[i] and add the
+     * result to mstd[3].
+     */
+    void (*wae5)(const float *w, const int n, float *mstd);
+} NNEDIDSPContext;
+
+void ff_nnedi_dot_prod_c(const float *data, const float *weights, float *vals,
+                         const int n, const int len, const float scale);
+void ff_nnedi_dot_prod_i16_c(const float *data, const float *weights, float *vals,
+                             const int n, const int len, const float scale);
+
+void ff_nnedi_init_dsp(NNEDIDSPContext *dsp);
+void ff_nnedi_init_x86(NNEDIDSPContext *dsp);
+
+#endif /* AVFILTER_NNEDI_H */
@@ -39,6 +39,7 @@
 #include "dualinput.h"
 #include "drawutils.h"
 #include "video.h"
+#include "vf_overlay.h"
 
 static const char *const var_names[] = {
     "main_w",    "W", ///< width  of the main    video
@@ -132,6 +133,8 @@ typedef struct OverlayContext {
     int eof_action;             ///< action to take on EOF from source
 
     AVExpr *x_pexpr, *y_pexpr;
+
+    OverlayDSPContext dsp;
 } OverlayContext;
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -384,36 +387,98 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
-// divide by 255 and round to nearest
-// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
-#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+void ff_overlay_blend_row_c(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    int k;
+
+    for (k = 0; k < w; k++)
+        d[k] = FAST_DIV255(d[k] * (255 - a[k]) + s[k] * a[k]);
+}
+
+void ff_overlay_blend_row_420_c(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                ptrdiff_t alinesize, int w)
+{
+    int k;
+
+    for (k = 0; k < w; k++) {
+        int alpha = (a[2*k] + a[2*k + alinesize] +
+                     a[2*k+1] + a[2*k+1 + alinesize]) >> 2;
+        d[k] = FAST_DIV255(d[k] * (255 - alpha) + s[k] * alpha);
+    }
+}
+
+void ff_overlay_blend_row_rgba_c(uint8_t *d, const uint8_t *s, int w,
+                                 const uint8_t *dmap, const uint8_t *smap)
+{
+    const int dr = dmap[R], dg = dmap[G], db = dmap[B], da = dmap[A];
+    const int sr = smap[R], sg = smap[G], sb = smap[B], sa = smap[A];
+    int j;
+
+    for (j = 0; j < w; j++) {
+        uint8_t alpha = s[sa];
+
+        if (alpha != 0 && alpha != 255)
+            alpha = UNPREMULTIPLY_ALPHA(alpha, d[da]);
+
+        switch (alpha) {
+        case 0:
+            break;
+        case 255:
+            d[dr] = s[sr];
+            d[dg] = s[sg];
+            d[db] = s[sb];
+            d[da] = s[sa];
+            break;
+        default:
+            d[dr] = FAST_DIV255(d[dr] * (255 - alpha) + s[sr] * alpha);
+            d[dg] = FAST_DIV255(d[dg] * (255 - alpha) + s[sg] * alpha);
+            d[db] = FAST_DIV255(d[db] * (255 - alpha) + s[sb] * alpha);
+            d[da] += FAST_DIV255((255 - d[da]) * s[sa]);
+        }
+        d += 4;
+        s += 4;
+    }
+}
+
+av_cold void ff_overlay_init_dsp(OverlayDSPContext *dsp)
+{
+    dsp->blend_row      = ff_overlay_blend_row_c;
+    dsp->blend_row_420  = ff_overlay_blend_row_420_c;
+    dsp->blend_row_rgba = ff_overlay_blend_row_rgba_c;
 
-// calculate the unpremultiplied alpha, applying the general equation:
-// alpha = alpha_overlay / ( (alpha_main + alpha_overlay) - (alpha_main * alpha_overlay) )
-// (((x) << 16) - ((x) << 9) + (x)) is a faster version of: 255 * 255 * x
-// ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
-#define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
+    if (ARCH_X86)
+        ff_overlay_init_x86(dsp);
+}
+
+typedef struct ThreadData {
+    AVFrame *dst;
+    const AVFrame *src;
+    int x, y;
+} ThreadData;
 
 /**
- * Blend image in src to destination buffer dst at position (x, y).
+ * Blend the rows of the image in src belonging to slice jobnr to
+ * destination buffer dst at position (x, y).
  */
-static void blend_image(AVFilterContext *ctx,
-                        AVFrame *dst, const AVFrame *src,
-                        int x, int y)
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
+    const OverlayDSPContext *dsp = &s->dsp;
+    ThreadData *td = arg;
+    AVFrame *dst = td->dst;
+    const AVFrame *src = td->src;
+    const int x = td->x;
+    const int y = td->y;
     int i, imax, j, jmax, k, kmax;
     const int src_w = src->width;
     const int src_h = src->height;
     const int dst_w = dst->width;
     const int dst_h = dst->height;
 
-    if (x >= dst_w || x+src_w < 0 ||
-        y >= dst_h || y+src_h < 0)
-        return; /* no intersection */
-
     if (s->main_is_packed_rgb) {
         uint8_t alpha;          ///< the amount of overlay to blend on to main
+        const uint8_t *dmap = s->main_rgba_map;
+        const uint8_t *smap = s->overlay_rgba_map;
         const int dr = s->main_rgba_map[R];
         const int dg = s->main_rgba_map[G];
         const int db = s->main_rgba_map[B];
@@ -425,18 +490,29 @@ static void blend_image(AVFilterContext *ctx,
         const int sa = s->overlay_rgba_map[A];
         const int sstep = s->overlay_pix_step[0];
         const int main_has_alpha = s->main_has_alpha;
+        const int use_dsp = main_has_alpha && dstep == 4 && sstep == 4;
         uint8_t *s, *sp, *d, *dp;
 
-        i = FFMAX(-y, 0);
+        i    = FFMAX(-y, 0);
+        imax = FFMIN(-y + dst_h, src_h);
+        j    = i + (imax - i) *  jobnr      / nb_jobs;
+        imax = i + (imax - i) * (jobnr + 1) / nb_jobs;
+        i    = j;
         sp = src->data[0] + i     * src->linesize[0];
         dp = dst->data[0] + (y+i) * dst->linesize[0];
 
-        for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
+        for (; i < imax; i++) {
             j = FFMAX(-x, 0);
             s = sp + j     * sstep;
             d = dp + (x+j) * dstep;
+            jmax = FFMIN(-x + dst_w, src_w);
+
+            if (use_dsp && jmax > j) {
+                dsp->blend_row_rgba(d, s, jmax - j, dmap, smap);
+                j = jmax;
+            }
 
-            for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
+            for (; j < jmax; j++) {
                 alpha = s[sa];
 
                 // if the main channel has an alpha channel, alpha has to be calculated
@@ -485,11 +561,15 @@ static void blend_image(AVFilterContext *ctx,
             uint8_t alpha;          ///< the amount of overlay to blend on to main
             uint8_t *s, *sa, *d, *da;
 
-            i = FFMAX(-y, 0);
+            i    = FFMAX(-y, 0);
+            imax = FFMIN(-y + dst_h, src_h);
+            j    = i + (imax - i) *  jobnr      / nb_jobs;
+            imax = i + (imax - i) * (jobnr + 1) / nb_jobs;
+            i    = j;
             sa = src->data[3] + i     * src->linesize[3];
             da = dst->data[3] + (y+i) * dst->linesize[3];
 
-            for (imax = FFMIN(-y + dst_h, src_h); i < imax; i++) {
+            for (; i < imax; i++) {
                 j = FFMAX(-x, 0);
                 s = sa + j;
                 d = da + x+j;
@@ -528,18 +608,43 @@ static void blend_image(AVFilterContext *ctx,
             int xp = x>>hsub;
             uint8_t *s, *sp, *d, *dp, *a, *ap;
 
-            j = FFMAX(-yp, 0);
+            j    = FFMAX(-yp, 0);
+            jmax = FFMIN(-yp + dst_hp, src_hp);
+            k    = j + (jmax - j) *  jobnr      / nb_jobs;
+            jmax = j + (jmax - j) * (jobnr + 1) / nb_jobs;
+            j    = k;
             sp = src->data[i] + j         * src->linesize[i];
             dp = dst->data[i] + (yp+j)    * dst->linesize[i];
             ap = src->data[3] + (j<<vsub) * src->linesize[3];
 
-            for (jmax = FFMIN(-yp + dst_hp, src_hp); j < jmax; j++) {
+            for (; j < jmax; j++) {
                 k = FFMAX(-xp, 0);
                 d = dp + xp+k;
                 s = sp + k;
                 a = ap + (k<<hsub);
+                kmax = FFMIN(-xp + dst_wp, src_wp);
+
+                if (!main_has_alpha) {
+                    int kfast = k;
+
+                    if (!hsub && !vsub)
+                        kfast = kmax;
+                    else if (hsub && vsub && j+1 < src_hp)
+                        kfast = FFMIN(kmax, src_wp - 1);
+
+                    if (kfast > k) {
+                        if (hsub)
+                            dsp->blend_row_420(d, s, a, src->linesize[3], kfast - k);
+                        else
+                            dsp->blend_row(d, s, a, kfast - k);
+                        d += kfast - k;
+                        s += kfast - k;
+                        a += (kfast - k) << hsub;
+                        k  = kfast;
+                    }
+                }
 
-                for (kmax = FFMIN(-xp + dst_wp, src_wp); k < kmax; k++) {
+                for (; k < kmax; k++) {
                     int alpha_v, alpha_h, alpha;
 
                     // average alpha for color components, improve quality
@@ -583,6 +688,33 @@ static void blend_image(AVFilterContext *ctx,
             }
         }
     }
+    return 0;
+}
+
+/**
+ * Blend image in src to destination buffer dst at position (x, y).
+ */
+static void blend_image(AVFilterContext *ctx,
+                        AVFrame *dst, const AVFrame *src,
+                        int x, int y)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData td = { .dst = dst, .src = src, .x = x, .y = y };
+    int nb_jobs;
+
+    if (x >= dst->width  || x+src->width  < 0 ||
+        y >= dst->height || y+src->height < 0)
+        return; /* no intersection */
+
+    /* The chroma planes of a main with alpha read the main pixels of the
+     * next row while blending the current one, so slices would race. */
+    if (!s->main_is_packed_rgb && s->main_has_alpha)
+        nb_jobs = 1;
+    else
+        nb_jobs = av_clip(FFMIN(y + src->height, dst->height) - FFMAX(y, 0),
+                          1, ctx->graph->nb_threads);
+
+    ctx->internal->execute(ctx, blend_slice, &td, NULL, nb_jobs);
 }
 
 static AVFrame *do_blend(AVFilterContext *ctx, AVFrame *mainpic,
@@ -647,6 +779,7 @@ static av_cold int init(AVFilterContext *ctx)
     }
 
     s->dinput.process = do_blend;
+    ff_overlay_init_dsp(&s->dsp);
     return 0;
 }
 
@@ -716,5 +849,6 @@ AVFilter ff_vf_overlay = {
     .process_command = process_command,
     .inputs        = avfilter_vf_overlay_inputs,
     .outputs       = avfilter_vf_overlay_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,66 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_H
+#define AVFILTER_OVERLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// divide by 255 and round to nearest
+// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
+#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+
+// calculate the unpremultiplied alpha, applying the general equation:
+// alpha = alpha_overlay / ( (alpha_main + alpha_overlay) - (alpha_main * alpha_overlay) )
+// (((x) << 16) - ((x) << 9) + (x)) is a faster version of: 255 * 255 * x
+// ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
+#define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
+
+typedef struct OverlayDSPContext {
+    /**
+     * Blend w overlay samples onto dst, with one alpha value per sample.
+     */
+    void (*blend_row)(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int w);
+
+    /**
+     * Blend w overlay chroma samples onto dst, with the alpha of each sample
+     * averaged over the 2x2 block at alpha and alpha + alpha_linesize.
+     */
+    void (*blend_row_420)(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                          ptrdiff_t alpha_linesize, int w);
+
+    /**
+     * Blend w packed 4-byte overlay pixels onto packed 4-byte main pixels
+     * that have an alpha channel. dst_map and src_map give the byte offsets
+     * of R, G, B and A within a pixel.
+     */
+    void (*blend_row_rgba)(uint8_t *dst, const uint8_t *src, int w,
+                           const uint8_t *dst_map, const uint8_t *src_map);
+} OverlayDSPContext;
+
+void ff_overlay_blend_row_c(uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int w);
+void ff_overlay_blend_row_420_c(uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                                ptrdiff_t alpha_linesize, int w);
+void ff_overlay_blend_row_rgba_c(uint8_t *dst, const uint8_t *src, int w,
+                                 const uint8_t *dst_map, const uint8_t *src_map);
+
+void ff_overlay_init_dsp(OverlayDSPContext *dsp);
+void ff_overlay_init_x86(OverlayDSPContext *dsp);
+
+#endif /* AVFILTER_OVERLAY_H */
@@ -29,6 +29,8 @@
 #include "libavutil/qsort.h"
 #include "dualinput.h"
 #include "avfilter.h"
+#include "internal.h"
+#include "vf_paletteuse.h"
 
 enum dithering_mode {
     DITHERING_NONE,
@@ -75,15 +77,21 @@ struct cache_node {
 
 struct PaletteUseContext;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
+typedef int (*set_frame_func)(struct PaletteUseContext *s, struct cache_node *cache,
+                              AVFrame *out, AVFrame *in,
                               int x_start, int y_start, int width, int height);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFDualInputContext dinput;
-    struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    struct cache_node *cache;               /* lookup cache of each job, CACHE_SIZE entries each */
+    int nb_threads;
+    int *job_ret;
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
     uint32_t palette[AVPALETTE_COUNT];
+    PaletteTable table;                     /* palette for the scan of dsp.nearest_color */
+    PaletteUseDSPContext dsp;
+    int use_table;
     int palette_loaded;
     int dither;
     set_frame_func set_frame;
@@ -313,16 +321,63 @@ end:
     search == COLOR_SEARCH_NNS_RECURSIVE ? colormap_nearest_recursive(root, target) :      \
                                            colormap_nearest_bruteforce(palette, target)
 
+int ff_paletteuse_nearest_color_c(const PaletteTable *t, uint32_t color)
+{
+    const int r = color >> 16 & 0xff;
+    const int g = color >>  8 & 0xff;
+    const int b = color       & 0xff;
+    int i, min_lo = INT_MAX, min_hi = INT_MAX;
+
+    /* the lowest and highest index of the entries at the smallest distance
+     * are the low byte of the smallest of these keys and of their bitwise
+     * complement, a single entry is at that distance if they are the same */
+    for (i = 0; i < AVPALETTE_COUNT; i++) {
+        const int dr = t->rg[2*i    ] - r;
+        const int dg = t->rg[2*i + 1] - g;
+        const int db = t->b [2*i    ] - b;
+        const int key = (dr*dr + dg*dg + db*db) << 8 | t->id[i];
+
+        min_lo = FFMIN(min_lo, key);
+        min_hi = FFMIN(min_hi, key ^ 0xff);
+    }
+    if (min_lo >= PALETTE_TABLE_SKIP || (min_lo & 0xff) != (~min_hi & 0xff))
+        return -1;
+    return min_lo & 0xff;
+}
+
+av_cold void ff_paletteuse_init_dsp(PaletteUseDSPContext *dsp)
+{
+    dsp->nearest_color = ff_paletteuse_nearest_color_c;
+
+    if (ARCH_X86)
+        ff_paletteuse_init_x86(dsp);
+}
+
+/**
+ * Look for the nearest color with a scan of the whole palette if that is
+ * faster than the search method, which is only needed when the scan finds
+ * several colors at the same distance.
+ */
+static av_always_inline uint8_t colormap_nearest(const PaletteUseContext *s, const uint8_t *rgb,
+                                                 const enum color_search_method search_method)
+{
+    if (s->use_table) {
+        const int pal_id = s->dsp.nearest_color(&s->table, rgb[0]<<16 | rgb[1]<<8 | rgb[2]);
+        if (pal_id >= 0)
+            return pal_id;
+    }
+    return COLORMAP_NEAREST(search_method, s->palette, s->map, rgb);
+}
+
 /**
  * Check if the requested color is in the cache already. If not, find it in the
  * color tree and cache it.
  * Note: r, g, and b are the component of c but are passed as well to avoid
  * recomputing them (they are generally computed by the caller for other uses).
  */
-static av_always_inline int color_get(struct cache_node *cache, uint32_t color,
+static av_always_inline int color_get(const PaletteUseContext *s,
+                                      struct cache_node *cache, uint32_t color,
                                       uint8_t r, uint8_t g, uint8_t b,
-                                      const struct color_node *map,
-                                      const uint32_t *palette,
                                       const enum color_search_method search_method)
 {
     int i;
@@ -345,36 +400,33 @@ static av_always_inline int color_get(struct cache_node *cache, uint32_t color,
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->pal_entry = COLORMAP_NEAREST(search_method, palette, map, rgb);
+    e->pal_entry = colormap_nearest(s, rgb, search_method);
     return e->pal_entry;
 }
 
-static av_always_inline int get_dst_color_err(struct cache_node *cache,
-                                              uint32_t c, const struct color_node *map,
-                                              const uint32_t *palette,
+static av_always_inline int get_dst_color_err(const PaletteUseContext *s,
+                                              struct cache_node *cache, uint32_t c,
                                               int *er, int *eg, int *eb,
                                               const enum color_search_method search_method)
 {
     const uint8_t r = c >> 16 & 0xff;
     const uint8_t g = c >>  8 & 0xff;
     const uint8_t b = c       & 0xff;
-    const int dstx = color_get(cache, c, r, g, b, map, palette, search_method);
-    const uint32_t dstc = palette[dstx];
+    const int dstx = color_get(s, cache, c, r, g, b, search_method);
+    const uint32_t dstc = s->palette[dstx];
     *er = r - (dstc >> 16 & 0xff);
     *eg = g - (dstc >>  8 & 0xff);
     *eb = b - (dstc       & 0xff);
     return dstx;
 }
 
-static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
+static av_always_inline int set_frame(PaletteUseContext *s, struct cache_node *cache,
+                                      AVFrame *out, AVFrame *in,
                                       int x_start, int y_start, int w, int h,
                                       enum dithering_mode dither,
                                       const enum color_search_method search_method)
 {
     int x, y;
-    const struct color_node *map = s->map;
-    struct cache_node *cache = s->cache;
-    const uint32_t *palette = s->palette;
     const int src_linesize = in ->linesize[0] >> 2;
     const int dst_linesize = out->linesize[0];
     uint32_t *src = ((uint32_t *)in ->data[0]) + y_start*src_linesize;
@@ -396,7 +448,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
                 const uint32_t c = r<<16 | g<<8 | b;
-                const int color = color_get(cache, c, r, g, b, map, palette, search_method);
+                const int color = color_get(s, cache, c, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -404,7 +456,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_HECKBERT) {
                 const int right = x < w - 1, down = y < h - 1;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -416,7 +468,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_FLOYD_STEINBERG) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -430,7 +482,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
             } else if (dither == DITHERING_SIERRA2) {
                 const int right  = x < w - 1, down  = y < h - 1, left  = x > x_start;
                 const int right2 = x < w - 2,                    left2 = x > x_start + 1;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -449,7 +501,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
 
             } else if (dither == DITHERING_SIERRA2_4A) {
                 const int right = x < w - 1, down = y < h - 1, left = x > x_start;
-                const int color = get_dst_color_err(cache, src[x], map, palette, &er, &eg, &eb, search_method);
+                const int color = get_dst_color_err(s, cache, src[x], &er, &eg, &eb, search_method);
 
                 if (color < 0)
                     return color;
@@ -463,7 +515,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = src[x] >> 16 & 0xff;
                 const uint8_t g = src[x] >>  8 & 0xff;
                 const uint8_t b = src[x]       & 0xff;
-                const int color = color_get(cache, src[x] & 0xffffff, r, g, b, map, palette, search_method);
+                const int color = color_get(s, cache, src[x] & 0xffffff, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -530,16 +582,17 @@ static int disp_tree(const struct color_node *node, const char *fname)
     return 0;
 }
 
-static int debug_accuracy(const struct color_node *node, const uint32_t *palette,
+static int debug_accuracy(const PaletteUseContext *s,
                           const enum color_search_method search_method)
 {
+    const uint32_t *palette = s->palette;
     int r, g, b, ret = 0;
 
     for (r = 0; r < 256; r++) {
         for (g = 0; g < 256; g++) {
             for (b = 0; b < 256; b++) {
                 const uint8_t rgb[] = {r, g, b};
-                const int r1 = COLORMAP_NEAREST(search_method, palette, node, rgb);
+                const int r1 = colormap_nearest(s, rgb, search_method);
                 const int r2 = colormap_nearest_bruteforce(palette, rgb);
                 if (r1 != r2) {
                     const uint32_t c1 = palette[r1];
@@ -718,6 +771,16 @@ static void load_colormap(PaletteUseContext *s)
         }
     }
 
+    for (i = 0; i < AVPALETTE_COUNT; i++) {
+        const uint32_t c = s->palette[i];
+
+        s->table.rg[2*i    ] = c >> 16 & 0xff;
+        s->table.rg[2*i + 1] = c >>  8 & 0xff;
+        s->table.b [2*i    ] = c       & 0xff;
+        s->table.b [2*i + 1] = 0;
+        s->table.id[i] = color_used[i] ? i | PALETTE_TABLE_SKIP : i;
+    }
+
     box.min[0] = box.min[1] = box.min[2] = 0x00;
     box.max[0] = box.max[1] = box.max[2] = 0xff;
 
@@ -727,7 +790,7 @@ static void load_colormap(PaletteUseContext *s)
         disp_tree(s->map, s->dot_filename);
 
     if (s->debug_accuracy) {
-        if (!debug_accuracy(s->map, s->palette, s->color_search_method))
+        if (!debug_accuracy(s, s->color_search_method))
             av_log(NULL, AV_LOG_INFO, "Accuracy check passed\n");
     }
 }
@@ -851,9 +914,26 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x, y, w, h;
+} ThreadData;
+
+static int set_frame_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteUseContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int slice_start = td->y + (td->h *  jobnr     ) / nb_jobs;
+    const int slice_end   = td->y + (td->h * (jobnr + 1)) / nb_jobs;
+
+    return s->set_frame(s, s->cache + jobnr * CACHE_SIZE, td->out, td->in,
+                        td->x, slice_start, td->w, slice_end - slice_start);
+}
+
 static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
 {
-    int x, y, w, h;
+    int i, x, y, w, h, nb_jobs;
+    ThreadData td;
     AVFilterContext *ctx = inlink->dst;
     PaletteUseContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
@@ -881,9 +961,21 @@ static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    if (s->set_frame(s, out, in, x, y, w, h) < 0) {
-        av_frame_free(&out);
-        return NULL;
+    /* error diffusion carries the error of each pixel to the next rows */
+    nb_jobs = s->dither == DITHERING_NONE || s->dither == DITHERING_BAYER
+            ? FFMIN(h, s->nb_threads) : 1;
+    td.in  = in;
+    td.out = out;
+    td.x = x;
+    td.y = y;
+    td.w = w;
+    td.h = h;
+    ctx->internal->execute(ctx, set_frame_slice, &td, s->job_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++) {
+        if (s->job_ret[i] < 0) {
+            av_frame_free(&out);
+            return NULL;
+        }
     }
     memcpy(out->data[1], s->palette, AVPALETTE_SIZE);
     if (s->calc_mean_err)
@@ -892,6 +984,18 @@ static AVFrame *apply_palette(AVFilterLink *inlink, AVFrame *in)
     return out;
 }
 
+static void free_cache(PaletteUseContext *s)
+{
+    int i;
+
+    if (s->cache) {
+        for (i = 0; i < s->nb_threads * CACHE_SIZE; i++)
+            av_freep(&s->cache[i].entries);
+    }
+    av_freep(&s->cache);
+    av_freep(&s->job_ret);
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     int ret;
@@ -902,6 +1006,14 @@ static int config_output(AVFilterLink *outlink)
     outlink->h = ctx->inputs[0]->h;
 
     outlink->time_base = ctx->inputs[0]->time_base;
+
+    free_cache(s);
+    s->nb_threads = ctx->graph->nb_threads;
+    s->cache   = av_calloc(s->nb_threads, CACHE_SIZE * sizeof(*s->cache));
+    s->job_ret = av_calloc(s->nb_threads, sizeof(*s->job_ret));
+    if (!s->cache || !s->job_ret)
+        return AVERROR(ENOMEM);
+
     if ((ret = ff_dualinput_init(ctx, &s->dinput)) < 0)
         return ret;
     return 0;
@@ -958,10 +1070,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 }
 
 #define DEFINE_SET_FRAME(color_search, name, value)                             \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
+static int set_frame_##name(PaletteUseContext *s, struct cache_node *cache,     \
+                            AVFrame *out, AVFrame *in,                          \
                             int x_start, int y_start, int w, int h)             \
 {                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value, color_search);  \
+    return set_frame(s, cache, out, in, x_start, y_start, w, h,                 \
+                     value, color_search);                                      \
 }
 
 #define DEFINE_SET_FRAME_COLOR_SEARCH(color_search, color_search_macro)                                 \
@@ -1008,6 +1122,10 @@ static av_cold int init(AVFilterContext *ctx)
 
     s->set_frame = set_frame_lut[s->color_search_method][s->dither];
 
+    ff_paletteuse_init_dsp(&s->dsp);
+    /* only a SIMD scan of the palette is faster than the k-d tree */
+    s->use_table = s->dsp.nearest_color != ff_paletteuse_nearest_color_c;
+
     if (s->dither == DITHERING_BAYER) {
         int i;
         const int delta = 1 << (5 - s->bayer_scale); // to avoid too much luma
@@ -1027,12 +1145,10 @@ static int request_frame(AVFilterLink *outlink)
 
 static av_cold void uninit(AVFilterContext *ctx)
 {
-    int i;
     PaletteUseContext *s = ctx->priv;
 
     ff_dualinput_uninit(&s->dinput);
-    for (i = 0; i < CACHE_SIZE; i++)
-        av_freep(&s->cache[i].entries);
+    free_cache(s);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
 }
@@ -1072,4 +1188,5 @@ AVFilter ff_vf_paletteuse = {
     .inputs        = paletteuse_inputs,
     .outputs       = paletteuse_outputs,
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
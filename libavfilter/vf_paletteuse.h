@@ -0,0 +1,54 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_PALETTEUSE_H
+#define AVFILTER_PALETTEUSE_H
+
+#include <stdint.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/pixfmt.h"
+
+/* set in PaletteTable.id for the entries the search must ignore */
+#define PALETTE_TABLE_SKIP 0x7f000000
+
+/**
+ * Palette laid out for a scan of all its entries: entry i has the red and
+ * green components rg[2*i] and rg[2*i+1], the blue component b[2*i] with
+ * b[2*i+1] = 0, and id[i] = i, or i | PALETTE_TABLE_SKIP.
+ */
+typedef struct PaletteTable {
+    DECLARE_ALIGNED(32, int16_t, rg)[AVPALETTE_COUNT * 2];
+    DECLARE_ALIGNED(32, int16_t, b)[AVPALETTE_COUNT * 2];
+    DECLARE_ALIGNED(32, int32_t, id)[AVPALETTE_COUNT];
+} PaletteTable;
+
+typedef struct PaletteUseDSPContext {
+    /**
+     * Return the index of the entry of t nearest to color (0xRRGGBB), or -1
+     * if several entries are at the smallest distance or all are skipped.
+     */
+    int (*nearest_color)(const PaletteTable *t, uint32_t color);
+} PaletteUseDSPContext;
+
+int ff_paletteuse_nearest_color_c(const PaletteTable *t, uint32_t color);
+
+void ff_paletteuse_init_dsp(PaletteUseDSPContext *dsp);
+void ff_paletteuse_init_x86(PaletteUseDSPContext *dsp);
+
+#endif /* AVFILTER_PALETTEUSE_H */
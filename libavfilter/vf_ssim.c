@@ -59,7 +59,10 @@ typedef struct SSIMContext {
     int planewidth[4];
     int planeheight[4];
     int *temp;
+    float *score[4];            ///< ssim of each row of blocks of each plane
     int is_rgb;
+    int max;
+    int nb_threads;
     SSIMDSPContext dsp;
 } SSIMContext;
 
@@ -118,6 +121,42 @@ static void ssim_4x4xn(const uint8_t *main, ptrdiff_t main_stride,
     }
 }
 
+void ff_ssim_4x4_line_16bit_c(const uint8_t *main8, ptrdiff_t main_stride,
+                              const uint8_t *ref8, ptrdiff_t ref_stride,
+                              int (*sums)[4], int width)
+{
+    const uint16_t *main = (const uint16_t *)main8;
+    const uint16_t *ref  = (const uint16_t *)ref8;
+    int x, y, z;
+
+    main_stride >>= 1;
+    ref_stride  >>= 1;
+
+    for (z = 0; z < width; z++) {
+        uint32_t s1 = 0, s2 = 0, ss = 0, s12 = 0;
+
+        for (y = 0; y < 4; y++) {
+            for (x = 0; x < 4; x++) {
+                int a = main[x + y * main_stride];
+                int b = ref[x + y * ref_stride];
+
+                s1  += a;
+                s2  += b;
+                ss  += a*a;
+                ss  += b*b;
+                s12 += a*b;
+            }
+        }
+
+        sums[z][0] = s1;
+        sums[z][1] = s2;
+        sums[z][2] = ss;
+        sums[z][3] = s12;
+        main += 4;
+        ref += 4;
+    }
+}
+
 static float ssim_end1(int s1, int s2, int ss, int s12)
 {
     static const int ssim_c1 = (int)(.01*.01*255*255*64 + .5);
@@ -147,31 +186,94 @@ static float ssim_endn(const int (*sum0)[4], const int (*sum1)[4], int width)
     return ssim;
 }
 
-static float ssim_plane(SSIMDSPContext *dsp,
-                        uint8_t *main, int main_stride,
-                        uint8_t *ref, int ref_stride,
-                        int width, int height, void *temp)
+/* same as ssim_end1() with the constants scaled to max and the sums of
+ * samples of up to 12 bits, whose products need 64 bits */
+static float ssim_end1x(int64_t s1, int64_t s2, int64_t ss, int64_t s12, int max)
+{
+    int64_t ssim_c1 = (int64_t)(.01*.01*max*max*64 + .5);
+    int64_t ssim_c2 = (int64_t)(.03*.03*max*max*64*63 + .5);
+
+    int64_t fs1 = s1;
+    int64_t fs2 = s2;
+    int64_t fss = ss;
+    int64_t fs12 = s12;
+    int64_t vars = fss * 64 - fs1 * fs1 - fs2 * fs2;
+    int64_t covar = fs12 * 64 - fs1 * fs2;
+
+    return (float)(2 * fs1 * fs2 + ssim_c1) * (float)(2 * covar + ssim_c2)
+         / ((float)(fs1 * fs1 + fs2 * fs2 + ssim_c1) * (float)(vars + ssim_c2));
+}
+
+static float ssim_endn_16bit(const int (*sum0)[4], const int (*sum1)[4], int width, int max)
 {
-    int z = 0, y;
     float ssim = 0.0;
-    int (*sum0)[4] = temp;
-    int (*sum1)[4] = sum0 + (width >> 2) + 3;
-
-    width >>= 2;
-    height >>= 2;
-
-    for (y = 1; y < height; y++) {
-        for (; z <= y; z++) {
-            FFSWAP(void*, sum0, sum1);
-            dsp->ssim_4x4_line(&main[4 * z * main_stride], main_stride,
-                               &ref[4 * z * ref_stride], ref_stride,
-                               sum0, width);
-        }
+    int i;
+
+    for (i = 0; i < width; i++)
+        ssim += ssim_end1x((int64_t)sum0[i][0] + sum0[i + 1][0] + sum1[i][0] + sum1[i + 1][0],
+                           (int64_t)sum0[i][1] + sum0[i + 1][1] + sum1[i][1] + sum1[i + 1][1],
+                           (int64_t)sum0[i][2] + sum0[i + 1][2] + sum1[i][2] + sum1[i + 1][2],
+                           (int64_t)sum0[i][3] + sum0[i + 1][3] + sum1[i][3] + sum1[i + 1][3],
+                           max);
+    return ssim;
+}
+
+av_cold void ff_ssim_init_dsp(SSIMDSPContext *dsp, int bpp)
+{
+    dsp->ssim_4x4_line = bpp > 8 ? ff_ssim_4x4_line_16bit_c : ssim_4x4xn;
+    dsp->ssim_end_line = ssim_endn;
+    if (ARCH_X86)
+        ff_ssim_init_x86(dsp, bpp);
+}
+
+typedef struct ThreadData {
+    const uint8_t *main_data[4];
+    const uint8_t *ref_data[4];
+    int main_linesize[4];
+    int ref_linesize[4];
+} ThreadData;
+
+/**
+ * Compute the ssim of the rows of 4x4 blocks of slice jobnr. The two lines
+ * of block sums above each row are recomputed at the start of a slice.
+ */
+static int ssim_plane(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SSIMContext *s = ctx->priv;
+    ThreadData *td = arg;
+    void *temp = s->temp + jobnr * (2 * s->planewidth[0] + 12);
+    int c, y, z;
+
+    for (c = 0; c < s->nb_components; c++) {
+        const uint8_t *main = td->main_data[c];
+        const uint8_t *ref  = td->ref_data[c];
+        const int main_stride = td->main_linesize[c];
+        const int ref_stride  = td->ref_linesize[c];
+        const int width  = s->planewidth[c] >> 2;
+        const int height = s->planeheight[c] >> 2;
+        const int slice_start = 1 + ((height - 1) *  jobnr     ) / nb_jobs;
+        const int slice_end   = 1 + ((height - 1) * (jobnr + 1)) / nb_jobs;
+        int (*sum0)[4] = temp;
+        int (*sum1)[4] = sum0 + width + 3;
+
+        for (z = slice_start - 1, y = slice_start; y < slice_end; y++) {
+            for (; z <= y; z++) {
+                FFSWAP(void*, sum0, sum1);
+                s->dsp.ssim_4x4_line(&main[4 * z * main_stride], main_stride,
+                                     &ref[4 * z * ref_stride], ref_stride,
+                                     sum0, width);
+            }
 
-        ssim += dsp->ssim_end_line((const int (*)[4])sum0, (const int (*)[4])sum1, width - 1);
+            if (s->max > 255)
+                s->score[c][y] = ssim_endn_16bit((const int (*)[4])sum0,
+                                                 (const int (*)[4])sum1, width - 1, s->max);
+            else
+                s->score[c][y] = s->dsp.ssim_end_line((const int (*)[4])sum0,
+                                                      (const int (*)[4])sum1, width - 1);
+        }
     }
 
-    return ssim / ((height - 1) * (width - 1));
+    return 0;
 }
 
 static double ssim_db(double ssim, double weight)
@@ -185,14 +287,29 @@ static AVFrame *do_ssim(AVFilterContext *ctx, AVFrame *main,
     AVDictionary **metadata = avpriv_frame_get_metadatap(main);
     SSIMContext *s = ctx->priv;
     float c[4], ssimv = 0.0;
-    int i;
+    ThreadData td;
+    int i, y;
 
     s->nb_frames++;
 
     for (i = 0; i < s->nb_components; i++) {
-        c[i] = ssim_plane(&s->dsp, main->data[i], main->linesize[i],
-                          ref->data[i], ref->linesize[i],
-                          s->planewidth[i], s->planeheight[i], s->temp);
+        td.main_data[i]     = main->data[i];
+        td.main_linesize[i] = main->linesize[i];
+        td.ref_data[i]      = ref->data[i];
+        td.ref_linesize[i]  = ref->linesize[i];
+    }
+    ctx->internal->execute(ctx, ssim_plane, &td, NULL,
+                           FFMAX(1, FFMIN((s->planeheight[1] >> 2) - 1, s->nb_threads)));
+
+    /* sum the rows in order, so that the result does not depend on threads */
+    for (i = 0; i < s->nb_components; i++) {
+        const int width  = s->planewidth[i] >> 2;
+        const int height = s->planeheight[i] >> 2;
+        float ssim = 0.0;
+
+        for (y = 1; y < height; y++)
+            ssim += s->score[i][y];
+        c[i] = ssim / ((height - 1) * (width - 1));
         ssimv += s->coefs[i] * c[i];
         s->ssim[i] += c[i];
     }
@@ -254,6 +371,9 @@ static int query_formats(AVFilterContext *ctx)
         AV_PIX_FMT_YUVJ411P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P,
         AV_PIX_FMT_YUVJ440P, AV_PIX_FMT_YUVJ444P,
         AV_PIX_FMT_GBRP,
+#define PF(suf) AV_PIX_FMT_YUV420##suf, AV_PIX_FMT_YUV422##suf, AV_PIX_FMT_YUV444##suf, AV_PIX_FMT_GBR##suf
+        PF(P9), PF(P10), PF(P12),
+        AV_PIX_FMT_YUV440P10, AV_PIX_FMT_YUV440P12,
         AV_PIX_FMT_NONE
     };
 
@@ -297,14 +417,23 @@ static int config_input_ref(AVFilterLink *inlink)
     for (i = 0; i < s->nb_components; i++)
         s->coefs[i] = (double) s->planeheight[i] * s->planewidth[i] / sum;
 
-    s->temp = av_malloc((2 * inlink->w + 12) * sizeof(*s->temp));
+    s->nb_threads = ctx->graph->nb_threads;
+    av_freep(&s->temp);
+    s->temp = av_malloc_array(s->nb_threads, (2 * inlink->w + 12) * sizeof(*s->temp));
     if (!s->temp)
         return AVERROR(ENOMEM);
 
-    s->dsp.ssim_4x4_line = ssim_4x4xn;
-    s->dsp.ssim_end_line = ssim_endn;
-    if (ARCH_X86)
-        ff_ssim_init_x86(&s->dsp);
+    av_freep(&s->score[0]);
+    s->score[0] = av_malloc_array(s->planeheight[0] * 2 + s->planeheight[1] * 2,
+                                  sizeof(*s->score[0]));
+    if (!s->score[0])
+        return AVERROR(ENOMEM);
+    for (i = 1; i < 4; i++)
+        s->score[i] = s->score[i - 1] + s->planeheight[i - 1];
+
+    s->max = (1 << desc->comp[0].depth) - 1;
+
+    ff_ssim_init_dsp(&s->dsp, desc->comp[0].depth);
 
     return 0;
 }
@@ -363,6 +492,7 @@ static av_cold void uninit(AVFilterContext *ctx)
         fclose(s->stats_file);
 
     av_freep(&s->temp);
+    av_freep(&s->score[0]);
 }
 
 static const AVFilterPad ssim_inputs[] = {
@@ -399,4 +529,5 @@ AVFilter ff_vf_ssim = {
     .priv_class    = &ssim_class,
     .inputs        = ssim_inputs,
     .outputs       = ssim_outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -48,78 +48,142 @@
 #include "unsharp.h"
 #include "unsharp_opencl.h"
 
-static void apply_unsharp(      uint8_t *dst, int dst_stride,
-                          const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+void ff_unsharp_hsum_c(uint32_t *buf, int len)
 {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
+    int x;
+
+    for (x = len - 1; x > 0; x--)
+        buf[x] += buf[x - 1];
+}
 
+void ff_unsharp_vsum_c(uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                       int nb_stages, int width)
+{
+    uint32_t tmp1, tmp2;
+    int x, z;
+
+    for (x = 0; x < width; x++) {
+        tmp1 = sum[x];
+        for (z = 0; z < nb_stages; z++) {
+            tmp2 = sc[z * stride + x] + tmp1;
+            sc[z * stride + x] = tmp1;
+            tmp1 = tmp2;
+        }
+        sum[x] = tmp1;
+    }
+}
+
+void ff_unsharp_sharpen_c(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                          int width, int amount, int scalebits, uint32_t halfscale)
+{
     int32_t res;
-    int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
+    int x;
+
+    for (x = 0; x < width; x++) {
+        res = (int32_t)src[x] + ((((int32_t)src[x] - (int32_t)((sum[x] + halfscale) >> scalebits)) * amount) >> 16);
+        dst[x] = av_clip_uint8(res);
+    }
+}
+
+/* The matrix is a cascade of 2 * steps_x horizontal and 2 * steps_y vertical
+ * [1 1] sums over edge-clamped input, so that each output row only depends on
+ * the steps_y input rows around it and a slice can start on its own. */
+static void apply_unsharp(UnsharpContext *s,
+                          uint8_t *dst, int dst_stride,
+                          const uint8_t *src, int src_stride,
+                          int width, int height, int slice_start, int slice_end,
+                          UnsharpFilterParam *fp, uint32_t *buf)
+{
     const int amount = fp->amount;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
     const int scalebits = fp->scalebits;
     const int32_t halfscale = fp->halfscale;
+    const int len = width + 2 * steps_x;
+    uint32_t *row = buf;
+    uint32_t *sc  = buf + FFALIGN(len, 8);
+    int x, y, z;
 
     if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
 
-    for (y = 0; y < 2 * steps_y; y++)
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
-
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
-        for (x = -steps_x; x < width + steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
-            }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
-                *dsx = av_clip_uint8(res);
-            }
-        }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
+    memset(sc, 0, sizeof(*sc) * 2 * steps_y * width);
+
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        const uint8_t *src2 = src + av_clip(y, 0, height - 1) * src_stride;
+
+        for (x = 0; x < len; x++)
+            row[x] = src2[av_clip(x - steps_x, 0, width - 1)];
+        for (z = 0; z < 2 * steps_x; z++)
+            s->dsp.hsum(row, len);
+        s->dsp.vsum(row + 2 * steps_x, sc, width, 2 * steps_y, width);
+
+        if (y >= slice_start + steps_y) {
+            if (scalebits < 32)
+                s->dsp.sharpen(dst + (y - steps_y) * dst_stride,
+                               src + (y - steps_y) * src_stride,
+                               row + 2 * steps_x, width, amount, scalebits, halfscale);
+            else
+                ff_unsharp_sharpen_c(dst + (y - steps_y) * dst_stride,
+                                     src + (y - steps_y) * src_stride,
+                                     row + 2 * steps_x, width, amount, scalebits, halfscale);
         }
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *s = ctx->priv;
-    int i, plane_w[3], plane_h[3];
-    UnsharpFilterParam *fp[3];
-    plane_w[0] = inlink->w;
-    plane_w[1] = plane_w[2] = AV_CEIL_RSHIFT(inlink->w, s->hsub);
-    plane_h[0] = inlink->h;
-    plane_h[1] = plane_h[2] = AV_CEIL_RSHIFT(inlink->h, s->vsub);
-    fp[0] = &s->luma;
-    fp[1] = fp[2] = &s->chroma;
+    ThreadData *td = arg;
+    int i;
+
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        const int w = i ? AV_CEIL_RSHIFT(inlink->w, s->hsub) : inlink->w;
+        const int h = i ? AV_CEIL_RSHIFT(inlink->h, s->vsub) : inlink->h;
+        const int slice_start = (h *  jobnr     ) / nb_jobs;
+        const int slice_end   = (h * (jobnr + 1)) / nb_jobs;
+
+        apply_unsharp(s, td->out->data[i], td->out->linesize[i],
+                      td->in->data[i], td->in->linesize[i],
+                      w, h, slice_start, slice_end,
+                      i ? &s->chroma : &s->luma, s->sc + jobnr * s->sc_size);
     }
+
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    UnsharpContext *s = ctx->priv;
+    ThreadData td;
+
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL,
+                           FFMIN(AV_CEIL_RSHIFT(inlink->h, s->vsub), s->nb_threads));
+    return 0;
+}
+
+av_cold void ff_unsharp_init_dsp(UnsharpDSPContext *dsp)
+{
+    dsp->hsum    = ff_unsharp_hsum_c;
+    dsp->vsum    = ff_unsharp_vsum_c;
+    dsp->sharpen = ff_unsharp_sharpen_c;
+
+    if (ARCH_X86)
+        ff_unsharp_init_x86(dsp);
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -142,6 +206,7 @@ static av_cold int init(AVFilterContext *ctx)
     set_filter_param(&s->chroma, s->cmsize_x, s->cmsize_y, s->camount);
 
     s->apply_unsharp = apply_unsharp_c;
+    ff_unsharp_init_dsp(&s->dsp);
     if (!CONFIG_OPENCL && s->opencl) {
         av_log(ctx, AV_LOG_ERROR, "OpenCL support was not enabled in this build, cannot be selected\n");
         return AVERROR(EINVAL);
@@ -171,7 +236,7 @@ static int query_formats(AVFilterContext *ctx)
 
 static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
 {
-    int z;
+    UnsharpContext *s = ctx->priv;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
 
     if  (!(fp->msize_x & fp->msize_y & 1)) {
@@ -184,22 +249,22 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        if (!(fp->sc[z] = av_malloc_array(width + 2 * fp->steps_x,
-                                          sizeof(*(fp->sc[z])))))
-            return AVERROR(ENOMEM);
+    s->sc_size = FFMAX(s->sc_size, FFALIGN(width + 2 * fp->steps_x, 8) +
+                                   2 * fp->steps_y * width);
 
     return 0;
 }
 
 static int config_props(AVFilterLink *link)
 {
-    UnsharpContext *s = link->dst->priv;
+    AVFilterContext *ctx = link->dst;
+    UnsharpContext *s = ctx->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(link->format);
     int ret;
 
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
+    s->sc_size = 0;
 
     ret = init_filter_param(link->dst, &s->luma,   "luma",   link->w);
     if (ret < 0)
@@ -208,15 +273,13 @@ static int config_props(AVFilterLink *link)
     if (ret < 0)
         return ret;
 
-    return 0;
-}
-
-static void free_filter_param(UnsharpFilterParam *fp)
-{
-    int z;
+    s->nb_threads = ctx->graph->nb_threads;
+    av_freep(&s->sc);
+    s->sc = av_malloc_array(s->nb_threads, s->sc_size * sizeof(*s->sc));
+    if (!s->sc)
+        return AVERROR(ENOMEM);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        av_freep(&fp->sc[z]);
+    return 0;
 }
 
 static av_cold void uninit(AVFilterContext *ctx)
@@ -227,8 +290,7 @@ static av_cold void uninit(AVFilterContext *ctx)
         ff_opencl_unsharp_uninit(ctx);
     }
 
-    free_filter_param(&s->luma);
-    free_filter_param(&s->chroma);
+    av_freep(&s->sc);
 }
 
 static int filter_frame(AVFilterLink *link, AVFrame *in)
@@ -310,5 +372,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -28,6 +28,7 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vf_vectorscope.h"
 
 enum VectorscopeMode {
     GRAY,
@@ -66,8 +67,12 @@ typedef struct VectorscopeContext {
     int cs;
     uint8_t *peak_memory;
     uint8_t **peak;
+    uint32_t *counts;           ///< per-job 256x256 hit tables, 8-bit only
+    int nb_threads;
 
-    void (*vectorscope)(struct VectorscopeContext *s,
+    VectorscopeDSPContext dsp;
+
+    void (*vectorscope)(AVFilterContext *ctx,
                         AVFrame *in, AVFrame *out, int pd);
     void (*graticulef)(struct VectorscopeContext *s, AVFrame *out,
                        int X, int Y, int D, int P);
@@ -397,8 +402,9 @@ static void envelope(VectorscopeContext *s, AVFrame *out)
     }
 }
 
-static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int pd)
+static void vectorscope16(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pd)
 {
+    VectorscopeContext *s = ctx->priv;
     const uint16_t * const *src = (const uint16_t * const *)in->data;
     const int slinesizex = in->linesize[s->x] / 2;
     const int slinesizey = in->linesize[s->y] / 2;
@@ -595,28 +601,112 @@ static void vectorscope16(VectorscopeContext *s, AVFrame *in, AVFrame *out, int
     }
 }
 
-static void vectorscope8(VectorscopeContext *s, AVFrame *in, AVFrame *out, int pd)
+void ff_vectorscope_accumulate_c(uint8_t *dst, const uint32_t *counts, int width, int intensity)
+{
+    int x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = FFMIN(dst[x] + FFMIN(counts[x], 255) * intensity, 255);
+}
+
+av_cold void ff_vectorscope_init_dsp(VectorscopeDSPContext *dsp)
 {
+    dsp->accumulate = ff_vectorscope_accumulate_c;
+
+    if (ARCH_X86)
+        ff_vectorscope_init_x86(dsp);
+}
+
+typedef struct ThreadData {
+    AVFrame *in;
+    int pd;
+} ThreadData;
+
+/* Every 8-bit mode only depends on how often (or, for color4, with which
+ * largest z) each of the 256x256 positions is hit, so the jobs count hits
+ * into private tables and the plot is drawn once from their sum. */
+static int vectorscope8_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    VectorscopeContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    const int pd = td->pd;
     const uint8_t * const *src = (const uint8_t * const *)in->data;
     const int slinesizex = in->linesize[s->x];
     const int slinesizey = in->linesize[s->y];
     const int slinesized = in->linesize[pd];
-    const int dlinesize = out->linesize[0];
-    const int intensity = s->intensity;
     const int px = s->x, py = s->y;
-    const int h = s->planeheight[py];
-    const int w = s->planewidth[px];
     const uint8_t *spx = src[px];
     const uint8_t *spy = src[py];
     const uint8_t *spd = src[pd];
     const int hsub = s->hsub;
     const int vsub = s->vsub;
+    const int tmin = s->tmin;
+    const int tmax = s->tmax;
+    uint32_t *counts = s->counts + jobnr * 256 * 256;
+    int i, j;
+
+    memset(counts, 0, 256 * 256 * sizeof(*counts));
+
+    if (s->mode == COLOR4) {
+        const int slice_start = (in->height *  jobnr     ) / nb_jobs;
+        const int slice_end   = (in->height * (jobnr + 1)) / nb_jobs;
+
+        for (i = slice_start; i < slice_end; i++) {
+            const int iwx = (i >> vsub) * slinesizex;
+            const int iwy = (i >> vsub) * slinesizey;
+            const int iwd = i * slinesized;
+            for (j = 0; j < in->width; j++) {
+                const int x = spx[iwx + (j >> hsub)];
+                const int y = spy[iwy + (j >> hsub)];
+                const int z = spd[iwd + j];
+                const int pos = (y << 8) + x;
+
+                if (z < tmin || z > tmax)
+                    continue;
+
+                counts[pos] = FFMAX(z + 1, counts[pos]);
+            }
+        }
+    } else {
+        const int h = s->planeheight[py];
+        const int w = s->planewidth[px];
+        const int slice_start = (h *  jobnr     ) / nb_jobs;
+        const int slice_end   = (h * (jobnr + 1)) / nb_jobs;
+
+        for (i = slice_start; i < slice_end; i++) {
+            const int iwx = i * slinesizex;
+            const int iwy = i * slinesizey;
+            const int iwd = i * slinesized;
+            for (j = 0; j < w; j++) {
+                const int x = spx[iwx + j];
+                const int y = spy[iwy + j];
+                const int z = spd[iwd + j];
+
+                if (z < tmin || z > tmax)
+                    continue;
+
+                counts[(y << 8) + x]++;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void vectorscope8(AVFilterContext *ctx, AVFrame *in, AVFrame *out, int pd)
+{
+    VectorscopeContext *s = ctx->priv;
+    const int dlinesize = out->linesize[0];
+    const int intensity = s->intensity;
+    const int px = s->x, py = s->y;
+    const int nb_jobs = FFMIN(s->mode == COLOR4 ? in->height : s->planeheight[py], s->nb_threads);
     uint8_t **dst = out->data;
     uint8_t *dpx = dst[px];
     uint8_t *dpy = dst[py];
     uint8_t *dpd = dst[pd];
-    const int tmin = s->tmin;
-    const int tmax = s->tmax;
+    uint32_t *counts = s->counts;
+    ThreadData td;
     int i, j, k;
 
     for (k = 0; k < 4 && dst[k]; k++)
@@ -624,128 +714,78 @@ static void vectorscope8(VectorscopeContext *s, AVFrame *in, AVFrame *out, int p
             memset(dst[k] + i * out->linesize[k],
                    (s->mode == COLOR || s->mode == COLOR5) && k == s->pd ? 0 : s->bg_color[k], out->width);
 
+    td.in = in;
+    td.pd = pd;
+    ctx->internal->execute(ctx, vectorscope8_slice, &td, NULL, nb_jobs);
+
+    for (k = 1; k < nb_jobs; k++) {
+        const uint32_t *src = s->counts + k * 256 * 256;
+
+        if (s->mode == COLOR4) {
+            for (i = 0; i < 256 * 256; i++)
+                counts[i] = FFMAX(counts[i], src[i]);
+        } else {
+            for (i = 0; i < 256 * 256; i++)
+                counts[i] += src[i];
+        }
+    }
+
     switch (s->mode) {
     case COLOR5:
     case COLOR:
     case GRAY:
         if (s->is_yuv) {
-            for (i = 0; i < h; i++) {
-                const int iwx = i * slinesizex;
-                const int iwy = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iwx + j];
-                    const int y = spy[iwy + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    dpd[pos] = FFMIN(dpd[pos] + intensity, 255);
-                }
-            }
+            for (i = 0; i < 256; i++)
+                s->dsp.accumulate(dpd + i * dlinesize, counts + (i << 8), 256, intensity);
         } else {
-            for (i = 0; i < h; i++) {
-                const int iwx = i * slinesizex;
-                const int iwy = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iwx + j];
-                    const int y = spy[iwy + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    dst[0][pos] = FFMIN(dst[0][pos] + intensity, 255);
-                    dst[1][pos] = FFMIN(dst[1][pos] + intensity, 255);
-                    dst[2][pos] = FFMIN(dst[2][pos] + intensity, 255);
-                }
+            for (i = 0; i < 256; i++) {
+                s->dsp.accumulate(dst[0] + i * dlinesize, counts + (i << 8), 256, intensity);
+                s->dsp.accumulate(dst[1] + i * dlinesize, counts + (i << 8), 256, intensity);
+                s->dsp.accumulate(dst[2] + i * dlinesize, counts + (i << 8), 256, intensity);
             }
         }
         break;
     case COLOR2:
-        if (s->is_yuv) {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iw1 + j];
-                    const int y = spy[iw2 + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
-
-                    if (z < tmin || z > tmax)
-                        continue;
-
-                    if (!dpd[pos])
-                        dpd[pos] = FFABS(128 - x) + FFABS(128 - y);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
-            }
-        } else {
-            for (i = 0; i < h; i++) {
-                const int iw1 = i * slinesizex;
-                const int iw2 = i * slinesizey;
-                const int iwd = i * slinesized;
-                for (j = 0; j < w; j++) {
-                    const int x = spx[iw1 + j];
-                    const int y = spy[iw2 + j];
-                    const int z = spd[iwd + j];
-                    const int pos = y * dlinesize + x;
+        for (i = 0; i < 256; i++) {
+            for (j = 0; j < 256; j++) {
+                const int pos = i * dlinesize + j;
 
-                    if (z < tmin || z > tmax)
-                        continue;
+                if (!counts[(i << 8) + j])
+                    continue;
 
-                    if (!dpd[pos])
-                        dpd[pos] = FFMIN(x + y, 255);
-                    dpx[pos] = x;
-                    dpy[pos] = y;
-                }
+                if (!dpd[pos])
+                    dpd[pos] = s->is_yuv ? FFABS(128 - j) + FFABS(128 - i) : FFMIN(j + i, 255);
+                dpx[pos] = j;
+                dpy[pos] = i;
             }
         }
         break;
     case COLOR3:
-        for (i = 0; i < h; i++) {
-            const int iw1 = i * slinesizex;
-            const int iw2 = i * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < w; j++) {
-                const int x = spx[iw1 + j];
-                const int y = spy[iw2 + j];
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
+        for (i = 0; i < 256; i++) {
+            s->dsp.accumulate(dpd + i * dlinesize, counts + (i << 8), 256, intensity);
+            for (j = 0; j < 256; j++) {
+                const int pos = i * dlinesize + j;
 
-                if (z < tmin || z > tmax)
+                if (!counts[(i << 8) + j])
                     continue;
 
-                dpd[pos] = FFMIN(255, dpd[pos] + intensity);
-                dpx[pos] = x;
-                dpy[pos] = y;
+                dpx[pos] = j;
+                dpy[pos] = i;
             }
         }
         break;
     case COLOR4:
-        for (i = 0; i < in->height; i++) {
-            const int iwx = (i >> vsub) * slinesizex;
-            const int iwy = (i >> vsub) * slinesizey;
-            const int iwd = i * slinesized;
-            for (j = 0; j < in->width; j++) {
-                const int x = spx[iwx + (j >> hsub)];
-                const int y = spy[iwy + (j >> hsub)];
-                const int z = spd[iwd + j];
-                const int pos = y * dlinesize + x;
+        for (i = 0; i < 256; i++) {
+            for (j = 0; j < 256; j++) {
+                const int pos = i * dlinesize + j;
+                const int z = counts[(i << 8) + j];
 
-                if (z < tmin || z > tmax)
+                if (!z)
                     continue;
 
-                dpd[pos] = FFMAX(z, dpd[pos]);
-                dpx[pos] = x;
-                dpy[pos] = y;
+                dpd[pos] = FFMAX(z - 1, dpd[pos]);
+                dpx[pos] = j;
+                dpy[pos] = i;
             }
         }
         break;
@@ -1230,7 +1270,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
     av_frame_copy_props(out, in);
 
-    s->vectorscope(s, in, out, s->pd);
+    s->vectorscope(ctx, in, out, s->pd);
     s->graticulef(s, out, s->x, s->y, s->pd, s->cs);
 
     for (plane = 0; plane < 4; plane++) {
@@ -1278,6 +1318,15 @@ static int config_input(AVFilterLink *inlink)
     else
         s->vectorscope = vectorscope16;
 
+    s->nb_threads = ctx->graph->nb_threads;
+    av_freep(&s->counts);
+    if (s->size == 256) {
+        s->counts = av_malloc_array(s->nb_threads, 256 * 256 * sizeof(*s->counts));
+        if (!s->counts)
+            return AVERROR(ENOMEM);
+    }
+    ff_vectorscope_init_dsp(&s->dsp);
+
     s->graticulef = none_graticule;
 
     if (s->is_yuv && s->size == 256) {
@@ -1326,6 +1375,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->peak);
     av_freep(&s->peak_memory);
+    av_freep(&s->counts);
 }
 
 static const AVFilterPad inputs[] = {
@@ -1356,4 +1406,5 @@ AVFilter ff_vf_vectorscope = {
     .uninit        = uninit,
     .inputs        = inputs,
     .outputs       = outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,38 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_VECTORSCOPE_H
+#define AVFILTER_VECTORSCOPE_H
+
+#include <stdint.h>
+
+typedef struct VectorscopeDSPContext {
+    /**
+     * Apply counts[x] saturating increments of intensity to dst[x], i.e.
+     * dst[x] = FFMIN(dst[x] + FFMIN(counts[x], 255) * intensity, 255),
+     * with 0 <= intensity <= 255 and counts[x] <= INT_MAX.
+     */
+    void (*accumulate)(uint8_t *dst, const uint32_t *counts, int width, int intensity);
+} VectorscopeDSPContext;
+
+void ff_vectorscope_accumulate_c(uint8_t *dst, const uint32_t *counts, int width, int intensity);
+
+void ff_vectorscope_init_dsp(VectorscopeDSPContext *dsp);
+void ff_vectorscope_init_x86(VectorscopeDSPContext *dsp);
+
+#endif /* AVFILTER_VECTORSCOPE_H */
@@ -90,11 +90,13 @@ typedef struct WaveformContext {
     int            shift_w[4], shift_h[4];
     GraticuleLines *glines;
     int            nb_glines;
+    int            nb_threads;
     void (*waveform)(struct WaveformContext *s,
                      AVFrame *in, AVFrame *out,
                      int component, int intensity,
                      int offset_y, int offset_x,
-                     int column, int mirror);
+                     int column, int mirror,
+                     int jobnr, int nb_jobs);
     void (*graticulef)(struct WaveformContext *s, AVFrame *out);
     const AVPixFmtDescriptor *desc;
 } WaveformContext;
@@ -592,11 +594,24 @@ static void update(uint8_t *target, int max, int intensity)
         *target = 255;
 }
 
+/* number of source row advances the row mode loops make before row y */
+static int row_steps(int y, int shift_h)
+{
+    int i, steps = 0;
+
+    if (!shift_h)
+        return y;
+    for (i = 0; i < y; i++)
+        steps += !!(i & shift_h);
+    return steps;
+}
+
 static av_always_inline void lowpass16(WaveformContext *s,
                                        AVFrame *in, AVFrame *out,
                                        int component, int intensity,
                                        int offset_y, int offset_x,
-                                       int column, int mirror)
+                                       int column, int mirror,
+                                       int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int shift_w = s->shift_w[component];
@@ -613,17 +628,25 @@ static av_always_inline void lowpass16(WaveformContext *s,
     uint16_t * const dst_bottom_line = dst_data + dst_linesize * (s->size - 1);
     uint16_t * const dst_line = (mirror ? dst_bottom_line : dst_data);
     const int step = column ? 1 << shift_w : 1 << shift_h;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
+    const int x0 = column ? slice_start : 0;
+    const int x1 = column ? slice_end   : src_w;
     const uint16_t *p;
     int y;
 
     if (!column && mirror)
         dst_data += s->size;
+    if (!column) {
+        src_data += src_linesize * slice_start;
+        dst_data += dst_linesize * step * slice_start;
+    }
 
-    for (y = 0; y < src_h; y++) {
-        const uint16_t *src_data_end = src_data + src_w;
-        uint16_t *dst = dst_line;
+    for (y = column ? 0 : slice_start; y < (column ? src_h : slice_end); y++) {
+        const uint16_t *src_data_end = src_data + x1;
+        uint16_t *dst = dst_line + x0 * step;
 
-        for (p = src_data; p < src_data_end; p++) {
+        for (p = src_data + x0; p < src_data_end; p++) {
             uint16_t *target;
             int i = 0, v = FFMIN(*p, limit);
 
@@ -647,8 +670,6 @@ static av_always_inline void lowpass16(WaveformContext *s,
         src_data += src_linesize;
         dst_data += dst_linesize * step;
     }
-
-    envelope16(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 #define LOWPASS16_FUNC(name, column, mirror)               \
@@ -656,10 +677,12 @@ static void lowpass16_##name(WaveformContext *s,           \
                              AVFrame *in, AVFrame *out,    \
                              int component, int intensity, \
                              int offset_y, int offset_x,   \
-                             int unused1, int unused2)     \
+                             int unused1, int unused2,     \
+                             int jobnr, int nb_jobs)       \
 {                                                          \
     lowpass16(s, in, out, component, intensity,            \
-              offset_y, offset_x, column, mirror);         \
+              offset_y, offset_x, column, mirror,          \
+              jobnr, nb_jobs);                             \
 }
 
 LOWPASS16_FUNC(column_mirror, 1, 1)
@@ -671,7 +694,8 @@ static av_always_inline void lowpass(WaveformContext *s,
                                      AVFrame *in, AVFrame *out,
                                      int component, int intensity,
                                      int offset_y, int offset_x,
-                                     int column, int mirror)
+                                     int column, int mirror,
+                                     int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int shift_w = s->shift_w[component];
@@ -687,17 +711,25 @@ static av_always_inline void lowpass(WaveformContext *s,
     uint8_t * const dst_bottom_line = dst_data + dst_linesize * (s->size - 1);
     uint8_t * const dst_line = (mirror ? dst_bottom_line : dst_data);
     const int step = column ? 1 << shift_w : 1 << shift_h;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
+    const int x0 = column ? slice_start : 0;
+    const int x1 = column ? slice_end   : src_w;
     const uint8_t *p;
     int y;
 
     if (!column && mirror)
         dst_data += s->size;
+    if (!column) {
+        src_data += src_linesize * slice_start;
+        dst_data += dst_linesize * step * slice_start;
+    }
 
-    for (y = 0; y < src_h; y++) {
-        const uint8_t *src_data_end = src_data + src_w;
-        uint8_t *dst = dst_line;
+    for (y = column ? 0 : slice_start; y < (column ? src_h : slice_end); y++) {
+        const uint8_t *src_data_end = src_data + x1;
+        uint8_t *dst = dst_line + x0 * step;
 
-        for (p = src_data; p < src_data_end; p++) {
+        for (p = src_data + x0; p < src_data_end; p++) {
             uint8_t *target;
             if (column) {
                 target = dst + dst_signed_linesize * *p;
@@ -725,7 +757,7 @@ static av_always_inline void lowpass(WaveformContext *s,
 
         dst = out->data[plane] + offset_y * dst_linesize + offset_x;
         for (y = 0; y < dst_h; y++) {
-            for (x = 0; x < dst_w; x+=step) {
+            for (x = slice_start * step; x < FFMIN(slice_end * step, dst_w); x+=step) {
                 for (z = 1; z < step; z++) {
                     dst[x + z] = dst[x];
                 }
@@ -738,15 +770,13 @@ static av_always_inline void lowpass(WaveformContext *s,
         uint8_t *dst;
         int z;
 
-        dst = out->data[plane] + offset_y * dst_linesize + offset_x;
-        for (y = 0; y < dst_h; y+=step) {
+        dst = out->data[plane] + offset_y * dst_linesize + offset_x + dst_linesize * slice_start * step;
+        for (y = slice_start * step; y < FFMIN(slice_end * step, dst_h); y+=step) {
             for (z = 1; z < step; z++)
                 memcpy(dst + dst_linesize * z, dst, dst_w);
             dst += dst_linesize * step;
         }
     }
-
-    envelope(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 #define LOWPASS_FUNC(name, column, mirror)               \
@@ -754,10 +784,12 @@ static void lowpass_##name(WaveformContext *s,           \
                            AVFrame *in, AVFrame *out,    \
                            int component, int intensity, \
                            int offset_y, int offset_x,   \
-                           int unused1, int unused2)     \
+                           int unused1, int unused2,     \
+                           int jobnr, int nb_jobs)       \
 {                                                        \
     lowpass(s, in, out, component, intensity,            \
-            offset_y, offset_x, column, mirror);         \
+            offset_y, offset_x, column, mirror,          \
+            jobnr, nb_jobs);                             \
 }
 
 LOWPASS_FUNC(column_mirror, 1, 1)
@@ -769,7 +801,8 @@ static av_always_inline void flat16(WaveformContext *s,
                                     AVFrame *in, AVFrame *out,
                                     int component, int intensity,
                                     int offset_y, int offset_x,
-                                    int column, int mirror)
+                                    int column, int mirror,
+                                    int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[ plane + 0 ] / 2;
@@ -788,13 +821,15 @@ static av_always_inline void flat16(WaveformContext *s,
     const int mid = s->max / 2;
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
         const int d0_signed_linesize = d0_linesize * (mirror == 1 ? -1 : 1);
         const int d1_signed_linesize = d1_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint16_t *c0_data = (uint16_t *)in->data[plane + 0];
             const uint16_t *c1_data = (uint16_t *)in->data[(plane + 1) % s->ncomp];
             const uint16_t *c2_data = (uint16_t *)in->data[(plane + 2) % s->ncomp];
@@ -839,7 +874,13 @@ static av_always_inline void flat16(WaveformContext *s,
             d1_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit) + s->max;
                 const int c1 = FFMIN(FFABS(c1_data[x >> c1_shift_w] - mid) + FFABS(c2_data[x >> c2_shift_w] - mid), limit);
@@ -872,16 +913,14 @@ static av_always_inline void flat16(WaveformContext *s,
             d1_data += d1_linesize;
         }
     }
-
-    envelope16(s, out, plane, plane, column ? offset_x : offset_y);
-    envelope16(s, out, plane, (plane + 1) % s->ncomp, column ? offset_x : offset_y);
 }
 
 static av_always_inline void flat(WaveformContext *s,
                                   AVFrame *in, AVFrame *out,
                                   int component, int intensity,
                                   int offset_y, int offset_x,
-                                  int column, int mirror)
+                                  int column, int mirror,
+                                  int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[ plane + 0 ];
@@ -898,13 +937,15 @@ static av_always_inline void flat(WaveformContext *s,
     const int max = 255 - intensity;
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
         const int d0_signed_linesize = d0_linesize * (mirror == 1 ? -1 : 1);
         const int d1_signed_linesize = d1_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint8_t *c0_data = in->data[plane + 0];
             const uint8_t *c1_data = in->data[(plane + 1) % s->ncomp];
             const uint8_t *c2_data = in->data[(plane + 2) % s->ncomp];
@@ -949,7 +990,13 @@ static av_always_inline void flat(WaveformContext *s,
             d1_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 int c0 = c0_data[x >> c0_shift_w] + 256;
                 const int c1 = FFABS(c1_data[x >> c1_shift_w] - 128) + FFABS(c2_data[x >> c2_shift_w] - 128);
@@ -982,16 +1029,14 @@ static av_always_inline void flat(WaveformContext *s,
             d1_data += d1_linesize;
         }
     }
-
-    envelope(s, out, plane, plane, column ? offset_x : offset_y);
-    envelope(s, out, plane, (plane + 1) % s->ncomp, column ? offset_x : offset_y);
 }
 
 static av_always_inline void aflat16(WaveformContext *s,
                                      AVFrame *in, AVFrame *out,
                                      int component, int intensity,
                                      int offset_y, int offset_x,
-                                     int column, int mirror)
+                                     int column, int mirror,
+                                     int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[ plane + 0 ] / 2;
@@ -1011,6 +1056,8 @@ static av_always_inline void aflat16(WaveformContext *s,
     const int mid = s->max / 2;
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
@@ -1018,7 +1065,7 @@ static av_always_inline void aflat16(WaveformContext *s,
         const int d1_signed_linesize = d1_linesize * (mirror == 1 ? -1 : 1);
         const int d2_signed_linesize = d2_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint16_t *c0_data = (uint16_t *)in->data[plane + 0];
             const uint16_t *c1_data = (uint16_t *)in->data[(plane + 1) % s->ncomp];
             const uint16_t *c2_data = (uint16_t *)in->data[(plane + 2) % s->ncomp];
@@ -1072,7 +1119,14 @@ static av_always_inline void aflat16(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit) + mid;
                 const int c1 = FFMIN(c1_data[x >> c1_shift_w], limit) - mid;
@@ -1107,17 +1161,14 @@ static av_always_inline void aflat16(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope16(s, out, plane, (plane + 0) % s->ncomp, column ? offset_x : offset_y);
-    envelope16(s, out, plane, (plane + 1) % s->ncomp, column ? offset_x : offset_y);
-    envelope16(s, out, plane, (plane + 2) % s->ncomp, column ? offset_x : offset_y);
 }
 
 static av_always_inline void aflat(WaveformContext *s,
                                    AVFrame *in, AVFrame *out,
                                    int component, int intensity,
                                    int offset_y, int offset_x,
-                                   int column, int mirror)
+                                   int column, int mirror,
+                                   int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[ plane + 0 ];
@@ -1135,6 +1186,8 @@ static av_always_inline void aflat(WaveformContext *s,
     const int max = 255 - intensity;
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
@@ -1142,7 +1195,7 @@ static av_always_inline void aflat(WaveformContext *s,
         const int d1_signed_linesize = d1_linesize * (mirror == 1 ? -1 : 1);
         const int d2_signed_linesize = d2_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint8_t *c0_data = in->data[plane + 0];
             const uint8_t *c1_data = in->data[(plane + 1) % s->ncomp];
             const uint8_t *c2_data = in->data[(plane + 2) % s->ncomp];
@@ -1196,7 +1249,14 @@ static av_always_inline void aflat(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = c0_data[x >> c0_shift_w] + 128;
                 const int c1 = c1_data[x >> c1_shift_w] - 128;
@@ -1231,17 +1291,14 @@ static av_always_inline void aflat(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope(s, out, plane, (plane + 0) % s->ncomp, column ? offset_x : offset_y);
-    envelope(s, out, plane, (plane + 1) % s->ncomp, column ? offset_x : offset_y);
-    envelope(s, out, plane, (plane + 2) % s->ncomp, column ? offset_x : offset_y);
 }
 
 static av_always_inline void chroma16(WaveformContext *s,
                                       AVFrame *in, AVFrame *out,
                                       int component, int intensity,
                                       int offset_y, int offset_x,
-                                      int column, int mirror)
+                                      int column, int mirror,
+                                      int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[(plane + 1) % s->ncomp] / 2;
@@ -1256,12 +1313,14 @@ static av_always_inline void chroma16(WaveformContext *s,
     const int c1_shift_h = s->shift_h[(component + 2) % s->ncomp];
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
         const int dst_signed_linesize = dst_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint16_t *c0_data = (uint16_t *)in->data[(plane + 1) % s->ncomp];
             const uint16_t *c1_data = (uint16_t *)in->data[(plane + 2) % s->ncomp];
             uint16_t *dst_data = (uint16_t *)out->data[plane] + offset_y * dst_linesize + offset_x;
@@ -1290,7 +1349,12 @@ static av_always_inline void chroma16(WaveformContext *s,
 
         if (mirror)
             dst_data += s->size - 1;
-        for (y = 0; y < src_h; y++) {
+
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        dst_data += dst_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int sum = FFMIN(FFABS(c0_data[x >> c0_shift_w] - mid) + FFABS(c1_data[x >> c1_shift_w] - mid - 1), limit);
                 uint16_t *target;
@@ -1311,15 +1375,14 @@ static av_always_inline void chroma16(WaveformContext *s,
             dst_data += dst_linesize;
         }
     }
-
-    envelope16(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static av_always_inline void chroma(WaveformContext *s,
                                     AVFrame *in, AVFrame *out,
                                     int component, int intensity,
                                     int offset_y, int offset_x,
-                                    int column, int mirror)
+                                    int column, int mirror,
+                                    int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int c0_linesize = in->linesize[(plane + 1) % s->ncomp];
@@ -1332,12 +1395,14 @@ static av_always_inline void chroma(WaveformContext *s,
     const int c1_shift_h = s->shift_h[(component + 2) % s->ncomp];
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
         const int dst_signed_linesize = dst_linesize * (mirror == 1 ? -1 : 1);
 
-        for (x = 0; x < src_w; x++) {
+        for (x = slice_start; x < slice_end; x++) {
             const uint8_t *c0_data = in->data[(plane + 1) % s->ncomp];
             const uint8_t *c1_data = in->data[(plane + 2) % s->ncomp];
             uint8_t *dst_data = out->data[plane] + offset_y * dst_linesize + offset_x;
@@ -1366,7 +1431,12 @@ static av_always_inline void chroma(WaveformContext *s,
 
         if (mirror)
             dst_data += s->size - 1;
-        for (y = 0; y < src_h; y++) {
+
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        dst_data += dst_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int sum = FFABS(c0_data[x >> c0_shift_w] - 128) + FFABS(c1_data[x >> c1_shift_w] - 127);
                 uint8_t *target;
@@ -1387,15 +1457,14 @@ static av_always_inline void chroma(WaveformContext *s,
             dst_data += dst_linesize;
         }
     }
-
-    envelope(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static av_always_inline void color16(WaveformContext *s,
                                      AVFrame *in, AVFrame *out,
                                      int component, int intensity,
                                      int offset_y, int offset_x,
-                                     int column, int mirror)
+                                     int column, int mirror,
+                                     int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int limit = s->max - 1;
@@ -1416,6 +1485,8 @@ static av_always_inline void color16(WaveformContext *s,
     const int c2_shift_h = s->shift_h[(component + 2) % s->ncomp];
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (column) {
@@ -1433,7 +1504,7 @@ static av_always_inline void color16(WaveformContext *s,
         uint16_t * const d2 = (mirror ? d2_bottom_line : d2_data);
 
         for (y = 0; y < src_h; y++) {
-            for (x = 0; x < src_w; x++) {
+            for (x = slice_start; x < slice_end; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit);
                 const int c1 = c1_data[x >> c1_shift_w];
                 const int c2 = c2_data[x >> c2_shift_w];
@@ -1464,7 +1535,14 @@ static av_always_inline void color16(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit);
                 const int c1 = c1_data[x >> c1_shift_w];
@@ -1492,15 +1570,14 @@ static av_always_inline void color16(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope16(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static av_always_inline void color(WaveformContext *s,
                                    AVFrame *in, AVFrame *out,
                                    int component, int intensity,
                                    int offset_y, int offset_x,
-                                   int column, int mirror)
+                                   int column, int mirror,
+                                   int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const uint8_t *c0_data = in->data[plane + 0];
@@ -1520,6 +1597,8 @@ static av_always_inline void color(WaveformContext *s,
     const int c2_shift_h = s->shift_h[(component + 2) % s->ncomp];
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (s->mode) {
@@ -1537,7 +1616,7 @@ static av_always_inline void color(WaveformContext *s,
         uint8_t * const d2 = (mirror ? d2_bottom_line : d2_data);
 
         for (y = 0; y < src_h; y++) {
-            for (x = 0; x < src_w; x++) {
+            for (x = slice_start; x < slice_end; x++) {
                 const int c0 = c0_data[x >> c0_shift_w];
                 const int c1 = c1_data[x >> c1_shift_w];
                 const int c2 = c2_data[x >> c2_shift_w];
@@ -1568,7 +1647,14 @@ static av_always_inline void color(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = c0_data[x >> c0_shift_w];
                 const int c1 = c1_data[x >> c1_shift_w];
@@ -1596,15 +1682,14 @@ static av_always_inline void color(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static av_always_inline void acolor16(WaveformContext *s,
                                       AVFrame *in, AVFrame *out,
                                       int component, int intensity,
                                       int offset_y, int offset_x,
-                                      int column, int mirror)
+                                      int column, int mirror,
+                                      int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const int limit = s->max - 1;
@@ -1626,6 +1711,8 @@ static av_always_inline void acolor16(WaveformContext *s,
     const int c2_shift_h = s->shift_h[(component + 2) % s->ncomp];
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (s->mode) {
@@ -1643,7 +1730,7 @@ static av_always_inline void acolor16(WaveformContext *s,
         uint16_t * const d2 = (mirror ? d2_bottom_line : d2_data);
 
         for (y = 0; y < src_h; y++) {
-            for (x = 0; x < src_w; x++) {
+            for (x = slice_start; x < slice_end; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit);
                 const int c1 = c1_data[x >> c1_shift_w];
                 const int c2 = c2_data[x >> c2_shift_w];
@@ -1674,7 +1761,14 @@ static av_always_inline void acolor16(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = FFMIN(c0_data[x >> c0_shift_w], limit);
                 const int c1 = c1_data[x >> c1_shift_w];
@@ -1702,15 +1796,14 @@ static av_always_inline void acolor16(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope16(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static av_always_inline void acolor(WaveformContext *s,
                                     AVFrame *in, AVFrame *out,
                                     int component, int intensity,
                                     int offset_y, int offset_x,
-                                    int column, int mirror)
+                                    int column, int mirror,
+                                    int jobnr, int nb_jobs)
 {
     const int plane = s->desc->comp[component].plane;
     const uint8_t *c0_data = in->data[plane + 0];
@@ -1731,6 +1824,8 @@ static av_always_inline void acolor(WaveformContext *s,
     const int max = 255 - intensity;
     const int src_h = in->height;
     const int src_w = in->width;
+    const int slice_start = ((column ? src_w : src_h) *  jobnr     ) / nb_jobs;
+    const int slice_end   = ((column ? src_w : src_h) * (jobnr + 1)) / nb_jobs;
     int x, y;
 
     if (s->mode) {
@@ -1748,7 +1843,7 @@ static av_always_inline void acolor(WaveformContext *s,
         uint8_t * const d2 = (mirror ? d2_bottom_line : d2_data);
 
         for (y = 0; y < src_h; y++) {
-            for (x = 0; x < src_w; x++) {
+            for (x = slice_start; x < slice_end; x++) {
                 const int c0 = c0_data[x >> c0_shift_w];
                 const int c1 = c1_data[x >> c1_shift_w];
                 const int c2 = c2_data[x >> c2_shift_w];
@@ -1779,7 +1874,14 @@ static av_always_inline void acolor(WaveformContext *s,
             d2_data += s->size - 1;
         }
 
-        for (y = 0; y < src_h; y++) {
+        c0_data += c0_linesize * row_steps(slice_start, c0_shift_h);
+        c1_data += c1_linesize * row_steps(slice_start, c1_shift_h);
+        c2_data += c2_linesize * row_steps(slice_start, c2_shift_h);
+        d0_data += d0_linesize * slice_start;
+        d1_data += d1_linesize * slice_start;
+        d2_data += d2_linesize * slice_start;
+
+        for (y = slice_start; y < slice_end; y++) {
             for (x = 0; x < src_w; x++) {
                 const int c0 = c0_data[x >> c0_shift_w];
                 const int c1 = c1_data[x >> c1_shift_w];
@@ -1807,8 +1909,6 @@ static av_always_inline void acolor(WaveformContext *s,
             d2_data += d2_linesize;
         }
     }
-
-    envelope(s, out, plane, plane, column ? offset_x : offset_y);
 }
 
 static const uint8_t black_yuva_color[4] = { 0, 127, 127, 255 };
@@ -2445,6 +2545,7 @@ static int config_input(AVFilterLink *inlink)
     s->bits = s->desc->comp[0].depth;
     s->max = 1 << s->bits;
     s->intensity = s->fintensity * (s->max - 1);
+    s->nb_threads = ctx->graph->nb_threads;
 
     s->shift_w[0] = s->shift_w[3] = 0;
     s->shift_h[0] = s->shift_h[3] = 0;
@@ -2717,13 +2818,33 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in;
+    AVFrame *out;
+    int component;
+    int offset_y;
+    int offset_x;
+} ThreadData;
+
+static int waveform_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    WaveformContext *s = ctx->priv;
+    ThreadData *td = arg;
+
+    s->waveform(s, td->in, td->out, td->component, s->intensity,
+                td->offset_y, td->offset_x, s->mode, s->mirror, jobnr, nb_jobs);
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx  = inlink->dst;
     WaveformContext *s    = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
+    const int nb_envelopes = s->filter == AFLAT ? 3 : s->filter == FLAT ? 2 : 1;
     AVFrame *out;
-    int i, j, k;
+    int i, j, k, e;
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
     if (!out) {
@@ -2753,6 +2874,10 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 
     for (k = 0, i = 0; k < s->ncomp; k++) {
         if ((1 << k) & s->pcomp) {
+            const int plane = s->desc->comp[k].plane;
+            const int size = s->mode ? AV_CEIL_RSHIFT(in->width,  s->shift_w[k])
+                                     : AV_CEIL_RSHIFT(in->height, s->shift_h[k]);
+            ThreadData td;
             int offset_y;
             int offset_x;
 
@@ -2763,7 +2888,21 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
                 offset_y = s->mode ? i++ * s->size * !!s->display : 0;
                 offset_x = s->mode ? 0 : i++ * s->size * !!s->display;
             }
-            s->waveform(s, in, out, k, s->intensity, offset_y, offset_x, s->mode, s->mirror);
+
+            td.in        = in;
+            td.out       = out;
+            td.component = k;
+            td.offset_y  = offset_y;
+            td.offset_x  = offset_x;
+            ctx->internal->execute(ctx, waveform_slice, &td, NULL,
+                                   FFMIN(size, s->nb_threads));
+
+            for (e = 0; e < nb_envelopes; e++) {
+                if (s->bits > 8)
+                    envelope16(s, out, plane, (plane + e) % s->ncomp, s->mode ? offset_x : offset_y);
+                else
+                    envelope(s, out, plane, (plane + e) % s->ncomp, s->mode ? offset_x : offset_y);
+            }
         }
     }
     s->graticulef(s, out);
@@ -2807,4 +2946,5 @@ AVFilter ff_vf_waveform = {
     .uninit        = uninit,
     .inputs        = inputs,
     .outputs       = outputs,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,166 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/af_biquads.h"
+
+/* Each lane does the same multiplies and additions, in the same order, as
+ * the scalar code, and there is no FMA, so the output is bit-identical.
+ * Two samples are done per iteration, so the odd last sample of a call is
+ * left to the C version, which sums it in a different order. */
+
+#if HAVE_SSE2_INLINE && ARCH_X86_64
+#define BIQUADS_STEP_SSE2(x, i1, i2, o1, o2)                \
+            "movapd %%"#i2", %%xmm13        \n\t"           \
+            "mulpd  %%xmm2, %%xmm13         \n\t"           \
+            "movapd %%"#i1", %%xmm14        \n\t"           \
+            "mulpd  %%xmm1, %%xmm14         \n\t"           \
+            "addpd  %%xmm14, %%xmm13        \n\t"           \
+            "movupd "x", %%"#i2"            \n\t"           \
+            "movapd %%"#i2", %%xmm14        \n\t"           \
+            "mulpd  %%xmm0, %%xmm14         \n\t"           \
+            "addpd  %%xmm14, %%xmm13        \n\t"           \
+            "movapd %%"#o2", %%xmm14        \n\t"           \
+            "mulpd  %%xmm4, %%xmm14         \n\t"           \
+            "addpd  %%xmm14, %%xmm13        \n\t"           \
+            "movapd %%"#o1", %%xmm14        \n\t"           \
+            "mulpd  %%xmm3, %%xmm14         \n\t"           \
+            "addpd  %%xmm14, %%xmm13        \n\t"           \
+            "movapd %%xmm13, %%"#o2"        \n\t"           \
+            "movupd %%xmm13, "x"            \n\t"
+
+static void biquads_filter_sse2(double *buf, int len, double *state, const double *coeffs)
+{
+    x86_reg size = (len & ~1) * BIQUADS_LANES * sizeof(*buf);
+    x86_reg i = -size;
+
+    if (size) {
+        __asm__ volatile (
+            "movsd    (%[coeffs]), %%xmm0   \n\t"
+            "movsd   8(%[coeffs]), %%xmm1   \n\t"
+            "movsd  16(%[coeffs]), %%xmm2   \n\t"
+            "movsd  24(%[coeffs]), %%xmm3   \n\t"
+            "movsd  32(%[coeffs]), %%xmm4   \n\t"
+            "unpcklpd %%xmm0, %%xmm0        \n\t"
+            "unpcklpd %%xmm1, %%xmm1        \n\t"
+            "unpcklpd %%xmm2, %%xmm2        \n\t"
+            "unpcklpd %%xmm3, %%xmm3        \n\t"
+            "unpcklpd %%xmm4, %%xmm4        \n\t"
+            "movupd    (%[state]), %%xmm5   \n\t"
+            "movupd  16(%[state]), %%xmm9   \n\t"
+            "movupd  32(%[state]), %%xmm6   \n\t"
+            "movupd  48(%[state]), %%xmm10  \n\t"
+            "movupd  64(%[state]), %%xmm7   \n\t"
+            "movupd  80(%[state]), %%xmm11  \n\t"
+            "movupd  96(%[state]), %%xmm8   \n\t"
+            "movupd 112(%[state]), %%xmm12  \n\t"
+            "1:                             \n\t"
+            BIQUADS_STEP_SSE2("  (%[buf],%[i])", xmm5,  xmm6,  xmm7,  xmm8)
+            BIQUADS_STEP_SSE2("16(%[buf],%[i])", xmm9,  xmm10, xmm11, xmm12)
+            BIQUADS_STEP_SSE2("32(%[buf],%[i])", xmm6,  xmm5,  xmm8,  xmm7)
+            BIQUADS_STEP_SSE2("48(%[buf],%[i])", xmm10, xmm9,  xmm12, xmm11)
+            "add $64, %[i]                  \n\t"
+            "jl 1b                          \n\t"
+            "movupd %%xmm5,     (%[state])  \n\t"
+            "movupd %%xmm9,   16(%[state])  \n\t"
+            "movupd %%xmm6,   32(%[state])  \n\t"
+            "movupd %%xmm10,  48(%[state])  \n\t"
+            "movupd %%xmm7,   64(%[state])  \n\t"
+            "movupd %%xmm11,  80(%[state])  \n\t"
+            "movupd %%xmm8,   96(%[state])  \n\t"
+            "movupd %%xmm12, 112(%[state])  \n\t"
+            : [i]"+r"(i)
+            : [buf]"r"((uint8_t *)buf + size), [state]"r"(state), [coeffs]"r"(coeffs)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",
+                           "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",
+                           "xmm12", "xmm13", "xmm14",) "memory"
+        );
+    }
+    if (len & 1)
+        ff_biquads_filter_c(buf + (len & ~1) * BIQUADS_LANES, 1, state, coeffs);
+}
+#endif /* HAVE_SSE2_INLINE && ARCH_X86_64 */
+
+#if HAVE_AVX_INLINE && ARCH_X86_64
+#define BIQUADS_STEP_AVX(x, i1, i2, o1, o2)                         \
+            "vmulpd %%ymm2, %%"#i2", %%ymm9         \n\t"           \
+            "vmulpd %%ymm1, %%"#i1", %%ymm10        \n\t"           \
+            "vaddpd %%ymm10, %%ymm9, %%ymm9         \n\t"           \
+            "vmovupd "x", %%"#i2"                   \n\t"           \
+            "vmulpd %%ymm0, %%"#i2", %%ymm10        \n\t"           \
+            "vaddpd %%ymm10, %%ymm9, %%ymm9         \n\t"           \
+            "vmulpd %%ymm4, %%"#o2", %%ymm10        \n\t"           \
+            "vaddpd %%ymm10, %%ymm9, %%ymm9         \n\t"           \
+            "vmulpd %%ymm3, %%"#o1", %%ymm10        \n\t"           \
+            "vaddpd %%ymm10, %%ymm9, %%"#o2"        \n\t"           \
+            "vmovupd %%"#o2", "x"                   \n\t"
+
+static void biquads_filter_avx(double *buf, int len, double *state, const double *coeffs)
+{
+    x86_reg size = (len & ~1) * BIQUADS_LANES * sizeof(*buf);
+    x86_reg i = -size;
+
+    if (size) {
+        __asm__ volatile (
+            "vbroadcastsd   (%[coeffs]), %%ymm0     \n\t"
+            "vbroadcastsd  8(%[coeffs]), %%ymm1     \n\t"
+            "vbroadcastsd 16(%[coeffs]), %%ymm2     \n\t"
+            "vbroadcastsd 24(%[coeffs]), %%ymm3     \n\t"
+            "vbroadcastsd 32(%[coeffs]), %%ymm4     \n\t"
+            "vmovupd   (%[state]), %%ymm5           \n\t"
+            "vmovupd 32(%[state]), %%ymm6           \n\t"
+            "vmovupd 64(%[state]), %%ymm7           \n\t"
+            "vmovupd 96(%[state]), %%ymm8           \n\t"
+            "1:                                     \n\t"
+            BIQUADS_STEP_AVX("  (%[buf],%[i])", ymm5, ymm6, ymm7, ymm8)
+            BIQUADS_STEP_AVX("32(%[buf],%[i])", ymm6, ymm5, ymm8, ymm7)
+            "add $64, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vmovupd %%ymm5,   (%[state])           \n\t"
+            "vmovupd %%ymm6, 32(%[state])           \n\t"
+            "vmovupd %%ymm7, 64(%[state])           \n\t"
+            "vmovupd %%ymm8, 96(%[state])           \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [buf]"r"((uint8_t *)buf + size), [state]"r"(state), [coeffs]"r"(coeffs)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",
+                           "xmm6", "xmm7", "xmm8", "xmm9", "xmm10",) "memory"
+        );
+    }
+    if (len & 1)
+        ff_biquads_filter_c(buf + (len & ~1) * BIQUADS_LANES, 1, state, coeffs);
+}
+#endif /* HAVE_AVX_INLINE && ARCH_X86_64 */
+
+av_cold void ff_biquads_init_x86(BiquadsDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE && ARCH_X86_64
+    if (INLINE_SSE2(cpu_flags))
+        dsp->filter = biquads_filter_sse2;
+#endif
+#if HAVE_AVX_INLINE && ARCH_X86_64
+    if (INLINE_AVX(cpu_flags))
+        dsp->filter = biquads_filter_avx;
+#endif
+}
@@ -0,0 +1,261 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/f_ebur128.h"
+
+/* Adjacent channels are filtered together, one per double lane, with the
+ * same operations in the same order as the scalar code and without FMA, so
+ * the results are bit-identical.  The RLB-filter numerator (1, -2, 1) is
+ * computed as Y[i] - (Y[i-1] + Y[i-1]) + Y[i-2], which rounds the same way
+ * as the multiplications.  The channels left over go to the C version. */
+
+#if ARCH_X86_64 && (HAVE_SSE2_INLINE || HAVE_AVX_INLINE)
+DECLARE_ALIGNED(32, static const double, ebur128_coeffs)[7][4] = {
+    { PRE_B0, PRE_B0, PRE_B0, PRE_B0 },
+    { PRE_B1, PRE_B1, PRE_B1, PRE_B1 },
+    { PRE_B2, PRE_B2, PRE_B2, PRE_B2 },
+    { PRE_A1, PRE_A1, PRE_A1, PRE_A1 },
+    { PRE_A2, PRE_A2, PRE_A2, PRE_A2 },
+    { RLB_A1, RLB_A1, RLB_A1, RLB_A1 },
+    { RLB_A2, RLB_A2, RLB_A2, RLB_A2 },
+};
+
+/* gather the history of lanes channels in st[k * lanes + lane], and back */
+static av_always_inline void load_state(double *st, const double *state,
+                                        const double *energy, int lanes)
+{
+    int k, lane;
+
+    for (k = 0; k < EBUR128_STATE_SIZE; k++)
+        for (lane = 0; lane < lanes; lane++)
+            st[k * lanes + lane] = state[lane * EBUR128_STATE_SIZE + k];
+    for (lane = 0; lane < lanes; lane++)
+        st[EBUR128_STATE_SIZE * lanes + lane] = energy[lane];
+}
+
+static av_always_inline void store_state(double *state, double *energy,
+                                         const double *st, int lanes)
+{
+    int k, lane;
+
+    for (k = 0; k < EBUR128_STATE_SIZE; k++)
+        for (lane = 0; lane < lanes; lane++)
+            state[lane * EBUR128_STATE_SIZE + k] = st[k * lanes + lane];
+    for (lane = 0; lane < lanes; lane++)
+        energy[lane] = st[EBUR128_STATE_SIZE * lanes + lane];
+}
+#endif
+
+#if HAVE_SSE2_INLINE && ARCH_X86_64
+static void filter_pair_sse2(const double *samples, int len, int stride,
+                             double *state, double *energy)
+{
+    LOCAL_ALIGNED_16(double, st, [(EBUR128_STATE_SIZE + 1) * 2]);
+    x86_reg step = stride * sizeof(*samples);
+    x86_reg i = -len * step;
+
+    load_state(st, state, energy, 2);
+    __asm__ volatile (
+        "movapd    (%[c]), %%xmm0           \n\t"
+        "movapd  32(%[c]), %%xmm1           \n\t"
+        "movapd  64(%[c]), %%xmm2           \n\t"
+        "movapd  96(%[c]), %%xmm3           \n\t"
+        "movapd 128(%[c]), %%xmm4           \n\t"
+        "movapd    (%[st]), %%xmm5          \n\t"
+        "movapd  16(%[st]), %%xmm6          \n\t"
+        "movapd  32(%[st]), %%xmm7          \n\t"
+        "movapd  48(%[st]), %%xmm8          \n\t"
+        "movapd  64(%[st]), %%xmm9          \n\t"
+        "movapd  80(%[st]), %%xmm10         \n\t"
+        "movapd  96(%[st]), %%xmm11         \n\t"
+        "1:                                 \n\t"
+        /* pre-filter, xmm13 = Y[i] */
+        "movupd (%[src],%[i]), %%xmm12      \n\t"
+        "movapd %%xmm12, %%xmm13            \n\t"
+        "mulpd  %%xmm0, %%xmm13             \n\t"
+        "movapd %%xmm5, %%xmm14             \n\t"
+        "mulpd  %%xmm1, %%xmm14             \n\t"
+        "addpd  %%xmm14, %%xmm13            \n\t"
+        "mulpd  %%xmm2, %%xmm6              \n\t"
+        "addpd  %%xmm6, %%xmm13             \n\t"
+        "movapd %%xmm5, %%xmm6              \n\t"
+        "movapd %%xmm12, %%xmm5             \n\t"
+        "movapd %%xmm7, %%xmm14             \n\t"
+        "mulpd  %%xmm3, %%xmm14             \n\t"
+        "subpd  %%xmm14, %%xmm13            \n\t"
+        "movapd %%xmm8, %%xmm14             \n\t"
+        "mulpd  %%xmm4, %%xmm14             \n\t"
+        "subpd  %%xmm14, %%xmm13            \n\t"
+        /* RLB-filter, xmm14 = Z[i] */
+        "movapd %%xmm7, %%xmm12             \n\t"
+        "addpd  %%xmm7, %%xmm12             \n\t"
+        "movapd %%xmm13, %%xmm14            \n\t"
+        "subpd  %%xmm12, %%xmm14            \n\t"
+        "addpd  %%xmm8, %%xmm14             \n\t"
+        "movapd %%xmm7, %%xmm8              \n\t"
+        "movapd %%xmm13, %%xmm7             \n\t"
+        "movapd %%xmm9, %%xmm12             \n\t"
+        "mulpd  160(%[c]), %%xmm12          \n\t"
+        "subpd  %%xmm12, %%xmm14            \n\t"
+        "movapd %%xmm10, %%xmm12            \n\t"
+        "mulpd  192(%[c]), %%xmm12          \n\t"
+        "subpd  %%xmm12, %%xmm14            \n\t"
+        "movapd %%xmm9, %%xmm10             \n\t"
+        "movapd %%xmm14, %%xmm9             \n\t"
+        /* energy */
+        "mulpd  %%xmm14, %%xmm14            \n\t"
+        "addpd  %%xmm14, %%xmm11            \n\t"
+        "add %[step], %[i]                  \n\t"
+        "jl 1b                              \n\t"
+        "movapd %%xmm5,    (%[st])          \n\t"
+        "movapd %%xmm6,  16(%[st])          \n\t"
+        "movapd %%xmm7,  32(%[st])          \n\t"
+        "movapd %%xmm8,  48(%[st])          \n\t"
+        "movapd %%xmm9,  64(%[st])          \n\t"
+        "movapd %%xmm10, 80(%[st])          \n\t"
+        "movapd %%xmm11, 96(%[st])          \n\t"
+        : [i]"+r"(i)
+        : [src]"r"(samples + len * stride), [step]"r"(step),
+          [st]"r"(st), [c]"r"(ebur128_coeffs)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",
+                       "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",
+                       "xmm12", "xmm13", "xmm14",) "memory"
+    );
+    store_state(state, energy, st, 2);
+}
+
+static void ebur128_filter_sse2(const double *samples, int len, int stride, int nb_channels,
+                                double *state, double *energy)
+{
+    int ch = 0;
+
+    if (len > 0) {
+        for (; ch + 1 < nb_channels; ch += 2)
+            filter_pair_sse2(samples + ch, len, stride,
+                             state + ch * EBUR128_STATE_SIZE, energy + ch);
+    }
+    ff_ebur128_filter_c(samples + ch, len, stride, nb_channels - ch,
+                        state + ch * EBUR128_STATE_SIZE, energy + ch);
+}
+#endif /* HAVE_SSE2_INLINE && ARCH_X86_64 */
+
+#if HAVE_AVX_INLINE && ARCH_X86_64
+static void filter_quad_avx(const double *samples, int len, int stride,
+                            double *state, double *energy)
+{
+    LOCAL_ALIGNED_32(double, st, [(EBUR128_STATE_SIZE + 1) * 4]);
+    x86_reg step = stride * sizeof(*samples);
+    x86_reg i = -len * step;
+
+    load_state(st, state, energy, 4);
+    __asm__ volatile (
+        "vmovapd    (%[c]), %%ymm0                  \n\t"
+        "vmovapd  32(%[c]), %%ymm1                  \n\t"
+        "vmovapd  64(%[c]), %%ymm2                  \n\t"
+        "vmovapd  96(%[c]), %%ymm3                  \n\t"
+        "vmovapd 128(%[c]), %%ymm4                  \n\t"
+        "vmovapd    (%[st]), %%ymm5                 \n\t"
+        "vmovapd  32(%[st]), %%ymm6                 \n\t"
+        "vmovapd  64(%[st]), %%ymm7                 \n\t"
+        "vmovapd  96(%[st]), %%ymm8                 \n\t"
+        "vmovapd 128(%[st]), %%ymm9                 \n\t"
+        "vmovapd 160(%[st]), %%ymm10                \n\t"
+        "vmovapd 192(%[st]), %%ymm11                \n\t"
+        "1:                                         \n\t"
+        /* pre-filter, ymm13 = Y[i] */
+        "vmovupd (%[src],%[i]), %%ymm12             \n\t"
+        "vmulpd %%ymm0, %%ymm12, %%ymm13            \n\t"
+        "vmulpd %%ymm1, %%ymm5, %%ymm14             \n\t"
+        "vaddpd %%ymm14, %%ymm13, %%ymm13           \n\t"
+        "vmulpd %%ymm2, %%ymm6, %%ymm14             \n\t"
+        "vaddpd %%ymm14, %%ymm13, %%ymm13           \n\t"
+        "vmovapd %%ymm5, %%ymm6                     \n\t"
+        "vmovapd %%ymm12, %%ymm5                    \n\t"
+        "vmulpd %%ymm3, %%ymm7, %%ymm14             \n\t"
+        "vsubpd %%ymm14, %%ymm13, %%ymm13           \n\t"
+        "vmulpd %%ymm4, %%ymm8, %%ymm14             \n\t"
+        "vsubpd %%ymm14, %%ymm13, %%ymm13           \n\t"
+        /* RLB-filter, ymm14 = Z[i] */
+        "vaddpd %%ymm7, %%ymm7, %%ymm12             \n\t"
+        "vsubpd %%ymm12, %%ymm13, %%ymm14           \n\t"
+        "vaddpd %%ymm8, %%ymm14, %%ymm14            \n\t"
+        "vmovapd %%ymm7, %%ymm8                     \n\t"
+        "vmovapd %%ymm13, %%ymm7                    \n\t"
+        "vmulpd 160(%[c]), %%ymm9, %%ymm12          \n\t"
+        "vsubpd %%ymm12, %%ymm14, %%ymm14           \n\t"
+        "vmulpd 192(%[c]), %%ymm10, %%ymm12         \n\t"
+        "vsubpd %%ymm12, %%ymm14, %%ymm14           \n\t"
+        "vmovapd %%ymm9, %%ymm10                    \n\t"
+        "vmovapd %%ymm14, %%ymm9                    \n\t"
+        /* energy */
+        "vmulpd %%ymm14, %%ymm14, %%ymm14           \n\t"
+        "vaddpd %%ymm14, %%ymm11, %%ymm11           \n\t"
+        "add %[step], %[i]                          \n\t"
+        "jl 1b                                      \n\t"
+        "vmovapd %%ymm5,     (%[st])                \n\t"
+        "vmovapd %%ymm6,   32(%[st])                \n\t"
+        "vmovapd %%ymm7,   64(%[st])                \n\t"
+        "vmovapd %%ymm8,   96(%[st])                \n\t"
+        "vmovapd %%ymm9,  128(%[st])                \n\t"
+        "vmovapd %%ymm10, 160(%[st])                \n\t"
+        "vmovapd %%ymm11, 192(%[st])                \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i)
+        : [src]"r"(samples + len * stride), [step]"r"(step),
+          [st]"r"(st), [c]"r"(ebur128_coeffs)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",
+                       "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",
+                       "xmm12", "xmm13", "xmm14",) "memory"
+    );
+    store_state(state, energy, st, 4);
+}
+
+static void ebur128_filter_avx(const double *samples, int len, int stride, int nb_channels,
+                               double *state, double *energy)
+{
+    int ch = 0;
+
+    if (len > 0) {
+        for (; ch + 3 < nb_channels; ch += 4)
+            filter_quad_avx(samples + ch, len, stride,
+                            state + ch * EBUR128_STATE_SIZE, energy + ch);
+    }
+    ebur128_filter_sse2(samples + ch, len, stride, nb_channels - ch,
+                        state + ch * EBUR128_STATE_SIZE, energy + ch);
+}
+#endif /* HAVE_AVX_INLINE && ARCH_X86_64 */
+
+av_cold void ff_ebur128_init_x86(EBUR128DSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE && ARCH_X86_64
+    if (INLINE_SSE2(cpu_flags))
+        dsp->filter = ebur128_filter_sse2;
+#endif
+#if HAVE_AVX_INLINE && ARCH_X86_64
+    if (INLINE_AVX(cpu_flags))
+        dsp->filter = ebur128_filter_avx;
+#endif
+}
@@ -0,0 +1,220 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_boxblur.h"
+
+/* The sums wrap like the C code, and only the low bits of sums >> 16 are
+ * stored: psrad leaves them sign-extended, so packssdw never saturates. */
+
+#if HAVE_SSE4_INLINE
+static void vblur_row8_sse4(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                            int *sums, int width, int inv)
+{
+    x86_reg len = width & ~7;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[inv], %%xmm7                \n\t"
+            "pshufd $0, %%xmm7, %%xmm7          \n\t"
+            "pcmpeqw %%xmm6, %%xmm6             \n\t"
+            "psrlw $8, %%xmm6                   \n\t"
+            "1:                                 \n\t"
+            "pmovzxbd (%[add],%[i]), %%xmm0     \n\t"
+            "pmovzxbd 4(%[add],%[i]), %%xmm1    \n\t"
+            "pmovzxbd (%[sub],%[i]), %%xmm2     \n\t"
+            "pmovzxbd 4(%[sub],%[i]), %%xmm3    \n\t"
+            "psubd %%xmm2, %%xmm0               \n\t"
+            "psubd %%xmm3, %%xmm1               \n\t"
+            "movdqu (%[sums],%[i],4), %%xmm2    \n\t"
+            "movdqu 16(%[sums],%[i],4), %%xmm3  \n\t"
+            "pmulld %%xmm7, %%xmm0              \n\t"
+            "pmulld %%xmm7, %%xmm1              \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm3, %%xmm1               \n\t"
+            "movdqu %%xmm0, (%[sums],%[i],4)    \n\t"
+            "movdqu %%xmm1, 16(%[sums],%[i],4)  \n\t"
+            "psrad $16, %%xmm0                  \n\t"
+            "psrad $16, %%xmm1                  \n\t"
+            "packssdw %%xmm1, %%xmm0            \n\t"
+            "pand %%xmm6, %%xmm0                \n\t"
+            "packuswb %%xmm0, %%xmm0            \n\t"
+            "movq %%xmm0, (%[dst],%[i])         \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [add]"r"(add + len), [sub]"r"(sub + len),
+              [sums]"r"(sums + len), [inv]"r"(inv)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_boxblur_vblur_row8_c(dst + len, add + len, sub + len, sums + len,
+                            width - len, inv);
+}
+
+static void vblur_row16_sse4(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                             int *sums, int width, int inv)
+{
+    x86_reg len = (width & ~7) * 2;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[inv], %%xmm7                \n\t"
+            "pshufd $0, %%xmm7, %%xmm7          \n\t"
+            "1:                                 \n\t"
+            "pmovzxwd (%[add],%[i]), %%xmm0     \n\t"
+            "pmovzxwd 8(%[add],%[i]), %%xmm1    \n\t"
+            "pmovzxwd (%[sub],%[i]), %%xmm2     \n\t"
+            "pmovzxwd 8(%[sub],%[i]), %%xmm3    \n\t"
+            "psubd %%xmm2, %%xmm0               \n\t"
+            "psubd %%xmm3, %%xmm1               \n\t"
+            "movdqu (%[sums],%[i],2), %%xmm2    \n\t"
+            "movdqu 16(%[sums],%[i],2), %%xmm3  \n\t"
+            "pmulld %%xmm7, %%xmm0              \n\t"
+            "pmulld %%xmm7, %%xmm1              \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm3, %%xmm1               \n\t"
+            "movdqu %%xmm0, (%[sums],%[i],2)    \n\t"
+            "movdqu %%xmm1, 16(%[sums],%[i],2)  \n\t"
+            "psrad $16, %%xmm0                  \n\t"
+            "psrad $16, %%xmm1                  \n\t"
+            "packssdw %%xmm1, %%xmm0            \n\t"
+            "movdqu %%xmm0, (%[dst],%[i])       \n\t"
+            "add $16, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [add]"r"(add + len), [sub]"r"(sub + len),
+              [sums]"r"(sums + len / 2), [inv]"r"(inv)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm7",) "memory"
+        );
+    }
+    ff_boxblur_vblur_row16_c(dst + len, add + len, sub + len, sums + len / 2,
+                             width - len / 2, inv);
+}
+#endif /* HAVE_SSE4_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void vblur_row8_avx2(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                            int *sums, int width, int inv)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[inv], %%xmm7                       \n\t"
+            "vpbroadcastd %%xmm7, %%ymm7                \n\t"
+            "vpcmpeqw %%ymm6, %%ymm6, %%ymm6            \n\t"
+            "vpsrlw $8, %%ymm6, %%ymm6                  \n\t"
+            "1:                                         \n\t"
+            "vpmovzxbd (%[add],%[i]), %%ymm0            \n\t"
+            "vpmovzxbd 8(%[add],%[i]), %%ymm1           \n\t"
+            "vpmovzxbd (%[sub],%[i]), %%ymm2            \n\t"
+            "vpmovzxbd 8(%[sub],%[i]), %%ymm3           \n\t"
+            "vpsubd %%ymm2, %%ymm0, %%ymm0              \n\t"
+            "vpsubd %%ymm3, %%ymm1, %%ymm1              \n\t"
+            "vpmulld %%ymm7, %%ymm0, %%ymm0             \n\t"
+            "vpmulld %%ymm7, %%ymm1, %%ymm1             \n\t"
+            "vpaddd (%[sums],%[i],4), %%ymm0, %%ymm0    \n\t"
+            "vpaddd 32(%[sums],%[i],4), %%ymm1, %%ymm1  \n\t"
+            "vmovdqu %%ymm0, (%[sums],%[i],4)           \n\t"
+            "vmovdqu %%ymm1, 32(%[sums],%[i],4)         \n\t"
+            "vpsrad $16, %%ymm0, %%ymm0                 \n\t"
+            "vpsrad $16, %%ymm1, %%ymm1                 \n\t"
+            "vpackssdw %%ymm1, %%ymm0, %%ymm0           \n\t"
+            "vpermq $0xd8, %%ymm0, %%ymm0               \n\t"
+            "vpand %%ymm6, %%ymm0, %%ymm0               \n\t"
+            "vextracti128 $1, %%ymm0, %%xmm1            \n\t"
+            "vpackuswb %%xmm1, %%xmm0, %%xmm0           \n\t"
+            "vmovdqu %%xmm0, (%[dst],%[i])              \n\t"
+            "add $16, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [add]"r"(add + len), [sub]"r"(sub + len),
+              [sums]"r"(sums + len), [inv]"r"(inv)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_boxblur_vblur_row8_c(dst + len, add + len, sub + len, sums + len,
+                            width - len, inv);
+}
+
+static void vblur_row16_avx2(uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                             int *sums, int width, int inv)
+{
+    x86_reg len = (width & ~15) * 2;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[inv], %%xmm7                       \n\t"
+            "vpbroadcastd %%xmm7, %%ymm7                \n\t"
+            "1:                                         \n\t"
+            "vpmovzxwd (%[add],%[i]), %%ymm0            \n\t"
+            "vpmovzxwd 16(%[add],%[i]), %%ymm1          \n\t"
+            "vpmovzxwd (%[sub],%[i]), %%ymm2            \n\t"
+            "vpmovzxwd 16(%[sub],%[i]), %%ymm3          \n\t"
+            "vpsubd %%ymm2, %%ymm0, %%ymm0              \n\t"
+            "vpsubd %%ymm3, %%ymm1, %%ymm1              \n\t"
+            "vpmulld %%ymm7, %%ymm0, %%ymm0             \n\t"
+            "vpmulld %%ymm7, %%ymm1, %%ymm1             \n\t"
+            "vpaddd (%[sums],%[i],2), %%ymm0, %%ymm0    \n\t"
+            "vpaddd 32(%[sums],%[i],2), %%ymm1, %%ymm1  \n\t"
+            "vmovdqu %%ymm0, (%[sums],%[i],2)           \n\t"
+            "vmovdqu %%ymm1, 32(%[sums],%[i],2)         \n\t"
+            "vpsrad $16, %%ymm0, %%ymm0                 \n\t"
+            "vpsrad $16, %%ymm1, %%ymm1                 \n\t"
+            "vpackssdw %%ymm1, %%ymm0, %%ymm0           \n\t"
+            "vpermq $0xd8, %%ymm0, %%ymm0               \n\t"
+            "vmovdqu %%ymm0, (%[dst],%[i])              \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [add]"r"(add + len), [sub]"r"(sub + len),
+              [sums]"r"(sums + len / 2), [inv]"r"(inv)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm7",) "memory"
+        );
+    }
+    ff_boxblur_vblur_row16_c(dst + len, add + len, sub + len, sums + len / 2,
+                             width - len / 2, inv);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_boxblur_init_x86(BoxBlurDSPContext *dsp, int depth)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE4_INLINE
+    if (INLINE_SSE4(cpu_flags))
+        dsp->vblur_row = depth > 8 ? vblur_row16_sse4 : vblur_row8_sse4;
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        dsp->vblur_row = depth > 8 ? vblur_row16_avx2 : vblur_row8_avx2;
+#endif
+}
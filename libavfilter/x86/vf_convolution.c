@@ -0,0 +1,488 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_convolution.h"
+
+#if ARCH_X86_64 && HAVE_INLINE_ASM
+
+DECLARE_ASM_CONST(32, float, ps_half)[8] = {
+    0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5
+};
+
+/* coefficients as pairs of words for pmaddwd, the last one padded with 0 */
+static void pack_coefs(int32_t *pairs, const int *coef, int nb)
+{
+    int i;
+
+    for (i = 0; i < nb; i += 2)
+        pairs[i >> 1] = (uint16_t)coef[i] | (i + 1 < nb ? coef[i + 1] * (1 << 16) : 0);
+}
+
+/* the taps of filter_row in pairs, the last one repeated */
+static int pack_taps(const uint8_t **p, int32_t *pairs, const int *matrix,
+                     const uint8_t *c[], int nb_taps)
+{
+    int i;
+
+    for (i = 0; i < nb_taps; i++)
+        p[i] = c[i];
+    p[nb_taps] = c[nb_taps - 1];
+    pack_coefs(pairs, matrix, nb_taps);
+
+    return (nb_taps + 1) >> 1;
+}
+
+static void filter_row_tail(uint8_t *dst, int width, float rdiv, float bias,
+                            const int *matrix, const uint8_t *c[], int nb_taps,
+                            int len)
+{
+    const uint8_t *p[25];
+    int i;
+
+    for (i = 0; i < nb_taps; i++)
+        p[i] = c[i] + len;
+    ff_convolution_filter_row_c(dst + len, width - len, rdiv, bias, matrix, p, nb_taps);
+}
+
+static void vfilter_row5_tail(uint8_t *dst, int width, float rdiv, float bias,
+                              const int *coef, const int16_t *c[], int len)
+{
+    const int16_t *p[5];
+    int i;
+
+    for (i = 0; i < 5; i++)
+        p[i] = c[i] + len;
+    ff_convolution_vfilter_row5_c(dst + len, width - len, rdiv, bias, coef, p);
+}
+
+/* (int)(sum * rdiv + bias + 0.5f) of the dwords in xmm0 and xmm1,
+ * with rdiv in xmm6 and bias in xmm7, packed to bytes in xmm0 */
+#define ROUND_PACK_SSE2                     \
+    "cvtdq2ps %%xmm0, %%xmm0    \n\t"       \
+    "cvtdq2ps %%xmm1, %%xmm1    \n\t"       \
+    "mulps %%xmm6, %%xmm0       \n\t"       \
+    "mulps %%xmm6, %%xmm1       \n\t"       \
+    "addps %%xmm7, %%xmm0       \n\t"       \
+    "addps %%xmm7, %%xmm1       \n\t"       \
+    "addps %[half], %%xmm0      \n\t"       \
+    "addps %[half], %%xmm1      \n\t"       \
+    "cvttps2dq %%xmm0, %%xmm0   \n\t"       \
+    "cvttps2dq %%xmm1, %%xmm1   \n\t"       \
+    "packssdw %%xmm1, %%xmm0    \n\t"       \
+    "packuswb %%xmm0, %%xmm0    \n\t"
+
+#define LOAD_ROUNDING_SSE2                  \
+    "movss %[rdiv], %%xmm6      \n\t"       \
+    "movss %[bias], %%xmm7      \n\t"       \
+    "shufps $0, %%xmm6, %%xmm6  \n\t"       \
+    "shufps $0, %%xmm7, %%xmm7  \n\t"
+
+/* the same on 16 pixels in ymm registers */
+#define ROUND_PACK_AVX2                             \
+    "vcvtdq2ps %%ymm0, %%ymm0               \n\t"   \
+    "vcvtdq2ps %%ymm1, %%ymm1               \n\t"   \
+    "vmulps %%ymm6, %%ymm0, %%ymm0          \n\t"   \
+    "vmulps %%ymm6, %%ymm1, %%ymm1          \n\t"   \
+    "vaddps %%ymm7, %%ymm0, %%ymm0          \n\t"   \
+    "vaddps %%ymm7, %%ymm1, %%ymm1          \n\t"   \
+    "vaddps %[half], %%ymm0, %%ymm0         \n\t"   \
+    "vaddps %[half], %%ymm1, %%ymm1         \n\t"   \
+    "vcvttps2dq %%ymm0, %%ymm0              \n\t"   \
+    "vcvttps2dq %%ymm1, %%ymm1              \n\t"   \
+    "vpackssdw %%ymm1, %%ymm0, %%ymm0       \n\t"   \
+    "vpackuswb %%ymm0, %%ymm0, %%ymm0       \n\t"   \
+    "vpermq $0x08, %%ymm0, %%ymm0           \n\t"
+
+#define LOAD_ROUNDING_AVX2                          \
+    "vbroadcastss %[rdiv], %%ymm6           \n\t"   \
+    "vbroadcastss %[bias], %%ymm7           \n\t"
+
+#if HAVE_SSE2_INLINE
+static void filter_row_sse2(uint8_t *dst, int width, float rdiv, float bias,
+                            const int *matrix, const uint8_t *c[], int nb_taps)
+{
+    const uint8_t *p[26];
+    int32_t pairs[13];
+    x86_reg len = width & ~7;
+    x86_reg x = 0;
+    x86_reg n = pack_taps(p, pairs, matrix, c, nb_taps);
+    x86_reg pp, pc, k, a, b;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_ROUNDING_SSE2
+            "pxor %%xmm8, %%xmm8                \n\t"
+            "1:                                 \n\t"
+            "pxor %%xmm0, %%xmm0                \n\t"
+            "pxor %%xmm1, %%xmm1                \n\t"
+            "mov %[p], %[pp]                    \n\t"
+            "mov %[pairs], %[pc]                \n\t"
+            "mov %[n], %[k]                     \n\t"
+            "2:                                 \n\t"
+            "mov (%[pp]), %[a]                  \n\t"
+            "mov 8(%[pp]), %[b]                 \n\t"
+            "movq (%[a],%[x]), %%xmm2           \n\t"
+            "movq (%[b],%[x]), %%xmm3           \n\t"
+            "movd (%[pc]), %%xmm4               \n\t"
+            "punpcklbw %%xmm8, %%xmm2           \n\t"
+            "punpcklbw %%xmm8, %%xmm3           \n\t"
+            "pshufd $0, %%xmm4, %%xmm4          \n\t"
+            "movdqa %%xmm2, %%xmm5              \n\t"
+            "punpcklwd %%xmm3, %%xmm2           \n\t"
+            "punpckhwd %%xmm3, %%xmm5           \n\t"
+            "pmaddwd %%xmm4, %%xmm2             \n\t"
+            "pmaddwd %%xmm4, %%xmm5             \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm5, %%xmm1               \n\t"
+            "add $16, %[pp]                     \n\t"
+            "add $4, %[pc]                      \n\t"
+            "dec %[k]                           \n\t"
+            "jg 2b                              \n\t"
+            ROUND_PACK_SSE2
+            "movq %%xmm0, (%[dst],%[x])         \n\t"
+            "add $8, %[x]                       \n\t"
+            "cmp %[len], %[x]                   \n\t"
+            "jl 1b                              \n\t"
+            : [x]"+r"(x), [pp]"=&r"(pp), [pc]"=&r"(pc), [k]"=&r"(k),
+              [a]"=&r"(a), [b]"=&r"(b)
+            : [dst]"r"(dst), [p]"r"(p), [pairs]"r"(pairs), [n]"r"(n),
+              [len]"r"(len), [rdiv]"m"(rdiv), [bias]"m"(bias),
+              [half]"m"(*ps_half)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7", "xmm8",) "memory"
+        );
+    }
+    filter_row_tail(dst, width, rdiv, bias, matrix, c, nb_taps, len);
+}
+
+static void hfilter_row5_sse2(int16_t *dst, const uint8_t *src, int width,
+                              const int *coef)
+{
+    int32_t pairs[3];
+    x86_reg len = width & ~7;
+    x86_reg i = -len;
+
+    pack_coefs(pairs, coef, 5);
+
+    if (len) {
+        __asm__ volatile (
+            "pxor %%xmm7, %%xmm7                \n\t"
+            "movd %[p01], %%xmm4                \n\t"
+            "movd %[p23], %%xmm5                \n\t"
+            "movd %[p4], %%xmm6                 \n\t"
+            "pshufd $0, %%xmm4, %%xmm4          \n\t"
+            "pshufd $0, %%xmm5, %%xmm5          \n\t"
+            "pshufd $0, %%xmm6, %%xmm6          \n\t"
+            "1:                                 \n\t"
+            "movq -2(%[src],%[i]), %%xmm0       \n\t"
+            "movq -1(%[src],%[i]), %%xmm2       \n\t"
+            "punpcklbw %%xmm7, %%xmm0           \n\t"
+            "punpcklbw %%xmm7, %%xmm2           \n\t"
+            "movdqa %%xmm0, %%xmm1              \n\t"
+            "punpcklwd %%xmm2, %%xmm0           \n\t"
+            "punpckhwd %%xmm2, %%xmm1           \n\t"
+            "pmaddwd %%xmm4, %%xmm0             \n\t"
+            "pmaddwd %%xmm4, %%xmm1             \n\t"
+            "movq (%[src],%[i]), %%xmm2         \n\t"
+            "punpcklbw %%xmm7, %%xmm2           \n\t"
+            "movq 1(%[src],%[i]), %%xmm3        \n\t"
+            "punpcklbw %%xmm7, %%xmm3           \n\t"
+            "movdqa %%xmm2, %%xmm8              \n\t"
+            "punpcklwd %%xmm3, %%xmm2           \n\t"
+            "punpckhwd %%xmm3, %%xmm8           \n\t"
+            "pmaddwd %%xmm5, %%xmm2             \n\t"
+            "pmaddwd %%xmm5, %%xmm8             \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm8, %%xmm1               \n\t"
+            "movq 2(%[src],%[i]), %%xmm2        \n\t"
+            "punpcklbw %%xmm7, %%xmm2           \n\t"
+            "movdqa %%xmm2, %%xmm8              \n\t"
+            "punpcklwd %%xmm7, %%xmm2           \n\t"
+            "punpckhwd %%xmm7, %%xmm8           \n\t"
+            "pmaddwd %%xmm6, %%xmm2             \n\t"
+            "pmaddwd %%xmm6, %%xmm8             \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm8, %%xmm1               \n\t"
+            "packssdw %%xmm1, %%xmm0            \n\t"
+            "movdqu %%xmm0, (%[dst],%[i],2)     \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src]"r"(src + len),
+              [p01]"m"(pairs[0]), [p23]"m"(pairs[1]), [p4]"m"(pairs[2])
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7", "xmm8",) "memory"
+        );
+    }
+    ff_convolution_hfilter_row5_c(dst + len, src + len, width - len, coef);
+}
+
+static void vfilter_row5_sse2(uint8_t *dst, int width, float rdiv, float bias,
+                              const int *coef, const int16_t *c[])
+{
+    int32_t pairs[3];
+    x86_reg len = width & ~7;
+    x86_reg i = -len;
+
+    pack_coefs(pairs, coef, 5);
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_ROUNDING_SSE2
+            "pxor %%xmm8, %%xmm8                \n\t"
+            "movd %[p01], %%xmm9                \n\t"
+            "movd %[p23], %%xmm10               \n\t"
+            "movd %[p4], %%xmm11                \n\t"
+            "pshufd $0, %%xmm9, %%xmm9          \n\t"
+            "pshufd $0, %%xmm10, %%xmm10        \n\t"
+            "pshufd $0, %%xmm11, %%xmm11        \n\t"
+            "1:                                 \n\t"
+            "movdqu (%[c0],%[i],2), %%xmm0      \n\t"
+            "movdqu (%[c1],%[i],2), %%xmm2      \n\t"
+            "movdqa %%xmm0, %%xmm1              \n\t"
+            "punpcklwd %%xmm2, %%xmm0           \n\t"
+            "punpckhwd %%xmm2, %%xmm1           \n\t"
+            "pmaddwd %%xmm9, %%xmm0             \n\t"
+            "pmaddwd %%xmm9, %%xmm1             \n\t"
+            "movdqu (%[c2],%[i],2), %%xmm2      \n\t"
+            "movdqu (%[c3],%[i],2), %%xmm4      \n\t"
+            "movdqa %%xmm2, %%xmm3              \n\t"
+            "punpcklwd %%xmm4, %%xmm2           \n\t"
+            "punpckhwd %%xmm4, %%xmm3           \n\t"
+            "pmaddwd %%xmm10, %%xmm2            \n\t"
+            "pmaddwd %%xmm10, %%xmm3            \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm3, %%xmm1               \n\t"
+            "movdqu (%[c4],%[i],2), %%xmm2      \n\t"
+            "movdqa %%xmm2, %%xmm3              \n\t"
+            "punpcklwd %%xmm8, %%xmm2           \n\t"
+            "punpckhwd %%xmm8, %%xmm3           \n\t"
+            "pmaddwd %%xmm11, %%xmm2            \n\t"
+            "pmaddwd %%xmm11, %%xmm3            \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm3, %%xmm1               \n\t"
+            ROUND_PACK_SSE2
+            "movq %%xmm0, (%[dst],%[i])         \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len),
+              [c0]"r"(c[0] + len), [c1]"r"(c[1] + len), [c2]"r"(c[2] + len),
+              [c3]"r"(c[3] + len), [c4]"r"(c[4] + len),
+              [p01]"m"(pairs[0]), [p23]"m"(pairs[1]), [p4]"m"(pairs[2]),
+              [rdiv]"m"(rdiv), [bias]"m"(bias), [half]"m"(*ps_half)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+                           "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",) "memory"
+        );
+    }
+    vfilter_row5_tail(dst, width, rdiv, bias, coef, c, len);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void filter_row_avx2(uint8_t *dst, int width, float rdiv, float bias,
+                            const int *matrix, const uint8_t *c[], int nb_taps)
+{
+    const uint8_t *p[26];
+    int32_t pairs[13];
+    x86_reg len = width & ~15;
+    x86_reg x = 0;
+    x86_reg n = pack_taps(p, pairs, matrix, c, nb_taps);
+    x86_reg pp, pc, k, a, b;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_ROUNDING_AVX2
+            "1:                                     \n\t"
+            "vpxor %%ymm0, %%ymm0, %%ymm0           \n\t"
+            "vpxor %%ymm1, %%ymm1, %%ymm1           \n\t"
+            "mov %[p], %[pp]                        \n\t"
+            "mov %[pairs], %[pc]                    \n\t"
+            "mov %[n], %[k]                         \n\t"
+            "2:                                     \n\t"
+            "mov (%[pp]), %[a]                      \n\t"
+            "mov 8(%[pp]), %[b]                     \n\t"
+            "vpmovzxbw (%[a],%[x]), %%ymm2          \n\t"
+            "vpmovzxbw (%[b],%[x]), %%ymm3          \n\t"
+            "vpbroadcastd (%[pc]), %%ymm5           \n\t"
+            "vpunpckhwd %%ymm3, %%ymm2, %%ymm4      \n\t"
+            "vpunpcklwd %%ymm3, %%ymm2, %%ymm2      \n\t"
+            "vpmaddwd %%ymm5, %%ymm2, %%ymm2        \n\t"
+            "vpmaddwd %%ymm5, %%ymm4, %%ymm4        \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0          \n\t"
+            "vpaddd %%ymm4, %%ymm1, %%ymm1          \n\t"
+            "add $16, %[pp]                         \n\t"
+            "add $4, %[pc]                          \n\t"
+            "dec %[k]                               \n\t"
+            "jg 2b                                  \n\t"
+            ROUND_PACK_AVX2
+            "vmovdqu %%xmm0, (%[dst],%[x])          \n\t"
+            "add $16, %[x]                          \n\t"
+            "cmp %[len], %[x]                       \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [x]"+r"(x), [pp]"=&r"(pp), [pc]"=&r"(pc), [k]"=&r"(k),
+              [a]"=&r"(a), [b]"=&r"(b)
+            : [dst]"r"(dst), [p]"r"(p), [pairs]"r"(pairs), [n]"r"(n),
+              [len]"r"(len), [rdiv]"m"(rdiv), [bias]"m"(bias),
+              [half]"m"(*ps_half)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    filter_row_tail(dst, width, rdiv, bias, matrix, c, nb_taps, len);
+}
+
+static void hfilter_row5_avx2(int16_t *dst, const uint8_t *src, int width,
+                              const int *coef)
+{
+    int32_t pairs[3];
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    pack_coefs(pairs, coef, 5);
+
+    if (len) {
+        __asm__ volatile (
+            "vpxor %%ymm7, %%ymm7, %%ymm7           \n\t"
+            "vpbroadcastd %[p01], %%ymm4            \n\t"
+            "vpbroadcastd %[p23], %%ymm5            \n\t"
+            "vpbroadcastd %[p4], %%ymm6             \n\t"
+            "1:                                     \n\t"
+            "vpmovzxbw -2(%[src],%[i]), %%ymm0      \n\t"
+            "vpmovzxbw -1(%[src],%[i]), %%ymm2      \n\t"
+            "vpunpckhwd %%ymm2, %%ymm0, %%ymm1      \n\t"
+            "vpunpcklwd %%ymm2, %%ymm0, %%ymm0      \n\t"
+            "vpmaddwd %%ymm4, %%ymm0, %%ymm0        \n\t"
+            "vpmaddwd %%ymm4, %%ymm1, %%ymm1        \n\t"
+            "vpmovzxbw (%[src],%[i]), %%ymm2        \n\t"
+            "vpmovzxbw 1(%[src],%[i]), %%ymm3       \n\t"
+            "vpunpckhwd %%ymm3, %%ymm2, %%ymm8      \n\t"
+            "vpunpcklwd %%ymm3, %%ymm2, %%ymm2      \n\t"
+            "vpmaddwd %%ymm5, %%ymm2, %%ymm2        \n\t"
+            "vpmaddwd %%ymm5, %%ymm8, %%ymm8        \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0          \n\t"
+            "vpaddd %%ymm8, %%ymm1, %%ymm1          \n\t"
+            "vpmovzxbw 2(%[src],%[i]), %%ymm2       \n\t"
+            "vpunpckhwd %%ymm7, %%ymm2, %%ymm8      \n\t"
+            "vpunpcklwd %%ymm7, %%ymm2, %%ymm2      \n\t"
+            "vpmaddwd %%ymm6, %%ymm2, %%ymm2        \n\t"
+            "vpmaddwd %%ymm6, %%ymm8, %%ymm8        \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0          \n\t"
+            "vpaddd %%ymm8, %%ymm1, %%ymm1          \n\t"
+            "vpackssdw %%ymm1, %%ymm0, %%ymm0       \n\t"
+            "vmovdqu %%ymm0, (%[dst],%[i],2)        \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src]"r"(src + len),
+              [p01]"m"(pairs[0]), [p23]"m"(pairs[1]), [p4]"m"(pairs[2])
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7", "xmm8",) "memory"
+        );
+    }
+    ff_convolution_hfilter_row5_c(dst + len, src + len, width - len, coef);
+}
+
+static void vfilter_row5_avx2(uint8_t *dst, int width, float rdiv, float bias,
+                              const int *coef, const int16_t *c[])
+{
+    int32_t pairs[3];
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    pack_coefs(pairs, coef, 5);
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_ROUNDING_AVX2
+            "vpxor %%ymm8, %%ymm8, %%ymm8           \n\t"
+            "vpbroadcastd %[p01], %%ymm9            \n\t"
+            "vpbroadcastd %[p23], %%ymm10           \n\t"
+            "vpbroadcastd %[p4], %%ymm11            \n\t"
+            "1:                                     \n\t"
+            "vmovdqu (%[c0],%[i],2), %%ymm2         \n\t"
+            "vmovdqu (%[c1],%[i],2), %%ymm3         \n\t"
+            "vpunpckhwd %%ymm3, %%ymm2, %%ymm1      \n\t"
+            "vpunpcklwd %%ymm3, %%ymm2, %%ymm0      \n\t"
+            "vpmaddwd %%ymm9, %%ymm0, %%ymm0        \n\t"
+            "vpmaddwd %%ymm9, %%ymm1, %%ymm1        \n\t"
+            "vmovdqu (%[c2],%[i],2), %%ymm2         \n\t"
+            "vmovdqu (%[c3],%[i],2), %%ymm3         \n\t"
+            "vpunpckhwd %%ymm3, %%ymm2, %%ymm4      \n\t"
+            "vpunpcklwd %%ymm3, %%ymm2, %%ymm2      \n\t"
+            "vpmaddwd %%ymm10, %%ymm2, %%ymm2       \n\t"
+            "vpmaddwd %%ymm10, %%ymm4, %%ymm4       \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0          \n\t"
+            "vpaddd %%ymm4, %%ymm1, %%ymm1          \n\t"
+            "vmovdqu (%[c4],%[i],2), %%ymm2         \n\t"
+            "vpunpckhwd %%ymm8, %%ymm2, %%ymm4      \n\t"
+            "vpunpcklwd %%ymm8, %%ymm2, %%ymm2      \n\t"
+            "vpmaddwd %%ymm11, %%ymm2, %%ymm2       \n\t"
+            "vpmaddwd %%ymm11, %%ymm4, %%ymm4       \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0          \n\t"
+            "vpaddd %%ymm4, %%ymm1, %%ymm1          \n\t"
+            ROUND_PACK_AVX2
+            "vmovdqu %%xmm0, (%[dst],%[i])          \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len),
+              [c0]"r"(c[0] + len), [c1]"r"(c[1] + len), [c2]"r"(c[2] + len),
+              [c3]"r"(c[3] + len), [c4]"r"(c[4] + len),
+              [p01]"m"(pairs[0]), [p23]"m"(pairs[1]), [p4]"m"(pairs[2]),
+              [rdiv]"m"(rdiv), [bias]"m"(bias), [half]"m"(*ps_half)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+                           "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",) "memory"
+        );
+    }
+    vfilter_row5_tail(dst, width, rdiv, bias, coef, c, len);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+#endif /* ARCH_X86_64 && HAVE_INLINE_ASM */
+
+av_cold void ff_convolution_init_x86(ConvolutionDSPContext *dsp)
+{
+#if ARCH_X86_64
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        dsp->filter_row   = filter_row_sse2;
+        dsp->hfilter_row5 = hfilter_row5_sse2;
+        dsp->vfilter_row5 = vfilter_row5_sse2;
+    }
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        dsp->filter_row   = filter_row_avx2;
+        dsp->hfilter_row5 = hfilter_row5_avx2;
+        dsp->vfilter_row5 = vfilter_row5_avx2;
+    }
+#endif
+#endif /* ARCH_X86_64 */
+}
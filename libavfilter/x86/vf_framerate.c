@@ -0,0 +1,303 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_framerate.h"
+
+#if HAVE_SSE2_INLINE
+/* the weighted sum of two 8-bit samples is at most 255 * 256 + 128 and is
+ * computed on unsigned words */
+static void blend_row8_sse2(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                            int width, int factor1, int factor2, int half, int shift)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[f1], %%xmm6                 \n\t"
+            "pshuflw $0, %%xmm6, %%xmm6         \n\t"
+            "punpcklqdq %%xmm6, %%xmm6          \n\t"
+            "movd %[f2], %%xmm5                 \n\t"
+            "pshuflw $0, %%xmm5, %%xmm5         \n\t"
+            "punpcklqdq %%xmm5, %%xmm5          \n\t"
+            "movd %[half], %%xmm4               \n\t"
+            "pshuflw $0, %%xmm4, %%xmm4         \n\t"
+            "punpcklqdq %%xmm4, %%xmm4          \n\t"
+            "movd %[shift], %%xmm3              \n\t"
+            "pxor %%xmm7, %%xmm7                \n\t"
+            "1:                                 \n\t"
+            "movq (%[src1],%[i]), %%xmm0        \n\t"
+            "movq (%[src2],%[i]), %%xmm1        \n\t"
+            "punpcklbw %%xmm7, %%xmm0           \n\t"
+            "punpcklbw %%xmm7, %%xmm1           \n\t"
+            "pmullw %%xmm6, %%xmm0              \n\t"
+            "pmullw %%xmm5, %%xmm1              \n\t"
+            "paddw %%xmm1, %%xmm0               \n\t"
+            "paddw %%xmm4, %%xmm0               \n\t"
+            "psrlw %%xmm3, %%xmm0               \n\t"
+            "movq 8(%[src1],%[i]), %%xmm1       \n\t"
+            "movq 8(%[src2],%[i]), %%xmm2       \n\t"
+            "punpcklbw %%xmm7, %%xmm1           \n\t"
+            "punpcklbw %%xmm7, %%xmm2           \n\t"
+            "pmullw %%xmm6, %%xmm1              \n\t"
+            "pmullw %%xmm5, %%xmm2              \n\t"
+            "paddw %%xmm2, %%xmm1               \n\t"
+            "paddw %%xmm4, %%xmm1               \n\t"
+            "psrlw %%xmm3, %%xmm1               \n\t"
+            "packuswb %%xmm1, %%xmm0            \n\t"
+            "movdqu %%xmm0, (%[dst],%[i])       \n\t"
+            "add $16, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src1]"r"(src1 + len), [src2]"r"(src2 + len),
+              [f1]"r"(factor1), [f2]"r"(factor2), [half]"r"(half), [shift]"r"(shift)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_framerate_blend_row8_c(dst + len, src1 + len, src2 + len, width - len,
+                              factor1, factor2, half, shift);
+}
+
+/* samples of up to 12 bits are interleaved with the sample of the other
+ * source, and weighted with pmaddwd */
+static void blend_row16_sse2(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                             int width, int factor1, int factor2, int half, int shift)
+{
+    x86_reg len = (width & ~7) * 2;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[f12], %%xmm6                \n\t"
+            "pshufd $0, %%xmm6, %%xmm6          \n\t"
+            "movd %[half], %%xmm4               \n\t"
+            "pshufd $0, %%xmm4, %%xmm4          \n\t"
+            "movd %[shift], %%xmm3              \n\t"
+            "1:                                 \n\t"
+            "movdqu (%[src1],%[i]), %%xmm0      \n\t"
+            "movdqu (%[src2],%[i]), %%xmm1      \n\t"
+            "movdqa %%xmm0, %%xmm2              \n\t"
+            "punpcklwd %%xmm1, %%xmm0           \n\t"
+            "punpckhwd %%xmm1, %%xmm2           \n\t"
+            "pmaddwd %%xmm6, %%xmm0             \n\t"
+            "pmaddwd %%xmm6, %%xmm2             \n\t"
+            "paddd %%xmm4, %%xmm0               \n\t"
+            "paddd %%xmm4, %%xmm2               \n\t"
+            "psrld %%xmm3, %%xmm0               \n\t"
+            "psrld %%xmm3, %%xmm2               \n\t"
+            "packssdw %%xmm2, %%xmm0            \n\t"
+            "movdqu %%xmm0, (%[dst],%[i])       \n\t"
+            "add $16, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src1]"r"(src1 + len), [src2]"r"(src2 + len),
+              [f12]"r"(factor1 | factor2 << 16), [half]"r"(half), [shift]"r"(shift)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm6",) "memory"
+        );
+    }
+    ff_framerate_blend_row16_c(dst + len, src1 + len, src2 + len, width - len / 2,
+                               factor1, factor2, half, shift);
+}
+
+static int64_t sad_row16_sse2(const uint16_t *src1, const uint16_t *src2, int width)
+{
+    x86_reg len = width & ~7;
+    x86_reg i = -len * 2;
+    int sum = 0;
+
+    if (len) {
+        __asm__ volatile (
+            "pcmpeqw %%xmm7, %%xmm7             \n\t"
+            "psrlw $15, %%xmm7                  \n\t"
+            "pxor %%xmm5, %%xmm5                \n\t"
+            "1:                                 \n\t"
+            "movdqu (%[src1],%[i]), %%xmm0      \n\t"
+            "movdqu (%[src2],%[i]), %%xmm1      \n\t"
+            "movdqa %%xmm0, %%xmm2              \n\t"
+            "psubusw %%xmm1, %%xmm0             \n\t"
+            "psubusw %%xmm2, %%xmm1             \n\t"
+            "por %%xmm1, %%xmm0                 \n\t"
+            "pmaddwd %%xmm7, %%xmm0             \n\t"
+            "paddd %%xmm0, %%xmm5               \n\t"
+            "add $16, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            "pshufd $0x4e, %%xmm5, %%xmm0       \n\t"
+            "paddd %%xmm0, %%xmm5               \n\t"
+            "pshufd $0xb1, %%xmm5, %%xmm0       \n\t"
+            "paddd %%xmm0, %%xmm5               \n\t"
+            "movd %%xmm5, %[sum]                \n\t"
+            : [i]"+r"(i), [sum]"=r"(sum)
+            : [src1]"r"(src1 + len), [src2]"r"(src2 + len)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm5", "xmm7",) "memory"
+        );
+    }
+    return sum + ff_framerate_sad_row16_c(src1 + len, src2 + len, width - len);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void blend_row8_avx2(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                            int width, int factor1, int factor2, int half, int shift)
+{
+    x86_reg len = width & ~31;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[f1], %%xmm6                        \n\t"
+            "vpbroadcastw %%xmm6, %%ymm6                \n\t"
+            "vmovd %[f2], %%xmm5                        \n\t"
+            "vpbroadcastw %%xmm5, %%ymm5                \n\t"
+            "vmovd %[half], %%xmm4                      \n\t"
+            "vpbroadcastw %%xmm4, %%ymm4                \n\t"
+            "vmovd %[shift], %%xmm3                     \n\t"
+            "1:                                         \n\t"
+            "vpmovzxbw (%[src1],%[i]), %%ymm0           \n\t"
+            "vpmovzxbw (%[src2],%[i]), %%ymm1           \n\t"
+            "vpmullw %%ymm6, %%ymm0, %%ymm0             \n\t"
+            "vpmullw %%ymm5, %%ymm1, %%ymm1             \n\t"
+            "vpaddw %%ymm1, %%ymm0, %%ymm0              \n\t"
+            "vpaddw %%ymm4, %%ymm0, %%ymm0              \n\t"
+            "vpsrlw %%xmm3, %%ymm0, %%ymm0              \n\t"
+            "vpmovzxbw 16(%[src1],%[i]), %%ymm1         \n\t"
+            "vpmovzxbw 16(%[src2],%[i]), %%ymm2         \n\t"
+            "vpmullw %%ymm6, %%ymm1, %%ymm1             \n\t"
+            "vpmullw %%ymm5, %%ymm2, %%ymm2             \n\t"
+            "vpaddw %%ymm2, %%ymm1, %%ymm1              \n\t"
+            "vpaddw %%ymm4, %%ymm1, %%ymm1              \n\t"
+            "vpsrlw %%xmm3, %%ymm1, %%ymm1              \n\t"
+            "vpackuswb %%ymm1, %%ymm0, %%ymm0           \n\t"
+            "vpermq $0xD8, %%ymm0, %%ymm0               \n\t"
+            "vmovdqu %%ymm0, (%[dst],%[i])              \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src1]"r"(src1 + len), [src2]"r"(src2 + len),
+              [f1]"r"(factor1), [f2]"r"(factor2), [half]"r"(half), [shift]"r"(shift)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6",) "memory"
+        );
+    }
+    ff_framerate_blend_row8_c(dst + len, src1 + len, src2 + len, width - len,
+                              factor1, factor2, half, shift);
+}
+
+/* unpacking and packing within each lane keeps the samples in order */
+static void blend_row16_avx2(uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                             int width, int factor1, int factor2, int half, int shift)
+{
+    x86_reg len = (width & ~15) * 2;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[f12], %%xmm6                       \n\t"
+            "vpbroadcastd %%xmm6, %%ymm6                \n\t"
+            "vmovd %[half], %%xmm4                      \n\t"
+            "vpbroadcastd %%xmm4, %%ymm4                \n\t"
+            "vmovd %[shift], %%xmm3                     \n\t"
+            "1:                                         \n\t"
+            "vmovdqu (%[src1],%[i]), %%ymm0             \n\t"
+            "vmovdqu (%[src2],%[i]), %%ymm1             \n\t"
+            "vpunpckhwd %%ymm1, %%ymm0, %%ymm2          \n\t"
+            "vpunpcklwd %%ymm1, %%ymm0, %%ymm0          \n\t"
+            "vpmaddwd %%ymm6, %%ymm0, %%ymm0            \n\t"
+            "vpmaddwd %%ymm6, %%ymm2, %%ymm2            \n\t"
+            "vpaddd %%ymm4, %%ymm0, %%ymm0              \n\t"
+            "vpaddd %%ymm4, %%ymm2, %%ymm2              \n\t"
+            "vpsrld %%xmm3, %%ymm0, %%ymm0              \n\t"
+            "vpsrld %%xmm3, %%ymm2, %%ymm2              \n\t"
+            "vpackssdw %%ymm2, %%ymm0, %%ymm0           \n\t"
+            "vmovdqu %%ymm0, (%[dst],%[i])              \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src1]"r"(src1 + len), [src2]"r"(src2 + len),
+              [f12]"r"(factor1 | factor2 << 16), [half]"r"(half), [shift]"r"(shift)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm6",) "memory"
+        );
+    }
+    ff_framerate_blend_row16_c(dst + len, src1 + len, src2 + len, width - len / 2,
+                               factor1, factor2, half, shift);
+}
+
+static int64_t sad_row16_avx2(const uint16_t *src1, const uint16_t *src2, int width)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len * 2;
+    int sum = 0;
+
+    if (len) {
+        __asm__ volatile (
+            "vpcmpeqw %%ymm7, %%ymm7, %%ymm7            \n\t"
+            "vpsrlw $15, %%ymm7, %%ymm7                 \n\t"
+            "vpxor %%ymm5, %%ymm5, %%ymm5               \n\t"
+            "1:                                         \n\t"
+            "vmovdqu (%[src1],%[i]), %%ymm0             \n\t"
+            "vmovdqu (%[src2],%[i]), %%ymm1             \n\t"
+            "vpsubusw %%ymm1, %%ymm0, %%ymm2            \n\t"
+            "vpsubusw %%ymm0, %%ymm1, %%ymm1            \n\t"
+            "vpor %%ymm1, %%ymm2, %%ymm0                \n\t"
+            "vpmaddwd %%ymm7, %%ymm0, %%ymm0            \n\t"
+            "vpaddd %%ymm0, %%ymm5, %%ymm5              \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vextracti128 $1, %%ymm5, %%xmm0            \n\t"
+            "vpaddd %%xmm0, %%xmm5, %%xmm5              \n\t"
+            "vpshufd $0x4e, %%xmm5, %%xmm0              \n\t"
+            "vpaddd %%xmm0, %%xmm5, %%xmm5              \n\t"
+            "vpshufd $0xb1, %%xmm5, %%xmm0              \n\t"
+            "vpaddd %%xmm0, %%xmm5, %%xmm5              \n\t"
+            "vmovd %%xmm5, %[sum]                       \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i), [sum]"=r"(sum)
+            : [src1]"r"(src1 + len), [src2]"r"(src2 + len)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm5", "xmm7",) "memory"
+        );
+    }
+    return sum + ff_framerate_sad_row16_c(src1 + len, src2 + len, width - len);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_framerate_init_x86(FrameRateDSPContext *dsp, int bitdepth)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags)) {
+        dsp->blend_row = bitdepth == 8 ? blend_row8_sse2 : blend_row16_sse2;
+        dsp->sad_row16 = sad_row16_sse2;
+    }
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        dsp->blend_row = bitdepth == 8 ? blend_row8_avx2 : blend_row16_avx2;
+        dsp->sad_row16 = sad_row16_avx2;
+    }
+#endif
+}
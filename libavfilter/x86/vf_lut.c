@@ -0,0 +1,72 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_lut.h"
+
+#if HAVE_AVX2_INLINE
+/* each gather loads the dword at tab + 2 * src[i], the high word of which
+ * belongs to the next entry and is cleared before packing */
+static void lut_row16_avx2(uint16_t *dst, const uint16_t *src,
+                           const uint16_t *tab, int w)
+{
+    x86_reg len = w & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vpxor %%ymm7, %%ymm7, %%ymm7           \n\t"
+            "vpcmpeqd %%ymm6, %%ymm6, %%ymm6        \n\t"
+            "1:                                     \n\t"
+            "vpmovzxwd (%[src],%[i],2), %%ymm0      \n\t"
+            "vpmovzxwd 16(%[src],%[i],2), %%ymm1    \n\t"
+            "vmovdqa %%ymm6, %%ymm4                 \n\t"
+            "vmovdqa %%ymm6, %%ymm5                 \n\t"
+            "vpgatherdd %%ymm4, (%[tab],%%ymm0,2), %%ymm2 \n\t"
+            "vpgatherdd %%ymm5, (%[tab],%%ymm1,2), %%ymm3 \n\t"
+            "vpblendw $0xAA, %%ymm7, %%ymm2, %%ymm2 \n\t"
+            "vpblendw $0xAA, %%ymm7, %%ymm3, %%ymm3 \n\t"
+            "vpackusdw %%ymm3, %%ymm2, %%ymm2       \n\t"
+            "vpermq $0xD8, %%ymm2, %%ymm2           \n\t"
+            "vmovdqu %%ymm2, (%[dst],%[i],2)        \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src]"r"(src + len), [tab]"r"(tab)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_lut_row16_c(dst + len, src + len, tab, w - len);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_lut_init_x86(LutDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_AVXSLOW))
+        dsp->lut_row16 = lut_row16_avx2;
+#endif
+}
@@ -0,0 +1,286 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_nnedi.h"
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE && HAVE_FMA3_INLINE
+
+#define DECLARE_PS_CONST(name, v) \
+    DECLARE_ASM_CONST(32, float, name)[8] = { v, v, v, v, v, v, v, v }
+
+DECLARE_PS_CONST(ps_1,        1.0f);
+DECLARE_PS_CONST(ps_exp_lo,  -80.0f);
+DECLARE_PS_CONST(ps_exp_hi,   80.0f);
+DECLARE_PS_CONST(ps_log2e,    1.44269504088896341f);
+DECLARE_PS_CONST(ps_ln2_hi,   0.693359375f);
+DECLARE_PS_CONST(ps_ln2_lo,  -2.12194440e-4f);
+DECLARE_PS_CONST(ps_exp_p0,   1.9875691500e-4f);
+DECLARE_PS_CONST(ps_exp_p1,   1.3981999507e-3f);
+DECLARE_PS_CONST(ps_exp_p2,   8.3334519073e-3f);
+DECLARE_PS_CONST(ps_exp_p3,   4.1665795894e-2f);
+DECLARE_PS_CONST(ps_exp_p4,   1.6666665459e-1f);
+DECLARE_PS_CONST(ps_exp_p5,   5.0000001201e-1f);
+DECLARE_ASM_CONST(32, uint32_t, pd_127)[8] = {
+    127, 127, 127, 127, 127, 127, 127, 127
+};
+DECLARE_ASM_CONST(32, uint32_t, pd_abs)[8] = {
+    0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff,
+    0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff
+};
+
+/*
+ * Eight neurons at a time: each block of inputs is loaded once and
+ * multiplied into one accumulator per neuron, and the accumulators are then
+ * reduced horizontally into a single vector of 8 sums.
+ */
+#define DOT_PROD_REDUCE(hadd, perm, add)                                \
+            hadd" %%ymm1, %%ymm0, %%ymm0                    \n\t"       \
+            hadd" %%ymm3, %%ymm2, %%ymm2                    \n\t"       \
+            hadd" %%ymm5, %%ymm4, %%ymm4                    \n\t"       \
+            hadd" %%ymm7, %%ymm6, %%ymm6                    \n\t"       \
+            hadd" %%ymm2, %%ymm0, %%ymm0                    \n\t"       \
+            hadd" %%ymm6, %%ymm4, %%ymm4                    \n\t"       \
+            perm" $0x20, %%ymm4, %%ymm0, %%ymm1             \n\t"       \
+            perm" $0x31, %%ymm4, %%ymm0, %%ymm0             \n\t"       \
+            add"  %%ymm1, %%ymm0, %%ymm0                    \n\t"
+
+#define DOT_PROD_ZERO                                                   \
+            "vxorps %%ymm0, %%ymm0, %%ymm0                  \n\t"       \
+            "vxorps %%ymm1, %%ymm1, %%ymm1                  \n\t"       \
+            "vxorps %%ymm2, %%ymm2, %%ymm2                  \n\t"       \
+            "vxorps %%ymm3, %%ymm3, %%ymm3                  \n\t"       \
+            "vxorps %%ymm4, %%ymm4, %%ymm4                  \n\t"       \
+            "vxorps %%ymm5, %%ymm5, %%ymm5                  \n\t"       \
+            "vxorps %%ymm6, %%ymm6, %%ymm6                  \n\t"       \
+            "vxorps %%ymm7, %%ymm7, %%ymm7                  \n\t"
+
+static void dot_prod_fma3(const float *data, const float *weights, float *vals,
+                          const int n, const int len, const float scale)
+{
+    const x86_reg stride  = len * sizeof(float);
+    const x86_reg stride3 = 3 * stride;
+    int i;
+
+    for (i = 0; i < n; i += 8) {
+        const float *d  = data;
+        const float *w  = weights + i * len;
+        const float *w4 = w + 4 * len;
+        x86_reg cnt = len;
+
+        __asm__ volatile (
+            DOT_PROD_ZERO
+            "1:                                             \n\t"
+            "vmovups (%[d]), %%ymm8                         \n\t"
+            "vfmadd231ps (%[w]), %%ymm8, %%ymm0             \n\t"
+            "vfmadd231ps (%[w], %[stride]), %%ymm8, %%ymm1  \n\t"
+            "vfmadd231ps (%[w], %[stride], 2), %%ymm8, %%ymm2 \n\t"
+            "vfmadd231ps (%[w], %[stride3]), %%ymm8, %%ymm3 \n\t"
+            "vfmadd231ps (%[w4]), %%ymm8, %%ymm4            \n\t"
+            "vfmadd231ps (%[w4], %[stride]), %%ymm8, %%ymm5 \n\t"
+            "vfmadd231ps (%[w4], %[stride], 2), %%ymm8, %%ymm6 \n\t"
+            "vfmadd231ps (%[w4], %[stride3]), %%ymm8, %%ymm7 \n\t"
+            "add $32, %[d]                                  \n\t"
+            "add $32, %[w]                                  \n\t"
+            "add $32, %[w4]                                 \n\t"
+            "sub $8, %[cnt]                                 \n\t"
+            "jg 1b                                          \n\t"
+            DOT_PROD_REDUCE("vhaddps", "vperm2f128", "vaddps")
+            "vbroadcastss %[scale], %%ymm1                  \n\t"
+            "vmulps %%ymm1, %%ymm0, %%ymm0                  \n\t"
+            "vaddps (%[bias]), %%ymm0, %%ymm0               \n\t"
+            "vmovups %%ymm0, (%[vals])                      \n\t"
+            "vzeroupper                                     \n\t"
+            : [d]"+r"(d), [w]"+r"(w), [w4]"+r"(w4), [cnt]"+r"(cnt)
+            : [stride]"r"(stride), [stride3]"r"(stride3), [scale]"m"(scale),
+              [bias]"r"(weights + n * len + i), [vals]"r"(vals + i)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+                           "xmm5", "xmm6", "xmm7", "xmm8",) "memory"
+        );
+    }
+}
+
+/*
+ * Same as above with pmaddwd, so the integer sums are exact. The float scale
+ * and bias of 4 consecutive neurons are stored together; they are gathered
+ * into two vectors and applied in the same order as in C.
+ */
+static void dot_prod_i16_avx2(const float *dataf, const float *weightsf, float *vals,
+                              const int n, const int len, const float scale)
+{
+    const int16_t *weights = (const int16_t *)weightsf;
+    const float *wf = (const float *)&weights[n * len];
+    const x86_reg stride  = len * sizeof(int16_t);
+    const x86_reg stride3 = 3 * stride;
+    int i;
+
+    for (i = 0; i < n; i += 8) {
+        const float *d = dataf;
+        const int16_t *w  = weights + i * len;
+        const int16_t *w4 = w + 4 * len;
+        x86_reg cnt = len;
+
+        __asm__ volatile (
+            DOT_PROD_ZERO
+            "1:                                             \n\t"
+            "vmovdqu (%[d]), %%ymm8                         \n\t"
+            "vpmaddwd (%[w]), %%ymm8, %%ymm9                \n\t"
+            "vpmaddwd (%[w], %[stride]), %%ymm8, %%ymm10    \n\t"
+            "vpmaddwd (%[w], %[stride], 2), %%ymm8, %%ymm11 \n\t"
+            "vpmaddwd (%[w], %[stride3]), %%ymm8, %%ymm12   \n\t"
+            "vpaddd %%ymm9,  %%ymm0, %%ymm0                 \n\t"
+            "vpaddd %%ymm10, %%ymm1, %%ymm1                 \n\t"
+            "vpaddd %%ymm11, %%ymm2, %%ymm2                 \n\t"
+            "vpaddd %%ymm12, %%ymm3, %%ymm3                 \n\t"
+            "vpmaddwd (%[w4]), %%ymm8, %%ymm9               \n\t"
+            "vpmaddwd (%[w4], %[stride]), %%ymm8, %%ymm10   \n\t"
+            "vpmaddwd (%[w4], %[stride], 2), %%ymm8, %%ymm11 \n\t"
+            "vpmaddwd (%[w4], %[stride3]), %%ymm8, %%ymm12  \n\t"
+            "vpaddd %%ymm9,  %%ymm4, %%ymm4                 \n\t"
+            "vpaddd %%ymm10, %%ymm5, %%ymm5                 \n\t"
+            "vpaddd %%ymm11, %%ymm6, %%ymm6                 \n\t"
+            "vpaddd %%ymm12, %%ymm7, %%ymm7                 \n\t"
+            "add $32, %[d]                                  \n\t"
+            "add $32, %[w]                                  \n\t"
+            "add $32, %[w4]                                 \n\t"
+            "sub $16, %[cnt]                                \n\t"
+            "jg 1b                                          \n\t"
+            DOT_PROD_REDUCE("vphaddd", "vperm2i128", "vpaddd")
+            "vcvtdq2ps %%ymm0, %%ymm0                       \n\t"
+            "vmovups   (%[wf]), %%ymm8                      \n\t"
+            "vmovups 32(%[wf]), %%ymm9                      \n\t"
+            "vperm2f128 $0x20, %%ymm9, %%ymm8, %%ymm10      \n\t"
+            "vperm2f128 $0x31, %%ymm9, %%ymm8, %%ymm11      \n\t"
+            "vbroadcastss %[scale], %%ymm1                  \n\t"
+            "vmulps %%ymm10, %%ymm0, %%ymm0                 \n\t"
+            "vmulps %%ymm1, %%ymm0, %%ymm0                  \n\t"
+            "vaddps %%ymm11, %%ymm0, %%ymm0                 \n\t"
+            "vmovups %%ymm0, (%[vals])                      \n\t"
+            "vzeroupper                                     \n\t"
+            : [d]"+r"(d), [w]"+r"(w), [w4]"+r"(w4), [cnt]"+r"(cnt)
+            : [stride]"r"(stride), [stride3]"r"(stride3), [scale]"m"(scale),
+              [wf]"r"(wf + 2 * i), [vals]"r"(vals + i)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6",
+                           "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12",) "memory"
+        );
+    }
+}
+
+/*
+ * Cephes-style expf: split off the power of two with a two-part ln(2), then
+ * a degree 5 polynomial, accurate to a couple of ulp.
+ */
+static void exp_fma3(float *s, const int n)
+{
+    x86_reg i = -n * (x86_reg)sizeof(float);
+
+    s += n;
+
+    __asm__ volatile (
+        "1:                                             \n\t"
+        "vmovups (%[s], %[i]), %%ymm0                   \n\t"
+        "vmaxps %[exp_lo], %%ymm0, %%ymm0               \n\t"
+        "vminps %[exp_hi], %%ymm0, %%ymm0               \n\t"
+        "vmulps %[log2e], %%ymm0, %%ymm1                \n\t"
+        "vroundps $0, %%ymm1, %%ymm1                    \n\t"
+        "vfnmadd231ps %[ln2_hi], %%ymm1, %%ymm0         \n\t"
+        "vfnmadd231ps %[ln2_lo], %%ymm1, %%ymm0         \n\t"
+        "vmovaps %[p0], %%ymm2                          \n\t"
+        "vfmadd213ps %[p1], %%ymm0, %%ymm2              \n\t"
+        "vfmadd213ps %[p2], %%ymm0, %%ymm2              \n\t"
+        "vfmadd213ps %[p3], %%ymm0, %%ymm2              \n\t"
+        "vfmadd213ps %[p4], %%ymm0, %%ymm2              \n\t"
+        "vfmadd213ps %[p5], %%ymm0, %%ymm2              \n\t"
+        "vmulps %%ymm0, %%ymm0, %%ymm3                  \n\t"
+        "vfmadd213ps %%ymm0, %%ymm3, %%ymm2             \n\t"
+        "vaddps %[one], %%ymm2, %%ymm2                  \n\t"
+        "vcvtps2dq %%ymm1, %%ymm1                       \n\t"
+        "vpaddd %[bias], %%ymm1, %%ymm1                 \n\t"
+        "vpslld $23, %%ymm1, %%ymm1                     \n\t"
+        "vmulps %%ymm1, %%ymm2, %%ymm2                  \n\t"
+        "vmovups %%ymm2, (%[s], %[i])                   \n\t"
+        "add $32, %[i]                                  \n\t"
+        "jl 1b                                          \n\t"
+        "vzeroupper                                     \n\t"
+        : [i]"+r"(i)
+        : [s]"r"(s), [exp_lo]"m"(*ps_exp_lo), [exp_hi]"m"(*ps_exp_hi),
+          [log2e]"m"(*ps_log2e), [ln2_hi]"m"(*ps_ln2_hi), [ln2_lo]"m"(*ps_ln2_lo),
+          [p0]"m"(*ps_exp_p0), [p1]"m"(*ps_exp_p1), [p2]"m"(*ps_exp_p2),
+          [p3]"m"(*ps_exp_p3), [p4]"m"(*ps_exp_p4), [p5]"m"(*ps_exp_p5),
+          [one]"m"(*ps_1), [bias]"m"(*pd_127)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "memory"
+    );
+}
+
+static void wae5_fma3(const float *w, const int n, float *mstd)
+{
+    x86_reg i = -n * (x86_reg)sizeof(float);
+    float sums[2];
+
+    __asm__ volatile (
+        "vxorps %%ymm0, %%ymm0, %%ymm0                  \n\t"
+        "vxorps %%ymm1, %%ymm1, %%ymm1                  \n\t"
+        "1:                                             \n\t"
+        "vmovups (%[e], %[i]), %%ymm2                   \n\t"
+        "vandps %[abs], %%ymm2, %%ymm3                  \n\t"
+        "vaddps %[one], %%ymm3, %%ymm3                  \n\t"
+        "vdivps %%ymm3, %%ymm2, %%ymm2                  \n\t"
+        "vmovups (%[w], %[i]), %%ymm4                   \n\t"
+        "vfmadd231ps %%ymm4, %%ymm2, %%ymm0             \n\t"
+        "vaddps %%ymm4, %%ymm1, %%ymm1                  \n\t"
+        "add $32, %[i]                                  \n\t"
+        "jl 1b                                          \n\t"
+        "vextractf128 $1, %%ymm0, %%xmm2                \n\t"
+        "vextractf128 $1, %%ymm1, %%xmm3                \n\t"
+        "vaddps %%xmm2, %%xmm0, %%xmm0                  \n\t"
+        "vaddps %%xmm3, %%xmm1, %%xmm1                  \n\t"
+        "vhaddps %%xmm1, %%xmm0, %%xmm0                 \n\t"
+        "vhaddps %%xmm0, %%xmm0, %%xmm0                 \n\t"
+        "vmovlps %%xmm0, (%[sums])                      \n\t"
+        "vzeroupper                                     \n\t"
+        : [i]"+r"(i)
+        : [w]"r"(w + n), [e]"r"(w + 2 * n), [sums]"r"(sums),
+          [abs]"m"(*pd_abs), [one]"m"(*ps_1)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",) "memory"
+    );
+
+    if (sums[1] > 1e-10f)
+        mstd[3] += ((5.0f * sums[0]) / sums[1]) * mstd[1] + mstd[0];
+    else
+        mstd[3] += mstd[0];
+}
+
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE && HAVE_FMA3_INLINE */
+
+av_cold void ff_nnedi_init_x86(NNEDIDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE && HAVE_FMA3_INLINE
+    if (INLINE_AVX2(cpu_flags) && INLINE_FMA3(cpu_flags)) {
+        dsp->dot_prod     = dot_prod_fma3;
+        dsp->dot_prod_i16 = dot_prod_i16_avx2;
+        dsp->expfunc      = exp_fma3;
+        dsp->wae5         = wae5_fma3;
+    }
+#endif
+}
@@ -0,0 +1,473 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_overlay.h"
+
+#if HAVE_INLINE_ASM
+
+#define R 0
+#define G 1
+#define B 2
+#define A 3
+
+/* 0x0101 words double as 0x01 bytes for pmaddubsw */
+DECLARE_ASM_CONST(32, uint16_t, pw_257)[16] = {
+    257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257, 257
+};
+DECLARE_ASM_CONST(32, uint16_t, pw_255)[16] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+DECLARE_ASM_CONST(32, uint16_t, pw_128)[16] = {
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128
+};
+DECLARE_ASM_CONST(32, float, ps_1)[8] = {
+    1, 1, 1, 1, 1, 1, 1, 1
+};
+DECLARE_ASM_CONST(32, float, ps_255)[8] = {
+    255, 255, 255, 255, 255, 255, 255, 255
+};
+DECLARE_ASM_CONST(32, float, ps_65025)[8] = {
+    65025, 65025, 65025, 65025, 65025, 65025, 65025, 65025
+};
+
+/* d = FAST_DIV255(d * (255 - a) + s * a) on 8 words,
+ * with zero in xmm7, pw_257 in xmm6, pw_128 in xmm5 and pw_255 in xmm4 */
+#define BLEND_8_SSE2                        \
+    "movdqa %%xmm4, %%xmm3      \n\t"       \
+    "psubw %%xmm2, %%xmm3       \n\t"       \
+    "pmullw %%xmm2, %%xmm1      \n\t"       \
+    "pmullw %%xmm3, %%xmm0      \n\t"       \
+    "paddw %%xmm1, %%xmm0       \n\t"       \
+    "paddw %%xmm5, %%xmm0       \n\t"       \
+    "pmulhuw %%xmm6, %%xmm0     \n\t"       \
+    "packuswb %%xmm0, %%xmm0    \n\t"
+
+#define LOAD_CONSTANTS_SSE2                 \
+    "pxor %%xmm7, %%xmm7        \n\t"       \
+    "movdqa %[pw_257], %%xmm6   \n\t"       \
+    "movdqa %[pw_128], %%xmm5   \n\t"       \
+    "movdqa %[pw_255], %%xmm4   \n\t"
+
+/* the same on 16 words with ymm registers */
+#define BLEND_16_AVX2                               \
+    "vpsubw %%ymm2, %%ymm4, %%ymm3          \n\t"   \
+    "vpmullw %%ymm2, %%ymm1, %%ymm1         \n\t"   \
+    "vpmullw %%ymm3, %%ymm0, %%ymm0         \n\t"   \
+    "vpaddw %%ymm1, %%ymm0, %%ymm0          \n\t"   \
+    "vpaddw %%ymm5, %%ymm0, %%ymm0          \n\t"   \
+    "vpmulhuw %%ymm6, %%ymm0, %%ymm0        \n\t"   \
+    "vextracti128 $1, %%ymm0, %%xmm1        \n\t"   \
+    "vpackuswb %%xmm1, %%xmm0, %%xmm0       \n\t"
+
+#define LOAD_CONSTANTS_AVX2                         \
+    "vmovdqa %[pw_257], %%ymm6              \n\t"   \
+    "vmovdqa %[pw_128], %%ymm5              \n\t"   \
+    "vmovdqa %[pw_255], %%ymm4              \n\t"
+
+#if HAVE_SSE2_INLINE
+static void blend_row_sse2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg len = w & ~7;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_CONSTANTS_SSE2
+            "1:                                 \n\t"
+            "movq (%[d],%[i]), %%xmm0           \n\t"
+            "movq (%[s],%[i]), %%xmm1           \n\t"
+            "movq (%[a],%[i]), %%xmm2           \n\t"
+            "punpcklbw %%xmm7, %%xmm0           \n\t"
+            "punpcklbw %%xmm7, %%xmm1           \n\t"
+            "punpcklbw %%xmm7, %%xmm2           \n\t"
+            BLEND_8_SSE2
+            "movq %%xmm0, (%[d],%[i])           \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + len), [s]"r"(s + len), [a]"r"(a + len),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128), [pw_255]"m"(*pw_255)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_overlay_blend_row_c(d + len, s + len, a + len, w - len);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_SSSE3_INLINE
+static void blend_row_420_ssse3(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                                ptrdiff_t alinesize, int w)
+{
+    x86_reg len = w & ~7;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_CONSTANTS_SSE2
+            "1:                                 \n\t"
+            "movdqu (%[a],%[i],2), %%xmm2       \n\t"
+            "movdqu (%[a2],%[i],2), %%xmm3      \n\t"
+            "pmaddubsw %%xmm6, %%xmm2           \n\t"
+            "pmaddubsw %%xmm6, %%xmm3           \n\t"
+            "paddw %%xmm3, %%xmm2               \n\t"
+            "psrlw $2, %%xmm2                   \n\t"
+            "movq (%[d],%[i]), %%xmm0           \n\t"
+            "movq (%[s],%[i]), %%xmm1           \n\t"
+            "punpcklbw %%xmm7, %%xmm0           \n\t"
+            "punpcklbw %%xmm7, %%xmm1           \n\t"
+            BLEND_8_SSE2
+            "movq %%xmm0, (%[d],%[i])           \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + len), [s]"r"(s + len),
+              [a]"r"(a + 2 * len), [a2]"r"(a + 2 * len + alinesize),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128), [pw_255]"m"(*pw_255)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_overlay_blend_row_420_c(d + len, s + len, a + 2 * len, alinesize, w - len);
+}
+#endif /* HAVE_SSSE3_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void blend_row_avx2(uint8_t *d, const uint8_t *s, const uint8_t *a, int w)
+{
+    x86_reg len = w & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_CONSTANTS_AVX2
+            "1:                                     \n\t"
+            "vpmovzxbw (%[d],%[i]), %%ymm0          \n\t"
+            "vpmovzxbw (%[s],%[i]), %%ymm1          \n\t"
+            "vpmovzxbw (%[a],%[i]), %%ymm2          \n\t"
+            BLEND_16_AVX2
+            "vmovdqu %%xmm0, (%[d],%[i])            \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + len), [s]"r"(s + len), [a]"r"(a + len),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128), [pw_255]"m"(*pw_255)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6",) "memory"
+        );
+    }
+    ff_overlay_blend_row_c(d + len, s + len, a + len, w - len);
+}
+
+static void blend_row_420_avx2(uint8_t *d, const uint8_t *s, const uint8_t *a,
+                               ptrdiff_t alinesize, int w)
+{
+    x86_reg len = w & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            LOAD_CONSTANTS_AVX2
+            "1:                                     \n\t"
+            "vmovdqu (%[a],%[i],2), %%ymm2          \n\t"
+            "vmovdqu (%[a2],%[i],2), %%ymm3         \n\t"
+            "vpmaddubsw %%ymm6, %%ymm2, %%ymm2      \n\t"
+            "vpmaddubsw %%ymm6, %%ymm3, %%ymm3      \n\t"
+            "vpaddw %%ymm3, %%ymm2, %%ymm2          \n\t"
+            "vpsrlw $2, %%ymm2, %%ymm2              \n\t"
+            "vpmovzxbw (%[d],%[i]), %%ymm0          \n\t"
+            "vpmovzxbw (%[s],%[i]), %%ymm1          \n\t"
+            BLEND_16_AVX2
+            "vmovdqu %%xmm0, (%[d],%[i])            \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + len), [s]"r"(s + len),
+              [a]"r"(a + 2 * len), [a2]"r"(a + 2 * len + alinesize),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128), [pw_255]"m"(*pw_255)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6",) "memory"
+        );
+    }
+    ff_overlay_blend_row_420_c(d + len, s + len, a + 2 * len, alinesize, w - len);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+#if ARCH_X86_64 && (HAVE_SSSE3_INLINE || HAVE_AVX2_INLINE)
+/**
+ * Build the byte shuffles and word masks for two 16-byte lanes of packed
+ * pixels. Offsets within tab:
+ *   0 source shuffled to main order, with 0 in the alpha byte
+ *  32 0xff in the alpha byte, to be or'ed to the above
+ *  64 source alpha to the low byte of each dword
+ *  96 main alpha to the low byte of each dword
+ * 128 low byte of each dword to the colour bytes and the next byte to the
+ *     alpha byte
+ * 160 words of 255 on colour bytes and 0 on the alpha byte
+ * 192 words of 0xffff on the alpha byte
+ */
+static void init_rgba_tables(uint8_t *tab, const uint8_t *dmap, const uint8_t *smap)
+{
+    uint16_t *k_w    = (uint16_t *)(tab + 160);
+    uint16_t *mask_w = (uint16_t *)(tab + 192);
+    int p, k;
+
+    for (p = 0; p < 8; p++) {
+        uint8_t *t = tab + 4 * p;
+        int b = 4 * (p & 3);
+
+        t[dmap[R]] = b + smap[R];
+        t[dmap[G]] = b + smap[G];
+        t[dmap[B]] = b + smap[B];
+        t[dmap[A]] = 0x80;
+        for (k = 0; k < 4; k++) {
+            t[ 32 + k] = k == dmap[A] ? 0xff : 0;
+            t[ 64 + k] = k ? 0x80 : b + smap[A];
+            t[ 96 + k] = k ? 0x80 : b + dmap[A];
+            t[128 + k] = b + (k == dmap[A]);
+        }
+    }
+    for (k = 0; k < 16; k++) {
+        k_w[k]    = (k & 3) == dmap[A] ? 0 : 255;
+        mask_w[k] = (k & 3) == dmap[A] ? 0xffff : 0;
+    }
+}
+#endif
+
+/*
+ * The unpremultiplied alpha 255*255*a / (255*(a+ad) - a*ad) has numerator
+ * and denominator below 2^24, so both are exact in single precision and the
+ * distance of a non-integer quotient to the next integer (at least 1/65025)
+ * exceeds half an ulp of the rounded quotient: truncating the float division
+ * gives the same result as the integer one.
+ *
+ * The colour bytes blend with d * (255 - alpha) + s * alpha. The alpha byte
+ * blends with d * -a + 255 * a = (255 - d) * a, then adds d back after the
+ * division, which is d += FAST_DIV255((255 - d) * a).
+ */
+#if ARCH_X86_64 && HAVE_SSSE3_INLINE
+static void blend_row_rgba_ssse3(uint8_t *d, const uint8_t *s, int w,
+                                 const uint8_t *dmap, const uint8_t *smap)
+{
+    LOCAL_ALIGNED_32(uint8_t, tab, [224]);
+    x86_reg len = w & ~3;
+    x86_reg i = -4 * len;
+
+    if (len) {
+        init_rgba_tables(tab, dmap, smap);
+        __asm__ volatile (
+            "movdqa    (%[tab]), %%xmm9             \n\t"
+            "movdqa  32(%[tab]), %%xmm8             \n\t"
+            "movdqa 128(%[tab]), %%xmm10            \n\t"
+            "movdqa 160(%[tab]), %%xmm12            \n\t"
+            "movdqa 192(%[tab]), %%xmm11            \n\t"
+            "movdqa %[pw_257], %%xmm13              \n\t"
+            "movdqa %[pw_128], %%xmm14              \n\t"
+            "pxor %%xmm15, %%xmm15                  \n\t"
+            "1:                                     \n\t"
+            "movdqu (%[d],%[i]), %%xmm0             \n\t"
+            "movdqu (%[s],%[i]), %%xmm1             \n\t"
+            "movdqa %%xmm1, %%xmm2                  \n\t"
+            "pshufb 64(%[tab]), %%xmm2              \n\t"
+            "movdqa %%xmm0, %%xmm3                  \n\t"
+            "pshufb 96(%[tab]), %%xmm3              \n\t"
+            "cvtdq2ps %%xmm2, %%xmm4                \n\t"
+            "cvtdq2ps %%xmm3, %%xmm3                \n\t"
+            "movaps %%xmm4, %%xmm5                  \n\t"
+            "addps %%xmm3, %%xmm5                   \n\t"
+            "mulps %[ps_255], %%xmm5                \n\t"
+            "mulps %%xmm4, %%xmm3                   \n\t"
+            "subps %%xmm3, %%xmm5                   \n\t"
+            "maxps %[ps_1], %%xmm5                  \n\t"
+            "mulps %[ps_65025], %%xmm4              \n\t"
+            "divps %%xmm5, %%xmm4                   \n\t"
+            "cvttps2dq %%xmm4, %%xmm4               \n\t"
+            "pslld $8, %%xmm2                       \n\t"
+            "por %%xmm2, %%xmm4                     \n\t"
+            "pshufb %%xmm10, %%xmm4                 \n\t"
+            "pshufb %%xmm9, %%xmm1                  \n\t"
+            "por %%xmm8, %%xmm1                     \n\t"
+
+            "movdqa %%xmm0, %%xmm2                  \n\t"
+            "movdqa %%xmm1, %%xmm3                  \n\t"
+            "movdqa %%xmm4, %%xmm5                  \n\t"
+            "punpcklbw %%xmm15, %%xmm2              \n\t"
+            "punpcklbw %%xmm15, %%xmm3              \n\t"
+            "punpcklbw %%xmm15, %%xmm5              \n\t"
+            "movdqa %%xmm12, %%xmm6                 \n\t"
+            "psubw %%xmm5, %%xmm6                   \n\t"
+            "pmullw %%xmm5, %%xmm3                  \n\t"
+            "movdqa %%xmm2, %%xmm7                  \n\t"
+            "pmullw %%xmm6, %%xmm2                  \n\t"
+            "paddw %%xmm3, %%xmm2                   \n\t"
+            "paddw %%xmm14, %%xmm2                  \n\t"
+            "pmulhuw %%xmm13, %%xmm2                \n\t"
+            "pand %%xmm11, %%xmm7                   \n\t"
+            "paddw %%xmm7, %%xmm2                   \n\t"
+
+            "punpckhbw %%xmm15, %%xmm0              \n\t"
+            "punpckhbw %%xmm15, %%xmm1              \n\t"
+            "punpckhbw %%xmm15, %%xmm4              \n\t"
+            "movdqa %%xmm12, %%xmm6                 \n\t"
+            "psubw %%xmm4, %%xmm6                   \n\t"
+            "pmullw %%xmm4, %%xmm1                  \n\t"
+            "movdqa %%xmm0, %%xmm7                  \n\t"
+            "pmullw %%xmm6, %%xmm0                  \n\t"
+            "paddw %%xmm1, %%xmm0                   \n\t"
+            "paddw %%xmm14, %%xmm0                  \n\t"
+            "pmulhuw %%xmm13, %%xmm0                \n\t"
+            "pand %%xmm11, %%xmm7                   \n\t"
+            "paddw %%xmm7, %%xmm0                   \n\t"
+
+            "packuswb %%xmm0, %%xmm2                \n\t"
+            "movdqu %%xmm2, (%[d],%[i])             \n\t"
+            "add $16, %[i]                          \n\t"
+            "jl 1b                                  \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + 4 * len), [s]"r"(s + 4 * len), [tab]"r"(tab),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128),
+              [ps_1]"m"(*ps_1), [ps_255]"m"(*ps_255), [ps_65025]"m"(*ps_65025)
+            : XMM_CLOBBERS("xmm0",  "xmm1",  "xmm2",  "xmm3",
+                           "xmm4",  "xmm5",  "xmm6",  "xmm7",
+                           "xmm8",  "xmm9",  "xmm10", "xmm11",
+                           "xmm12", "xmm13", "xmm14", "xmm15",) "memory"
+        );
+    }
+    ff_overlay_blend_row_rgba_c(d + 4 * len, s + 4 * len, w - len, dmap, smap);
+}
+#endif /* ARCH_X86_64 && HAVE_SSSE3_INLINE */
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+static void blend_row_rgba_avx2(uint8_t *d, const uint8_t *s, int w,
+                                const uint8_t *dmap, const uint8_t *smap)
+{
+    LOCAL_ALIGNED_32(uint8_t, tab, [224]);
+    x86_reg len = w & ~7;
+    x86_reg i = -4 * len;
+
+    if (len) {
+        init_rgba_tables(tab, dmap, smap);
+        __asm__ volatile (
+            "vmovdqa    (%[tab]), %%ymm9                \n\t"
+            "vmovdqa  32(%[tab]), %%ymm8                \n\t"
+            "vmovdqa 128(%[tab]), %%ymm10               \n\t"
+            "vmovdqa 160(%[tab]), %%ymm12               \n\t"
+            "vmovdqa 192(%[tab]), %%ymm11               \n\t"
+            "vmovdqa %[pw_257], %%ymm13                 \n\t"
+            "vmovdqa %[pw_128], %%ymm14                 \n\t"
+            "vpxor %%ymm15, %%ymm15, %%ymm15            \n\t"
+            "1:                                         \n\t"
+            "vmovdqu (%[d],%[i]), %%ymm0                \n\t"
+            "vmovdqu (%[s],%[i]), %%ymm1                \n\t"
+            "vpshufb 64(%[tab]), %%ymm1, %%ymm2         \n\t"
+            "vpshufb 96(%[tab]), %%ymm0, %%ymm3         \n\t"
+            "vcvtdq2ps %%ymm2, %%ymm4                   \n\t"
+            "vcvtdq2ps %%ymm3, %%ymm3                   \n\t"
+            "vaddps %%ymm3, %%ymm4, %%ymm5              \n\t"
+            "vmulps %[ps_255], %%ymm5, %%ymm5           \n\t"
+            "vmulps %%ymm4, %%ymm3, %%ymm3              \n\t"
+            "vsubps %%ymm3, %%ymm5, %%ymm5              \n\t"
+            "vmaxps %[ps_1], %%ymm5, %%ymm5             \n\t"
+            "vmulps %[ps_65025], %%ymm4, %%ymm4         \n\t"
+            "vdivps %%ymm5, %%ymm4, %%ymm4              \n\t"
+            "vcvttps2dq %%ymm4, %%ymm4                  \n\t"
+            "vpslld $8, %%ymm2, %%ymm2                  \n\t"
+            "vpor %%ymm2, %%ymm4, %%ymm4                \n\t"
+            "vpshufb %%ymm10, %%ymm4, %%ymm4            \n\t"
+            "vpshufb %%ymm9, %%ymm1, %%ymm1             \n\t"
+            "vpor %%ymm8, %%ymm1, %%ymm1                \n\t"
+
+            "vpunpcklbw %%ymm15, %%ymm0, %%ymm2         \n\t"
+            "vpunpcklbw %%ymm15, %%ymm1, %%ymm3         \n\t"
+            "vpunpcklbw %%ymm15, %%ymm4, %%ymm5         \n\t"
+            "vpsubw %%ymm5, %%ymm12, %%ymm6             \n\t"
+            "vpmullw %%ymm5, %%ymm3, %%ymm3             \n\t"
+            "vpmullw %%ymm6, %%ymm2, %%ymm6             \n\t"
+            "vpand %%ymm11, %%ymm2, %%ymm2              \n\t"
+            "vpaddw %%ymm3, %%ymm6, %%ymm6              \n\t"
+            "vpaddw %%ymm14, %%ymm6, %%ymm6             \n\t"
+            "vpmulhuw %%ymm13, %%ymm6, %%ymm6           \n\t"
+            "vpaddw %%ymm2, %%ymm6, %%ymm6              \n\t"
+
+            "vpunpckhbw %%ymm15, %%ymm0, %%ymm2         \n\t"
+            "vpunpckhbw %%ymm15, %%ymm1, %%ymm3         \n\t"
+            "vpunpckhbw %%ymm15, %%ymm4, %%ymm5         \n\t"
+            "vpsubw %%ymm5, %%ymm12, %%ymm7             \n\t"
+            "vpmullw %%ymm5, %%ymm3, %%ymm3             \n\t"
+            "vpmullw %%ymm7, %%ymm2, %%ymm7             \n\t"
+            "vpand %%ymm11, %%ymm2, %%ymm2              \n\t"
+            "vpaddw %%ymm3, %%ymm7, %%ymm7              \n\t"
+            "vpaddw %%ymm14, %%ymm7, %%ymm7             \n\t"
+            "vpmulhuw %%ymm13, %%ymm7, %%ymm7           \n\t"
+            "vpaddw %%ymm2, %%ymm7, %%ymm7              \n\t"
+
+            "vpackuswb %%ymm7, %%ymm6, %%ymm6           \n\t"
+            "vmovdqu %%ymm6, (%[d],%[i])                \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [d]"r"(d + 4 * len), [s]"r"(s + 4 * len), [tab]"r"(tab),
+              [pw_257]"m"(*pw_257), [pw_128]"m"(*pw_128),
+              [ps_1]"m"(*ps_1), [ps_255]"m"(*ps_255), [ps_65025]"m"(*ps_65025)
+            : XMM_CLOBBERS("xmm0",  "xmm1",  "xmm2",  "xmm3",
+                           "xmm4",  "xmm5",  "xmm6",  "xmm7",
+                           "xmm8",  "xmm9",  "xmm10", "xmm11",
+                           "xmm12", "xmm13", "xmm14", "xmm15",) "memory"
+        );
+    }
+    ff_overlay_blend_row_rgba_c(d + 4 * len, s + 4 * len, w - len, dmap, smap);
+}
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE */
+
+#endif /* HAVE_INLINE_ASM */
+
+av_cold void ff_overlay_init_x86(OverlayDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->blend_row = blend_row_sse2;
+#endif
+#if HAVE_SSSE3_INLINE
+    if (INLINE_SSSE3(cpu_flags)) {
+        dsp->blend_row_420 = blend_row_420_ssse3;
+#if ARCH_X86_64
+        dsp->blend_row_rgba = blend_row_rgba_ssse3;
+#endif
+    }
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        dsp->blend_row     = blend_row_avx2;
+        dsp->blend_row_420 = blend_row_420_avx2;
+#if ARCH_X86_64
+        dsp->blend_row_rgba = blend_row_rgba_avx2;
+#endif
+    }
+#endif
+}
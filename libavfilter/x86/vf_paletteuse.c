@@ -0,0 +1,157 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_paletteuse.h"
+
+/* keys are distance << 8 | id, see ff_paletteuse_nearest_color_c() */
+static av_always_inline int unique_nearest(int min_lo, int min_hi)
+{
+    if (min_lo >= PALETTE_TABLE_SKIP || (min_lo & 0xff) != (~min_hi & 0xff))
+        return -1;
+    return min_lo & 0xff;
+}
+
+#if HAVE_SSE4_INLINE
+static int nearest_color_sse4(const PaletteTable *t, uint32_t color)
+{
+    const int rg = (color >> 16 & 0xff) | (color & 0xff00) << 8;
+    const int b  =  color       & 0xff;
+    x86_reg i = -AVPALETTE_COUNT * 4;
+    int min_lo, min_hi;
+
+    __asm__ volatile (
+        "movd %[rg], %%xmm6                 \n\t"
+        "pshufd $0, %%xmm6, %%xmm6          \n\t"
+        "movd %[b], %%xmm7                  \n\t"
+        "pshufd $0, %%xmm7, %%xmm7          \n\t"
+        "pcmpeqd %%xmm5, %%xmm5             \n\t"
+        "psrld $24, %%xmm5                  \n\t"
+        "pcmpeqd %%xmm4, %%xmm4             \n\t"
+        "psrld $1, %%xmm4                   \n\t"
+        "movdqa %%xmm4, %%xmm3              \n\t"
+        "1:                                 \n\t"
+        "movdqa (%[rgp],%[i]), %%xmm0       \n\t"
+        "movdqa (%[bp],%[i]), %%xmm1        \n\t"
+        "psubw %%xmm6, %%xmm0               \n\t"
+        "psubw %%xmm7, %%xmm1               \n\t"
+        "pmaddwd %%xmm0, %%xmm0             \n\t"
+        "pmaddwd %%xmm1, %%xmm1             \n\t"
+        "paddd %%xmm1, %%xmm0               \n\t"
+        "pslld $8, %%xmm0                   \n\t"
+        "por (%[id],%[i]), %%xmm0           \n\t"
+        "pminsd %%xmm0, %%xmm4              \n\t"
+        "pxor %%xmm5, %%xmm0                \n\t"
+        "pminsd %%xmm0, %%xmm3              \n\t"
+        "add $16, %[i]                      \n\t"
+        "jl 1b                              \n\t"
+        "pshufd $0x4e, %%xmm4, %%xmm0       \n\t"
+        "pshufd $0x4e, %%xmm3, %%xmm1       \n\t"
+        "pminsd %%xmm0, %%xmm4              \n\t"
+        "pminsd %%xmm1, %%xmm3              \n\t"
+        "pshufd $0xb1, %%xmm4, %%xmm0       \n\t"
+        "pshufd $0xb1, %%xmm3, %%xmm1       \n\t"
+        "pminsd %%xmm0, %%xmm4              \n\t"
+        "pminsd %%xmm1, %%xmm3              \n\t"
+        "movd %%xmm4, %[lo]                 \n\t"
+        "movd %%xmm3, %[hi]                 \n\t"
+        : [i]"+r"(i), [lo]"=r"(min_lo), [hi]"=r"(min_hi)
+        : [rg]"r"(rg), [b]"r"(b),
+          [rgp]"r"(t->rg + 2 * AVPALETTE_COUNT), [bp]"r"(t->b + 2 * AVPALETTE_COUNT),
+          [id]"r"(t->id + AVPALETTE_COUNT)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm3", "xmm4",
+                       "xmm5", "xmm6", "xmm7",) "memory"
+    );
+    return unique_nearest(min_lo, min_hi);
+}
+#endif /* HAVE_SSE4_INLINE */
+
+#if HAVE_AVX2_INLINE
+static int nearest_color_avx2(const PaletteTable *t, uint32_t color)
+{
+    const int rg = (color >> 16 & 0xff) | (color & 0xff00) << 8;
+    const int b  =  color       & 0xff;
+    x86_reg i = -AVPALETTE_COUNT * 4;
+    int min_lo, min_hi;
+
+    __asm__ volatile (
+        "vmovd %[rg], %%xmm6                        \n\t"
+        "vpbroadcastd %%xmm6, %%ymm6                \n\t"
+        "vmovd %[b], %%xmm7                         \n\t"
+        "vpbroadcastd %%xmm7, %%ymm7                \n\t"
+        "vpcmpeqd %%ymm5, %%ymm5, %%ymm5            \n\t"
+        "vpsrld $24, %%ymm5, %%ymm5                 \n\t"
+        "vpcmpeqd %%ymm4, %%ymm4, %%ymm4            \n\t"
+        "vpsrld $1, %%ymm4, %%ymm4                  \n\t"
+        "vmovdqa %%ymm4, %%ymm3                     \n\t"
+        "1:                                         \n\t"
+        "vpsubw (%[rgp],%[i]), %%ymm6, %%ymm0       \n\t"
+        "vpsubw (%[bp],%[i]), %%ymm7, %%ymm1        \n\t"
+        "vpmaddwd %%ymm0, %%ymm0, %%ymm0            \n\t"
+        "vpmaddwd %%ymm1, %%ymm1, %%ymm1            \n\t"
+        "vpaddd %%ymm1, %%ymm0, %%ymm0              \n\t"
+        "vpslld $8, %%ymm0, %%ymm0                  \n\t"
+        "vpor (%[id],%[i]), %%ymm0, %%ymm0          \n\t"
+        "vpminsd %%ymm0, %%ymm4, %%ymm4             \n\t"
+        "vpxor %%ymm5, %%ymm0, %%ymm0               \n\t"
+        "vpminsd %%ymm0, %%ymm3, %%ymm3             \n\t"
+        "add $32, %[i]                              \n\t"
+        "jl 1b                                      \n\t"
+        "vextracti128 $1, %%ymm4, %%xmm0            \n\t"
+        "vextracti128 $1, %%ymm3, %%xmm1            \n\t"
+        "vpminsd %%xmm0, %%xmm4, %%xmm4             \n\t"
+        "vpminsd %%xmm1, %%xmm3, %%xmm3             \n\t"
+        "vpshufd $0x4e, %%xmm4, %%xmm0              \n\t"
+        "vpshufd $0x4e, %%xmm3, %%xmm1              \n\t"
+        "vpminsd %%xmm0, %%xmm4, %%xmm4             \n\t"
+        "vpminsd %%xmm1, %%xmm3, %%xmm3             \n\t"
+        "vpshufd $0xb1, %%xmm4, %%xmm0              \n\t"
+        "vpshufd $0xb1, %%xmm3, %%xmm1              \n\t"
+        "vpminsd %%xmm0, %%xmm4, %%xmm4             \n\t"
+        "vpminsd %%xmm1, %%xmm3, %%xmm3             \n\t"
+        "vmovd %%xmm4, %[lo]                        \n\t"
+        "vmovd %%xmm3, %[hi]                        \n\t"
+        "vzeroupper                                 \n\t"
+        : [i]"+r"(i), [lo]"=r"(min_lo), [hi]"=r"(min_hi)
+        : [rg]"r"(rg), [b]"r"(b),
+          [rgp]"r"(t->rg + 2 * AVPALETTE_COUNT), [bp]"r"(t->b + 2 * AVPALETTE_COUNT),
+          [id]"r"(t->id + AVPALETTE_COUNT)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm3", "xmm4",
+                       "xmm5", "xmm6", "xmm7",) "memory"
+    );
+    return unique_nearest(min_lo, min_hi);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_paletteuse_init_x86(PaletteUseDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE4_INLINE
+    if (INLINE_SSE4(cpu_flags))
+        dsp->nearest_color = nearest_color_sse4;
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        dsp->nearest_color = nearest_color_avx2;
+#endif
+}
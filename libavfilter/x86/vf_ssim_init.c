@@ -18,6 +18,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 
 #include "libavfilter/ssim.h"
@@ -30,10 +34,167 @@ void ff_ssim_4x4_line_xop  (const uint8_t *buf, ptrdiff_t buf_stride,
                             int (*sums)[4], int w);
 float ff_ssim_end_line_sse4(const int (*sum0)[4], const int (*sum1)[4], int w);
 
-void ff_ssim_init_x86(SSIMDSPContext *dsp)
+#if ARCH_X86_64 && HAVE_INLINE_ASM
+DECLARE_ASM_CONST(32, int16_t, pw_1)[16] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1
+};
+
+/* accumulate the words of a row of main in xmm2 and of ref in xmm3,
+ * a * b in xmm4 and a * a + b * b in xmm5 */
+#define SSIM_ROW_SSE2(m, r)                 \
+    "movdqu " m ", %%xmm0       \n\t"       \
+    "movdqu " r ", %%xmm1       \n\t"       \
+    "paddw %%xmm0, %%xmm2       \n\t"       \
+    "paddw %%xmm1, %%xmm3       \n\t"       \
+    "movdqa %%xmm0, %%xmm6      \n\t"       \
+    "pmaddwd %%xmm1, %%xmm6     \n\t"       \
+    "pmaddwd %%xmm0, %%xmm0     \n\t"       \
+    "pmaddwd %%xmm1, %%xmm1     \n\t"       \
+    "paddd %%xmm6, %%xmm4       \n\t"       \
+    "paddd %%xmm0, %%xmm5       \n\t"       \
+    "paddd %%xmm1, %%xmm5       \n\t"
+
+#define SSIM_ROW_AVX2(m, r)                         \
+    "vmovdqu " m ", %%ymm0                  \n\t"   \
+    "vmovdqu " r ", %%ymm1                  \n\t"   \
+    "vpaddw %%ymm0, %%ymm2, %%ymm2          \n\t"   \
+    "vpaddw %%ymm1, %%ymm3, %%ymm3          \n\t"   \
+    "vpmaddwd %%ymm1, %%ymm0, %%ymm6        \n\t"   \
+    "vpmaddwd %%ymm0, %%ymm0, %%ymm0        \n\t"   \
+    "vpmaddwd %%ymm1, %%ymm1, %%ymm1        \n\t"   \
+    "vpaddd %%ymm6, %%ymm4, %%ymm4          \n\t"   \
+    "vpaddd %%ymm0, %%ymm5, %%ymm5          \n\t"   \
+    "vpaddd %%ymm1, %%ymm5, %%ymm5          \n\t"
+
+#if HAVE_SSE2_INLINE
+/* two blocks of 12-bit samples per iteration, the pairs of dwords of
+ * each sum are transposed to { s1, s2, ss, s12 } and added */
+static void ssim_4x4_line_16bit_sse2(const uint8_t *buf, ptrdiff_t buf_stride,
+                                     const uint8_t *ref, ptrdiff_t ref_stride,
+                                     int (*sums)[4], int w)
+{
+    x86_reg len = (w & ~1) * 8;
+    x86_reg x = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movdqa %[pw_1], %%xmm7             \n\t"
+            "1:                                 \n\t"
+            "pxor %%xmm2, %%xmm2                \n\t"
+            "pxor %%xmm3, %%xmm3                \n\t"
+            "pxor %%xmm4, %%xmm4                \n\t"
+            "pxor %%xmm5, %%xmm5                \n\t"
+            SSIM_ROW_SSE2("(%[m0],%[x])", "(%[r0],%[x])")
+            SSIM_ROW_SSE2("(%[m1],%[x])", "(%[r1],%[x])")
+            SSIM_ROW_SSE2("(%[m2],%[x])", "(%[r2],%[x])")
+            SSIM_ROW_SSE2("(%[m3],%[x])", "(%[r3],%[x])")
+            "pmaddwd %%xmm7, %%xmm2             \n\t"
+            "pmaddwd %%xmm7, %%xmm3             \n\t"
+            "movdqa %%xmm2, %%xmm0              \n\t"
+            "punpckldq %%xmm3, %%xmm2           \n\t"
+            "punpckhdq %%xmm3, %%xmm0           \n\t"
+            "movdqa %%xmm5, %%xmm1              \n\t"
+            "punpckldq %%xmm4, %%xmm5           \n\t"
+            "punpckhdq %%xmm4, %%xmm1           \n\t"
+            "movdqa %%xmm2, %%xmm3              \n\t"
+            "punpcklqdq %%xmm5, %%xmm2          \n\t"
+            "punpckhqdq %%xmm5, %%xmm3          \n\t"
+            "paddd %%xmm3, %%xmm2               \n\t"
+            "movdqa %%xmm0, %%xmm3              \n\t"
+            "punpcklqdq %%xmm1, %%xmm0          \n\t"
+            "punpckhqdq %%xmm1, %%xmm3          \n\t"
+            "paddd %%xmm3, %%xmm0               \n\t"
+            "movdqu %%xmm2, (%[sums],%[x],2)    \n\t"
+            "movdqu %%xmm0, 16(%[sums],%[x],2)  \n\t"
+            "add $16, %[x]                      \n\t"
+            "jl 1b                              \n\t"
+            : [x]"+r"(x)
+            : [m0]"r"(buf + len), [m1]"r"(buf + buf_stride + len),
+              [m2]"r"(buf + 2 * buf_stride + len), [m3]"r"(buf + 3 * buf_stride + len),
+              [r0]"r"(ref + len), [r1]"r"(ref + ref_stride + len),
+              [r2]"r"(ref + 2 * ref_stride + len), [r3]"r"(ref + 3 * ref_stride + len),
+              [sums]"r"(sums + (w & ~1)), [pw_1]"m"(*pw_1)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_ssim_4x4_line_16bit_c(buf + len, buf_stride, ref + len, ref_stride,
+                             sums + (w & ~1), w & 1);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX2_INLINE
+/* the same on four blocks, the two in each lane being stored in order */
+static void ssim_4x4_line_16bit_avx2(const uint8_t *buf, ptrdiff_t buf_stride,
+                                     const uint8_t *ref, ptrdiff_t ref_stride,
+                                     int (*sums)[4], int w)
+{
+    x86_reg len = (w & ~3) * 8;
+    x86_reg x = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovdqa %[pw_1], %%ymm7                \n\t"
+            "1:                                     \n\t"
+            "vpxor %%ymm2, %%ymm2, %%ymm2           \n\t"
+            "vpxor %%ymm3, %%ymm3, %%ymm3           \n\t"
+            "vpxor %%ymm4, %%ymm4, %%ymm4           \n\t"
+            "vpxor %%ymm5, %%ymm5, %%ymm5           \n\t"
+            SSIM_ROW_AVX2("(%[m0],%[x])", "(%[r0],%[x])")
+            SSIM_ROW_AVX2("(%[m1],%[x])", "(%[r1],%[x])")
+            SSIM_ROW_AVX2("(%[m2],%[x])", "(%[r2],%[x])")
+            SSIM_ROW_AVX2("(%[m3],%[x])", "(%[r3],%[x])")
+            "vpmaddwd %%ymm7, %%ymm2, %%ymm2        \n\t"
+            "vpmaddwd %%ymm7, %%ymm3, %%ymm3        \n\t"
+            "vpunpckhdq %%ymm3, %%ymm2, %%ymm0      \n\t"
+            "vpunpckldq %%ymm3, %%ymm2, %%ymm2      \n\t"
+            "vpunpckhdq %%ymm4, %%ymm5, %%ymm1      \n\t"
+            "vpunpckldq %%ymm4, %%ymm5, %%ymm5      \n\t"
+            "vpunpckhqdq %%ymm5, %%ymm2, %%ymm3     \n\t"
+            "vpunpcklqdq %%ymm5, %%ymm2, %%ymm2     \n\t"
+            "vpaddd %%ymm3, %%ymm2, %%ymm2          \n\t"
+            "vpunpckhqdq %%ymm1, %%ymm0, %%ymm3     \n\t"
+            "vpunpcklqdq %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpaddd %%ymm3, %%ymm0, %%ymm0          \n\t"
+            "vperm2i128 $0x20, %%ymm0, %%ymm2, %%ymm1 \n\t"
+            "vperm2i128 $0x31, %%ymm0, %%ymm2, %%ymm2 \n\t"
+            "vmovdqu %%ymm1, (%[sums],%[x],2)       \n\t"
+            "vmovdqu %%ymm2, 32(%[sums],%[x],2)     \n\t"
+            "add $32, %[x]                          \n\t"
+            "jl 1b                                  \n\t"
+            "vzeroupper                             \n\t"
+            : [x]"+r"(x)
+            : [m0]"r"(buf + len), [m1]"r"(buf + buf_stride + len),
+              [m2]"r"(buf + 2 * buf_stride + len), [m3]"r"(buf + 3 * buf_stride + len),
+              [r0]"r"(ref + len), [r1]"r"(ref + ref_stride + len),
+              [r2]"r"(ref + 2 * ref_stride + len), [r3]"r"(ref + 3 * ref_stride + len),
+              [sums]"r"(sums + (w & ~3)), [pw_1]"m"(*pw_1)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_ssim_4x4_line_16bit_c(buf + len, buf_stride, ref + len, ref_stride,
+                             sums + (w & ~3), w & 3);
+}
+#endif /* HAVE_AVX2_INLINE */
+#endif /* ARCH_X86_64 && HAVE_INLINE_ASM */
+
+av_cold void ff_ssim_init_x86(SSIMDSPContext *dsp, int bpp)
 {
     int cpu_flags = av_get_cpu_flags();
 
+    if (bpp > 8) {
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+        if (INLINE_SSE2(cpu_flags))
+            dsp->ssim_4x4_line = ssim_4x4_line_16bit_sse2;
+#endif
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+        if (INLINE_AVX2(cpu_flags))
+            dsp->ssim_4x4_line = ssim_4x4_line_16bit_avx2;
+#endif
+        return;
+    }
+
     if (ARCH_X86_64 && EXTERNAL_SSSE3(cpu_flags))
         dsp->ssim_4x4_line = ff_ssim_4x4_line_ssse3;
     if (EXTERNAL_SSE4(cpu_flags))
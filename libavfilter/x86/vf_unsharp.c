@@ -0,0 +1,278 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/unsharp.h"
+
+#if HAVE_SSE2_INLINE
+/* the row is walked from its end, so that buf[x - 1] is still the input of
+ * the pass when buf[x] is computed */
+static void hsum_sse2(uint32_t *buf, int len)
+{
+    const int n = (len - 1) & ~3;
+    x86_reg i = (n - 4) * 4;
+
+    if (n) {
+        __asm__ volatile (
+            "1:                                 \n\t"
+            "movdqu -4(%[buf],%[i]), %%xmm1     \n\t"
+            "movdqu (%[buf],%[i]), %%xmm0       \n\t"
+            "paddd %%xmm1, %%xmm0               \n\t"
+            "movdqu %%xmm0, (%[buf],%[i])       \n\t"
+            "sub $16, %[i]                      \n\t"
+            "jge 1b                             \n\t"
+            : [i]"+r"(i)
+            : [buf]"r"(buf + len - n)
+            : XMM_CLOBBERS("xmm0", "xmm1",) "memory"
+        );
+    }
+    ff_unsharp_hsum_c(buf, len - n);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+static void vsum_sse2(uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                      int nb_stages, int width)
+{
+    x86_reg len = width & ~7;
+    x86_reg i = -len * 4;
+    x86_reg p, k;
+
+    if (len) {
+        __asm__ volatile (
+            "1:                                 \n\t"
+            "movdqu (%[sum],%[i]), %%xmm0       \n\t"
+            "movdqu 16(%[sum],%[i]), %%xmm1     \n\t"
+            "lea (%[sc],%[i]), %[p]             \n\t"
+            "mov %[n], %[k]                     \n\t"
+            "2:                                 \n\t"
+            "movdqu (%[p]), %%xmm2              \n\t"
+            "movdqu 16(%[p]), %%xmm3            \n\t"
+            "movdqu %%xmm0, (%[p])              \n\t"
+            "movdqu %%xmm1, 16(%[p])            \n\t"
+            "paddd %%xmm2, %%xmm0               \n\t"
+            "paddd %%xmm3, %%xmm1               \n\t"
+            "add %[stride], %[p]                \n\t"
+            "sub $1, %[k]                       \n\t"
+            "jg 2b                              \n\t"
+            "movdqu %%xmm0, (%[sum],%[i])       \n\t"
+            "movdqu %%xmm1, 16(%[sum],%[i])     \n\t"
+            "add $32, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i), [p]"=&r"(p), [k]"=&r"(k)
+            : [sum]"r"(sum + len), [sc]"r"(sc + len),
+              [stride]"r"((x86_reg)stride * 4), [n]"r"((x86_reg)nb_stages)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "memory"
+        );
+    }
+    ff_unsharp_vsum_c(sum + len, sc + len, stride, nb_stages, width - len);
+}
+#endif /* ARCH_X86_64 && HAVE_SSE2_INLINE */
+
+#if HAVE_SSE4_INLINE
+static void sharpen_sse4(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                         int width, int amount, int scalebits, uint32_t halfscale)
+{
+    x86_reg len = width & ~7;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[amount], %%xmm5             \n\t"
+            "pshufd $0, %%xmm5, %%xmm5          \n\t"
+            "movd %[half], %%xmm6               \n\t"
+            "pshufd $0, %%xmm6, %%xmm6          \n\t"
+            "movd %[shift], %%xmm7              \n\t"
+            "1:                                 \n\t"
+            "movdqu (%[sum],%[i],4), %%xmm3     \n\t"
+            "movdqu 16(%[sum],%[i],4), %%xmm4   \n\t"
+            "paddd %%xmm6, %%xmm3               \n\t"
+            "paddd %%xmm6, %%xmm4               \n\t"
+            "psrld %%xmm7, %%xmm3               \n\t"
+            "psrld %%xmm7, %%xmm4               \n\t"
+            "pmovzxbd (%[src],%[i]), %%xmm1     \n\t"
+            "pmovzxbd 4(%[src],%[i]), %%xmm2    \n\t"
+            "movdqa %%xmm1, %%xmm0              \n\t"
+            "psubd %%xmm3, %%xmm0               \n\t"
+            "movdqa %%xmm2, %%xmm3              \n\t"
+            "psubd %%xmm4, %%xmm3               \n\t"
+            "pmulld %%xmm5, %%xmm0              \n\t"
+            "pmulld %%xmm5, %%xmm3              \n\t"
+            "psrad $16, %%xmm0                  \n\t"
+            "psrad $16, %%xmm3                  \n\t"
+            "paddd %%xmm1, %%xmm0               \n\t"
+            "paddd %%xmm2, %%xmm3               \n\t"
+            "packssdw %%xmm3, %%xmm0            \n\t"
+            "packuswb %%xmm0, %%xmm0            \n\t"
+            "movq %%xmm0, (%[dst],%[i])         \n\t"
+            "add $8, %[i]                       \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src]"r"(src + len), [sum]"r"(sum + len),
+              [amount]"r"(amount), [half]"r"(halfscale), [shift]"r"(scalebits)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_unsharp_sharpen_c(dst + len, src + len, sum + len, width - len,
+                         amount, scalebits, halfscale);
+}
+#endif /* HAVE_SSE4_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void hsum_avx2(uint32_t *buf, int len)
+{
+    const int n = (len - 1) & ~7;
+    x86_reg i = (n - 8) * 4;
+
+    if (n) {
+        __asm__ volatile (
+            "1:                                         \n\t"
+            "vmovdqu (%[buf],%[i]), %%ymm0              \n\t"
+            "vpaddd -4(%[buf],%[i]), %%ymm0, %%ymm0     \n\t"
+            "vmovdqu %%ymm0, (%[buf],%[i])              \n\t"
+            "sub $32, %[i]                              \n\t"
+            "jge 1b                                     \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [buf]"r"(buf + len - n)
+            : XMM_CLOBBERS("xmm0",) "memory"
+        );
+    }
+    ff_unsharp_hsum_c(buf, len - n);
+}
+
+static void sharpen_avx2(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                         int width, int amount, int scalebits, uint32_t halfscale)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[amount], %%xmm5                    \n\t"
+            "vpbroadcastd %%xmm5, %%ymm5                \n\t"
+            "vmovd %[half], %%xmm6                      \n\t"
+            "vpbroadcastd %%xmm6, %%ymm6                \n\t"
+            "vmovd %[shift], %%xmm7                     \n\t"
+            "1:                                         \n\t"
+            "vpaddd (%[sum],%[i],4), %%ymm6, %%ymm3     \n\t"
+            "vpaddd 32(%[sum],%[i],4), %%ymm6, %%ymm4   \n\t"
+            "vpsrld %%xmm7, %%ymm3, %%ymm3              \n\t"
+            "vpsrld %%xmm7, %%ymm4, %%ymm4              \n\t"
+            "vpmovzxbd (%[src],%[i]), %%ymm1            \n\t"
+            "vpmovzxbd 8(%[src],%[i]), %%ymm2           \n\t"
+            "vpsubd %%ymm3, %%ymm1, %%ymm0              \n\t"
+            "vpsubd %%ymm4, %%ymm2, %%ymm3              \n\t"
+            "vpmulld %%ymm5, %%ymm0, %%ymm0             \n\t"
+            "vpmulld %%ymm5, %%ymm3, %%ymm3             \n\t"
+            "vpsrad $16, %%ymm0, %%ymm0                 \n\t"
+            "vpsrad $16, %%ymm3, %%ymm3                 \n\t"
+            "vpaddd %%ymm1, %%ymm0, %%ymm0              \n\t"
+            "vpaddd %%ymm2, %%ymm3, %%ymm3              \n\t"
+            "vpackssdw %%ymm3, %%ymm0, %%ymm0           \n\t"
+            "vpermq $0xd8, %%ymm0, %%ymm0               \n\t"
+            "vextracti128 $1, %%ymm0, %%xmm3            \n\t"
+            "vpackuswb %%xmm3, %%xmm0, %%xmm0           \n\t"
+            "vmovdqu %%xmm0, (%[dst],%[i])              \n\t"
+            "add $16, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [src]"r"(src + len), [sum]"r"(sum + len),
+              [amount]"r"(amount), [half]"r"(halfscale), [shift]"r"(scalebits)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_unsharp_sharpen_c(dst + len, src + len, sum + len, width - len,
+                         amount, scalebits, halfscale);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+static void vsum_avx2(uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                      int nb_stages, int width)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len * 4;
+    x86_reg p, k;
+
+    if (len) {
+        __asm__ volatile (
+            "1:                                         \n\t"
+            "vmovdqu (%[sum],%[i]), %%ymm0              \n\t"
+            "vmovdqu 32(%[sum],%[i]), %%ymm1            \n\t"
+            "lea (%[sc],%[i]), %[p]                     \n\t"
+            "mov %[n], %[k]                             \n\t"
+            "2:                                         \n\t"
+            "vmovdqu (%[p]), %%ymm2                     \n\t"
+            "vmovdqu 32(%[p]), %%ymm3                   \n\t"
+            "vmovdqu %%ymm0, (%[p])                     \n\t"
+            "vmovdqu %%ymm1, 32(%[p])                   \n\t"
+            "vpaddd %%ymm2, %%ymm0, %%ymm0              \n\t"
+            "vpaddd %%ymm3, %%ymm1, %%ymm1              \n\t"
+            "add %[stride], %[p]                        \n\t"
+            "sub $1, %[k]                               \n\t"
+            "jg 2b                                      \n\t"
+            "vmovdqu %%ymm0, (%[sum],%[i])              \n\t"
+            "vmovdqu %%ymm1, 32(%[sum],%[i])            \n\t"
+            "add $64, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i), [p]"=&r"(p), [k]"=&r"(k)
+            : [sum]"r"(sum + len), [sc]"r"(sc + len),
+              [stride]"r"((x86_reg)stride * 4), [n]"r"((x86_reg)nb_stages)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "memory"
+        );
+    }
+    ff_unsharp_vsum_c(sum + len, sc + len, stride, nb_stages, width - len);
+}
+#endif /* ARCH_X86_64 && HAVE_AVX2_INLINE */
+
+av_cold void ff_unsharp_init_x86(UnsharpDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->hsum = hsum_sse2;
+#endif
+#if ARCH_X86_64 && HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->vsum = vsum_sse2;
+#endif
+#if HAVE_SSE4_INLINE
+    if (INLINE_SSE4(cpu_flags))
+        dsp->sharpen = sharpen_sse4;
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags)) {
+        dsp->hsum    = hsum_avx2;
+        dsp->sharpen = sharpen_avx2;
+    }
+#endif
+#if ARCH_X86_64 && HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        dsp->vsum = vsum_avx2;
+#endif
+}
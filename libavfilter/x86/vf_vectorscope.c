@@ -0,0 +1,136 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/internal.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vf_vectorscope.h"
+
+/* The counts are clipped to 255 (packssdw + pminsw), so the product with
+ * the intensity fits in an unsigned word; adding 0xff00 with unsigned
+ * saturation and subtracting it again clips that to 255 before the final
+ * saturating byte add. */
+
+#if HAVE_SSE2_INLINE
+static void accumulate_sse2(uint8_t *dst, const uint32_t *counts, int width, int intensity)
+{
+    x86_reg len = width & ~15;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "movd %[intensity], %%xmm7          \n\t"
+            "pshuflw $0, %%xmm7, %%xmm7         \n\t"
+            "punpcklqdq %%xmm7, %%xmm7          \n\t"
+            "pcmpeqw %%xmm6, %%xmm6             \n\t"
+            "psllw $8, %%xmm6                   \n\t"
+            "pcmpeqw %%xmm5, %%xmm5             \n\t"
+            "psrlw $8, %%xmm5                   \n\t"
+            "1:                                 \n\t"
+            "movdqu (%[counts],%[i],4), %%xmm0  \n\t"
+            "movdqu 16(%[counts],%[i],4), %%xmm1\n\t"
+            "movdqu 32(%[counts],%[i],4), %%xmm2\n\t"
+            "movdqu 48(%[counts],%[i],4), %%xmm3\n\t"
+            "packssdw %%xmm1, %%xmm0            \n\t"
+            "packssdw %%xmm3, %%xmm2            \n\t"
+            "pminsw %%xmm5, %%xmm0              \n\t"
+            "pminsw %%xmm5, %%xmm2              \n\t"
+            "pmullw %%xmm7, %%xmm0              \n\t"
+            "pmullw %%xmm7, %%xmm2              \n\t"
+            "paddusw %%xmm6, %%xmm0             \n\t"
+            "paddusw %%xmm6, %%xmm2             \n\t"
+            "psubw %%xmm6, %%xmm0               \n\t"
+            "psubw %%xmm6, %%xmm2               \n\t"
+            "packuswb %%xmm2, %%xmm0            \n\t"
+            "movdqu (%[dst],%[i]), %%xmm4       \n\t"
+            "paddusb %%xmm4, %%xmm0             \n\t"
+            "movdqu %%xmm0, (%[dst],%[i])       \n\t"
+            "add $16, %[i]                      \n\t"
+            "jl 1b                              \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [counts]"r"(counts + len),
+              [intensity]"r"(intensity)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_vectorscope_accumulate_c(dst + len, counts + len, width - len, intensity);
+}
+#endif /* HAVE_SSE2_INLINE */
+
+#if HAVE_AVX2_INLINE
+static void accumulate_avx2(uint8_t *dst, const uint32_t *counts, int width, int intensity)
+{
+    x86_reg len = width & ~31;
+    x86_reg i = -len;
+
+    if (len) {
+        __asm__ volatile (
+            "vmovd %[intensity], %%xmm7                 \n\t"
+            "vpbroadcastw %%xmm7, %%ymm7                \n\t"
+            "vpcmpeqw %%ymm6, %%ymm6, %%ymm6            \n\t"
+            "vpsllw $8, %%ymm6, %%ymm6                  \n\t"
+            "vpcmpeqw %%ymm5, %%ymm5, %%ymm5            \n\t"
+            "vpsrlw $8, %%ymm5, %%ymm5                  \n\t"
+            "1:                                         \n\t"
+            "vmovdqu (%[counts],%[i],4), %%ymm0         \n\t"
+            "vmovdqu 64(%[counts],%[i],4), %%ymm2       \n\t"
+            "vpackssdw 32(%[counts],%[i],4), %%ymm0, %%ymm0 \n\t"
+            "vpackssdw 96(%[counts],%[i],4), %%ymm2, %%ymm2 \n\t"
+            "vpermq $0xd8, %%ymm0, %%ymm0               \n\t"
+            "vpermq $0xd8, %%ymm2, %%ymm2               \n\t"
+            "vpminsw %%ymm5, %%ymm0, %%ymm0             \n\t"
+            "vpminsw %%ymm5, %%ymm2, %%ymm2             \n\t"
+            "vpmullw %%ymm7, %%ymm0, %%ymm0             \n\t"
+            "vpmullw %%ymm7, %%ymm2, %%ymm2             \n\t"
+            "vpaddusw %%ymm6, %%ymm0, %%ymm0            \n\t"
+            "vpaddusw %%ymm6, %%ymm2, %%ymm2            \n\t"
+            "vpsubw %%ymm6, %%ymm0, %%ymm0              \n\t"
+            "vpsubw %%ymm6, %%ymm2, %%ymm2              \n\t"
+            "vpackuswb %%ymm2, %%ymm0, %%ymm0           \n\t"
+            "vpermq $0xd8, %%ymm0, %%ymm0               \n\t"
+            "vpaddusb (%[dst],%[i]), %%ymm0, %%ymm0     \n\t"
+            "vmovdqu %%ymm0, (%[dst],%[i])              \n\t"
+            "add $32, %[i]                              \n\t"
+            "jl 1b                                      \n\t"
+            "vzeroupper                                 \n\t"
+            : [i]"+r"(i)
+            : [dst]"r"(dst + len), [counts]"r"(counts + len),
+              [intensity]"r"(intensity)
+            : XMM_CLOBBERS("xmm0", "xmm2", "xmm5", "xmm6", "xmm7",) "memory"
+        );
+    }
+    ff_vectorscope_accumulate_c(dst + len, counts + len, width - len, intensity);
+}
+#endif /* HAVE_AVX2_INLINE */
+
+av_cold void ff_vectorscope_init_x86(VectorscopeDSPContext *dsp)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_SSE2_INLINE
+    if (INLINE_SSE2(cpu_flags))
+        dsp->accumulate = accumulate_sse2;
+#endif
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        dsp->accumulate = accumulate_avx2;
+#endif
+}
@@ -54,6 +54,8 @@ typedef struct Parser {
     void *log_ctx;
 #define VARS 10
     double *var;
+    const double * const *const_arrays;
+    int index;
 } Parser;
 
 static const AVClass eval_class = { "Eval", av_default_item_name, NULL, LIBAVUTIL_VERSION_INT, offsetof(Parser,log_offset), offsetof(Parser,log_ctx) };
@@ -165,8 +167,23 @@ struct AVExpr {
     } a;
     struct AVExpr *param[3];
     double *var;
+    struct ExprInsn *insn;  ///< flattened program, root node only
+    int nb_insn;
+    int pure;
 };
 
+/**
+ * One node of a compiled expression. It reads its parameters from
+ * registers reg, reg + 1 and reg + 2 and writes its result to reg.
+ */
+typedef struct ExprInsn {
+    const AVExpr *e;
+    int reg;
+} ExprInsn;
+
+#define MAX_REGS 32
+#define BATCH_SIZE 32
+
 static double etime(double v)
 {
     return av_gettime() * 0.000001;
@@ -176,7 +193,9 @@ static double eval_expr(Parser *p, AVExpr *e)
 {
     switch (e->type) {
         case e_value:  return e->value;
-        case e_const:  return e->value * p->const_values[e->a.const_index];
+        case e_const:  return e->value * (p->const_arrays && p->const_arrays[e->a.const_index] ?
+                                          p->const_arrays[e->a.const_index][p->index] :
+                                          p->const_values[e->a.const_index]);
         case e_func0:  return e->value * e->a.func0(eval_expr(p, e->param[0]));
         case e_func1:  return e->value * e->a.func1(p->opaque, eval_expr(p, e->param[0]));
         case e_func2:  return e->value * e->a.func2(p->opaque, eval_expr(p, e->param[0]), eval_expr(p, e->param[1]));
@@ -322,6 +341,7 @@ void av_expr_free(AVExpr *e)
     av_expr_free(e->param[1]);
     av_expr_free(e->param[2]);
     av_freep(&e->var);
+    av_freep(&e->insn);
     av_freep(&e);
 }
 
@@ -655,6 +675,50 @@ static int verify_expr(AVExpr *e)
     }
 }
 
+static int is_pure(const AVExpr *e)
+{
+    if (!e)
+        return 1;
+    switch (e->type) {
+    case e_st:
+    case e_random:
+    case e_print:
+    case e_while:
+    case e_taylor:
+    case e_root:
+        return 0;
+    default:
+        return is_pure(e->param[0]) && is_pure(e->param[1]) && is_pure(e->param[2]);
+    }
+}
+
+static int count_nodes(const AVExpr *e)
+{
+    if (!e)
+        return 0;
+    return 1 + count_nodes(e->param[0]) + count_nodes(e->param[1]) + count_nodes(e->param[2]);
+}
+
+/**
+ * Flatten the tree into prog in evaluation order, placing each node in
+ * the first register not holding a pending operand.
+ */
+static int compile_expr(ExprInsn *prog, int *nb_insn, const AVExpr *e, int reg)
+{
+    int i;
+
+    for (i = 0; i < 3 && e->param[i]; i++) {
+        if (reg + i >= MAX_REGS)
+            return AVERROR(ENOSYS);
+        if (compile_expr(prog, nb_insn, e->param[i], reg + i) < 0)
+            return AVERROR(ENOSYS);
+    }
+    prog[*nb_insn].e   = e;
+    prog[*nb_insn].reg = reg;
+    (*nb_insn)++;
+    return 0;
+}
+
 int av_expr_parse(AVExpr **expr, const char *s,
                   const char * const *const_names,
                   const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -702,6 +766,16 @@ int av_expr_parse(AVExpr **expr, const char *s,
         ret = AVERROR(ENOMEM);
         goto end;
     }
+    e->pure = is_pure(e);
+    if (e->pure) {
+        e->insn = av_malloc_array(count_nodes(e), sizeof(*e->insn));
+        if (!e->insn) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        if (compile_expr(e->insn, &e->nb_insn, e, 0) < 0)
+            av_freep(&e->insn);
+    }
     *expr = e;
     e = NULL;
 end:
@@ -720,6 +794,136 @@ double av_expr_eval(AVExpr *e, const double *const_values, void *opaque)
     return eval_expr(&p, e);
 }
 
+#define LOOP1(expr)                     \
+    for (k = 0; k < n; k++) {           \
+        double d  = r0[k];              \
+        r0[k] = expr;                   \
+    }
+
+#define LOOP2(expr)                     \
+    for (k = 0; k < n; k++) {           \
+        double d  = r0[k];              \
+        double d2 = r1[k];              \
+        r0[k] = expr;                   \
+    }
+
+#define LOOP3(expr)                     \
+    for (k = 0; k < n; k++) {           \
+        double d  = r0[k];              \
+        double d2 = r1[k];              \
+        double d3 = r2[k];              \
+        r0[k] = expr;                   \
+    }
+
+static void eval_insn(const ExprInsn *insn, double (*regs)[BATCH_SIZE], int n, int index,
+                      const double *var, const double *const_values,
+                      const double * const *const_arrays, void *opaque)
+{
+    const AVExpr *e = insn->e;
+    double *r0 = regs[insn->reg];
+    double *r1 = regs[insn->reg + 1];
+    double *r2 = regs[insn->reg + 2];
+    int k;
+
+    switch (e->type) {
+    case e_value:
+        for (k = 0; k < n; k++)
+            r0[k] = e->value;
+        break;
+    case e_const:
+        if (const_arrays && const_arrays[e->a.const_index]) {
+            const double *src = const_arrays[e->a.const_index] + index;
+            for (k = 0; k < n; k++)
+                r0[k] = e->value * src[k];
+        } else {
+            for (k = 0; k < n; k++)
+                r0[k] = e->value * const_values[e->a.const_index];
+        }
+        break;
+    case e_func0:  LOOP1(e->value * e->a.func0(d));                              break;
+    case e_func1:  LOOP1(e->value * e->a.func1(opaque, d));                      break;
+    case e_func2:  LOOP2(e->value * e->a.func2(opaque, d, d2));                  break;
+    case e_squish: LOOP1(1/(1+exp(4*d)));                                        break;
+    case e_gauss:  LOOP1(exp(-d*d/2)/sqrt(2*M_PI));                              break;
+    case e_ld:     LOOP1(e->value * var[av_clip(d, 0, VARS-1)]);                 break;
+    case e_isnan:  LOOP1(e->value * !!isnan(d));                                 break;
+    case e_isinf:  LOOP1(e->value * !!isinf(d));                                 break;
+    case e_floor:  LOOP1(e->value * floor(d));                                   break;
+    case e_ceil:   LOOP1(e->value * ceil (d));                                   break;
+    case e_trunc:  LOOP1(e->value * trunc(d));                                   break;
+    case e_sqrt:   LOOP1(e->value * sqrt (d));                                   break;
+    case e_not:    LOOP1(e->value * (d == 0));                                   break;
+    case e_if:
+        if (e->param[2]) LOOP3(e->value * ( d ? d2 : d3))
+        else             LOOP2(e->value * ( d ? d2 : 0))
+        break;
+    case e_ifnot:
+        if (e->param[2]) LOOP3(e->value * (!d ? d2 : d3))
+        else             LOOP2(e->value * (!d ? d2 : 0))
+        break;
+    case e_clip:
+        LOOP3(isnan(d2) || isnan(d3) || isnan(d) || d2 > d3 ? NAN : e->value * av_clipd(d, d2, d3));
+        break;
+    case e_between: LOOP3(e->value * (d >= d2 && d <= d3));                     break;
+    case e_mod:    LOOP2(e->value * (d - floor((!CONFIG_FTRAPV || d2) ? d / d2 : d * INFINITY) * d2)); break;
+    case e_gcd:    LOOP2(e->value * av_gcd(d,d2));                               break;
+    case e_max:    LOOP2(e->value * (d >  d2 ?   d : d2));                       break;
+    case e_min:    LOOP2(e->value * (d <  d2 ?   d : d2));                       break;
+    case e_eq:     LOOP2(e->value * (d == d2 ? 1.0 : 0.0));                      break;
+    case e_gt:     LOOP2(e->value * (d >  d2 ? 1.0 : 0.0));                      break;
+    case e_gte:    LOOP2(e->value * (d >= d2 ? 1.0 : 0.0));                      break;
+    case e_lt:     LOOP2(e->value * (d <  d2 ? 1.0 : 0.0));                      break;
+    case e_lte:    LOOP2(e->value * (d <= d2 ? 1.0 : 0.0));                      break;
+    case e_pow:    LOOP2(e->value * pow(d, d2));                                 break;
+    case e_mul:    LOOP2(e->value * (d * d2));                                   break;
+    case e_div:    LOOP2(e->value * ((!CONFIG_FTRAPV || d2 ) ? (d / d2) : d * INFINITY)); break;
+    case e_add:    LOOP2(e->value * (d + d2));                                   break;
+    case e_last:
+        for (k = 0; k < n; k++)
+            r0[k] = e->value * r1[k];
+        break;
+    case e_hypot:  LOOP2(e->value * hypot(d, d2));                               break;
+    case e_bitand: LOOP2(isnan(d) || isnan(d2) ? NAN : e->value * ((long int)d & (long int)d2)); break;
+    case e_bitor:  LOOP2(isnan(d) || isnan(d2) ? NAN : e->value * ((long int)d | (long int)d2)); break;
+    default:
+        for (k = 0; k < n; k++)
+            r0[k] = NAN;
+        break;
+    }
+}
+
+void av_expr_eval_array(AVExpr *e, double *res, int nb,
+                        const double *const_values, const double * const *const_arrays,
+                        void *opaque)
+{
+    double regs[MAX_REGS + 2][BATCH_SIZE];
+    int i, j;
+
+    if (!e->insn) {
+        Parser p = { 0 };
+        p.var          = e->var;
+        p.const_values = const_values;
+        p.const_arrays = const_arrays;
+        p.opaque       = opaque;
+        for (p.index = 0; p.index < nb; p.index++)
+            res[p.index] = eval_expr(&p, e);
+        return;
+    }
+
+    for (i = 0; i < nb; i += BATCH_SIZE) {
+        const int n = FFMIN(nb - i, BATCH_SIZE);
+
+        for (j = 0; j < e->nb_insn; j++)
+            eval_insn(&e->insn[j], regs, n, i, e->var, const_values, const_arrays, opaque);
+        memcpy(res + i, regs[0], n * sizeof(*res));
+    }
+}
+
+int av_expr_is_pure(const AVExpr *e)
+{
+    return e->pure;
+}
+
 int av_expr_parse_and_eval(double *d, const char *s,
                            const char * const *const_names, const double *const_values,
                            const char * const *func1_names, double (* const *funcs1)(void *, double),
@@ -86,6 +86,38 @@ int av_expr_parse(AVExpr **expr, const char *s,
  */
 double av_expr_eval(AVExpr *e, const double *const_values, void *opaque);
 
+/**
+ * Evaluate a previously parsed expression nb times, with some of the
+ * constants taking a different value for each evaluation.
+ *
+ * Expressions for which av_expr_is_pure() returns 1 are evaluated over
+ * blocks of values at once, which is much faster than calling av_expr_eval()
+ * in a loop. The functions from funcs1 and funcs2 are then called for all
+ * the values of a block, including those for which the result is discarded
+ * by if() or ifnot(), so they must only depend on their arguments.
+ *
+ * @param res array where the nb results are stored
+ * @param nb number of evaluations
+ * @param const_values a zero terminated array of values for the identifiers from av_expr_parse() const_names
+ * @param const_arrays NULL, or an array with one entry for each identifier from
+ *                     av_expr_parse() const_names, either NULL to use the value
+ *                     from const_values or an array of nb values
+ * @param opaque a pointer which will be passed to all functions from funcs1 and funcs2
+ */
+void av_expr_eval_array(AVExpr *e, double *res, int nb,
+                        const double *const_values, const double * const *const_arrays,
+                        void *opaque);
+
+/**
+ * Check whether an expression has no side effects, i.e. does not use st(),
+ * random(), print(), while(), taylor() or root(). Such an expression can be
+ * evaluated in any order and from several threads at once, provided the
+ * functions from funcs1 and funcs2 allow it too.
+ *
+ * @return 1 if the expression has no side effects, 0 otherwise
+ */
+int av_expr_is_pure(const AVExpr *e);
+
 /**
  * Free a parsed expression previously created with av_expr_parse().
  */
@@ -20,6 +20,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "libavutil/common.h"
 #include "libavutil/libm.h"
 #include "libavutil/timer.h"
 #include "libavutil/eval.h"
@@ -36,6 +37,33 @@ static const char *const const_names[] = {
     0
 };
 
+/* check that av_expr_eval_array() matches av_expr_eval() */
+static void check_eval_array(const char *s)
+{
+    AVExpr *e0 = NULL, *e1 = NULL;
+    double pis[41], res[41], values[3];
+    const double *arrays[3] = { pis, NULL, NULL };
+    int i;
+
+    if (av_expr_parse(&e0, s, const_names, NULL, NULL, NULL, NULL, 0, NULL) >= 0 &&
+        av_expr_parse(&e1, s, const_names, NULL, NULL, NULL, NULL, 0, NULL) >= 0) {
+        for (i = 0; i < FF_ARRAY_ELEMS(pis); i++)
+            pis[i] = M_PI * (i - 20) / 7;
+        av_expr_eval_array(e1, res, FF_ARRAY_ELEMS(res), const_values, arrays, NULL);
+        memcpy(values, const_values, sizeof(values));
+        for (i = 0; i < FF_ARRAY_ELEMS(pis); i++) {
+            double d;
+
+            values[0] = pis[i];
+            d = av_expr_eval(e0, values, NULL);
+            if (d != res[i] && !(isnan(d) && isnan(res[i])))
+                printf("av_expr_eval_array mismatch at %d: %f != %f\n", i, res[i], d);
+        }
+    }
+    av_expr_free(e0);
+    av_expr_free(e1);
+}
+
 int main(int argc, char **argv)
 {
     int i;
@@ -152,6 +180,7 @@ int main(int argc, char **argv)
             printf("'%s' -> %f\n\n", *expr, d);
         if (ret < 0)
             printf("av_expr_parse_and_eval failed\n");
+        check_eval_array(*expr);
     }
 
     ret = av_expr_parse_and_eval(&d, "1+(5-2)^(3-1)+1/2+sin(PI)-max(-2.2,-3.1)",
@@ -19,6 +19,7 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/internal.h"
 #include "swresample_internal.h"
 
 #include "noise_shaping_data.c"
@@ -81,6 +82,8 @@ av_cold int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AV
     int i;
     double scale = 0;
 
+    s->dither.noise_shaping_8 = NULL;
+
     if (s->dither.method > SWR_DITHER_TRIANGULAR_HIGHPASS && s->dither.method <= SWR_DITHER_NS)
         return AVERROR(EINVAL);
 
@@ -128,9 +131,14 @@ av_cold int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AV
         s->dither.method = SWR_DITHER_TRIANGULAR_HIGHPASS;
     }
 
+    if (ARCH_X86)
+        swri_dither_init_x86(&s->dither);
+
     return 0;
 }
 
+#define NS_BLOCK 64
+
 #define TEMPLATE_DITHER_S16
 #include "dither_template.c"
 #undef TEMPLATE_DITHER_S16
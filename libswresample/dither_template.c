@@ -40,6 +40,73 @@
 ERROR
 #endif
 
+/**
+ * Noise shaping through noise_shaping_8(), with the channels handled in
+ * groups of 8. The unused lanes of a short group stay silent.
+ */
+static void RENAME(noise_shaping_8)(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count){
+    LOCAL_ALIGNED_32(double, src,    [NS_BLOCK * 8]);
+    LOCAL_ALIGNED_32(double, dst,    [NS_BLOCK * 8]);
+    LOCAL_ALIGNED_32(float,  noise,  [NS_BLOCK * 8]);
+    LOCAL_ALIGNED_32(float,  errors, [2 * NS_TAPS * 8]);
+    LOCAL_ALIGNED_32(float,  coeffs, [(NS_TAPS + 1) * 8]);
+    int pos = s->dither.ns_pos;
+    int i, j, k, ch;
+    int taps  = s->dither.ns_taps;
+    float S   = s->dither.ns_scale;
+    float S_1 = s->dither.ns_scale_1;
+
+    for (j = 0; j <= taps; j++)
+        for (k = 0; k < 8; k++)
+            coeffs[8 * j + k] = j < taps ? s->dither.ns_coeffs[j] : 0;
+
+    for (ch = 0; ch < srcs->ch_count; ch += 8) {
+        int nb_ch = FFMIN(srcs->ch_count - ch, 8);
+        const DELEM *srcp[8];
+        const float *noisep[8];
+
+        if (nb_ch < 8) {
+            memset(src,    0, NS_BLOCK * 8 * sizeof(*src));
+            memset(noise,  0, NS_BLOCK * 8 * sizeof(*noise));
+            memset(errors, 0, 2 * NS_TAPS * 8 * sizeof(*errors));
+        }
+        for (k = 0; k < nb_ch; k++) {
+            srcp[k]   = (const DELEM*)srcs->ch[ch + k];
+            noisep[k] = ((const float *)noises->ch[ch + k]) + s->dither.noise_pos;
+            for (j = 0; j < 2 * taps; j++)
+                errors[8 * j + k] = s->dither.ns_errors[ch + k][j];
+        }
+
+        pos = s->dither.ns_pos;
+        for (i = 0; i < count; i += NS_BLOCK) {
+            int n = FFMIN(count - i, NS_BLOCK);
+
+            for (j = 0; j < n; j++) {
+                for (k = 0; k < nb_ch; k++) {
+                    src  [8 * j + k] = srcp  [k][i + j]*S_1;
+                    noise[8 * j + k] = noisep[k][i + j];
+                }
+            }
+            pos = s->dither.noise_shaping_8(errors, coeffs, src, noise, dst, n, taps, pos);
+            for (k = 0; k < nb_ch; k++) {
+                DELEM *dstp = (DELEM*)dsts->ch[ch + k];
+                for (j = 0; j < n; j++) {
+                    double d1 = dst[8 * j + k];
+                    d1 *= S;
+                    CLIP(d1);
+                    dstp[i + j] = d1;
+                }
+            }
+        }
+
+        for (k = 0; k < nb_ch; k++)
+            for (j = 0; j < 2 * taps; j++)
+                s->dither.ns_errors[ch + k][j] = errors[8 * j + k];
+    }
+
+    s->dither.ns_pos = pos;
+}
+
 void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count){
     int pos = s->dither.ns_pos;
     int i, j, ch;
@@ -50,6 +117,11 @@ void RENAME(swri_noise_shaping)(SwrContext *s, AudioData *dsts, const AudioData
     av_assert2((taps&3) != 2);
     av_assert2((taps&3) != 3 || s->dither.ns_coeffs[taps] == 0);
 
+    if (s->dither.noise_shaping_8 && srcs->ch_count > 1) {
+        RENAME(noise_shaping_8)(s, dsts, srcs, noises, count);
+        return;
+    }
+
     for (ch=0; ch<srcs->ch_count; ch++) {
         const float *noise = ((const float *)noises->ch[ch]) + s->dither.noise_pos;
         const DELEM *src = (const DELEM*)srcs->ch[ch];
@@ -357,12 +357,75 @@ av_cold static int auto_matrix(SwrContext *s)
     return 0;
 }
 
+static int mix_n_4_coeff_size(enum AVSampleFormat fmt){
+    return fmt == AV_SAMPLE_FMT_DBLP ? sizeof(double) : sizeof(float);
+}
+
+/**
+ * Group the output channels which mix more than two inputs by four, for
+ * mix_n_4_simd, and collect the inputs used by each group.
+ */
+static av_cold int init_mix_n_4(SwrContext *s, int nb_in, int nb_out){
+    int i, j, k, g = 0, n = 0, off = 0;
+
+    s->mix_n_4_groups = 0;
+    for (i = 0; i < nb_out; i++) {
+        if (s->matrix_ch[i][0] <= 2)
+            continue;
+        s->mix_n_4_out[g][n++] = i;
+        if (n == 4) {
+            g++;
+            n = 0;
+        }
+    }
+    if (n) {
+        for (; n < 4; n++)
+            s->mix_n_4_out[g][n] = s->mix_n_4_out[g][n - 1];
+        g++;
+    }
+    if (!g)
+        return 0;
+
+    s->mix_n_4_matrix = av_calloc(g * nb_in * 4, mix_n_4_coeff_size(s->midbuf.fmt));
+    if (!s->mix_n_4_matrix)
+        return AVERROR(ENOMEM);
+
+    for (n = 0; n < g; n++) {
+        uint8_t *in = s->mix_n_4_in[n];
+        in[0] = 0;
+        for (j = 0; j < nb_in; j++) {
+            for (k = 0; k < 4; k++)
+                if (s->matrix[s->mix_n_4_out[n][k]][j])
+                    break;
+            if (k < 4)
+                in[++in[0]] = j;
+        }
+        for (j = 0; j < in[0]; j++) {
+            for (k = 0; k < 4; k++) {
+                int out_i = s->mix_n_4_out[n][k];
+                int idx   = (off + j) * 4 + k;
+                if (s->midbuf.fmt == AV_SAMPLE_FMT_FLTP)
+                    ((float  *)s->mix_n_4_matrix)[idx] = s->matrix[out_i][in[1 + j]];
+                else if (s->midbuf.fmt == AV_SAMPLE_FMT_DBLP)
+                    ((double *)s->mix_n_4_matrix)[idx] = s->matrix[out_i][in[1 + j]];
+                else
+                    ((int    *)s->mix_n_4_matrix)[idx] = s->matrix32[out_i][in[1 + j]];
+            }
+        }
+        off += in[0];
+    }
+    s->mix_n_4_groups = g;
+    return 0;
+}
+
 av_cold int swri_rematrix_init(SwrContext *s){
-    int i, j;
+    int i, j, ret;
     int nb_in  = av_get_channel_layout_nb_channels(s->in_ch_layout);
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
 
     s->mix_any_f = NULL;
+    s->mix_n_4_simd = NULL;
+    s->mix_n_4_groups = 0;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -447,8 +510,13 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
-    if(HAVE_YASM && HAVE_MMX)
-        return swri_rematrix_init_x86(s);
+    if (ARCH_X86) {
+        ret = swri_rematrix_init_x86(s);
+        if (ret < 0)
+            return ret;
+    }
+    if (s->mix_n_4_simd)
+        return init_mix_n_4(s, nb_in, nb_out);
 
     return 0;
 }
@@ -458,12 +526,14 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->mix_n_4_matrix);
 }
 
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
     int out_i, in_i, i, j;
     int len1 = 0;
     int off = 0;
+    int len_any = 0;
 
     if(s->mix_any_f) {
         s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
@@ -478,6 +548,22 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
     av_assert0(!s->out_ch_layout || out->ch_count == av_get_channel_layout_nb_channels(s->out_ch_layout));
     av_assert0(!s-> in_ch_layout || in ->ch_count == av_get_channel_layout_nb_channels(s-> in_ch_layout));
 
+    if(s->mix_n_4_groups && len >= 16){
+        uint8_t *coeffp = s->mix_n_4_matrix;
+        len_any = len&~15;
+        for(i=0; i<s->mix_n_4_groups; i++){
+            const uint8_t *in_ch[SWR_CH_MAX];
+            uint8_t *out_ch[4];
+            int nb_in = s->mix_n_4_in[i][0];
+            for(j=0; j<4; j++)
+                out_ch[j]= out->ch[s->mix_n_4_out[i][j]];
+            for(j=0; j<nb_in; j++)
+                in_ch[j]= in->ch[s->mix_n_4_in[i][1+j]];
+            s->mix_n_4_simd(out_ch, in_ch, coeffp, nb_in, len_any);
+            coeffp += nb_in * 4 * mix_n_4_coeff_size(s->int_sample_fmt);
+        }
+    }
+
     for(out_i=0; out_i<out->ch_count; out_i++){
         switch(s->matrix_ch[out_i][0]){
         case 0:
@@ -509,7 +595,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             break;}
         default:
             if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
+                for(i=len_any; i<len; i++){
                     float v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -518,7 +604,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                     ((float*)out->ch[out_i])[i]= v;
                 }
             }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
+                for(i=len_any; i<len; i++){
                     double v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -527,7 +613,7 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                     ((double*)out->ch[out_i])[i]= v;
                 }
             }else{
-                for(i=0; i<len; i++){
+                for(i=len_any; i<len; i++){
                     int v=0;
                     for(j=0; j<s->matrix_ch[out_i][0]; j++){
                         in_i= s->matrix_ch[out_i][1+j];
@@ -503,7 +503,38 @@ static int swri_resample(ResampleContext *c,
     return dst_size;
 }
 
-static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
+/* Minimum number of filter taps times output samples per channel for which
+ * waking up the worker threads pays off. */
+#define MIN_THREADED_WORK (1 << 15)
+
+typedef struct ResampleThreadData {
+    ResampleContext *c;
+    ResampleContext last;   ///< private copy updated by the last channel
+    AudioData *dst, *src;
+    int dst_size, src_size;
+    int need_emms;
+    int consumed, ret;
+} ResampleThreadData;
+
+static int resample_channel(void *arg, int ch, int nb_ch)
+{
+    ResampleThreadData *td = arg;
+    int consumed;
+
+    if (ch + 1 == nb_ch) {
+        td->ret = swri_resample(&td->last, td->dst->ch[ch], td->src->ch[ch],
+                                &td->consumed, td->src_size, td->dst_size, 1);
+    } else {
+        swri_resample(td->c, td->dst->ch[ch], td->src->ch[ch],
+                      &consumed, td->src_size, td->dst_size, 0);
+    }
+    if (td->need_emms)
+        emms_c();
+    return 0;
+}
+
+static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed,
+                             struct SwrThreadContext *thread){
     int i, ret= -1;
     int av_unused mm_flags = av_get_cpu_flags();
     int need_emms = c->format == AV_SAMPLE_FMT_S16P && ARCH_X86_32 &&
@@ -514,9 +545,31 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         dst_size = FFMIN(dst_size, c->compensation_distance);
     src_size = FFMIN(src_size, max_src_size);
 
-    for(i=0; i<dst->ch_count; i++){
-        ret= swri_resample(c, dst->ch[i], src->ch[i],
-                           consumed, src_size, dst_size, i+1==dst->ch_count);
+    if (thread && dst->ch_count > 1 &&
+        (int64_t)dst_size * c->filter_length >= MIN_THREADED_WORK) {
+        /* Channels only read the context, except the last one which
+         * updates the phase; it works on a copy so the others are not
+         * disturbed, and the copy is written back once all are done. */
+        ResampleThreadData td = {
+            .c         = c,
+            .last      = *c,
+            .dst       = dst,
+            .src       = src,
+            .dst_size  = dst_size,
+            .src_size  = src_size,
+            .need_emms = need_emms,
+        };
+        swri_thread_execute(thread, resample_channel, &td, dst->ch_count);
+        c->index  = td.last.index;
+        c->frac   = td.last.frac;
+        *consumed = td.consumed;
+        ret       = td.ret;
+        need_emms = 0;
+    } else {
+        for(i=0; i<dst->ch_count; i++){
+            ret= swri_resample(c, dst->ch[i], src->ch[i],
+                               consumed, src_size, dst_size, i+1==dst->ch_count);
+        }
     }
     if(need_emms)
         emms_c();
@@ -114,6 +114,17 @@ static void free_temp(AudioData *a){
     memset(a, 0, sizeof(*a));
 }
 
+#if !HAVE_THREADS
+int swri_thread_init(SwrContext *s, int nb_channels)
+{
+    return 0;
+}
+
+void swri_thread_free(SwrContext *s)
+{
+}
+#endif
+
 static void clear_context(SwrContext *s){
     s->in_buffer_index= 0;
     s->in_buffer_count= 0;
@@ -132,6 +143,7 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    swri_thread_free(s);
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
@@ -366,6 +378,8 @@ av_assert0(s->out.ch_count);
 
     if(s->resample){
         set_audiodata_fmt(&s->in_buffer, s->int_sample_fmt);
+        if (s->engine == SWR_ENGINE_SWR && (ret = swri_thread_init(s, s->in_buffer.ch_count)) < 0)
+            goto fail;
     }
 
     av_assert0(!s->preout.count);
@@ -507,7 +521,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
         int ret, size, consumed;
         if(!s->resample_in_constraint && s->in_buffer_count){
             buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed);
+            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &tmp, s->in_buffer_count, &consumed, s->thread);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
@@ -527,7 +541,7 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
 
         if((s->flushed || in_count > padless) && !s->in_buffer_count){
             s->in_buffer_index=0;
-            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed);
+            ret= s->resampler->multiple_resample(s->resample, &out, out_count, &in, FFMAX(in_count-padless, 0), &consumed, s->thread);
             out_count -= ret;
             ret_sum += ret;
             buf_set(&out, &out, ret);
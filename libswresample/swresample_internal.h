@@ -42,6 +42,13 @@ typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, vo
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
+/**
+ * Mix nb_in input channels into 4 output channels.
+ * coeffp holds 4 consecutive coefficients (one per output) for each input,
+ * len is a multiple of 16.
+ */
+typedef void (mix_n_4_func_type)(uint8_t **out, const uint8_t **in, const void *coeffp, integer nb_in, integer len);
+
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
     uint8_t *data;              ///< samples buffer
@@ -63,15 +70,27 @@ struct DitherContext {
     int ns_pos;                                     ///< Noise shaping dither position
     float ns_coeffs[NS_TAPS];                       ///< Noise shaping filter coefficients
     float ns_errors[SWR_CH_MAX][2*NS_TAPS];
+
+    /**
+     * Noise shape 8 channels at once.
+     * errors holds the 2*ns_taps error history of each channel interleaved,
+     * coeffs each filter coefficient repeated 8 times, src and noise the
+     * scaled input and the noise interleaved. Stores the rounded samples
+     * into dst and returns the new ns_pos.
+     */
+    int (*noise_shaping_8)(float *errors, const float *coeffs, const double *src,
+                           const float *noise, double *dst, int count, int taps, int pos);
     AudioData noise;                                ///< noise used for dithering
     AudioData temp;                                 ///< temporary storage when writing into the input buffer isn't possible
     int output_sample_bits;                         ///< the number of used output bits, needed to scale dither correctly
 };
 
+struct SwrThreadContext;
+
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
-typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
+typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed, struct SwrThreadContext *thread);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
 typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
@@ -167,6 +186,8 @@ struct SwrContext {
     struct AudioConvert *full_convert;              ///< full conversion context (single conversion for input and output)
     struct ResampleContext *resample;               ///< resampling context
     struct Resampler const *resampler;              ///< resampler virtual function table
+    int nb_threads;                                 ///< number of threads used to resample channels, 0 for auto
+    struct SwrThreadContext *thread;                ///< worker threads resampling channels, NULL when unthreaded
 
     float matrix[SWR_CH_MAX][SWR_CH_MAX];           ///< floating point rematrixing coefficients
     uint8_t *native_matrix;
@@ -183,6 +204,12 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_4_func_type *mix_n_4_simd;
+    int mix_n_4_groups;                             ///< number of output channel groups mixed by mix_n_4_simd
+    uint8_t mix_n_4_out[SWR_CH_MAX/4][4];           ///< output channels of each group, short groups repeat their last channel
+    uint8_t mix_n_4_in[SWR_CH_MAX/4][SWR_CH_MAX+1]; ///< Lists of input channels with a non zero coefficient in each group
+    uint8_t *mix_n_4_matrix;                        ///< mix_n_4_simd coefficients of all groups, in native format
+
     /* TODO: callbacks for ASM optimizations */
 };
 
@@ -194,6 +221,21 @@ void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 
+typedef int (swri_thread_func)(void *arg, int jobnr, int nb_jobs);
+
+/**
+ * Start the resampling worker threads for nb_channels channels, according to
+ * the threads option. s->thread stays NULL if a single thread is used.
+ */
+av_warn_unused_result
+int swri_thread_init(SwrContext *s, int nb_channels);
+void swri_thread_free(SwrContext *s);
+/**
+ * Run func for jobs 0 to nb_jobs-1 on the worker threads and wait for all
+ * of them to finish.
+ */
+void swri_thread_execute(struct SwrThreadContext *c, swri_thread_func *func, void *arg, int nb_jobs);
+
 av_warn_unused_result
 int swri_rematrix_init(SwrContext *s);
 void swri_rematrix_free(SwrContext *s);
@@ -202,6 +244,8 @@ int swri_rematrix_init_x86(struct SwrContext *s);
 
 av_warn_unused_result
 int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
+void swri_dither_init_x86(struct DitherContext *c);
+
 av_warn_unused_result
 int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt);
 
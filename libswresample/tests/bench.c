@@ -0,0 +1,298 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Resampler and dither throughput benchmark.
+ *
+ * Resamples one channel for every filter length and phase count combination
+ * and reports the output rate in MSamples/s, once with the C code and once
+ * with the CPU optimizations, together with the largest output difference.
+ *
+ * With -dither, converts to s16 with the given dither method instead, for
+ * several channel counts.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
+
+#include "libswresample/swresample.h"
+
+static const int filter_sizes[] = { 16, 32, 64, 128 };
+static const int phase_shifts[] = { 8, 10, 12 };
+static const int channels[]     = { 1, 2, 6, 8 };
+
+static double get(const uint8_t *p, enum AVSampleFormat fmt, int i)
+{
+    switch (av_get_packed_sample_fmt(fmt)) {
+    case AV_SAMPLE_FMT_S16: return ((const int16_t *)p)[i] / 32768.0;
+    case AV_SAMPLE_FMT_S32: return ((const int32_t *)p)[i] / 2147483648.0;
+    case AV_SAMPLE_FMT_FLT: return ((const float   *)p)[i];
+    case AV_SAMPLE_FMT_DBL: return ((const double  *)p)[i];
+    default:                return 0;
+    }
+}
+
+static void set(uint8_t *p, enum AVSampleFormat fmt, int i, double v)
+{
+    switch (av_get_packed_sample_fmt(fmt)) {
+    case AV_SAMPLE_FMT_S16: ((int16_t *)p)[i] = lrint(v * 32767);      break;
+    case AV_SAMPLE_FMT_S32: ((int32_t *)p)[i] = lrint(v * 2147483647); break;
+    case AV_SAMPLE_FMT_FLT: ((float   *)p)[i] = v;                     break;
+    case AV_SAMPLE_FMT_DBL: ((double  *)p)[i] = v;                     break;
+    default:                                                           break;
+    }
+}
+
+/*
+ * Resamples src once into dst for comparison, then times further runs over
+ * the same input. Returns the output rate in MSamples/s, or a negative value
+ * on error.
+ */
+static double run(const uint8_t *src, int src_samples, uint8_t *dst, int dst_cap,
+                  int *dst_samples, enum AVSampleFormat fmt, int in_rate,
+                  int out_rate, int filter_size, int phase_shift, int linear,
+                  int cpu_flags, int runs)
+{
+    struct SwrContext *swr;
+    uint8_t *tmp = av_malloc_array(dst_cap, av_get_bytes_per_sample(fmt));
+    int64_t t = 0, samples = 0;
+    int i, ret = AVERROR(ENOMEM);
+
+    av_force_cpu_flags(cpu_flags);
+    swr = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_MONO, fmt, out_rate,
+                             AV_CH_LAYOUT_MONO, fmt, in_rate, 0, NULL);
+    if (!swr || !tmp)
+        goto end;
+    av_opt_set_int(swr, "filter_size",   filter_size, 0);
+    av_opt_set_int(swr, "phase_shift",   phase_shift, 0);
+    av_opt_set_int(swr, "linear_interp", linear,      0);
+    if ((ret = swr_init(swr)) < 0)
+        goto end;
+
+    ret = swr_convert(swr, &dst, dst_cap, &src, src_samples);
+    *dst_samples = ret;
+
+    t = av_gettime_relative();
+    for (i = 0; i < runs && ret >= 0; i++) {
+        ret = swr_convert(swr, &tmp, dst_cap, &src, src_samples);
+        samples += ret;
+    }
+    t = av_gettime_relative() - t;
+
+end:
+    swr_free(&swr);
+    av_free(tmp);
+    av_force_cpu_flags(-1);
+    return ret < 0 ? -1 : (double)samples / FFMAX(t, 1);
+}
+
+/*
+ * Converts nb_ch channels of src to s16 with dithering, once into dst for
+ * comparison and then timed. Returns the output rate in MSamples/s per
+ * channel, or a negative value on error.
+ */
+static double run_dither(const uint8_t *src, int samples, uint8_t *dst, int nb_ch,
+                         enum AVSampleFormat fmt, int rate, const char *method,
+                         int cpu_flags, int runs)
+{
+    struct SwrContext *swr;
+    const uint8_t *in[8];
+    uint8_t *out[8];
+    int16_t *tmp = av_malloc_array(samples, nb_ch * sizeof(*tmp));
+    int64_t t = 0, done = 0;
+    int i, ret = AVERROR(ENOMEM);
+
+    av_force_cpu_flags(cpu_flags);
+    swr = swr_alloc_set_opts(NULL, av_get_default_channel_layout(nb_ch), AV_SAMPLE_FMT_S16P, rate,
+                             av_get_default_channel_layout(nb_ch), fmt, rate, 0, NULL);
+    if (!swr || !tmp)
+        goto end;
+    if ((ret = av_opt_set(swr, "dither_method", method, 0)) < 0 ||
+        (ret = swr_init(swr)) < 0)
+        goto end;
+
+    for (i = 0; i < nb_ch; i++) {
+        in[i]  = src;
+        out[i] = dst + i * samples * sizeof(int16_t);
+    }
+    ret = swr_convert(swr, out, samples, in, samples);
+
+    for (i = 0; i < nb_ch; i++)
+        out[i] = (uint8_t *)(tmp + i * samples);
+    t = av_gettime_relative();
+    for (i = 0; i < runs && ret >= 0; i++) {
+        ret = swr_convert(swr, out, samples, in, samples);
+        done += ret;
+    }
+    t = av_gettime_relative() - t;
+
+end:
+    swr_free(&swr);
+    av_free(tmp);
+    av_force_cpu_flags(-1);
+    return ret < 0 ? -1 : (double)done / FFMAX(t, 1);
+}
+
+static int bench_dither(const uint8_t *src, int samples, enum AVSampleFormat fmt,
+                        int rate, const char *method, int runs)
+{
+    uint8_t *dst_c    = av_malloc_array(samples, 8 * sizeof(int16_t));
+    uint8_t *dst_simd = av_malloc_array(samples, 8 * sizeof(int16_t));
+    int c, i, ret = 0;
+
+    if (!dst_c || !dst_simd) {
+        ret = 1;
+        goto end;
+    }
+
+    printf("%s -> s16p, %d Hz, %s dither, %d run(s) of 1 s\n",
+           av_get_sample_fmt_name(fmt), rate, method, runs);
+    printf("%8s %11s %11s %8s %10s\n", "channels", "C MS/s", "SIMD MS/s", "speedup", "max diff");
+
+    for (c = 0; c < FF_ARRAY_ELEMS(channels); c++) {
+        double t_c, t_simd;
+        int diff = 0;
+
+        t_c    = run_dither(src, samples, dst_c,    channels[c], fmt, rate, method, 0,  runs);
+        t_simd = run_dither(src, samples, dst_simd, channels[c], fmt, rate, method, -1, runs);
+        if (t_c < 0 || t_simd < 0) {
+            fprintf(stderr, "dithering failed\n");
+            ret = 1;
+            goto end;
+        }
+        for (i = 0; i < samples * channels[c]; i++)
+            diff = FFMAX(diff, abs(((int16_t *)dst_c)[i] - ((int16_t *)dst_simd)[i]));
+
+        printf("%8d %11.2f %11.2f %7.2fx %10d\n", channels[c], t_c, t_simd, t_simd / t_c, diff);
+    }
+
+end:
+    av_free(dst_c);
+    av_free(dst_simd);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dither = NULL;
+    enum AVSampleFormat fmt = AV_SAMPLE_FMT_FLTP;
+    int in_rate  = 48000;
+    int out_rate = 44100;
+    int runs     = 10;
+    int src_samples, dst_cap, bps;
+    uint8_t *src = NULL, *dst_c = NULL, *dst_simd = NULL;
+    int i, f, p, linear, ret = 0;
+    AVLFG rand;
+
+    for (i = 1; i < argc; i += 2) {
+        if (argv[i][0] != '-' || i + 1 == argc)
+            goto bad_option;
+        if (!strcmp(argv[i], "-fmt")) {
+            fmt = av_get_planar_sample_fmt(av_get_sample_fmt(argv[i + 1]));
+            if (fmt != AV_SAMPLE_FMT_S16P && fmt != AV_SAMPLE_FMT_S32P &&
+                fmt != AV_SAMPLE_FMT_FLTP && fmt != AV_SAMPLE_FMT_DBLP) {
+                fprintf(stderr, "invalid sample format %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-in")) {
+            in_rate = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-out")) {
+            out_rate = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-runs")) {
+            runs = FFMAX(atoi(argv[i + 1]), 1);
+        } else if (!strcmp(argv[i], "-dither")) {
+            dither = argv[i + 1];
+        } else {
+bad_option:
+            fprintf(stderr, "bad option or argument missing (%s)\n"
+                    "usage: %s [-fmt s16|s32|flt|dbl] [-in rate] [-out rate] [-runs n] [-dither method]\n",
+                    argv[i], argv[0]);
+            return 1;
+        }
+    }
+    if (in_rate <= 0 || out_rate <= 0) {
+        fprintf(stderr, "invalid sample rate\n");
+        return 1;
+    }
+
+    bps         = av_get_bytes_per_sample(fmt);
+    src_samples = in_rate;
+    dst_cap     = av_rescale(src_samples, out_rate, in_rate) + 256;
+    src         = av_malloc_array(src_samples, bps);
+    dst_c       = av_malloc_array(dst_cap, bps);
+    dst_simd    = av_malloc_array(dst_cap, bps);
+    if (!src || !dst_c || !dst_simd) {
+        ret = 1;
+        goto end;
+    }
+
+    av_lfg_init(&rand, 1);
+    for (i = 0; i < src_samples; i++)
+        set(src, fmt, i, 0.5 * sin(i * 0.0731) + 0.2 * sin(i * 1.13) +
+                         0.1 * ((int)av_lfg_get(&rand) / 2147483648.0));
+
+    if (dither) {
+        ret = bench_dither(src, src_samples, fmt, out_rate, dither, runs);
+        goto end;
+    }
+
+    printf("%s, %d -> %d Hz, %d run(s) of 1 s\n", av_get_sample_fmt_name(fmt),
+           in_rate, out_rate, runs);
+    printf("%-6s %5s %6s %11s %11s %8s %10s\n", "interp", "taps", "phases",
+           "C MS/s", "SIMD MS/s", "speedup", "max diff");
+
+    for (linear = 0; linear < 2; linear++)
+    for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++)
+    for (p = 0; p < FF_ARRAY_ELEMS(phase_shifts); p++) {
+        int n_c, n_simd;
+        double c, simd, diff = 0;
+
+        c    = run(src, src_samples, dst_c, dst_cap, &n_c, fmt, in_rate, out_rate,
+                   filter_sizes[f], phase_shifts[p], linear, 0, runs);
+        simd = run(src, src_samples, dst_simd, dst_cap, &n_simd, fmt, in_rate, out_rate,
+                   filter_sizes[f], phase_shifts[p], linear, -1, runs);
+        if (c < 0 || simd < 0 || n_c != n_simd) {
+            fprintf(stderr, "resampling failed\n");
+            ret = 1;
+            goto end;
+        }
+        for (i = 0; i < n_c; i++)
+            diff = FFMAX(diff, fabs(get(dst_c, fmt, i) - get(dst_simd, fmt, i)));
+
+        printf("%-6s %5d %6d %11.2f %11.2f %7.2fx %10.3g\n",
+               linear ? "linear" : "none", filter_sizes[f], 1 << phase_shifts[p],
+               c, simd, simd / c, diff);
+    }
+
+end:
+    av_free(src);
+    av_free(dst_c);
+    av_free(dst_simd);
+    return ret;
+}
@@ -0,0 +1,138 @@
+/*
+ * This file is part of libswresample
+ *
+ * libswresample is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * libswresample is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libswresample; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/asm.h"
+#include "libavutil/x86/cpu.h"
+#include "libswresample/swresample_internal.h"
+
+#if HAVE_AVX_INLINE && ARCH_X86_64
+
+/*
+ * One lane per channel. The error filter is evaluated in single precision
+ * in groups of 4 taps and subtracted in double precision, in the same order
+ * as the C code, so the output is identical.
+ */
+static int noise_shaping_8_avx(float *errors, const float *coeffs, const double *src,
+                               const float *noise, double *dst, int count, int taps, int pos)
+{
+    x86_reg groups = taps > 2 ? (taps + 1) >> 2 : 0;
+    x86_reg rem    = 4 * groups < taps;
+    x86_reg len    = count;
+    x86_reg ntaps  = taps;
+    x86_reg p      = pos;
+    x86_reg e, c, j;
+
+    __asm__ volatile (
+        "1:                                        \n\t"
+        "vmovapd   (%[src]), %%ymm0                \n\t"
+        "vmovapd 32(%[src]), %%ymm1                \n\t"
+        "mov %[p], %[e]                            \n\t"
+        "shl $5, %[e]                              \n\t"
+        "add %[errors], %[e]                       \n\t"
+        "mov %[coeffs], %[c]                       \n\t"
+        "mov %[groups], %[j]                       \n\t"
+        "test %[j], %[j]                           \n\t"
+        "jz 3f                                     \n\t"
+        "2:                                        \n\t"
+        "vmovaps   (%[e]), %%ymm2                  \n\t"
+        "vmulps    (%[c]), %%ymm2, %%ymm2          \n\t"
+        "vmovaps 32(%[e]), %%ymm3                  \n\t"
+        "vmulps  32(%[c]), %%ymm3, %%ymm3          \n\t"
+        "vaddps %%ymm3, %%ymm2, %%ymm2             \n\t"
+        "vmovaps 64(%[e]), %%ymm3                  \n\t"
+        "vmulps  64(%[c]), %%ymm3, %%ymm3          \n\t"
+        "vaddps %%ymm3, %%ymm2, %%ymm2             \n\t"
+        "vmovaps 96(%[e]), %%ymm3                  \n\t"
+        "vmulps  96(%[c]), %%ymm3, %%ymm3          \n\t"
+        "vaddps %%ymm3, %%ymm2, %%ymm2             \n\t"
+        "vextractf128 $1, %%ymm2, %%xmm3           \n\t"
+        "vcvtps2pd %%xmm2, %%ymm2                  \n\t"
+        "vcvtps2pd %%xmm3, %%ymm3                  \n\t"
+        "vsubpd %%ymm2, %%ymm0, %%ymm0             \n\t"
+        "vsubpd %%ymm3, %%ymm1, %%ymm1             \n\t"
+        "add $128, %[e]                            \n\t"
+        "add $128, %[c]                            \n\t"
+        "dec %[j]                                  \n\t"
+        "jnz 2b                                    \n\t"
+        "3:                                        \n\t"
+        "mov %[rem], %[j]                          \n\t"
+        "test %[j], %[j]                           \n\t"
+        "jz 4f                                     \n\t"
+        "vmovaps   (%[e]), %%ymm2                  \n\t"
+        "vmulps    (%[c]), %%ymm2, %%ymm2          \n\t"
+        "vextractf128 $1, %%ymm2, %%xmm3           \n\t"
+        "vcvtps2pd %%xmm2, %%ymm2                  \n\t"
+        "vcvtps2pd %%xmm3, %%ymm3                  \n\t"
+        "vsubpd %%ymm2, %%ymm0, %%ymm0             \n\t"
+        "vsubpd %%ymm3, %%ymm1, %%ymm1             \n\t"
+        "4:                                        \n\t"
+        "test %[p], %[p]                           \n\t"
+        "jnz 5f                                    \n\t"
+        "mov %[ntaps], %[p]                        \n\t"
+        "5:                                        \n\t"
+        "dec %[p]                                  \n\t"
+        /* d1 = rint(d + noise), error = d1 - d */
+        "vcvtps2pd   (%[noise]), %%ymm2            \n\t"
+        "vcvtps2pd 16(%[noise]), %%ymm3            \n\t"
+        "vaddpd %%ymm2, %%ymm0, %%ymm2             \n\t"
+        "vaddpd %%ymm3, %%ymm1, %%ymm3             \n\t"
+        "vroundpd $4, %%ymm2, %%ymm2               \n\t"
+        "vroundpd $4, %%ymm3, %%ymm3               \n\t"
+        "vmovapd %%ymm2,   (%[dst])                \n\t"
+        "vmovapd %%ymm3, 32(%[dst])                \n\t"
+        "vsubpd %%ymm0, %%ymm2, %%ymm2             \n\t"
+        "vsubpd %%ymm1, %%ymm3, %%ymm3             \n\t"
+        "vcvtpd2ps %%ymm2, %%xmm2                  \n\t"
+        "vcvtpd2ps %%ymm3, %%xmm3                  \n\t"
+        "vinsertf128 $1, %%xmm3, %%ymm2, %%ymm2    \n\t"
+        "mov %[p], %[e]                            \n\t"
+        "shl $5, %[e]                              \n\t"
+        "add %[errors], %[e]                       \n\t"
+        "mov %[ntaps], %[c]                        \n\t"
+        "shl $5, %[c]                              \n\t"
+        "vmovaps %%ymm2, (%[e])                    \n\t"
+        "vmovaps %%ymm2, (%[e], %[c])              \n\t"
+        "add $64, %[src]                           \n\t"
+        "add $32, %[noise]                         \n\t"
+        "add $64, %[dst]                           \n\t"
+        "dec %[len]                                \n\t"
+        "jnz 1b                                    \n\t"
+        "vzeroupper                                \n\t"
+        : [src]"+r"(src), [noise]"+r"(noise), [dst]"+r"(dst), [len]"+r"(len),
+          [p]"+r"(p), [e]"=&r"(e), [c]"=&r"(c), [j]"=&r"(j)
+        : [errors]"r"(errors), [coeffs]"m"(coeffs), [groups]"m"(groups),
+          [rem]"m"(rem), [ntaps]"m"(ntaps)
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",) "memory"
+    );
+
+    return p;
+}
+
+#endif /* HAVE_AVX_INLINE && ARCH_X86_64 */
+
+av_cold void swri_dither_init_x86(struct DitherContext *c)
+{
+    av_unused int cpu_flags = av_get_cpu_flags();
+
+#if HAVE_AVX_INLINE && ARCH_X86_64
+    if (INLINE_AVX(cpu_flags))
+        c->noise_shaping_8 = noise_shaping_8_avx;
+#endif
+}
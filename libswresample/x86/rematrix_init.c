@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/attributes.h"
+#include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libswresample/swresample_internal.h"
 
@@ -30,9 +32,147 @@ D(float, avx)
 D(int16, mmx)
 D(int16, sse2)
 
+#if HAVE_AVX_INLINE && ARCH_X86_64
+
+/* The 4 output channels are accumulated in ymm0-7, two registers each. The
+ * products are added in input order without fusing, so the result is the
+ * same as the C code. */
+
+#define MIX_N_4_MUL(c, acc)                                             \
+    MUL" %%ymm"#c", %%ymm8, %%ymm14                \n\t"                \
+    MUL" %%ymm"#c", %%ymm9, %%ymm15                \n\t"                \
+    ADD" %%ymm14, %%ymm"#acc", %%ymm"#acc"         \n\t"                \
+    ADD" %%ymm15, %%ymm1"#acc", %%ymm1"#acc"       \n\t"
+
+#define MIX_N_4(LOAD, LOAD_OFF, BCAST, COEFF_SIZE, STORE, STEP)         \
+    "1:                                            \n\t"                \
+    "vxorps %%ymm0, %%ymm0, %%ymm0                 \n\t"                \
+    "vxorps %%ymm1, %%ymm1, %%ymm1                 \n\t"                \
+    "vxorps %%ymm2, %%ymm2, %%ymm2                 \n\t"                \
+    "vxorps %%ymm3, %%ymm3, %%ymm3                 \n\t"                \
+    "vxorps %%ymm10, %%ymm10, %%ymm10              \n\t"                \
+    "vxorps %%ymm11, %%ymm11, %%ymm11              \n\t"                \
+    "vxorps %%ymm12, %%ymm12, %%ymm12              \n\t"                \
+    "vxorps %%ymm13, %%ymm13, %%ymm13              \n\t"                \
+    "mov %[coeffp], %[c]                           \n\t"                \
+    "mov %[in], %[p]                               \n\t"                \
+    "mov %[nb_in], %[j]                            \n\t"                \
+    "2:                                            \n\t"                \
+    "mov (%[p]), %[ptr]                            \n\t"                \
+    LOAD"           (%[ptr], %[i]), %%ymm8         \n\t"                \
+    LOAD" "LOAD_OFF"(%[ptr], %[i]), %%ymm9         \n\t"                \
+    BCAST" 0*"COEFF_SIZE"(%[c]), %%ymm4            \n\t"                \
+    BCAST" 1*"COEFF_SIZE"(%[c]), %%ymm5            \n\t"                \
+    BCAST" 2*"COEFF_SIZE"(%[c]), %%ymm6            \n\t"                \
+    BCAST" 3*"COEFF_SIZE"(%[c]), %%ymm7            \n\t"                \
+    MIX_N_4_MUL(4, 0)                                                   \
+    MIX_N_4_MUL(5, 1)                                                   \
+    MIX_N_4_MUL(6, 2)                                                   \
+    MIX_N_4_MUL(7, 3)                                                   \
+    "add $4*"COEFF_SIZE", %[c]                     \n\t"                \
+    "add $8, %[p]                                  \n\t"                \
+    "dec %[j]                                      \n\t"                \
+    "jg 2b                                         \n\t"                \
+    STORE(0, 10, out0)                                                  \
+    STORE(1, 11, out1)                                                  \
+    STORE(2, 12, out2)                                                  \
+    STORE(3, 13, out3)                                                  \
+    "add $"STEP", %[i]                             \n\t"                \
+    "cmp %[len], %[i]                              \n\t"                \
+    "jl 1b                                         \n\t"                \
+    "vzeroupper                                    \n\t"
+
+#define STORE_FLT(a, b, out)                                            \
+    "mov %["#out"], %[ptr]                         \n\t"                \
+    "vmovups %%ymm"#a", (%[ptr], %[i])             \n\t"                \
+    "vmovups %%ymm"#b", 32(%[ptr], %[i])           \n\t"
+
+/* ((v + 16384) >> 15) truncated to 16 bits, as in the C code */
+#define STORE_S16(a, b, out)                                            \
+    "vpbroadcastd %[round], %%ymm15                \n\t"                \
+    "vpaddd %%ymm15, %%ymm"#a", %%ymm"#a"          \n\t"                \
+    "vpaddd %%ymm15, %%ymm"#b", %%ymm"#b"          \n\t"                \
+    "vpslld $1, %%ymm"#a", %%ymm"#a"               \n\t"                \
+    "vpslld $1, %%ymm"#b", %%ymm"#b"               \n\t"                \
+    "vpsrad $16, %%ymm"#a", %%ymm"#a"              \n\t"                \
+    "vpsrad $16, %%ymm"#b", %%ymm"#b"              \n\t"                \
+    "vpackssdw %%ymm"#b", %%ymm"#a", %%ymm"#a"     \n\t"                \
+    "vpermq $0xd8, %%ymm"#a", %%ymm"#a"            \n\t"                \
+    "mov %["#out"], %[ptr]                         \n\t"                \
+    "vmovdqu %%ymm"#a", (%[ptr], %[i])             \n\t"
+
+#define MIX_N_4_OPERANDS                                                \
+    : [i]"+&r"(i), [c]"=&r"(c), [p]"=&r"(p), [j]"=&r"(j), [ptr]"=&r"(ptr) \
+    : [coeffp]"m"(coeffp), [in]"m"(in), [nb_in]"m"(nb_in), [len]"r"(len),  \
+      [out0]"m"(out[0]), [out1]"m"(out[1]),                             \
+      [out2]"m"(out[2]), [out3]"m"(out[3])
+
+#define MIX_N_4_CLOBBERS                                                \
+    : XMM_CLOBBERS("xmm0",  "xmm1",  "xmm2",  "xmm3",                   \
+                   "xmm4",  "xmm5",  "xmm6",  "xmm7",                   \
+                   "xmm8",  "xmm9",  "xmm10", "xmm11",                  \
+                   "xmm12", "xmm13", "xmm14", "xmm15",)                 \
+      "memory"
+
+static void mix_n_4_float_avx(uint8_t **out, const uint8_t **in,
+                              const void *coeffp, integer nb_in, integer len)
+{
+    x86_reg i = 0, c, p, j, ptr;
+
+    len *= sizeof(float);
+#define MUL "vmulps"
+#define ADD "vaddps"
+    __asm__ volatile (
+        MIX_N_4("vmovups", "32", "vbroadcastss", "4", STORE_FLT, "64")
+        MIX_N_4_OPERANDS
+        MIX_N_4_CLOBBERS
+    );
+#undef MUL
+#undef ADD
+}
+
+static void mix_n_4_double_avx(uint8_t **out, const uint8_t **in,
+                               const void *coeffp, integer nb_in, integer len)
+{
+    x86_reg i = 0, c, p, j, ptr;
+
+    len *= sizeof(double);
+#define MUL "vmulpd"
+#define ADD "vaddpd"
+    __asm__ volatile (
+        MIX_N_4("vmovupd", "32", "vbroadcastsd", "8", STORE_FLT, "64")
+        MIX_N_4_OPERANDS
+        MIX_N_4_CLOBBERS
+    );
+#undef MUL
+#undef ADD
+}
+
+#if HAVE_AVX2_INLINE
+static void mix_n_4_int16_avx2(uint8_t **out, const uint8_t **in,
+                               const void *coeffp, integer nb_in, integer len)
+{
+    static const int32_t round = 16384;
+    x86_reg i = 0, c, p, j, ptr;
+
+    len *= sizeof(int16_t);
+#define MUL "vpmulld"
+#define ADD "vpaddd"
+    __asm__ volatile (
+        MIX_N_4("vpmovsxwd", "16", "vpbroadcastd", "4", STORE_S16, "32")
+        MIX_N_4_OPERANDS, [round]"m"(round)
+        MIX_N_4_CLOBBERS
+    );
+#undef MUL
+#undef ADD
+}
+#endif
+
+#endif /* HAVE_AVX_INLINE && ARCH_X86_64 */
+
 av_cold int swri_rematrix_init_x86(struct SwrContext *s){
+    av_unused int mm_flags = av_get_cpu_flags();
 #if HAVE_YASM
-    int mm_flags = av_get_cpu_flags();
     int nb_in  = av_get_channel_layout_nb_channels(s->in_ch_layout);
     int nb_out = av_get_channel_layout_nb_channels(s->out_ch_layout);
     int num    = nb_in * nb_out;
@@ -86,5 +226,16 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
     }
 #endif
 
+#if HAVE_AVX_INLINE && ARCH_X86_64
+    if (s->midbuf.fmt == AV_SAMPLE_FMT_FLTP && INLINE_AVX(mm_flags))
+        s->mix_n_4_simd = mix_n_4_float_avx;
+    if (s->midbuf.fmt == AV_SAMPLE_FMT_DBLP && INLINE_AVX(mm_flags))
+        s->mix_n_4_simd = mix_n_4_double_avx;
+#if HAVE_AVX2_INLINE
+    if (s->midbuf.fmt == AV_SAMPLE_FMT_S16P && INLINE_AVX2(mm_flags))
+        s->mix_n_4_simd = mix_n_4_int16_avx2;
+#endif
+#endif
+
     return 0;
 }
@@ -25,6 +25,10 @@
  * @author Michael Niedermayer <michaelni@gmx.at>
  */
 
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/x86/asm.h"
 #include "libavutil/x86/cpu.h"
 #include "libswresample/resample.h"
 
@@ -43,6 +47,181 @@ RESAMPLE_FUNCS(float,  fma3);
 RESAMPLE_FUNCS(float,  fma4);
 RESAMPLE_FUNCS(double, sse2);
 
+#if HAVE_AVX2_INLINE && HAVE_FMA3_INLINE && ARCH_X86_64
+
+DECLARE_ALIGNED(32, static const int32_t, dword_index)[8] = {
+    0, 1, 2, 3, 4, 5, 6, 7
+};
+
+#define MAIN_LOAD(addr, reg) "vmovups        "addr", %%ymm"reg"                  \n\t"
+#define TAIL_LOAD(addr, reg) "vmaskmovps     "addr", %%ymm15, %%ymm"reg"         \n\t"
+
+#define KEEP(x) x
+#define DROP(x)
+
+/* acc += src (ymm8) * filter (reg), for each sample type */
+#define MAC_FLOAT(reg, acc)                                                     \
+    "vfmadd231ps    %%ymm"reg", %%ymm8, %%ymm"acc"                  \n\t"
+#define MAC_DOUBLE(reg, acc)                                                    \
+    "vfmadd231pd    %%ymm"reg", %%ymm8, %%ymm"acc"                  \n\t"
+#define MAC_INT16(reg, acc)                                                     \
+    "vpmaddwd       %%ymm"reg", %%ymm8, %%ymm10                     \n\t"       \
+    "vpaddd         %%ymm10, %%ymm"acc", %%ymm"acc"                 \n\t"
+#define MAC_INT32(reg, acc)                                                     \
+    "vpmuldq        %%ymm"reg", %%ymm8, %%ymm10                     \n\t"       \
+    "vpaddq         %%ymm10, %%ymm"acc", %%ymm"acc"                 \n\t"       \
+    "vpsrlq         $32, %%ymm8, %%ymm12                            \n\t"       \
+    "vpsrlq         $32, %%ymm"reg", %%ymm13                        \n\t"       \
+    "vpmuldq        %%ymm13, %%ymm12, %%ymm10                       \n\t"       \
+    "vpaddq         %%ymm10, %%ymm"acc", %%ymm"acc"                 \n\t"
+
+/* Horizontally adds accumulators a, b, c, d and stores the four sums. */
+#define SUM4_FLOAT(a, b, c, d, out)                                             \
+    "vhaddps        %%ymm"b", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vhaddps        %%ymm"d", %%ymm"c", %%ymm"c"                    \n\t"       \
+    "vhaddps        %%ymm"c", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vextractf128   $1, %%ymm"a", %%xmm9                            \n\t"       \
+    "vaddps         %%xmm9, %%xmm"a", %%xmm"a"                      \n\t"       \
+    "vmovups        %%xmm"a", "out"                                 \n\t"
+#define SUM4_INT16(a, b, c, d, out)                                             \
+    "vphaddd        %%ymm"b", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vphaddd        %%ymm"d", %%ymm"c", %%ymm"c"                    \n\t"       \
+    "vphaddd        %%ymm"c", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vextracti128   $1, %%ymm"a", %%xmm9                            \n\t"       \
+    "vpaddd         %%xmm9, %%xmm"a", %%xmm"a"                      \n\t"       \
+    "vmovdqu        %%xmm"a", "out"                                 \n\t"
+#define SUM4_DOUBLE(a, b, c, d, out)                                            \
+    "vhaddpd        %%ymm"b", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vhaddpd        %%ymm"d", %%ymm"c", %%ymm"c"                    \n\t"       \
+    "vperm2f128     $0x20, %%ymm"c", %%ymm"a", %%ymm9               \n\t"       \
+    "vperm2f128     $0x31, %%ymm"c", %%ymm"a", %%ymm"a"             \n\t"       \
+    "vaddpd         %%ymm9, %%ymm"a", %%ymm"a"                      \n\t"       \
+    "vmovupd        %%ymm"a", "out"                                 \n\t"
+#define SUM4_INT32(a, b, c, d, out)                                             \
+    "vpunpcklqdq    %%ymm"b", %%ymm"a", %%ymm9                      \n\t"       \
+    "vpunpckhqdq    %%ymm"b", %%ymm"a", %%ymm"a"                    \n\t"       \
+    "vpaddq         %%ymm9, %%ymm"a", %%ymm"a"                      \n\t"       \
+    "vpunpcklqdq    %%ymm"d", %%ymm"c", %%ymm9                      \n\t"       \
+    "vpunpckhqdq    %%ymm"d", %%ymm"c", %%ymm"c"                    \n\t"       \
+    "vpaddq         %%ymm9, %%ymm"c", %%ymm"c"                      \n\t"       \
+    "vperm2i128     $0x20, %%ymm"c", %%ymm"a", %%ymm9               \n\t"       \
+    "vperm2i128     $0x31, %%ymm"c", %%ymm"a", %%ymm"a"             \n\t"       \
+    "vpaddq         %%ymm9, %%ymm"a", %%ymm"a"                      \n\t"       \
+    "vmovdqu        %%ymm"a", "out"                                 \n\t"
+
+#define DOT_STEP(LOAD, MAC, LINEAR, k, acc, acc2)                               \
+    LOAD("(%[s"#k"], %[i])", "8")                                               \
+    LOAD("(%[f"#k"], %[i])", "9")                                               \
+    MAC("9", acc)                                                               \
+    LINEAR(LOAD("(%[f"#k"], %[i2])", "11") MAC("11", acc2))
+
+#define DOT_BLOCK(LOAD, MAC, LINEAR)                                            \
+    DOT_STEP(LOAD, MAC, LINEAR, 0, "0", "4")                                    \
+    DOT_STEP(LOAD, MAC, LINEAR, 1, "1", "5")                                    \
+    DOT_STEP(LOAD, MAC, LINEAR, 2, "2", "6")                                    \
+    DOT_STEP(LOAD, MAC, LINEAR, 3, "3", "7")
+
+/**
+ * Computes the dot products of four source/filter pairs, and with LINEAR
+ * also of the four filters of the next phase, filter_alloc elements later.
+ * Whole 32-byte blocks are loaded directly, the remainder with a dword mask
+ * so that nothing past the filter length is read.
+ */
+#define DOT4_ASM(FELEM2, MAC, SUM4, LINEAR, tail_bytes)                         \
+    __asm__ volatile(                                                           \
+        "vmovd          %[tail], %%xmm15                            \n\t"       \
+        "vpbroadcastd   %%xmm15, %%ymm15                            \n\t"       \
+        "vpcmpgtd       %[idx], %%ymm15, %%ymm15                    \n\t"       \
+        "vpxor          %%ymm0, %%ymm0, %%ymm0                      \n\t"       \
+        "vpxor          %%ymm1, %%ymm1, %%ymm1                      \n\t"       \
+        "vpxor          %%ymm2, %%ymm2, %%ymm2                      \n\t"       \
+        "vpxor          %%ymm3, %%ymm3, %%ymm3                      \n\t"       \
+        LINEAR("vpxor   %%ymm4, %%ymm4, %%ymm4                      \n\t"       \
+               "vpxor   %%ymm5, %%ymm5, %%ymm5                      \n\t"       \
+               "vpxor   %%ymm6, %%ymm6, %%ymm6                      \n\t"       \
+               "vpxor   %%ymm7, %%ymm7, %%ymm7                      \n\t")      \
+        "cmp            %[end], %[i]                                \n\t"       \
+        "jge            2f                                          \n\t"       \
+        "1:                                                         \n\t"       \
+        DOT_BLOCK(MAIN_LOAD, MAC, LINEAR)                                       \
+        "add            $32, %[i]                                   \n\t"       \
+        LINEAR("add     $32, %[i2]                                  \n\t")      \
+        "cmp            %[end], %[i]                                \n\t"       \
+        "jl             1b                                          \n\t"       \
+        "2:                                                         \n\t"       \
+        "cmp            %[len], %[i]                                \n\t"       \
+        "jge            3f                                          \n\t"       \
+        DOT_BLOCK(TAIL_LOAD, MAC, LINEAR)                                       \
+        "3:                                                         \n\t"       \
+        SUM4("0", "1", "2", "3", "%[sum]")                                      \
+        LINEAR(SUM4("4", "5", "6", "7", "%[sum2]"))                             \
+        "vzeroupper                                                 \n\t"       \
+        : [i] "+r"(i), [i2] "+r"(i2), [sum] "=m"(*(FELEM2 (*)[4])val),          \
+          [sum2] "=m"(*(FELEM2 (*)[4])val2)                                     \
+        : [s0] "r"(s[0]), [s1] "r"(s[1]), [s2] "r"(s[2]), [s3] "r"(s[3]),       \
+          [f0] "r"(f[0]), [f1] "r"(f[1]), [f2] "r"(f[2]), [f3] "r"(f[3]),       \
+          [end] "g"(end), [len] "g"(end + (tail_bytes)),                        \
+          [tail] "rm"((int)(tail_bytes) >> 2), [idx] "m"(dword_index)           \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",          \
+                       "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11",        \
+                       "xmm12", "xmm13", "xmm15",) "memory")
+
+#define DOT4_FUNCS(type, DELEM, FELEM2, MAC, SUM4)                              \
+static av_always_inline void dot4_ ## type ## _avx2(const DELEM *const s[4],    \
+                                                    const DELEM *const f[4],    \
+                                                    int len, FELEM2 val[4])     \
+{                                                                               \
+    x86_reg i = 0, i2 = 0, bytes = len * sizeof(DELEM), end = bytes & ~31;      \
+    FELEM2 *val2 = val;                                                         \
+                                                                                \
+    DOT4_ASM(FELEM2, MAC, SUM4, DROP, (bytes - end) & ~3);                      \
+    if (sizeof(DELEM) == 2 && len & 1) {                                        \
+        int k;                                                                  \
+        for (k = 0; k < 4; k++)                                                 \
+            val[k] += s[k][len - 1] * (FELEM2)f[k][len - 1];                    \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+static av_always_inline void dot4_linear_ ## type ## _avx2(                     \
+    const DELEM *const s[4], const DELEM *const f[4], int len, int alloc,       \
+    FELEM2 val[4], FELEM2 val2[4])                                              \
+{                                                                               \
+    x86_reg i = 0, i2 = alloc * sizeof(DELEM);                                  \
+    x86_reg bytes = len * sizeof(DELEM), end = bytes & ~31;                     \
+                                                                                \
+    DOT4_ASM(FELEM2, MAC, SUM4, KEEP, (bytes - end) & ~3);                      \
+    if (sizeof(DELEM) == 2 && len & 1) {                                        \
+        int k;                                                                  \
+        for (k = 0; k < 4; k++) {                                               \
+            val[k]  += s[k][len - 1] * (FELEM2)f[k][len - 1];                   \
+            val2[k] += s[k][len - 1] * (FELEM2)f[k][len - 1 + alloc];           \
+        }                                                                       \
+    }                                                                           \
+}
+
+DOT4_FUNCS(int16,  int16_t, int32_t, MAC_INT16,  SUM4_INT16)
+DOT4_FUNCS(int32,  int32_t, int64_t, MAC_INT32,  SUM4_INT32)
+DOT4_FUNCS(float,  float,   float,   MAC_FLOAT,  SUM4_FLOAT)
+DOT4_FUNCS(double, double,  double,  MAC_DOUBLE, SUM4_DOUBLE)
+
+#define TEMPLATE_RESAMPLE_S16
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_S16
+
+#define TEMPLATE_RESAMPLE_S32
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_S32
+
+#define TEMPLATE_RESAMPLE_FLT
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_FLT
+
+#define TEMPLATE_RESAMPLE_DBL
+#include "resample_template.c"
+#undef TEMPLATE_RESAMPLE_DBL
+
+#endif /* HAVE_AVX2_INLINE && HAVE_FMA3_INLINE && ARCH_X86_64 */
+
 av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
 {
     int av_unused mm_flags = av_get_cpu_flags();
@@ -87,4 +266,27 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
         }
         break;
     }
+
+#if HAVE_AVX2_INLINE && HAVE_FMA3_INLINE && ARCH_X86_64
+    if (INLINE_AVX2(mm_flags) && INLINE_FMA3(mm_flags)) {
+        switch (c->format) {
+        case AV_SAMPLE_FMT_S16P:
+            c->dsp.resample = c->linear ? resample_linear_int16_avx2
+                                        : resample_common_int16_avx2;
+            break;
+        case AV_SAMPLE_FMT_S32P:
+            c->dsp.resample = c->linear ? resample_linear_int32_avx2
+                                        : resample_common_int32_avx2;
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            c->dsp.resample = c->linear ? resample_linear_float_avx2
+                                        : resample_common_float_avx2;
+            break;
+        case AV_SAMPLE_FMT_DBLP:
+            c->dsp.resample = c->linear ? resample_linear_double_avx2
+                                        : resample_common_double_avx2;
+            break;
+        }
+    }
+#endif
 }
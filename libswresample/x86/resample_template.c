@@ -0,0 +1,208 @@
+/*
+ * audio resampling
+ * Copyright (c) 2004-2012 Michael Niedermayer <michaelni@gmx.at>
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * audio resampling, computing four output samples per iteration
+ * @author Michael Niedermayer <michaelni@gmx.at>
+ *
+ * The output phases are stepped in C exactly as in the generic template;
+ * RENAME(dot4) and RENAME(dot4_linear) compute the filter dot products of
+ * four output samples at once.
+ */
+
+#if defined(TEMPLATE_RESAMPLE_DBL)
+
+#    define RENAME(N) N ## _double_avx2
+#    define FILTER_SHIFT 0
+#    define DELEM  double
+#    define FELEM  double
+#    define FELEM2 double
+#    define OUT(d, v) d = v
+
+#elif    defined(TEMPLATE_RESAMPLE_FLT)
+
+#    define RENAME(N) N ## _float_avx2
+#    define FILTER_SHIFT 0
+#    define DELEM  float
+#    define FELEM  float
+#    define FELEM2 float
+#    define OUT(d, v) d = v
+
+#elif defined(TEMPLATE_RESAMPLE_S32)
+
+#    define RENAME(N) N ## _int32_avx2
+#    define FILTER_SHIFT 30
+#    define DELEM  int32_t
+#    define FELEM  int32_t
+#    define FELEM2 int64_t
+#    define OUT(d, v) (v) = ((v) + (1<<(FILTER_SHIFT-1)))>>FILTER_SHIFT;\
+                      (d) = av_clipl_int32(v)
+
+#elif    defined(TEMPLATE_RESAMPLE_S16)
+
+#    define RENAME(N) N ## _int16_avx2
+#    define FILTER_SHIFT 15
+#    define DELEM  int16_t
+#    define FELEM  int16_t
+#    define FELEM2 int32_t
+#    define FELEML int64_t
+#    define OUT(d, v) (v) = ((v) + (1<<(FILTER_SHIFT-1)))>>FILTER_SHIFT;\
+                      (d) = av_clip_int16(v)
+
+#endif
+
+static int RENAME(resample_common)(ResampleContext *c,
+                                   void *dest, const void *source,
+                                   int n, int update_ctx)
+{
+    DELEM *dst = dest;
+    const DELEM *src = source;
+    int dst_index;
+    int index= c->index;
+    int frac= c->frac;
+    int sample_index = 0;
+
+    while (index >= c->phase_count) {
+        sample_index++;
+        index -= c->phase_count;
+    }
+
+    for (dst_index = 0; dst_index < n; dst_index += 4) {
+        const DELEM *s[4];
+        const FELEM *filter[4];
+        FELEM2 val[4];
+        int k, m = FFMIN(n - dst_index, 4);
+
+        for (k = 0; k < m; k++) {
+            s[k]      = src + sample_index;
+            filter[k] = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+
+            frac  += c->dst_incr_mod;
+            index += c->dst_incr_div;
+            if (frac >= c->src_incr) {
+                frac -= c->src_incr;
+                index++;
+            }
+
+            while (index >= c->phase_count) {
+                sample_index++;
+                index -= c->phase_count;
+            }
+        }
+        /* pad a short last group with copies of its first output */
+        for (; k < 4; k++) {
+            s[k]      = s[0];
+            filter[k] = filter[0];
+        }
+
+        RENAME(dot4)(s, filter, c->filter_length, val);
+        for (k = 0; k < m; k++) {
+            OUT(dst[dst_index + k], val[k]);
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
+static int RENAME(resample_linear)(ResampleContext *c,
+                                   void *dest, const void *source,
+                                   int n, int update_ctx)
+{
+    DELEM *dst = dest;
+    const DELEM *src = source;
+    int dst_index;
+    int index= c->index;
+    int frac= c->frac;
+    int sample_index = 0;
+#if FILTER_SHIFT == 0
+    double inv_src_incr = 1.0 / c->src_incr;
+#endif
+
+    while (index >= c->phase_count) {
+        sample_index++;
+        index -= c->phase_count;
+    }
+
+    for (dst_index = 0; dst_index < n; dst_index += 4) {
+        const DELEM *s[4];
+        const FELEM *filter[4];
+        FELEM2 val[4], v2[4];
+        int fr[4];
+        int k, m = FFMIN(n - dst_index, 4);
+
+        for (k = 0; k < m; k++) {
+            s[k]      = src + sample_index;
+            filter[k] = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+            fr[k]     = frac;
+
+            frac += c->dst_incr_mod;
+            index += c->dst_incr_div;
+            if (frac >= c->src_incr) {
+                frac -= c->src_incr;
+                index++;
+            }
+
+            while (index >= c->phase_count) {
+                sample_index++;
+                index -= c->phase_count;
+            }
+        }
+        for (; k < 4; k++) {
+            s[k]      = s[0];
+            filter[k] = filter[0];
+        }
+
+        RENAME(dot4_linear)(s, filter, c->filter_length, c->filter_alloc, val, v2);
+        for (k = 0; k < m; k++) {
+#ifdef FELEML
+            val[k] += (v2[k] - val[k]) * (FELEML) fr[k] / c->src_incr;
+#else
+#    if FILTER_SHIFT == 0
+            val[k] += (v2[k] - val[k]) * inv_src_incr * fr[k];
+#    else
+            val[k] += (v2[k] - val[k]) / c->src_incr * fr[k];
+#    endif
+#endif
+            OUT(dst[dst_index + k], val[k]);
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
+#undef RENAME
+#undef FILTER_SHIFT
+#undef DELEM
+#undef FELEM
+#undef FELEM2
+#undef FELEML
+#undef OUT
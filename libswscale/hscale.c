@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/imgutils.h"
 #include "swscale_internal.h"
 
 /// Scaler instance data
@@ -33,14 +34,41 @@ typedef struct FilterContext
 typedef struct ColorContext
 {
     uint32_t *pal;
+    int step[4];    ///< bytes per pixel of each source plane
+    int packed;     ///< all components share plane 0
+    int h_shift;    ///< log2 of the horizontal chroma subsampling of the source planes
 } ColorContext;
 
+static void init_color_context(ColorContext *li, enum AVPixelFormat fmt, uint32_t *pal)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+
+    li->pal     = pal;
+    li->packed  = !(desc->flags & AV_PIX_FMT_FLAG_PLANAR);
+    li->h_shift = desc->log2_chroma_w;
+    av_image_fill_max_pixsteps(li->step, NULL, desc);
+}
+
+// move the source line pointers to the luma column x
+static void offset_src(const ColorContext *li, const uint8_t *src[4], int x)
+{
+    int i;
+    if (!x)
+        return;
+    for (i = 0; i < 4; i++) {
+        int chroma = !li->packed && (i == 1 || i == 2);
+        src[i] += (x >> (chroma ? li->h_shift : 0)) * li->step[li->packed ? 0 : i];
+    }
+}
+
 static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     FilterContext *instance = desc->instance;
     int srcW = desc->src->width;
     int dstW = desc->dst->width;
     int xInc = instance->xInc;
+    const int16_t *filter = (const int16_t *)instance->filter + c->strip_x * instance->filter_size;
+    const int32_t *filter_pos = instance->filter_pos + c->strip_x;
 
     int i;
     for (i = 0; i < sliceH; ++i) {
@@ -53,8 +81,8 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         if (c->hyscale_fast) {
             c->hyscale_fast(c, (int16_t*)dst[dst_pos], dstW, src[src_pos], srcW, xInc);
         } else {
-            c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance->filter,
-                       instance->filter_pos, instance->filter_size);
+            c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], filter,
+                       filter_pos, instance->filter_size);
         }
 
         if (c->lumConvertRange)
@@ -74,8 +102,8 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
             if (c->hyscale_fast) {
                 c->hyscale_fast(c, (int16_t*)dst[dst_pos], dstW, src[src_pos], srcW, xInc);
             } else {
-                c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance->filter,
-                            instance->filter_pos, instance->filter_size);
+                c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], filter,
+                            filter_pos, instance->filter_size);
             }
         }
     }
@@ -85,7 +113,9 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
 
 static int lum_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
-    int srcW = desc->src->width;
+    int srcX = c->strip_src_x[0];
+    int srcW = c->strip_src_w[0];
+    int dstX = srcX * (c->srcBpc == 8 ? 1 : 2);
     ColorContext * instance = desc->instance;
     uint32_t * pal = instance->pal;
     int i;
@@ -102,7 +132,9 @@ static int lum_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
                         desc->src->plane[1].line[sp1],
                         desc->src->plane[2].line[sp1],
                         desc->src->plane[3].line[sp0]};
-        uint8_t * dst = desc->dst->plane[0].line[i];
+        uint8_t * dst = desc->dst->plane[0].line[i] + dstX;
+
+        offset_src(instance, src, srcX);
 
         if (c->lumToYV12) {
             c->lumToYV12(dst, src[0], src[1], src[2], srcW, pal);
@@ -112,7 +144,7 @@ static int lum_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
 
 
         if (desc->alpha) {
-            dst = desc->dst->plane[3].line[i];
+            dst = desc->dst->plane[3].line[i] + dstX;
             if (c->alpToYV12) {
                 c->alpToYV12(dst, src[3], src[1], src[2], srcW, pal);
             } else if (c->readAlpPlanar) {
@@ -129,7 +161,7 @@ int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice
     ColorContext * li = av_malloc(sizeof(ColorContext));
     if (!li)
         return AVERROR(ENOMEM);
-    li->pal = pal;
+    init_color_context(li, src->fmt, pal);
     desc->instance = li;
 
     desc->alpha = isALPHA(src->fmt) && isALPHA(dst->fmt);
@@ -169,6 +201,9 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
     int srcW = AV_CEIL_RSHIFT(desc->src->width, desc->src->h_chr_sub_sample);
     int dstW = AV_CEIL_RSHIFT(desc->dst->width, desc->dst->h_chr_sub_sample);
     int xInc = instance->xInc;
+    int dstX = c->strip_x >> desc->dst->h_chr_sub_sample;
+    const int16_t *filter = (const int16_t *)instance->filter + dstX * instance->filter_size;
+    const int32_t *filter_pos = instance->filter_pos + dstX;
 
     uint8_t ** src1 = desc->src->plane[1].line;
     uint8_t ** dst1 = desc->dst->plane[1].line;
@@ -186,8 +221,8 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         if (c->hcscale_fast) {
             c->hcscale_fast(c, (uint16_t*)dst1[dst_pos1+i], (uint16_t*)dst2[dst_pos2+i], dstW, src1[src_pos1+i], src2[src_pos2+i], srcW, xInc);
         } else {
-            c->hcScale(c, (uint16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i], instance->filter, instance->filter_pos, instance->filter_size);
-            c->hcScale(c, (uint16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i], instance->filter, instance->filter_pos, instance->filter_size);
+            c->hcScale(c, (uint16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i], filter, filter_pos, instance->filter_size);
+            c->hcScale(c, (uint16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i], filter, filter_pos, instance->filter_size);
         }
 
         if (c->chrConvertRange)
@@ -201,7 +236,9 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
 
 static int chr_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
-    int srcW = AV_CEIL_RSHIFT(desc->src->width, desc->src->h_chr_sub_sample);
+    int srcX = c->strip_src_x[1];
+    int srcW = c->strip_src_w[1];
+    int dstX = srcX * (c->srcBpc == 8 ? 1 : 2);
     ColorContext * instance = desc->instance;
     uint32_t * pal = instance->pal;
 
@@ -221,8 +258,10 @@ static int chr_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
                         desc->src->plane[2].line[sp1+i],
                         desc->src->plane[3].line[sp0+i]};
 
-        uint8_t * dst1 = desc->dst->plane[1].line[i];
-        uint8_t * dst2 = desc->dst->plane[2].line[i];
+        uint8_t * dst1 = desc->dst->plane[1].line[i] + dstX;
+        uint8_t * dst2 = desc->dst->plane[2].line[i] + dstX;
+
+        offset_src(instance, src, srcX << desc->src->h_chr_sub_sample);
         if (c->chrToYV12) {
             c->chrToYV12(dst1, dst2, src[0], src[1], src[2], srcW, pal);
         } else if (c->readChrPlanar) {
@@ -237,7 +276,7 @@ int ff_init_desc_cfmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlic
     ColorContext * li = av_malloc(sizeof(ColorContext));
     if (!li)
         return AVERROR(ENOMEM);
-    li->pal = pal;
+    init_color_context(li, src->fmt, pal);
     desc->instance = li;
 
     desc->src =src;
@@ -87,6 +87,20 @@ void (*interleaveBytes)(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
 void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
                           int width, int height, int srcStride,
                           int dst1Stride, int dst2Stride);
+void (*planar3topacked24)(const uint8_t *src0, const uint8_t *src1,
+                          const uint8_t *src2, uint8_t *dst, int width);
+void (*planar3topacked32)(const uint8_t *src0, const uint8_t *src1,
+                          const uint8_t *src2, uint8_t *dst, int width,
+                          int alpha_first);
+void (*packed24toplanar3)(const uint8_t *src, uint8_t *dst0,
+                          uint8_t *dst1, uint8_t *dst2, int width);
+void (*packed32toplanar3)(const uint8_t *src, uint8_t *dst0,
+                          uint8_t *dst1, uint8_t *dst2, int width,
+                          int alpha_first);
+void (*packed16toplanar16)(const uint16_t *src, uint16_t *dst[4],
+                           int width, int src_alpha, int swap, int shift);
+void (*planar16topacked16)(const uint16_t *src[4], uint16_t *dst,
+                           int width, int alpha, int swap, int bpp);
 void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                     uint8_t *dst1, uint8_t *dst2,
                     int width, int height,
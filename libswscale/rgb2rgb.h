@@ -139,6 +139,53 @@ extern void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst
                                  int width, int height, int srcStride,
                                  int dst1Stride, int dst2Stride);
 
+/**
+ * Interleave one line of three 8-bit planes into packed 24-bit pixels,
+ * src0 being stored first.
+ */
+extern void (*planar3topacked24)(const uint8_t *src0, const uint8_t *src1,
+                                 const uint8_t *src2, uint8_t *dst, int width);
+
+/**
+ * Interleave one line of three 8-bit planes into packed 32-bit pixels with
+ * an opaque alpha byte stored first or last.
+ */
+extern void (*planar3topacked32)(const uint8_t *src0, const uint8_t *src1,
+                                 const uint8_t *src2, uint8_t *dst, int width,
+                                 int alpha_first);
+
+/**
+ * Split one line of packed 24-bit pixels into three 8-bit planes.
+ */
+extern void (*packed24toplanar3)(const uint8_t *src, uint8_t *dst0,
+                                 uint8_t *dst1, uint8_t *dst2, int width);
+
+/**
+ * Split one line of packed 32-bit pixels into three 8-bit planes,
+ * dropping the alpha byte stored first or last.
+ */
+extern void (*packed32toplanar3)(const uint8_t *src, uint8_t *dst0,
+                                 uint8_t *dst1, uint8_t *dst2, int width,
+                                 int alpha_first);
+
+/**
+ * Split one line of packed 48/64-bit pixels into 16-bit planes, shifting
+ * the samples right by shift. dst[3] may be NULL, otherwise it receives
+ * the source alpha or 0xFFFF.
+ * Bit 0 of swap byteswaps the source, bit 1 the destination.
+ */
+extern void (*packed16toplanar16)(const uint16_t *src, uint16_t *dst[4],
+                                  int width, int src_alpha, int swap, int shift);
+
+/**
+ * Interleave one line of bpp-bit planes into packed 48/64-bit pixels,
+ * scaling the samples to 16 bits. With alpha set the output has four
+ * components, taken from src[3] or opaque if src[3] is NULL.
+ * Bit 0 of swap byteswaps the source, bit 1 the destination.
+ */
+extern void (*planar16topacked16)(const uint16_t *src[4], uint16_t *dst,
+                                  int width, int alpha, int swap, int bpp);
+
 extern void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                            uint8_t *dst1, uint8_t *dst2,
                            int width, int height,
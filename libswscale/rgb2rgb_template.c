@@ -725,6 +725,312 @@ static void deinterleaveBytes_c(const uint8_t *src, uint8_t *dst1, uint8_t *dst2
     }
 }
 
+static void planar3topacked24_c(const uint8_t *src0, const uint8_t *src1,
+                                const uint8_t *src2, uint8_t *dst, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        *dst++ = src0[x];
+        *dst++ = src1[x];
+        *dst++ = src2[x];
+    }
+}
+
+static void planar3topacked32_c(const uint8_t *src0, const uint8_t *src1,
+                                const uint8_t *src2, uint8_t *dst, int width,
+                                int alpha_first)
+{
+    int x;
+
+    if (alpha_first) {
+        for (x = 0; x < width; x++) {
+            *dst++ = 0xff;
+            *dst++ = src0[x];
+            *dst++ = src1[x];
+            *dst++ = src2[x];
+        }
+    } else {
+        for (x = 0; x < width; x++) {
+            *dst++ = src0[x];
+            *dst++ = src1[x];
+            *dst++ = src2[x];
+            *dst++ = 0xff;
+        }
+    }
+}
+
+static void packed24toplanar3_c(const uint8_t *src, uint8_t *dst0,
+                                uint8_t *dst1, uint8_t *dst2, int width)
+{
+    int x;
+
+    for (x = 0; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+        src += 3;
+    }
+}
+
+static void packed32toplanar3_c(const uint8_t *src, uint8_t *dst0,
+                                uint8_t *dst1, uint8_t *dst2, int width,
+                                int alpha_first)
+{
+    int x;
+
+    if (alpha_first)
+        src++;
+
+    for (x = 0; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+        src += 4;
+    }
+}
+
+static void packed16toplanar16_c(const uint16_t *src, uint16_t *dst[4],
+                                 int width, int src_alpha, int swap, int shift)
+{
+    int x;
+    int dst_alpha = dst[3] != NULL;
+    switch (swap) {
+    case 3:
+        if (src_alpha && dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[1][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[2][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[3][x] = av_bswap16(av_bswap16(*src++) >> shift);
+            }
+        } else if (dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[1][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[2][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[3][x] = 0xFFFF;
+            }
+        } else if (src_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[1][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[2][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                src++;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[1][x] = av_bswap16(av_bswap16(*src++) >> shift);
+                dst[2][x] = av_bswap16(av_bswap16(*src++) >> shift);
+            }
+        }
+        break;
+    case 2:
+        if (src_alpha && dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++ >> shift);
+                dst[1][x] = av_bswap16(*src++ >> shift);
+                dst[2][x] = av_bswap16(*src++ >> shift);
+                dst[3][x] = av_bswap16(*src++ >> shift);
+            }
+        } else if (dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++ >> shift);
+                dst[1][x] = av_bswap16(*src++ >> shift);
+                dst[2][x] = av_bswap16(*src++ >> shift);
+                dst[3][x] = 0xFFFF;
+            }
+        } else if (src_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++ >> shift);
+                dst[1][x] = av_bswap16(*src++ >> shift);
+                dst[2][x] = av_bswap16(*src++ >> shift);
+                src++;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++ >> shift);
+                dst[1][x] = av_bswap16(*src++ >> shift);
+                dst[2][x] = av_bswap16(*src++ >> shift);
+            }
+        }
+        break;
+    case 1:
+        if (src_alpha && dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++) >> shift;
+                dst[1][x] = av_bswap16(*src++) >> shift;
+                dst[2][x] = av_bswap16(*src++) >> shift;
+                dst[3][x] = av_bswap16(*src++) >> shift;
+            }
+        } else if (dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++) >> shift;
+                dst[1][x] = av_bswap16(*src++) >> shift;
+                dst[2][x] = av_bswap16(*src++) >> shift;
+                dst[3][x] = 0xFFFF;
+            }
+        } else if (src_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++) >> shift;
+                dst[1][x] = av_bswap16(*src++) >> shift;
+                dst[2][x] = av_bswap16(*src++) >> shift;
+                src++;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = av_bswap16(*src++) >> shift;
+                dst[1][x] = av_bswap16(*src++) >> shift;
+                dst[2][x] = av_bswap16(*src++) >> shift;
+            }
+        }
+        break;
+    default:
+        if (src_alpha && dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = *src++ >> shift;
+                dst[1][x] = *src++ >> shift;
+                dst[2][x] = *src++ >> shift;
+                dst[3][x] = *src++ >> shift;
+            }
+        } else if (dst_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = *src++ >> shift;
+                dst[1][x] = *src++ >> shift;
+                dst[2][x] = *src++ >> shift;
+                dst[3][x] = 0xFFFF;
+            }
+        } else if (src_alpha) {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = *src++ >> shift;
+                dst[1][x] = *src++ >> shift;
+                dst[2][x] = *src++ >> shift;
+                src++;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                dst[0][x] = *src++ >> shift;
+                dst[1][x] = *src++ >> shift;
+                dst[2][x] = *src++ >> shift;
+            }
+        }
+    }
+}
+
+static void planar16topacked16_c(const uint16_t *src[4], uint16_t *dst,
+                                 int width, int alpha, int swap, int bpp)
+{
+    int x;
+    int src_alpha = src[3] != NULL;
+    int scale_high = 16 - bpp, scale_low = (bpp - 8) * 2;
+    uint16_t component;
+
+    switch(swap) {
+    case 3:
+        if (alpha && !src_alpha) {
+            for (x = 0; x < width; x++) {
+                component = av_bswap16(src[0][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[1][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[2][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                *dst++ = 0xffff;
+            }
+        } else if (alpha && src_alpha) {
+            for (x = 0; x < width; x++) {
+                component = av_bswap16(src[0][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[1][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[2][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[3][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                component = av_bswap16(src[0][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[1][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+                component = av_bswap16(src[2][x]);
+                *dst++ = av_bswap16(component << scale_high | component >> scale_low);
+            }
+        }
+        break;
+    case 2:
+        if (alpha && !src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
+                *dst++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
+                *dst++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
+                *dst++ = 0xffff;
+            }
+        } else if (alpha && src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
+                *dst++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
+                *dst++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
+                *dst++ = av_bswap16(src[3][x] << scale_high | src[3][x] >> scale_low);
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
+                *dst++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
+                *dst++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
+            }
+        }
+        break;
+    case 1:
+        if (alpha && !src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
+                *dst++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
+                *dst++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
+                *dst++ = 0xffff;
+            }
+        } else if (alpha && src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
+                *dst++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
+                *dst++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
+                *dst++ = av_bswap16(src[3][x]) << scale_high | av_bswap16(src[3][x]) >> scale_low;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                *dst++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
+                *dst++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
+                *dst++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
+            }
+        }
+        break;
+    default:
+        if (alpha && !src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+                *dst++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+                *dst++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+                *dst++ = 0xffff;
+            }
+        } else if (alpha && src_alpha) {
+            for (x = 0; x < width; x++) {
+                *dst++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+                *dst++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+                *dst++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+                *dst++ = src[3][x] << scale_high | src[3][x] >> scale_low;
+            }
+        } else {
+            for (x = 0; x < width; x++) {
+                *dst++ = src[0][x] << scale_high | src[0][x] >> scale_low;
+                *dst++ = src[1][x] << scale_high | src[1][x] >> scale_low;
+                *dst++ = src[2][x] << scale_high | src[2][x] >> scale_low;
+            }
+        }
+    }
+}
+
 static inline void vu9_to_vu12_c(const uint8_t *src1, const uint8_t *src2,
                                  uint8_t *dst1, uint8_t *dst2,
                                  int width, int height,
@@ -961,6 +1267,12 @@ static av_cold void rgb2rgb_init_c(void)
     ff_rgb24toyv12     = ff_rgb24toyv12_c;
     interleaveBytes    = interleaveBytes_c;
     deinterleaveBytes  = deinterleaveBytes_c;
+    planar3topacked24  = planar3topacked24_c;
+    planar3topacked32  = planar3topacked32_c;
+    packed24toplanar3  = packed24toplanar3_c;
+    packed32toplanar3  = packed32toplanar3_c;
+    packed16toplanar16 = packed16toplanar16_c;
+    planar16topacked16 = planar16topacked16_c;
     vu9_to_vu12        = vu9_to_vu12_c;
     yvu9_to_yuy2       = yvu9_to_yuy2_c;
 
@@ -20,6 +20,12 @@
 
 #include "swscale_internal.h"
 
+/// strip widths are kept a multiple of the dither period at any subsampling
+#define STRIP_ALIGN       64
+#define STRIP_MIN_WIDTH 1024
+/// bytes of horizontally scaled lines one strip may keep live
+#define STRIP_WORKING_SET (256 * 1024)
+
 static void free_lines(SwsSlice *s)
 {
     int i;
@@ -246,6 +252,82 @@ static void get_min_buffer_size(SwsContext *c, int *out_lum_size, int *out_chr_s
 
 
 
+/*
+ Strips are only used when every step of the filter chain can work on a
+ range of columns: planar output, scalers which go through the filter
+ tables and input formats that can be addressed at any pixel.
+*/
+static int strip_supported(SwsContext *c)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+
+    if (!isPlanarYUV(c->dstFormat) && !(isGray(c->dstFormat) && !isALPHA(c->dstFormat)))
+        return 0;
+    if (c->hyscale_fast || c->hcscale_fast || c->is_internal_gamma)
+        return 0;
+    if (desc->flags & AV_PIX_FMT_FLAG_BITSTREAM || isBayer(c->srcFormat))
+        return 0;
+    if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR) && desc->log2_chroma_w)
+        return 0;
+    return 1;
+}
+
+/*
+ Picks the strip width so that the horizontal scaler output ring of one
+ strip fits in the target working set.
+*/
+static int get_strip_width(SwsContext *c, int lumBufSize, int chrBufSize)
+{
+    int bytes  = c->dstBpc > 14 ? 4 : 2;
+    int column = (lumBufSize * (c->needAlpha ? 2 : 1) +
+                  (2 * chrBufSize >> c->chrDstHSubSample)) * bytes;
+    int w;
+
+    if (!c->strip_width || !strip_supported(c))
+        return 0;
+
+    if (c->strip_width > 0)
+        w = FFALIGN(c->strip_width, STRIP_ALIGN);
+    else
+        w = FFMAX(STRIP_WORKING_SET / column & ~(STRIP_ALIGN - 1), STRIP_MIN_WIDTH);
+
+    return w < c->dstW ? w : 0;
+}
+
+// source columns read by the horizontal filter for destination columns [x, x + w)
+static void get_src_range(const int32_t *filter_pos, int filter_size, int srcW,
+                          int x, int w, int *src_x, int *src_w)
+{
+    int first = srcW, last = 0;
+    int i;
+
+    for (i = x; i < x + w; i++) {
+        first = FFMIN(first, filter_pos[i]);
+        last  = FFMAX(last,  filter_pos[i] + filter_size);
+    }
+    *src_x = av_clip(first, 0, srcW);
+    *src_w = FFMIN(last, srcW) - *src_x;
+}
+
+void ff_sws_set_strip(SwsContext *c, int x, int w)
+{
+    int cx = x >> c->chrDstHSubSample;
+    int cw = AV_CEIL_RSHIFT(x + w, c->chrDstHSubSample) - cx;
+
+    c->strip_x = x;
+    c->strip_src_x[0] = c->strip_src_x[1] = 0;
+    c->strip_src_w[0] = c->srcW;
+    c->strip_src_w[1] = c->chrSrcW;
+    if (!x && w == c->dstW)
+        return;
+
+    get_src_range(c->hLumFilterPos, c->hLumFilterSize, c->srcW, x, w,
+                  &c->strip_src_x[0], &c->strip_src_w[0]);
+    if (c->needs_hcscale)
+        get_src_range(c->hChrFilterPos, c->hChrFilterSize, c->chrSrcW, cx, cw,
+                      &c->strip_src_x[1], &c->strip_src_w[1]);
+}
+
 int ff_init_filters(SwsContext * c)
 {
     int i;
@@ -304,6 +386,9 @@ int ff_init_filters(SwsContext * c)
 
     fill_ones(&c->slice[i], dst_stride>>1, c->dstBpc == 16);
 
+    c->strip_w = get_strip_width(c, lumBufSize, chrBufSize);
+    ff_sws_set_strip(c, 0, c->dstW);
+
     // vertical scaler output
     ++i;
     res = alloc_slice(&c->slice[i], c->dstFormat, c->dstH, c->chrDstH, c->chrDstHSubSample, c->chrDstVSubSample, 0);
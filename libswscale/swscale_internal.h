@@ -337,6 +337,17 @@ typedef struct SwsContext {
     struct SwsSlice *slice;
     struct SwsFilterDescriptor *desc;
 
+    /**
+     * Vertical strip processing.
+     * Wide frames are scaled in strips of strip_w destination columns so
+     * that the horizontal scaler output ring stays in cache.
+     */
+    int strip_width;      ///< requested strip width, 0 for full width, -1 for automatic
+    int strip_w;          ///< strip width in use, 0 if the frame is scaled at full width
+    int strip_x;          ///< first destination column of the current strip
+    int strip_src_x[2];   ///< first luma/chroma source column needed by the current strip
+    int strip_src_w[2];   ///< number of luma/chroma source columns needed by the current strip
+
     uint32_t pal_yuv[256];
     uint32_t pal_rgb[256];
 
@@ -998,6 +1009,9 @@ int ff_init_filters(SwsContext *c);
 // Free all filter data
 int ff_free_filters(SwsContext *c);
 
+// Restrict the filter chain to the destination columns [x, x + w)
+void ff_sws_set_strip(SwsContext *c, int x, int w);
+
 /*
  function for applying ring buffer logic into slice s
  It checks if the slice can hold more @lum lines, if yes
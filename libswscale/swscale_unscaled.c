@@ -414,131 +414,10 @@ static void packed16togbra16(const uint8_t *src, int srcStride,
                              uint16_t *dst[], int dstStride[], int srcSliceH,
                              int src_alpha, int swap, int shift, int width)
 {
-    int x, h, i;
-    int dst_alpha = dst[3] != NULL;
+    int h, i;
     for (h = 0; h < srcSliceH; h++) {
-        uint16_t *src_line = (uint16_t *)(src + srcStride * h);
-        switch (swap) {
-        case 3:
-            if (src_alpha && dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[1][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[2][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[3][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                }
-            } else if (dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[1][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[2][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[3][x] = 0xFFFF;
-                }
-            } else if (src_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[1][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[2][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    src_line++;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[1][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                    dst[2][x] = av_bswap16(av_bswap16(*src_line++) >> shift);
-                }
-            }
-            break;
-        case 2:
-            if (src_alpha && dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++ >> shift);
-                    dst[1][x] = av_bswap16(*src_line++ >> shift);
-                    dst[2][x] = av_bswap16(*src_line++ >> shift);
-                    dst[3][x] = av_bswap16(*src_line++ >> shift);
-                }
-            } else if (dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++ >> shift);
-                    dst[1][x] = av_bswap16(*src_line++ >> shift);
-                    dst[2][x] = av_bswap16(*src_line++ >> shift);
-                    dst[3][x] = 0xFFFF;
-                }
-            } else if (src_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++ >> shift);
-                    dst[1][x] = av_bswap16(*src_line++ >> shift);
-                    dst[2][x] = av_bswap16(*src_line++ >> shift);
-                    src_line++;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++ >> shift);
-                    dst[1][x] = av_bswap16(*src_line++ >> shift);
-                    dst[2][x] = av_bswap16(*src_line++ >> shift);
-                }
-            }
-            break;
-        case 1:
-            if (src_alpha && dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++) >> shift;
-                    dst[1][x] = av_bswap16(*src_line++) >> shift;
-                    dst[2][x] = av_bswap16(*src_line++) >> shift;
-                    dst[3][x] = av_bswap16(*src_line++) >> shift;
-                }
-            } else if (dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++) >> shift;
-                    dst[1][x] = av_bswap16(*src_line++) >> shift;
-                    dst[2][x] = av_bswap16(*src_line++) >> shift;
-                    dst[3][x] = 0xFFFF;
-                }
-            } else if (src_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++) >> shift;
-                    dst[1][x] = av_bswap16(*src_line++) >> shift;
-                    dst[2][x] = av_bswap16(*src_line++) >> shift;
-                    src_line++;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = av_bswap16(*src_line++) >> shift;
-                    dst[1][x] = av_bswap16(*src_line++) >> shift;
-                    dst[2][x] = av_bswap16(*src_line++) >> shift;
-                }
-            }
-            break;
-        default:
-            if (src_alpha && dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    dst[3][x] = *src_line++ >> shift;
-                }
-            } else if (dst_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    dst[3][x] = 0xFFFF;
-                }
-            } else if (src_alpha) {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                    src_line++;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    dst[0][x] = *src_line++ >> shift;
-                    dst[1][x] = *src_line++ >> shift;
-                    dst[2][x] = *src_line++ >> shift;
-                }
-            }
-        }
+        packed16toplanar16((const uint16_t *)(src + srcStride * h), dst,
+                           width, src_alpha, swap, shift);
         for (i = 0; i < 4; i++)
             dst[i] += dstStride[i] >> 1;
     }
@@ -600,116 +479,11 @@ static void gbr16ptopacked16(const uint16_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int alpha, int swap, int bpp, int width)
 {
-    int x, h, i;
+    int h, i;
     int src_alpha = src[3] != NULL;
-    int scale_high = 16 - bpp, scale_low = (bpp - 8) * 2;
     for (h = 0; h < srcSliceH; h++) {
-        uint16_t *dest = (uint16_t *)(dst + dstStride * h);
-        uint16_t component;
-
-        switch(swap) {
-        case 3:
-            if (alpha && !src_alpha) {
-                for (x = 0; x < width; x++) {
-                    component = av_bswap16(src[0][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[1][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[2][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    *dest++ = 0xffff;
-                }
-            } else if (alpha && src_alpha) {
-                for (x = 0; x < width; x++) {
-                    component = av_bswap16(src[0][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[1][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[2][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[3][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    component = av_bswap16(src[0][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[1][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                    component = av_bswap16(src[2][x]);
-                    *dest++ = av_bswap16(component << scale_high | component >> scale_low);
-                }
-            }
-            break;
-        case 2:
-            if (alpha && !src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
-                    *dest++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
-                    *dest++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
-                    *dest++ = 0xffff;
-                }
-            } else if (alpha && src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
-                    *dest++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
-                    *dest++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
-                    *dest++ = av_bswap16(src[3][x] << scale_high | src[3][x] >> scale_low);
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x] << scale_high | src[0][x] >> scale_low);
-                    *dest++ = av_bswap16(src[1][x] << scale_high | src[1][x] >> scale_low);
-                    *dest++ = av_bswap16(src[2][x] << scale_high | src[2][x] >> scale_low);
-                }
-            }
-            break;
-        case 1:
-            if (alpha && !src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
-                    *dest++ = 0xffff;
-                }
-            } else if (alpha && src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[3][x]) << scale_high | av_bswap16(src[3][x]) >> scale_low;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    *dest++ = av_bswap16(src[0][x]) << scale_high | av_bswap16(src[0][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[1][x]) << scale_high | av_bswap16(src[1][x]) >> scale_low;
-                    *dest++ = av_bswap16(src[2][x]) << scale_high | av_bswap16(src[2][x]) >> scale_low;
-                }
-            }
-            break;
-        default:
-            if (alpha && !src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                    *dest++ = 0xffff;
-                }
-            } else if (alpha && src_alpha) {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                    *dest++ = src[3][x] << scale_high | src[3][x] >> scale_low;
-                }
-            } else {
-                for (x = 0; x < width; x++) {
-                    *dest++ = src[0][x] << scale_high | src[0][x] >> scale_low;
-                    *dest++ = src[1][x] << scale_high | src[1][x] >> scale_low;
-                    *dest++ = src[2][x] << scale_high | src[2][x] >> scale_low;
-                }
-            }
-        }
+        planar16topacked16(src, (uint16_t *)(dst + dstStride * h),
+                           width, alpha, swap, bpp);
         for (i = 0; i < 3 + src_alpha; i++)
             src[i] += srcStride[i] >> 1;
     }
@@ -779,14 +553,9 @@ static void gbr24ptopacked24(const uint8_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int width)
 {
-    int x, h, i;
+    int h, i;
     for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-        for (x = 0; x < width; x++) {
-            *dest++ = src[0][x];
-            *dest++ = src[1][x];
-            *dest++ = src[2][x];
-        }
+        planar3topacked24(src[0], src[1], src[2], dst + dstStride * h, width);
 
         for (i = 0; i < 3; i++)
             src[i] += srcStride[i];
@@ -797,25 +566,10 @@ static void gbr24ptopacked32(const uint8_t *src[], int srcStride[],
                              uint8_t *dst, int dstStride, int srcSliceH,
                              int alpha_first, int width)
 {
-    int x, h, i;
+    int h, i;
     for (h = 0; h < srcSliceH; h++) {
-        uint8_t *dest = dst + dstStride * h;
-
-        if (alpha_first) {
-            for (x = 0; x < width; x++) {
-                *dest++ = 0xff;
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-            }
-        } else {
-            for (x = 0; x < width; x++) {
-                *dest++ = src[0][x];
-                *dest++ = src[1][x];
-                *dest++ = src[2][x];
-                *dest++ = 0xff;
-            }
-        }
+        planar3topacked32(src[0], src[1], src[2], dst + dstStride * h,
+                          width, alpha_first);
 
         for (i = 0; i < 3; i++)
             src[i] += srcStride[i];
@@ -900,24 +654,19 @@ static void packedtogbr24p(const uint8_t *src, int srcStride,
                            int alpha_first, int inc_size, int width)
 {
     uint8_t *dest[3];
-    int x, h;
+    int h;
 
     dest[0] = dst[0];
     dest[1] = dst[1];
     dest[2] = dst[2];
 
-    if (alpha_first)
-        src++;
-
     for (h = 0; h < srcSliceH; h++) {
-        for (x = 0; x < width; x++) {
-            dest[0][x] = src[0];
-            dest[1][x] = src[1];
-            dest[2][x] = src[2];
+        if (inc_size == 3)
+            packed24toplanar3(src, dest[0], dest[1], dest[2], width);
+        else
+            packed32toplanar3(src, dest[0], dest[1], dest[2], width, alpha_first);
 
-            src += inc_size;
-        }
-        src     += srcStride - width * inc_size;
+        src     += srcStride;
         dest[0] += dstStride[0];
         dest[1] += dstStride[1];
         dest[2] += dstStride[2];
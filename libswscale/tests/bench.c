@@ -0,0 +1,212 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Scaler throughput benchmark.
+ *
+ * Scales between the usual frame sizes up to 8K and reports the output rate
+ * in MPix/s, once with the frame processed in vertical strips and once at
+ * full width, checking that both produce the same picture.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/crc.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+
+static const struct {
+    const char *name;
+    int w, h;
+} sizes[] = {
+    { "720p",  1280,  720 },
+    { "1080p", 1920, 1080 },
+    { "4K",    3840, 2160 },
+    { "8K",    7680, 4320 },
+};
+
+typedef struct Picture {
+    uint8_t *data[4];
+    int linesize[4];
+    int w, h;
+    enum AVPixelFormat fmt;
+} Picture;
+
+static int alloc_picture(Picture *p, int w, int h, enum AVPixelFormat fmt)
+{
+    p->w   = w;
+    p->h   = h;
+    p->fmt = fmt;
+    return av_image_alloc(p->data, p->linesize, w, h, fmt, 64);
+}
+
+static void free_picture(Picture *p)
+{
+    av_freep(&p->data[0]);
+}
+
+static int plane_height(const Picture *p, int plane)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(p->fmt);
+    return plane == 1 || plane == 2 ? AV_CEIL_RSHIFT(p->h, desc->log2_chroma_h) : p->h;
+}
+
+static uint32_t picture_crc(const Picture *p)
+{
+    const AVCRC *table = av_crc_get_table(AV_CRC_32_IEEE);
+    uint32_t crc = 0;
+    int i, y;
+
+    for (i = 0; i < 4 && p->data[i]; i++) {
+        int w = av_image_get_linesize(p->fmt, p->w, i);
+        for (y = 0; y < plane_height(p, i); y++)
+            crc = av_crc(table, crc, p->data[i] + y * p->linesize[i], w);
+    }
+    return crc;
+}
+
+/* Returns the output rate in MPix/s, or a negative value on error. */
+static double run(const Picture *src, Picture *dst, int flags, int strip_width,
+                  int frames, uint32_t *crc)
+{
+    struct SwsContext *sws = sws_alloc_context();
+    int64_t t;
+    int i;
+
+    if (!sws)
+        return -1;
+    av_opt_set_int(sws, "srcw",        src->w,      0);
+    av_opt_set_int(sws, "srch",        src->h,      0);
+    av_opt_set_int(sws, "src_format",  src->fmt,    0);
+    av_opt_set_int(sws, "dstw",        dst->w,      0);
+    av_opt_set_int(sws, "dsth",        dst->h,      0);
+    av_opt_set_int(sws, "dst_format",  dst->fmt,    0);
+    av_opt_set_int(sws, "sws_flags",   flags,       0);
+    av_opt_set_int(sws, "strip_width", strip_width, 0);
+    if (sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return -1;
+    }
+
+    sws_scale(sws, (const uint8_t * const *)src->data, src->linesize,
+              0, src->h, dst->data, dst->linesize);
+    t = av_gettime_relative();
+    for (i = 0; i < frames; i++)
+        sws_scale(sws, (const uint8_t * const *)src->data, src->linesize,
+                  0, src->h, dst->data, dst->linesize);
+    t = av_gettime_relative() - t;
+    sws_freeContext(sws);
+
+    *crc = picture_crc(dst);
+    return (double)dst->w * dst->h * frames / FFMAX(t, 1);
+}
+
+int main(int argc, char **argv)
+{
+    enum AVPixelFormat srcFormat = AV_PIX_FMT_YUV420P;
+    enum AVPixelFormat dstFormat = AV_PIX_FMT_YUV420P;
+    int flags       = SWS_BICUBIC;
+    int frames      = 10;
+    int strip_width = -1;
+    int ret         = 0;
+    int i, j, k;
+    AVLFG rand;
+
+    for (i = 1; i < argc; i += 2) {
+        if (argv[i][0] != '-' || i + 1 == argc)
+            goto bad_option;
+        if (!strcmp(argv[i], "-src")) {
+            srcFormat = av_get_pix_fmt(argv[i + 1]);
+            if (srcFormat == AV_PIX_FMT_NONE) {
+                fprintf(stderr, "invalid pixel format %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-dst")) {
+            dstFormat = av_get_pix_fmt(argv[i + 1]);
+            if (dstFormat == AV_PIX_FMT_NONE) {
+                fprintf(stderr, "invalid pixel format %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-flags")) {
+            flags = strtol(argv[i + 1], NULL, 0);
+        } else if (!strcmp(argv[i], "-frames")) {
+            frames = FFMAX(atoi(argv[i + 1]), 1);
+        } else if (!strcmp(argv[i], "-strip")) {
+            strip_width = atoi(argv[i + 1]);
+        } else {
+bad_option:
+            fprintf(stderr, "bad option or argument missing (%s)\n"
+                    "usage: %s [-src fmt] [-dst fmt] [-flags n] [-frames n] [-strip width]\n",
+                    argv[i], argv[0]);
+            return 1;
+        }
+    }
+
+    av_lfg_init(&rand, 1);
+    printf("%s -> %s, flags 0x%x\n", av_get_pix_fmt_name(srcFormat),
+           av_get_pix_fmt_name(dstFormat), flags);
+    printf("%-6s -> %-6s %12s %12s %8s\n", "src", "dst", "strips", "full", "speedup");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        Picture src;
+
+        if (alloc_picture(&src, sizes[i].w, sizes[i].h, srcFormat) < 0)
+            return 1;
+        for (k = 0; k < 4 && src.data[k]; k++) {
+            int size = src.linesize[k] * plane_height(&src, k), n;
+            for (n = 0; n < size; n++)
+                src.data[k][n] = av_lfg_get(&rand);
+        }
+
+        for (j = 0; j < FF_ARRAY_ELEMS(sizes); j++) {
+            Picture dst;
+            uint32_t crc_strips, crc_full;
+            double strips, full;
+
+            if (alloc_picture(&dst, sizes[j].w, sizes[j].h, dstFormat) < 0) {
+                free_picture(&src);
+                return 1;
+            }
+            strips = run(&src, &dst, flags, strip_width, frames, &crc_strips);
+            full   = run(&src, &dst, flags, 0,           frames, &crc_full);
+            free_picture(&dst);
+            if (strips < 0 || full < 0) {
+                fprintf(stderr, "failed to set up %s -> %s\n", sizes[i].name, sizes[j].name);
+                free_picture(&src);
+                return 1;
+            }
+
+            printf("%-6s -> %-6s %7.1f MP/s %7.1f MP/s %7.2fx%s\n",
+                   sizes[i].name, sizes[j].name, strips, full, strips / full,
+                   crc_strips != crc_full ? "  MISMATCH" : "");
+            if (crc_strips != crc_full)
+                ret = 1;
+        }
+        free_picture(&src);
+    }
+
+    return ret;
+}
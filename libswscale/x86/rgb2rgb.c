@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "config.h"
 #include "libavutil/attributes.h"
@@ -142,6 +143,504 @@ DECLARE_ALIGNED(8, extern const uint64_t, ff_bgr2UVOffset);
  32-bit C version, and and&add trick by Michael Niedermayer
 */
 
+#if HAVE_SSSE3_INLINE && HAVE_7REGS
+
+#define Z 0x80
+DECLARE_ASM_CONST(16, uint8_t, pack24_shuf)[9][16] = {
+    {   0,   Z,   Z,   1,   Z,   Z,   2,   Z,   Z,   3,   Z,   Z,   4,   Z,   Z,   5 }, /* out 0, plane 0 */
+    {   Z,   0,   Z,   Z,   1,   Z,   Z,   2,   Z,   Z,   3,   Z,   Z,   4,   Z,   Z }, /* out 0, plane 1 */
+    {   Z,   Z,   0,   Z,   Z,   1,   Z,   Z,   2,   Z,   Z,   3,   Z,   Z,   4,   Z }, /* out 0, plane 2 */
+    {   Z,   Z,   6,   Z,   Z,   7,   Z,   Z,   8,   Z,   Z,   9,   Z,   Z,  10,   Z }, /* out 1, plane 0 */
+    {   5,   Z,   Z,   6,   Z,   Z,   7,   Z,   Z,   8,   Z,   Z,   9,   Z,   Z,  10 }, /* out 1, plane 1 */
+    {   Z,   5,   Z,   Z,   6,   Z,   Z,   7,   Z,   Z,   8,   Z,   Z,   9,   Z,   Z }, /* out 1, plane 2 */
+    {   Z,  11,   Z,   Z,  12,   Z,   Z,  13,   Z,   Z,  14,   Z,   Z,  15,   Z,   Z }, /* out 2, plane 0 */
+    {   Z,   Z,  11,   Z,   Z,  12,   Z,   Z,  13,   Z,   Z,  14,   Z,   Z,  15,   Z }, /* out 2, plane 1 */
+    {  10,   Z,   Z,  11,   Z,   Z,  12,   Z,   Z,  13,   Z,   Z,  14,   Z,   Z,  15 }, /* out 2, plane 2 */
+};
+
+DECLARE_ASM_CONST(16, uint8_t, unpack24_shuf)[9][16] = {
+    {   0,   3,   6,   9,  12,  15,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 0, in 0 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   2,   5,   8,  11,  14,   Z,   Z,   Z,   Z,   Z }, /* plane 0, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   1,   4,   7,  10,  13 }, /* plane 0, in 2 */
+    {   1,   4,   7,  10,  13,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 1, in 0 */
+    {   Z,   Z,   Z,   Z,   Z,   0,   3,   6,   9,  12,  15,   Z,   Z,   Z,   Z,   Z }, /* plane 1, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   2,   5,   8,  11,  14 }, /* plane 1, in 2 */
+    {   2,   5,   8,  11,  14,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 2, in 0 */
+    {   Z,   Z,   Z,   Z,   Z,   1,   4,   7,  10,  13,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 2, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   0,   3,   6,   9,  12,  15 }, /* plane 2, in 2 */
+};
+
+DECLARE_ASM_CONST(16, uint8_t, unpack48_shuf)[9][16] = {
+    {   0,   1,   6,   7,  12,  13,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 0, in 0 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   2,   3,   8,   9,  14,  15,   Z,   Z,   Z,   Z }, /* plane 0, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   4,   5,  10,  11 }, /* plane 0, in 2 */
+    {   2,   3,   8,   9,  14,  15,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 1, in 0 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   4,   5,  10,  11,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 1, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   0,   1,   6,   7,  12,  13 }, /* plane 1, in 2 */
+    {   4,   5,  10,  11,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 2, in 0 */
+    {   Z,   Z,   Z,   Z,   0,   1,   6,   7,  12,  13,   Z,   Z,   Z,   Z,   Z,   Z }, /* plane 2, in 1 */
+    {   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   Z,   2,   3,   8,   9,  14,  15 }, /* plane 2, in 2 */
+};
+
+DECLARE_ASM_CONST(16, uint8_t, pack48_shuf)[9][16] = {
+    {   0,   1,   Z,   Z,   Z,   Z,   2,   3,   Z,   Z,   Z,   Z,   4,   5,   Z,   Z }, /* out 0, plane 0 */
+    {   Z,   Z,   0,   1,   Z,   Z,   Z,   Z,   2,   3,   Z,   Z,   Z,   Z,   4,   5 }, /* out 0, plane 1 */
+    {   Z,   Z,   Z,   Z,   0,   1,   Z,   Z,   Z,   Z,   2,   3,   Z,   Z,   Z,   Z }, /* out 0, plane 2 */
+    {   Z,   Z,   6,   7,   Z,   Z,   Z,   Z,   8,   9,   Z,   Z,   Z,   Z,  10,  11 }, /* out 1, plane 0 */
+    {   Z,   Z,   Z,   Z,   6,   7,   Z,   Z,   Z,   Z,   8,   9,   Z,   Z,   Z,   Z }, /* out 1, plane 1 */
+    {   4,   5,   Z,   Z,   Z,   Z,   6,   7,   Z,   Z,   Z,   Z,   8,   9,   Z,   Z }, /* out 1, plane 2 */
+    {   Z,   Z,   Z,   Z,  12,  13,   Z,   Z,   Z,   Z,  14,  15,   Z,   Z,   Z,   Z }, /* out 2, plane 0 */
+    {  10,  11,   Z,   Z,   Z,   Z,  12,  13,   Z,   Z,   Z,   Z,  14,  15,   Z,   Z }, /* out 2, plane 1 */
+    {   Z,   Z,  10,  11,   Z,   Z,   Z,   Z,  12,  13,   Z,   Z,   Z,   Z,  14,  15 }, /* out 2, plane 2 */
+};
+#undef Z
+
+DECLARE_ASM_CONST(16, uint8_t, unpack32_shuf)[2][16] = {
+    { 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 }, /* alpha last */
+    { 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12 }, /* alpha first */
+};
+
+DECLARE_ASM_CONST(16, uint8_t, unpack64_shuf)[2][16] = {
+    { 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15 },
+    { 1, 0, 9, 8, 3, 2, 11, 10, 5, 4, 13, 12, 7, 6, 15, 14 }, /* byteswapped */
+};
+
+DECLARE_ASM_CONST(16, uint8_t, word_shuf)[2][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 }, /* byteswapped */
+};
+
+#define SHUF9(t)                                                \
+    [m0] "m"(t[0]), [m1] "m"(t[1]), [m2] "m"(t[2]),             \
+    [m3] "m"(t[3]), [m4] "m"(t[4]), [m5] "m"(t[5]),             \
+    [m6] "m"(t[6]), [m7] "m"(t[7]), [m8] "m"(t[8])
+
+/* Gathers bytes of xmm0-xmm2 into xmm3 with three shuffle masks. */
+#define GATHER3(m0, m1, m2)                                     \
+    "movdqa         %%xmm0, %%xmm3              \n\t"           \
+    "pshufb     %["#m0"], %%xmm3                \n\t"           \
+    "movdqa         %%xmm1, %%xmm4              \n\t"           \
+    "pshufb     %["#m1"], %%xmm4                \n\t"           \
+    "por            %%xmm4, %%xmm3              \n\t"           \
+    "movdqa         %%xmm2, %%xmm4              \n\t"           \
+    "pshufb     %["#m2"], %%xmm4                \n\t"           \
+    "por            %%xmm4, %%xmm3              \n\t"
+
+/* Transposes the dwords of xmm0-xmm3 into xmm1, xmm4, xmm3, xmm0. */
+#define TRANSPOSE4D                                             \
+    "movdqa         %%xmm0, %%xmm4              \n\t"           \
+    "punpckldq      %%xmm1, %%xmm4              \n\t"           \
+    "punpckhdq      %%xmm1, %%xmm0              \n\t"           \
+    "movdqa         %%xmm2, %%xmm5              \n\t"           \
+    "punpckldq      %%xmm3, %%xmm5              \n\t"           \
+    "punpckhdq      %%xmm3, %%xmm2              \n\t"           \
+    "movdqa         %%xmm4, %%xmm1              \n\t"           \
+    "punpcklqdq     %%xmm5, %%xmm1              \n\t"           \
+    "punpckhqdq     %%xmm5, %%xmm4              \n\t"           \
+    "movdqa         %%xmm0, %%xmm3              \n\t"           \
+    "punpcklqdq     %%xmm2, %%xmm3              \n\t"           \
+    "punpckhqdq     %%xmm2, %%xmm0              \n\t"
+
+static void planar3topacked24_ssse3(const uint8_t *src0, const uint8_t *src1,
+                                    const uint8_t *src2, uint8_t *dst, int width)
+{
+    x86_reg x = 0, w = width & ~15;
+
+    if (w)
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "movdqu     (%[s0], %[x]), %%xmm0           \n\t"
+            "movdqu     (%[s1], %[x]), %%xmm1           \n\t"
+            "movdqu     (%[s2], %[x]), %%xmm2           \n\t"
+            GATHER3(m0, m1, m2)
+            "movdqu         %%xmm3,   (%[dst])          \n\t"
+            GATHER3(m3, m4, m5)
+            "movdqu         %%xmm3, 16(%[dst])          \n\t"
+            GATHER3(m6, m7, m8)
+            "movdqu         %%xmm3, 32(%[dst])          \n\t"
+            "add               $48, %[dst]              \n\t"
+            "add               $16, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [dst] "+r"(dst)
+            : [s0] "r"(src0), [s1] "r"(src1), [s2] "r"(src2), [w] "g"(w),
+              SHUF9(pack24_shuf)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",) "memory");
+
+    for (; x < width; x++) {
+        *dst++ = src0[x];
+        *dst++ = src1[x];
+        *dst++ = src2[x];
+    }
+}
+
+#define PLANAR3TOPACKED32(a, b, c, d)                           \
+    __asm__ volatile(                                           \
+        "pcmpeqb        %%xmm7, %%xmm7              \n\t"       \
+        "1:                                         \n\t"       \
+        "movdqu     (%[s0], %[x]), %%xmm0           \n\t"       \
+        "movdqu     (%[s1], %[x]), %%xmm1           \n\t"       \
+        "movdqu     (%[s2], %[x]), %%xmm2           \n\t"       \
+        "movdqa         "a", %%xmm3                 \n\t"       \
+        "punpcklbw      "b", %%xmm3                 \n\t"       \
+        "movdqa         "a", %%xmm4                 \n\t"       \
+        "punpckhbw      "b", %%xmm4                 \n\t"       \
+        "movdqa         "c", %%xmm5                 \n\t"       \
+        "punpcklbw      "d", %%xmm5                 \n\t"       \
+        "movdqa         "c", %%xmm6                 \n\t"       \
+        "punpckhbw      "d", %%xmm6                 \n\t"       \
+        "movdqa         %%xmm3, %%xmm0              \n\t"       \
+        "punpcklwd      %%xmm5, %%xmm0              \n\t"       \
+        "punpckhwd      %%xmm5, %%xmm3              \n\t"       \
+        "movdqa         %%xmm4, %%xmm1              \n\t"       \
+        "punpcklwd      %%xmm6, %%xmm1              \n\t"       \
+        "punpckhwd      %%xmm6, %%xmm4              \n\t"       \
+        "movdqu         %%xmm0,   (%[dst])          \n\t"       \
+        "movdqu         %%xmm3, 16(%[dst])          \n\t"       \
+        "movdqu         %%xmm1, 32(%[dst])          \n\t"       \
+        "movdqu         %%xmm4, 48(%[dst])          \n\t"       \
+        "add               $64, %[dst]              \n\t"       \
+        "add               $16, %[x]                \n\t"       \
+        "cmp             %[w], %[x]                 \n\t"       \
+        " jb                 1b                     \n\t"       \
+        : [x] "+r"(x), [dst] "+r"(dst)                          \
+        : [s0] "r"(src0), [s1] "r"(src1), [s2] "r"(src2),       \
+          [w] "g"(w)                                            \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",          \
+                       "xmm4", "xmm5", "xmm6", "xmm7",) "memory")
+
+static void planar3topacked32_ssse3(const uint8_t *src0, const uint8_t *src1,
+                                    const uint8_t *src2, uint8_t *dst, int width,
+                                    int alpha_first)
+{
+    x86_reg x = 0, w = width & ~15;
+
+    if (w) {
+        if (alpha_first)
+            PLANAR3TOPACKED32("%%xmm7", "%%xmm0", "%%xmm1", "%%xmm2");
+        else
+            PLANAR3TOPACKED32("%%xmm0", "%%xmm1", "%%xmm2", "%%xmm7");
+    }
+
+    for (; x < width; x++) {
+        if (alpha_first)
+            *dst++ = 0xff;
+        *dst++ = src0[x];
+        *dst++ = src1[x];
+        *dst++ = src2[x];
+        if (!alpha_first)
+            *dst++ = 0xff;
+    }
+}
+
+static void packed24toplanar3_ssse3(const uint8_t *src, uint8_t *dst0,
+                                    uint8_t *dst1, uint8_t *dst2, int width)
+{
+    x86_reg x = 0, w = width & ~15;
+
+    if (w)
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "movdqu           (%[src]), %%xmm0          \n\t"
+            "movdqu         16(%[src]), %%xmm1          \n\t"
+            "movdqu         32(%[src]), %%xmm2          \n\t"
+            GATHER3(m0, m1, m2)
+            "movdqu         %%xmm3, (%[d0], %[x])       \n\t"
+            GATHER3(m3, m4, m5)
+            "movdqu         %%xmm3, (%[d1], %[x])       \n\t"
+            GATHER3(m6, m7, m8)
+            "movdqu         %%xmm3, (%[d2], %[x])       \n\t"
+            "add               $48, %[src]              \n\t"
+            "add               $16, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [src] "+r"(src)
+            : [d0] "r"(dst0), [d1] "r"(dst1), [d2] "r"(dst2), [w] "g"(w),
+              SHUF9(unpack24_shuf)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4",) "memory");
+
+    for (; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+        src += 3;
+    }
+}
+
+static void packed32toplanar3_ssse3(const uint8_t *src, uint8_t *dst0,
+                                    uint8_t *dst1, uint8_t *dst2, int width,
+                                    int alpha_first)
+{
+    DECLARE_ALIGNED(16, uint8_t, shuf)[16];
+    x86_reg x = 0, w = width & ~15;
+
+    memcpy(shuf, unpack32_shuf[!!alpha_first], sizeof(shuf));
+    if (w)
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "movdqu           (%[src]), %%xmm0          \n\t"
+            "movdqu         16(%[src]), %%xmm1          \n\t"
+            "movdqu         32(%[src]), %%xmm2          \n\t"
+            "movdqu         48(%[src]), %%xmm3          \n\t"
+            "pshufb         %[shuf], %%xmm0             \n\t"
+            "pshufb         %[shuf], %%xmm1             \n\t"
+            "pshufb         %[shuf], %%xmm2             \n\t"
+            "pshufb         %[shuf], %%xmm3             \n\t"
+            TRANSPOSE4D
+            "movdqu         %%xmm1, (%[d0], %[x])       \n\t"
+            "movdqu         %%xmm4, (%[d1], %[x])       \n\t"
+            "movdqu         %%xmm3, (%[d2], %[x])       \n\t"
+            "add               $64, %[src]              \n\t"
+            "add               $16, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [src] "+r"(src)
+            : [d0] "r"(dst0), [d1] "r"(dst1), [d2] "r"(dst2), [w] "g"(w),
+              [shuf] "m"(shuf)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",)
+              "memory");
+
+    if (alpha_first)
+        src++;
+    for (; x < width; x++) {
+        dst0[x] = src[0];
+        dst1[x] = src[1];
+        dst2[x] = src[2];
+        src += 4;
+    }
+}
+
+static av_always_inline unsigned shift16(unsigned v, int swap, int shift)
+{
+    if (swap & 1)
+        v = av_bswap16(v);
+    v >>= shift;
+    return swap & 2 ? av_bswap16(v) : v;
+}
+
+static void packed16toplanar16_ssse3(const uint16_t *src, uint16_t *dst[4],
+                                     int width, int src_alpha, int swap, int shift)
+{
+    DECLARE_ALIGNED(16, uint8_t, shuf)[2][16];
+    uint64_t count = shift;
+    x86_reg x = 0, w = width & ~7;
+    int c;
+
+    memcpy(shuf[1], word_shuf[swap >> 1 & 1], 16);
+    if (w && src_alpha) {
+        /* Without a destination alpha plane, alpha goes to dst[0] first and
+         * is overwritten by the first component. */
+        uint16_t *dst3 = dst[3] ? dst[3] : dst[0];
+
+        memcpy(shuf[0], unpack64_shuf[swap & 1], 16);
+        __asm__ volatile(
+            "movq           %[count], %%xmm7            \n\t"
+            "1:                                         \n\t"
+            "movdqu           (%[src]), %%xmm0          \n\t"
+            "movdqu         16(%[src]), %%xmm1          \n\t"
+            "movdqu         32(%[src]), %%xmm2          \n\t"
+            "movdqu         48(%[src]), %%xmm3          \n\t"
+            "pshufb         %[sshuf], %%xmm0            \n\t"
+            "pshufb         %[sshuf], %%xmm1            \n\t"
+            "pshufb         %[sshuf], %%xmm2            \n\t"
+            "pshufb         %[sshuf], %%xmm3            \n\t"
+            TRANSPOSE4D
+            "psrlw          %%xmm7, %%xmm0              \n\t"
+            "psrlw          %%xmm7, %%xmm1              \n\t"
+            "psrlw          %%xmm7, %%xmm3              \n\t"
+            "psrlw          %%xmm7, %%xmm4              \n\t"
+            "pshufb         %[dshuf], %%xmm0            \n\t"
+            "pshufb         %[dshuf], %%xmm1            \n\t"
+            "pshufb         %[dshuf], %%xmm3            \n\t"
+            "pshufb         %[dshuf], %%xmm4            \n\t"
+            "movdqu         %%xmm0, (%[d3], %[x], 2)    \n\t"
+            "movdqu         %%xmm1, (%[d0], %[x], 2)    \n\t"
+            "movdqu         %%xmm4, (%[d1], %[x], 2)    \n\t"
+            "movdqu         %%xmm3, (%[d2], %[x], 2)    \n\t"
+            "add               $64, %[src]              \n\t"
+            "add                $8, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [src] "+r"(src)
+            : [d0] "r"(dst[0]), [d1] "r"(dst[1]), [d2] "r"(dst[2]),
+              [d3] "r"(dst3), [w] "g"(w), [count] "m"(count),
+              [sshuf] "m"(shuf[0]), [dshuf] "m"(shuf[1])
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm7",) "memory");
+    } else if (w) {
+        memcpy(shuf[0], word_shuf[swap & 1], 16);
+        __asm__ volatile(
+            "movq           %[count], %%xmm7            \n\t"
+            "1:                                         \n\t"
+            "movdqu           (%[src]), %%xmm0          \n\t"
+            "movdqu         16(%[src]), %%xmm1          \n\t"
+            "movdqu         32(%[src]), %%xmm2          \n\t"
+            "pshufb         %[sshuf], %%xmm0            \n\t"
+            "pshufb         %[sshuf], %%xmm1            \n\t"
+            "pshufb         %[sshuf], %%xmm2            \n\t"
+            GATHER3(m0, m1, m2)
+            "psrlw          %%xmm7, %%xmm3              \n\t"
+            "pshufb         %[dshuf], %%xmm3            \n\t"
+            "movdqu         %%xmm3, (%[d0], %[x], 2)    \n\t"
+            GATHER3(m3, m4, m5)
+            "psrlw          %%xmm7, %%xmm3              \n\t"
+            "pshufb         %[dshuf], %%xmm3            \n\t"
+            "movdqu         %%xmm3, (%[d1], %[x], 2)    \n\t"
+            GATHER3(m6, m7, m8)
+            "psrlw          %%xmm7, %%xmm3              \n\t"
+            "pshufb         %[dshuf], %%xmm3            \n\t"
+            "movdqu         %%xmm3, (%[d2], %[x], 2)    \n\t"
+            "add               $48, %[src]              \n\t"
+            "add                $8, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [src] "+r"(src)
+            : [d0] "r"(dst[0]), [d1] "r"(dst[1]), [d2] "r"(dst[2]),
+              [w] "g"(w), [count] "m"(count),
+              [sshuf] "m"(shuf[0]), [dshuf] "m"(shuf[1]),
+              SHUF9(unpack48_shuf)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm7",)
+              "memory");
+        if (dst[3])
+            memset(dst[3], 0xFF, w * sizeof(*dst[3]));
+    }
+
+    for (; x < width; x++) {
+        for (c = 0; c < 3; c++)
+            dst[c][x] = shift16(src[c], swap, shift);
+        if (dst[3])
+            dst[3][x] = src_alpha ? shift16(src[3], swap, shift) : 0xFFFF;
+        src += 3 + !!src_alpha;
+    }
+}
+
+/* Scales the words of reg to 16 bits with the shift counts in xmm6/xmm7. */
+#define SCALE16(reg)                                            \
+    "pshufb         %[sshuf], "reg"             \n\t"           \
+    "movdqa         "reg", %%xmm4               \n\t"           \
+    "psllw          %%xmm6, "reg"               \n\t"           \
+    "psrlw          %%xmm7, %%xmm4              \n\t"           \
+    "por            %%xmm4, "reg"               \n\t"
+
+static av_always_inline unsigned scale16(unsigned v, int swap, int high, int low)
+{
+    if (swap & 1)
+        v = av_bswap16(v);
+    v = (uint16_t)(v << high | v >> low);
+    return swap & 2 ? av_bswap16(v) : v;
+}
+
+static void planar16topacked16_ssse3(const uint16_t *src[4], uint16_t *dst,
+                                     int width, int alpha, int swap, int bpp)
+{
+    DECLARE_ALIGNED(16, uint8_t, shuf)[3][16];
+    uint64_t high = 16 - bpp, low = (bpp - 8) * 2;
+    x86_reg x = 0, w = width & ~7;
+    int c;
+
+    memcpy(shuf[0], word_shuf[swap & 1], 16);
+    memcpy(shuf[1], word_shuf[swap >> 1 & 1], 16);
+    if (w && alpha) {
+        /* Without a source alpha plane, the alpha lanes are forced opaque. */
+        const uint16_t *src3 = src[3] ? src[3] : src[0];
+
+        memset(shuf[2], src[3] ? 0 : 0xFF, 16);
+        __asm__ volatile(
+            "movq           %[high], %%xmm6             \n\t"
+            "movq           %[low], %%xmm7              \n\t"
+            "1:                                         \n\t"
+            "movdqu     (%[s0], %[x], 2), %%xmm0        \n\t"
+            "movdqu     (%[s1], %[x], 2), %%xmm1        \n\t"
+            "movdqu     (%[s2], %[x], 2), %%xmm2        \n\t"
+            "movdqu     (%[s3], %[x], 2), %%xmm3        \n\t"
+            SCALE16("%%xmm0")
+            SCALE16("%%xmm1")
+            SCALE16("%%xmm2")
+            SCALE16("%%xmm3")
+            "por            %[amask], %%xmm3            \n\t"
+            "movdqa         %%xmm0, %%xmm4              \n\t"
+            "punpcklwd      %%xmm1, %%xmm4              \n\t"
+            "punpckhwd      %%xmm1, %%xmm0              \n\t"
+            "movdqa         %%xmm2, %%xmm5              \n\t"
+            "punpcklwd      %%xmm3, %%xmm5              \n\t"
+            "punpckhwd      %%xmm3, %%xmm2              \n\t"
+            "movdqa         %%xmm4, %%xmm1              \n\t"
+            "punpckldq      %%xmm5, %%xmm1              \n\t"
+            "punpckhdq      %%xmm5, %%xmm4              \n\t"
+            "movdqa         %%xmm0, %%xmm3              \n\t"
+            "punpckldq      %%xmm2, %%xmm3              \n\t"
+            "punpckhdq      %%xmm2, %%xmm0              \n\t"
+            "pshufb         %[dshuf], %%xmm1            \n\t"
+            "pshufb         %[dshuf], %%xmm4            \n\t"
+            "pshufb         %[dshuf], %%xmm3            \n\t"
+            "pshufb         %[dshuf], %%xmm0            \n\t"
+            "movdqu         %%xmm1,   (%[dst])          \n\t"
+            "movdqu         %%xmm4, 16(%[dst])          \n\t"
+            "movdqu         %%xmm3, 32(%[dst])          \n\t"
+            "movdqu         %%xmm0, 48(%[dst])          \n\t"
+            "add               $64, %[dst]              \n\t"
+            "add                $8, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [dst] "+r"(dst)
+            : [s0] "r"(src[0]), [s1] "r"(src[1]), [s2] "r"(src[2]),
+              [s3] "r"(src3), [w] "g"(w), [high] "m"(high), [low] "m"(low),
+              [sshuf] "m"(shuf[0]), [dshuf] "m"(shuf[1]), [amask] "m"(shuf[2])
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm5", "xmm6", "xmm7",) "memory");
+    } else if (w) {
+        __asm__ volatile(
+            "movq           %[high], %%xmm6             \n\t"
+            "movq           %[low], %%xmm7              \n\t"
+            "1:                                         \n\t"
+            "movdqu     (%[s0], %[x], 2), %%xmm0        \n\t"
+            "movdqu     (%[s1], %[x], 2), %%xmm1        \n\t"
+            "movdqu     (%[s2], %[x], 2), %%xmm2        \n\t"
+            SCALE16("%%xmm0")
+            SCALE16("%%xmm1")
+            SCALE16("%%xmm2")
+            "pshufb         %[dshuf], %%xmm0            \n\t"
+            "pshufb         %[dshuf], %%xmm1            \n\t"
+            "pshufb         %[dshuf], %%xmm2            \n\t"
+            GATHER3(m0, m1, m2)
+            "movdqu         %%xmm3,   (%[dst])          \n\t"
+            GATHER3(m3, m4, m5)
+            "movdqu         %%xmm3, 16(%[dst])          \n\t"
+            GATHER3(m6, m7, m8)
+            "movdqu         %%xmm3, 32(%[dst])          \n\t"
+            "add               $48, %[dst]              \n\t"
+            "add                $8, %[x]                \n\t"
+            "cmp             %[w], %[x]                 \n\t"
+            " jb                 1b                     \n\t"
+            : [x] "+r"(x), [dst] "+r"(dst)
+            : [s0] "r"(src[0]), [s1] "r"(src[1]), [s2] "r"(src[2]),
+              [w] "g"(w), [high] "m"(high), [low] "m"(low),
+              [sshuf] "m"(shuf[0]), [dshuf] "m"(shuf[1]),
+              SHUF9(pack48_shuf)
+            : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",
+                           "xmm4", "xmm6", "xmm7",) "memory");
+    }
+
+    for (; x < width; x++) {
+        for (c = 0; c < 3; c++)
+            *dst++ = scale16(src[c][x], swap, high, low);
+        if (alpha)
+            *dst++ = src[3] ? scale16(src[3][x], swap, high, low) : 0xFFFF;
+    }
+}
+
+static av_cold void rgb2rgb_init_ssse3(void)
+{
+    planar3topacked24  = planar3topacked24_ssse3;
+    planar3topacked32  = planar3topacked32_ssse3;
+    packed24toplanar3  = packed24toplanar3_ssse3;
+    packed32toplanar3  = packed32toplanar3_ssse3;
+    packed16toplanar16 = packed16toplanar16_ssse3;
+    planar16topacked16 = planar16topacked16_ssse3;
+}
+
+#endif /* HAVE_SSSE3_INLINE && HAVE_7REGS */
+
 #endif /* HAVE_INLINE_ASM */
 
 av_cold void rgb2rgb_init_x86(void)
@@ -159,5 +658,9 @@ av_cold void rgb2rgb_init_x86(void)
         rgb2rgb_init_sse2();
     if (INLINE_AVX(cpu_flags))
         rgb2rgb_init_avx();
+#if HAVE_SSSE3_INLINE && HAVE_7REGS
+    if (INLINE_SSSE3(cpu_flags))
+        rgb2rgb_init_ssse3();
+#endif
 #endif /* HAVE_INLINE_ASM */
 }
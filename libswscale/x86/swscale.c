@@ -275,6 +275,731 @@ static void yuv2yuvX_sse3(const int16_t *filter, int filterSize,
 }
 #endif
 
+#if HAVE_AVX2_INLINE
+static void yuv2yuvX_avx2(const int16_t *filter, int filterSize,
+                          const int16_t **src, uint8_t *dest, int dstW,
+                          const uint8_t *dither, int offset)
+{
+    filterSize--;
+    /* 32 pixels per iteration, the last 1..16 pixels are done in an xmm pass
+     * so that no more is read or written past dstW than in yuv2yuvX_sse3 */
+    __asm__ volatile(
+        "movq                %5, %%xmm3             \n\t"
+        "test                %3, %3                 \n\t"
+        "jz                  2f                     \n\t"
+        "vpsrlq             $24, %%xmm3, %%xmm4     \n\t"
+        "vpsllq             $40, %%xmm3, %%xmm3     \n\t"
+        "vpor            %%xmm4, %%xmm3, %%xmm3     \n\t"
+        "2:                                         \n\t"
+        "vpmovzxbw       %%xmm3, %%xmm3             \n\t"
+        "vmovd               %4, %%xmm1             \n\t"
+        "vpbroadcastw    %%xmm1, %%xmm1             \n\t"
+        "vpsllw              $3, %%xmm1, %%xmm1     \n\t"
+        "vpaddw          %%xmm1, %%xmm3, %%xmm3     \n\t"
+        "vpsraw              $4, %%xmm3, %%xmm3     \n\t"
+        "vinserti128         $1, %%xmm3, %%ymm3, %%ymm7 \n\t"
+        "mov                 %3, %%"FF_REG_c"       \n\t"
+        "mov                 %2, %%"FF_REG_a"       \n\t"
+        "sub                $16, %%"FF_REG_a"       \n\t"
+        "cmp       %%"FF_REG_a", %%"FF_REG_c"       \n\t"
+        "jge                 4f                     \n\t"
+        ".p2align            4                      \n\t"
+        "1:                                         \n\t"
+        "vmovdqa         %%ymm7, %%ymm3             \n\t"
+        "vmovdqa         %%ymm7, %%ymm4             \n\t"
+        "mov                 %0, %%"FF_REG_d"       \n\t"
+        "mov       (%%"FF_REG_d"), %%"FF_REG_S"     \n\t"
+        "3:                                         \n\t"
+        "vpbroadcastq   8(%%"FF_REG_d"), %%ymm0     \n\t" /* filterCoeff */
+        "vpmulhw     (%%"FF_REG_S", %%"FF_REG_c", 2), %%ymm0, %%ymm2 \n\t"
+        "vpmulhw   32(%%"FF_REG_S", %%"FF_REG_c", 2), %%ymm0, %%ymm5 \n\t"
+        "add                $16, %%"FF_REG_d"       \n\t"
+        "mov       (%%"FF_REG_d"), %%"FF_REG_S"     \n\t"
+        "vpaddw          %%ymm2, %%ymm3, %%ymm3     \n\t"
+        "vpaddw          %%ymm5, %%ymm4, %%ymm4     \n\t"
+        "test      %%"FF_REG_S", %%"FF_REG_S"       \n\t"
+        "jnz                 3b                     \n\t"
+        "vpsraw              $3, %%ymm3, %%ymm3     \n\t"
+        "vpsraw              $3, %%ymm4, %%ymm4     \n\t"
+        "vpackuswb       %%ymm4, %%ymm3, %%ymm3     \n\t"
+        "vpermq           $0xd8, %%ymm3, %%ymm3     \n\t"
+        "vmovdqu         %%ymm3, (%1, %%"FF_REG_c") \n\t"
+        "add                $32, %%"FF_REG_c"       \n\t"
+        "cmp       %%"FF_REG_a", %%"FF_REG_c"       \n\t"
+        "jl                  1b                     \n\t"
+        "4:                                         \n\t"
+        "cmp                 %2, %%"FF_REG_c"       \n\t"
+        "jge                 6f                     \n\t"
+        "vmovdqa         %%xmm7, %%xmm3             \n\t"
+        "vmovdqa         %%xmm7, %%xmm4             \n\t"
+        "mov                 %0, %%"FF_REG_d"       \n\t"
+        "mov       (%%"FF_REG_d"), %%"FF_REG_S"     \n\t"
+        "5:                                         \n\t"
+        "vmovddup       8(%%"FF_REG_d"), %%xmm0     \n\t" /* filterCoeff */
+        "vpmulhw     (%%"FF_REG_S", %%"FF_REG_c", 2), %%xmm0, %%xmm2 \n\t"
+        "vpmulhw   16(%%"FF_REG_S", %%"FF_REG_c", 2), %%xmm0, %%xmm5 \n\t"
+        "add                $16, %%"FF_REG_d"       \n\t"
+        "mov       (%%"FF_REG_d"), %%"FF_REG_S"     \n\t"
+        "vpaddw          %%xmm2, %%xmm3, %%xmm3     \n\t"
+        "vpaddw          %%xmm5, %%xmm4, %%xmm4     \n\t"
+        "test      %%"FF_REG_S", %%"FF_REG_S"       \n\t"
+        "jnz                 5b                     \n\t"
+        "vpsraw              $3, %%xmm3, %%xmm3     \n\t"
+        "vpsraw              $3, %%xmm4, %%xmm4     \n\t"
+        "vpackuswb       %%xmm4, %%xmm3, %%xmm3     \n\t"
+        "vmovdqu         %%xmm3, (%1, %%"FF_REG_c") \n\t"
+        "6:                                         \n\t"
+        "vzeroupper                                 \n\t"
+        :: "g" (filter),
+           "r" (dest - offset), "g" ((x86_reg)(dstW + offset)), "r" ((x86_reg)offset),
+           "m" (filterSize), "m" (((uint64_t *) dither)[0])
+        : XMM_CLOBBERS("%xmm0" , "%xmm1" , "%xmm2" , "%xmm3" , "%xmm4" , "%xmm5" , "%xmm7" ,)
+          "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_S, "%"FF_REG_c, "memory"
+    );
+}
+
+/* The vertical filter taps packed two at a time for pmaddwd, terminated by a
+ * NULL line. The lines are kept in 64-bit slots so that the 32-byte layout
+ * read by VFILTER_AVX2 is the same on x86-32. An odd last tap is paired with
+ * a 0 coefficient. */
+typedef struct VFilterPair {
+    union {
+        const void *ptr;
+        uint64_t pad;
+    } src[2];               ///< lines j and j + 1
+    int32_t coeff;          ///< filter[j] | filter[j + 1] << 16
+    int32_t pad[3];
+} VFilterPair;
+
+#define VFILTER_PAIRS_SIZE (MAX_FILTER_SIZE / 2 + 1)
+
+static void vfilter_pairs_avx2(VFilterPair *pairs, const int16_t *filter,
+                               int filterSize, const int16_t **src)
+{
+    int j;
+
+    for (j = 0; j < filterSize; j += 2, pairs++) {
+        int last = j + 1 == filterSize;
+        pairs->src[0].ptr = src[j];
+        pairs->src[1].ptr = src[last ? j : j + 1];
+        pairs->coeff = (uint16_t)filter[j] |
+                       (last ? 0 : (unsigned)(uint16_t)filter[j + 1] << 16);
+    }
+    pairs->src[0].ptr = NULL;
+}
+
+/* accumulate the filtered 16 pixels at %%REG_c, pixels 0-3 and 8-11 in lo
+ * and 4-7 and 12-15 in hi */
+#define VFILTER_AVX2(pairs, label, lo, hi) \
+        "mov            "pairs", %%"FF_REG_d"       \n\t" \
+        "mov       (%%"FF_REG_d"), %%"FF_REG_a"     \n\t" \
+        label":                                     \n\t" \
+        "mov      8(%%"FF_REG_d"), %%"FF_REG_S"     \n\t" \
+        "vpbroadcastd  16(%%"FF_REG_d"), %%ymm4     \n\t" \
+        "vmovdqu (%%"FF_REG_a", %%"FF_REG_c", 2), %%ymm2 \n\t" \
+        "vmovdqu (%%"FF_REG_S", %%"FF_REG_c", 2), %%ymm3 \n\t" \
+        "add                $32, %%"FF_REG_d"       \n\t" \
+        "vpunpcklwd      %%ymm3, %%ymm2, %%ymm5     \n\t" \
+        "vpunpckhwd      %%ymm3, %%ymm2, %%ymm2     \n\t" \
+        "vpmaddwd        %%ymm4, %%ymm5, %%ymm5     \n\t" \
+        "vpmaddwd        %%ymm4, %%ymm2, %%ymm2     \n\t" \
+        "mov       (%%"FF_REG_d"), %%"FF_REG_a"     \n\t" \
+        "vpaddd          %%ymm5, "lo", "lo"         \n\t" \
+        "vpaddd          %%ymm2, "hi", "hi"         \n\t" \
+        "test      %%"FF_REG_a", %%"FF_REG_a"       \n\t" \
+        "jnz             "label"b                   \n\t"
+
+static void yuv2planeX_8_avx2(const int16_t *filter, int filterSize,
+                              const int16_t **src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset)
+{
+    DECLARE_ALIGNED(32, int32_t, bias)[2][8];
+    DECLARE_ALIGNED(32, VFilterPair, pairs)[VFILTER_PAIRS_SIZE];
+    x86_reg i = 0, w = dstW & ~15;
+    int j;
+
+    if (w) {
+        vfilter_pairs_avx2(pairs, filter, filterSize, src);
+        for (j = 0; j < 4; j++) {
+            bias[0][j] = bias[0][j + 4] = dither[(j +     offset) & 7] << 12;
+            bias[1][j] = bias[1][j + 4] = dither[(j + 4 + offset) & 7] << 12;
+        }
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "vmovdqa             %3, %%ymm0             \n\t"
+            "vmovdqa             %4, %%ymm1             \n\t"
+            VFILTER_AVX2("%1", "2", "%%ymm0", "%%ymm1")
+            "vpsrad             $19, %%ymm0, %%ymm0     \n\t"
+            "vpsrad             $19, %%ymm1, %%ymm1     \n\t"
+            "vpackssdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpackuswb       %%ymm0, %%ymm0, %%ymm0     \n\t"
+            "vpermq           $0x08, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%xmm0, (%2, %%"FF_REG_c") \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %5, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "g" (pairs), "r" (dest), "m" (bias[0]), "m" (bias[1]), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5",)
+              "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_S, "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++) {
+        int val = dither[(i + offset) & 7] << 12;
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+        dest[i] = av_clip_uint8(val >> 19);
+    }
+}
+
+static void yuv2plane1_8_avx2(const int16_t *src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset)
+{
+    x86_reg i = 0, w = dstW & ~15;
+    uint64_t d = AV_RN64(dither);
+
+    if (w) {
+        if (offset)
+            d = d >> (8 * offset) | d << (64 - 8 * offset);
+        /* (src + dither) >> 7 saturates exactly like av_clip_uint8() */
+        __asm__ volatile(
+            "vmovq               %3, %%xmm1             \n\t"
+            "vpmovzxbw       %%xmm1, %%xmm1             \n\t"
+            "vinserti128         $1, %%xmm1, %%ymm1, %%ymm1 \n\t"
+            "1:                                         \n\t"
+            "vpaddsw (%1, %%"FF_REG_c", 2), %%ymm1, %%ymm0 \n\t"
+            "vpsraw              $7, %%ymm0, %%ymm0     \n\t"
+            "vpackuswb       %%ymm0, %%ymm0, %%ymm0     \n\t"
+            "vpermq           $0x08, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%xmm0, (%2, %%"FF_REG_c") \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %4, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "r" (src), "r" (dest), "m" (d), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1",) "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++) {
+        int val = (src[i] + dither[(i + offset) & 7]) >> 7;
+        dest[i] = av_clip_uint8(val);
+    }
+}
+
+/* 9 to 14 bit output from 15 bit intermediates */
+static av_always_inline void yuv2planeX_hbd_avx2(const int16_t *filter, int filterSize,
+                                                 const int16_t **src, uint16_t *dest,
+                                                 int dstW, int output_bits)
+{
+    DECLARE_ALIGNED(32, VFilterPair, pairs)[VFILTER_PAIRS_SIZE];
+    const int shift = 11 + 16 - output_bits;
+    const int32_t rnd = 1 << (shift - 1);
+    const uint16_t max = (1 << output_bits) - 1;
+    x86_reg i = 0, w = dstW & ~15;
+    int j;
+
+    if (w) {
+        vfilter_pairs_avx2(pairs, filter, filterSize, src);
+        __asm__ volatile(
+            "vpbroadcastd        %3, %%ymm6             \n\t"
+            "1:                                         \n\t"
+            "vmovdqa         %%ymm6, %%ymm0             \n\t"
+            "vmovdqa         %%ymm6, %%ymm1             \n\t"
+            VFILTER_AVX2("%1", "2", "%%ymm0", "%%ymm1")
+            "vpsrad              %4, %%ymm0, %%ymm0     \n\t"
+            "vpsrad              %4, %%ymm1, %%ymm1     \n\t"
+            "vpbroadcastw        %5, %%ymm3             \n\t"
+            "vpackusdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpminuw         %%ymm3, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %6, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "g" (pairs), "r" (dest), "m" (rnd), "i" (shift), "m" (max), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6",)
+              "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_S, "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++) {
+        int val = rnd;
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+        dest[i] = av_clip_uintp2(val >> shift, output_bits);
+    }
+}
+
+static av_always_inline void yuv2plane1_hbd_avx2(const int16_t *src, uint16_t *dest,
+                                                 int dstW, int output_bits)
+{
+    const int shift = 15 - output_bits;
+    const int16_t rnd = 1 << (shift - 1);
+    const int16_t max = (1 << output_bits) - 1;
+    x86_reg i = 0, w = dstW & ~15;
+
+    /* the saturating add only clips values that end up above max anyway */
+    if (w) {
+        __asm__ volatile(
+            "vpbroadcastw        %3, %%ymm1             \n\t"
+            "vpbroadcastw        %5, %%ymm2             \n\t"
+            "vpxor           %%ymm3, %%ymm3, %%ymm3     \n\t"
+            "1:                                         \n\t"
+            "vpaddsw (%1, %%"FF_REG_c", 2), %%ymm1, %%ymm0 \n\t"
+            "vpsraw              %4, %%ymm0, %%ymm0     \n\t"
+            "vpmaxsw         %%ymm3, %%ymm0, %%ymm0     \n\t"
+            "vpminsw         %%ymm2, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %6, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "r" (src), "r" (dest), "m" (rnd), "i" (shift), "m" (max), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",) "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++)
+        dest[i] = av_clip_uintp2((src[i] + rnd) >> shift, output_bits);
+}
+
+#define YUV2PLANE_HBD_AVX2(bits) \
+static void yuv2planeX_ ## bits ## LE_avx2(const int16_t *filter, int filterSize, \
+                                           const int16_t **src, uint8_t *dest, int dstW, \
+                                           const uint8_t *dither, int offset) \
+{ \
+    yuv2planeX_hbd_avx2(filter, filterSize, src, (uint16_t *)dest, dstW, bits); \
+} \
+static void yuv2plane1_ ## bits ## LE_avx2(const int16_t *src, uint8_t *dest, int dstW, \
+                                           const uint8_t *dither, int offset) \
+{ \
+    yuv2plane1_hbd_avx2(src, (uint16_t *)dest, dstW, bits); \
+}
+
+YUV2PLANE_HBD_AVX2(9)
+YUV2PLANE_HBD_AVX2(10)
+YUV2PLANE_HBD_AVX2(12)
+YUV2PLANE_HBD_AVX2(14)
+
+/* 16 bit output from 19 bit intermediates, the taps are not paired as the
+ * products need 32 bits: one VFilterPair per line with the sign extended
+ * coefficient. The sums wrap like the unsigned ones of the C version. */
+static void yuv2planeX_16LE_avx2(const int16_t *filter, int filterSize,
+                                 const int16_t **src, uint8_t *dest, int dstW,
+                                 const uint8_t *dither, int offset)
+{
+    DECLARE_ALIGNED(32, VFilterPair, taps)[MAX_FILTER_SIZE + 1];
+    const int32_t **src32 = (const int32_t **)src;
+    const int32_t rnd = (1 << 14) - 0x40000000;
+    uint16_t *dst = (uint16_t *)dest;
+    const uint16_t bias = 0x8000;
+    x86_reg i = 0, w = dstW & ~15;
+    int j;
+
+    if (w) {
+        for (j = 0; j < filterSize; j++) {
+            taps[j].src[0].ptr = src32[j];
+            taps[j].coeff = filter[j];
+        }
+        taps[j].src[0].ptr = NULL;
+        __asm__ volatile(
+            "vpbroadcastd        %3, %%ymm6             \n\t"
+            "vpbroadcastw        %4, %%ymm7             \n\t"
+            "1:                                         \n\t"
+            "vmovdqa         %%ymm6, %%ymm0             \n\t"
+            "vmovdqa         %%ymm6, %%ymm1             \n\t"
+            "mov                 %1, %%"FF_REG_d"       \n\t"
+            "mov       (%%"FF_REG_d"), %%"FF_REG_a"     \n\t"
+            "2:                                         \n\t"
+            "vpbroadcastd  16(%%"FF_REG_d"), %%ymm4     \n\t"
+            "vpmulld   (%%"FF_REG_a", %%"FF_REG_c", 4), %%ymm4, %%ymm2 \n\t"
+            "vpmulld 32(%%"FF_REG_a", %%"FF_REG_c", 4), %%ymm4, %%ymm3 \n\t"
+            "add                $32, %%"FF_REG_d"       \n\t"
+            "mov       (%%"FF_REG_d"), %%"FF_REG_a"     \n\t"
+            "vpaddd          %%ymm2, %%ymm0, %%ymm0     \n\t"
+            "vpaddd          %%ymm3, %%ymm1, %%ymm1     \n\t"
+            "test      %%"FF_REG_a", %%"FF_REG_a"       \n\t"
+            "jnz                 2b                     \n\t"
+            "vpsrad             $15, %%ymm0, %%ymm0     \n\t"
+            "vpsrad             $15, %%ymm1, %%ymm1     \n\t"
+            "vpackssdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpermq           $0xd8, %%ymm0, %%ymm0     \n\t"
+            "vpxor           %%ymm7, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %5, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "g" (taps), "r" (dst), "m" (rnd), "m" (bias), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm6", "%xmm7",)
+              "%"FF_REG_a, "%"FF_REG_d, "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++) {
+        int val = rnd;
+        for (j = 0; j < filterSize; j++)
+            val += src32[j][i] * (unsigned)filter[j];
+        dst[i] = 0x8000 + av_clip_int16(val >> 15);
+    }
+}
+
+static void yuv2plane1_16LE_avx2(const int16_t *src, uint8_t *dest, int dstW,
+                                 const uint8_t *dither, int offset)
+{
+    const int32_t *src32 = (const int32_t *)src;
+    uint16_t *dst = (uint16_t *)dest;
+    const int32_t rnd = 1 << 2;
+    x86_reg i = 0, w = dstW & ~15;
+
+    if (w) {
+        __asm__ volatile(
+            "vpbroadcastd        %3, %%ymm2             \n\t"
+            "1:                                         \n\t"
+            "vpaddd   (%1, %%"FF_REG_c", 4), %%ymm2, %%ymm0 \n\t"
+            "vpaddd 32(%1, %%"FF_REG_c", 4), %%ymm2, %%ymm1 \n\t"
+            "vpsrad              $3, %%ymm0, %%ymm0     \n\t"
+            "vpsrad              $3, %%ymm1, %%ymm1     \n\t"
+            "vpackusdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpermq           $0xd8, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %4, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "r" (src32), "r" (dst), "m" (rnd), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2",) "memory"
+        );
+    }
+
+    for (i = w; i < dstW; i++)
+        dst[i] = av_clip_uint16((src32[i] + rnd) >> 3);
+}
+
+DECLARE_ASM_CONST(32, uint8_t, nv12_interleave)[32] = {
+    0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+    0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15,
+};
+
+static void yuv2nv12cX_avx2(SwsContext *c, const int16_t *chrFilter, int chrFilterSize,
+                            const int16_t **chrUSrc, const int16_t **chrVSrc,
+                            uint8_t *dest, int chrDstW)
+{
+    const uint8_t *dither = c->chrDither8;
+    const int nv12 = c->dstFormat == AV_PIX_FMT_NV12;
+    DECLARE_ALIGNED(32, int32_t, bias)[4][8];
+    DECLARE_ALIGNED(32, VFilterPair, pairs)[2][VFILTER_PAIRS_SIZE];
+    x86_reg i = 0, w = chrDstW & ~15;
+    int j;
+
+    if (w) {
+        /* the first byte of each pair is U for NV12 and V for NV21, bias
+         * 0/1 and 2/3 hold the dither of the first and second byte */
+        vfilter_pairs_avx2(pairs[0], chrFilter, chrFilterSize, nv12 ? chrUSrc : chrVSrc);
+        vfilter_pairs_avx2(pairs[1], chrFilter, chrFilterSize, nv12 ? chrVSrc : chrUSrc);
+        for (j = 0; j < 4; j++) {
+            bias[2 * !nv12    ][j] = bias[2 * !nv12    ][j + 4] = dither[ j         ] << 12;
+            bias[2 * !nv12 + 1][j] = bias[2 * !nv12 + 1][j + 4] = dither[ j + 4     ] << 12;
+            bias[2 *  nv12    ][j] = bias[2 *  nv12    ][j + 4] = dither[(j + 3) & 7] << 12;
+            bias[2 *  nv12 + 1][j] = bias[2 *  nv12 + 1][j + 4] = dither[(j + 7) & 7] << 12;
+        }
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "vmovdqa             %4, %%ymm0             \n\t"
+            "vmovdqa             %5, %%ymm1             \n\t"
+            VFILTER_AVX2("%1", "2", "%%ymm0", "%%ymm1")
+            "vpsrad             $19, %%ymm0, %%ymm0     \n\t"
+            "vpsrad             $19, %%ymm1, %%ymm1     \n\t"
+            "vpackssdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vmovdqa             %6, %%ymm1             \n\t"
+            "vmovdqa             %7, %%ymm6             \n\t"
+            VFILTER_AVX2("%2", "3", "%%ymm1", "%%ymm6")
+            "vpsrad             $19, %%ymm1, %%ymm1     \n\t"
+            "vpsrad             $19, %%ymm6, %%ymm6     \n\t"
+            "vpackssdw       %%ymm6, %%ymm1, %%ymm1     \n\t"
+            "vpackuswb       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpshufb             %8, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%3, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %9, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "g" (pairs[0]), "g" (pairs[1]), "r" (dest),
+              "m" (bias[0]), "m" (bias[1]), "m" (bias[2]), "m" (bias[3]),
+              "m" (*nv12_interleave), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6",)
+              "%"FF_REG_a, "%"FF_REG_d, "%"FF_REG_S, "memory"
+        );
+    }
+
+    for (i = w; i < chrDstW; i++) {
+        int u = dither[i & 7] << 12;
+        int v = dither[(i + 3) & 7] << 12;
+        for (j = 0; j < chrFilterSize; j++) {
+            u += chrUSrc[j][i] * chrFilter[j];
+            v += chrVSrc[j][i] * chrFilter[j];
+        }
+        dest[2 * i + !nv12] = av_clip_uint8(u >> 19);
+        dest[2 * i +  nv12] = av_clip_uint8(v >> 19);
+    }
+}
+
+static void p010LEToY_avx2(uint8_t *dst, const uint8_t *src, const uint8_t *unused1,
+                           const uint8_t *unused2, int width, uint32_t *unused)
+{
+    x86_reg i = 0, w = width & ~15;
+
+    if (w) {
+        __asm__ volatile(
+            "1:                                         \n\t"
+            "vmovdqu (%1, %%"FF_REG_c", 2), %%ymm0      \n\t"
+            "vpsrlw              $6, %%ymm0, %%ymm0     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %3, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "r" (src), "r" (dst), "g" (w)
+            : XMM_CLOBBERS("%xmm0",) "memory"
+        );
+    }
+
+    for (i = w; i < width; i++)
+        AV_WN16(dst + i * 2, AV_RL16(src + i * 2) >> 6);
+}
+
+static void p010LEToUV_avx2(uint8_t *dstU, uint8_t *dstV,
+                            const uint8_t *unused0, const uint8_t *src1, const uint8_t *src2,
+                            int width, uint32_t *unused)
+{
+    x86_reg i = 0, w = width & ~15;
+
+    if (w) {
+        __asm__ volatile(
+            "vpxor           %%ymm4, %%ymm4, %%ymm4     \n\t"
+            "1:                                         \n\t"
+            "vmovdqu   (%1, %%"FF_REG_c", 4), %%ymm0    \n\t"
+            "vmovdqu 32(%1, %%"FF_REG_c", 4), %%ymm1    \n\t"
+            "vpsrld             $16, %%ymm0, %%ymm2     \n\t"
+            "vpsrld             $16, %%ymm1, %%ymm3     \n\t"
+            "vpblendw         $0xaa, %%ymm4, %%ymm0, %%ymm0 \n\t"
+            "vpblendw         $0xaa, %%ymm4, %%ymm1, %%ymm1 \n\t"
+            "vpackusdw       %%ymm1, %%ymm0, %%ymm0     \n\t"
+            "vpackusdw       %%ymm3, %%ymm2, %%ymm2     \n\t"
+            "vpermq           $0xd8, %%ymm0, %%ymm0     \n\t"
+            "vpermq           $0xd8, %%ymm2, %%ymm2     \n\t"
+            "vpsrlw              $6, %%ymm0, %%ymm0     \n\t"
+            "vpsrlw              $6, %%ymm2, %%ymm2     \n\t"
+            "vmovdqu         %%ymm0, (%2, %%"FF_REG_c", 2) \n\t"
+            "vmovdqu         %%ymm2, (%3, %%"FF_REG_c", 2) \n\t"
+            "add                $16, %%"FF_REG_c"       \n\t"
+            "cmp                 %4, %%"FF_REG_c"       \n\t"
+            "jl                  1b                     \n\t"
+            "vzeroupper                                 \n\t"
+            : "+c" (i)
+            : "r" (src1), "r" (dstU), "r" (dstV), "g" (w)
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3", "%xmm4",) "memory"
+        );
+    }
+
+    for (i = w; i < width; i++) {
+        AV_WN16(dstU + i * 2, AV_RL16(src1 + i * 4 + 0) >> 6);
+        AV_WN16(dstV + i * 2, AV_RL16(src1 + i * 4 + 2) >> 6);
+    }
+}
+
+DECLARE_ASM_CONST(32, uint8_t, hscale_shuf_lo)[32] = {
+    0, 0x80, 1, 0x80, 4, 0x80, 5, 0x80, 8, 0x80, 9, 0x80, 12, 0x80, 13, 0x80,
+    0, 0x80, 1, 0x80, 4, 0x80, 5, 0x80, 8, 0x80, 9, 0x80, 12, 0x80, 13, 0x80,
+};
+DECLARE_ASM_CONST(32, uint8_t, hscale_shuf_hi)[32] = {
+    2, 0x80, 3, 0x80, 6, 0x80, 7, 0x80, 10, 0x80, 11, 0x80, 14, 0x80, 15, 0x80,
+    2, 0x80, 3, 0x80, 6, 0x80, 7, 0x80, 10, 0x80, 11, 0x80, 14, 0x80, 15, 0x80,
+};
+DECLARE_ASM_CONST(32, uint8_t, hscale_pack_w)[32] = {
+    0, 1, 4, 5, 8, 9, 12, 13, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0, 1, 4, 5, 8, 9, 12, 13, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+DECLARE_ASM_CONST(32, int32_t, hscale_steps)[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+DECLARE_ASM_CONST(32, uint16_t, hscale_w8000)[16] = {
+    0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+    0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+};
+
+/* Horizontal scaling, 8 output pixels per call of the asm block. The source
+ * pixels and coefficients of each output pixel are fetched 4 taps at a time
+ * with gathers, so any filter size that is a multiple of 4 is handled.
+ * ymm5 holds the source offsets, ymm6 the filter offsets and ymm7
+ * accumulates the 32-bit sums; the source and filter pointers advance. */
+#define HSCALE_AVX2_SETUP \
+    "vpbroadcastd     %[fstride], %%ymm6                \n\t" \
+    "vpmulld      %[steps], %%ymm6, %%ymm6              \n\t" \
+    "vmovdqu          %[pos], %%ymm5                    \n\t" \
+    "vpxor           %%ymm7, %%ymm7, %%ymm7             \n\t"
+
+#define HSCALE_AVX2_GATHER(offset, base, idx, dst) \
+    "vpcmpeqd        %%ymm4, %%ymm4, %%ymm4             \n\t" \
+    "vpgatherdd      %%ymm4, "#offset"(%["#base"], %%ymm"#idx", 1), %%ymm"#dst" \n\t"
+
+/* 8-bit input: one gather fetches the 4 taps of every output pixel,
+ * which are then split into the word pairs multiplied by pmaddwd */
+#define HSCALE_AVX2_TAPS_8 \
+    "1:                                                 \n\t" \
+    HSCALE_AVX2_GATHER(0, src, 5, 0) \
+    HSCALE_AVX2_GATHER(0, f,   6, 1) \
+    HSCALE_AVX2_GATHER(4, f,   6, 2) \
+    "vpshufb     %[shuf_hi], %%ymm0, %%ymm3             \n\t" \
+    "vpshufb     %[shuf_lo], %%ymm0, %%ymm0             \n\t" \
+    "vpmaddwd        %%ymm1, %%ymm0, %%ymm0             \n\t" \
+    "vpmaddwd        %%ymm2, %%ymm3, %%ymm3             \n\t" \
+    "vpaddd          %%ymm0, %%ymm7, %%ymm7             \n\t" \
+    "vpaddd          %%ymm3, %%ymm7, %%ymm7             \n\t" \
+    "add                 $4, %[src]                     \n\t" \
+    "add                 $8, %[f]                       \n\t" \
+    "cmp            %[fend], %[f]                       \n\t" \
+    "jb                  1b                             \n\t"
+
+/* 16-bit input: the samples are biased to signed words for pmaddwd and the
+ * bias is added back as 0x8000 times the sum of the coefficients */
+#define HSCALE_AVX2_TAPS_16 \
+    "vpaddd          %%ymm5, %%ymm5, %%ymm5             \n\t" \
+    "1:                                                 \n\t" \
+    HSCALE_AVX2_GATHER(0, src, 5, 0) \
+    HSCALE_AVX2_GATHER(4, src, 5, 3) \
+    HSCALE_AVX2_GATHER(0, f,   6, 1) \
+    HSCALE_AVX2_GATHER(4, f,   6, 2) \
+    "vpxor         %[w8000], %%ymm0, %%ymm0             \n\t" \
+    "vpxor         %[w8000], %%ymm3, %%ymm3             \n\t" \
+    "vpmaddwd        %%ymm1, %%ymm0, %%ymm0             \n\t" \
+    "vpmaddwd        %%ymm2, %%ymm3, %%ymm3             \n\t" \
+    "vpmaddwd      %[w8000], %%ymm1, %%ymm1             \n\t" \
+    "vpmaddwd      %[w8000], %%ymm2, %%ymm2             \n\t" \
+    "vpaddd          %%ymm0, %%ymm7, %%ymm7             \n\t" \
+    "vpaddd          %%ymm3, %%ymm7, %%ymm7             \n\t" \
+    "vpsubd          %%ymm1, %%ymm7, %%ymm7             \n\t" \
+    "vpsubd          %%ymm2, %%ymm7, %%ymm7             \n\t" \
+    "add                 $8, %[src]                     \n\t" \
+    "add                 $8, %[f]                       \n\t" \
+    "cmp            %[fend], %[f]                       \n\t" \
+    "jb                  1b                             \n\t"
+
+/* shift and clip the sums like the C code, 15-bit output keeps the low
+ * word of each sum */
+#define HSCALE_AVX2_STORE(dst_bpc) \
+    "vmovd              %[sh], %%xmm0                   \n\t" \
+    "vpsrad          %%xmm0, %%ymm7, %%ymm7             \n\t" \
+    "vpbroadcastd      %[max], %%ymm0                   \n\t" \
+    "vpminsd         %%ymm0, %%ymm7, %%ymm7             \n\t" \
+    HSCALE_AVX2_STORE_ ## dst_bpc \
+    "vzeroupper                                         \n\t"
+
+#define HSCALE_AVX2_STORE_15 \
+    "vpshufb      %[pack_w], %%ymm7, %%ymm7             \n\t" \
+    "vpermq           $0x08, %%ymm7, %%ymm7             \n\t" \
+    "vmovdqu         %%xmm7, %[dst]                     \n\t"
+
+#define HSCALE_AVX2_STORE_19 \
+    "vmovdqu         %%ymm7, %[dst]                     \n\t"
+
+#define HSCALE_FUNC_AVX2(src_bpc, dst_bpc, src_type, dst_type)                \
+static void hscale ## src_bpc ## to ## dst_bpc ## _avx2(dst_type *dst,        \
+                                       int dstW, const uint8_t *src,          \
+                                       const int16_t *filter,                 \
+                                       const int32_t *filterPos,              \
+                                       int filterSize, int sh)                \
+{                                                                             \
+    const int max     = (1 << dst_bpc) - 1;                                   \
+    const int fstride = 2 * filterSize;                                       \
+    int i;                                                                    \
+                                                                              \
+    for (i = 0; i + 8 <= dstW; i += 8) {                                      \
+        const int16_t *f    = filter + i * filterSize;                        \
+        const int16_t *fend = f + filterSize;                                 \
+        const uint8_t *s    = src;                                            \
+                                                                              \
+        __asm__ volatile(                                                     \
+            HSCALE_AVX2_SETUP                                                 \
+            HSCALE_AVX2_TAPS_ ## src_bpc                                      \
+            HSCALE_AVX2_STORE(dst_bpc)                                        \
+            : [f] "+&r" (f), [src] "+&r" (s),                                 \
+              [dst] "=m" (*(dst_type (*)[8])(dst + i))                        \
+            : [fend] "r" (fend),                                              \
+              [pos] "m" (*(const int32_t (*)[8])(filterPos + i)),             \
+              [fstride] "m" (fstride), [steps] "m" (hscale_steps),            \
+              [shuf_lo] "m" (hscale_shuf_lo), [shuf_hi] "m" (hscale_shuf_hi), \
+              [pack_w] "m" (hscale_pack_w), [w8000] "m" (hscale_w8000),       \
+              [sh] "m" (sh), [max] "m" (max)                                  \
+            : XMM_CLOBBERS("%xmm0", "%xmm1", "%xmm2", "%xmm3",                \
+                           "%xmm4", "%xmm5", "%xmm6", "%xmm7",) "memory"      \
+        );                                                                    \
+    }                                                                         \
+    for (; i < dstW; i++) {                                                   \
+        const src_type *s = (const src_type *)src;                            \
+        int j, val = 0;                                                       \
+                                                                              \
+        for (j = 0; j < filterSize; j++)                                      \
+            val += s[filterPos[i] + j] * filter[filterSize * i + j];          \
+        dst[i] = FFMIN(val >> sh, max);                                       \
+    }                                                                         \
+}
+
+HSCALE_FUNC_AVX2( 8, 15,  uint8_t, int16_t)
+HSCALE_FUNC_AVX2( 8, 19,  uint8_t, int32_t)
+HSCALE_FUNC_AVX2(16, 15, uint16_t, int16_t)
+HSCALE_FUNC_AVX2(16, 19, uint16_t, int32_t)
+
+static void hScale8To15_avx2(SwsContext *c, int16_t *dst, int dstW,
+                             const uint8_t *src, const int16_t *filter,
+                             const int32_t *filterPos, int filterSize)
+{
+    hscale8to15_avx2(dst, dstW, src, filter, filterPos, filterSize, 7);
+}
+
+static void hScale8To19_avx2(SwsContext *c, int16_t *dst, int dstW,
+                             const uint8_t *src, const int16_t *filter,
+                             const int32_t *filterPos, int filterSize)
+{
+    hscale8to19_avx2((int32_t *)dst, dstW, src, filter, filterPos, filterSize, 3);
+}
+
+static void hScale16To15_avx2(SwsContext *c, int16_t *dst, int dstW,
+                              const uint8_t *src, const int16_t *filter,
+                              const int32_t *filterPos, int filterSize)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int sh = desc->comp[0].depth - 1;
+
+    if (sh < 15)
+        sh = isAnyRGB(c->srcFormat) || c->srcFormat == AV_PIX_FMT_PAL8 ? 13 : sh;
+
+    hscale16to15_avx2(dst, dstW, src, filter, filterPos, filterSize, sh);
+}
+
+static void hScale16To19_avx2(SwsContext *c, int16_t *dst, int dstW,
+                              const uint8_t *src, const int16_t *filter,
+                              const int32_t *filterPos, int filterSize)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int sh = desc->comp[0].depth - 5;
+
+    if ((isAnyRGB(c->srcFormat) || c->srcFormat == AV_PIX_FMT_PAL8) &&
+        desc->comp[0].depth < 16)
+        sh = 9;
+
+    hscale16to19_avx2((int32_t *)dst, dstW, src, filter, filterPos, filterSize, sh);
+}
+#endif /* HAVE_AVX2_INLINE */
+
 #endif /* HAVE_INLINE_ASM */
 
 #define SCALE_FUNC(filter_n, from_bpc, to_bpc, opt) \
@@ -581,4 +1306,48 @@ switch(c->dstBpc){ \
             break;
         }
     }
+
+#if HAVE_AVX2_INLINE
+#define ASSIGN_AVX2_SCALE_FUNC(hscalefn, filtersize) do { \
+    if (!((filtersize) & 3)) { \
+        if (c->srcBpc == 8) \
+            hscalefn = c->dstBpc <= 14 ? hScale8To15_avx2 : hScale8To19_avx2; \
+        else \
+            hscalefn = c->dstBpc <= 14 ? hScale16To15_avx2 : hScale16To19_avx2; \
+    } \
+} while (0)
+    if (INLINE_AVX2(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_AVXSLOW)) {
+        ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+        if (c->use_mmx_vfilter) {
+            if (!(c->flags & SWS_ACCURATE_RND))
+                c->yuv2planeX = yuv2yuvX_avx2;
+        } else if (c->dstBpc == 8) {
+            c->yuv2planeX = yuv2planeX_8_avx2;
+        }
+        if (c->yuv2nv12cX)
+            c->yuv2nv12cX = yuv2nv12cX_avx2;
+        if (is9_OR_10BPS(c->dstFormat) && !isBE(c->dstFormat)) {
+            switch (c->dstBpc) {
+            case 9:  c->yuv2planeX = yuv2planeX_9LE_avx2;
+                     c->yuv2plane1 = yuv2plane1_9LE_avx2;  break;
+            case 10: c->yuv2planeX = yuv2planeX_10LE_avx2;
+                     c->yuv2plane1 = yuv2plane1_10LE_avx2; break;
+            case 12: c->yuv2planeX = yuv2planeX_12LE_avx2;
+                     c->yuv2plane1 = yuv2plane1_12LE_avx2; break;
+            case 14: c->yuv2planeX = yuv2planeX_14LE_avx2;
+                     c->yuv2plane1 = yuv2plane1_14LE_avx2; break;
+            }
+        } else if (c->dstBpc == 16 && !isBE(c->dstFormat)) {
+            c->yuv2planeX = yuv2planeX_16LE_avx2;
+            c->yuv2plane1 = yuv2plane1_16LE_avx2;
+        } else if (c->dstBpc == 8) {
+            c->yuv2plane1 = yuv2plane1_8_avx2;
+        }
+        if (c->srcFormat == AV_PIX_FMT_P010LE) {
+            c->lumToYV12 = p010LEToY_avx2;
+            c->chrToYV12 = p010LEToUV_avx2;
+        }
+    }
+#endif
 }
@@ -0,0 +1,79 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/af_biquads.h"
+
+#include "checkasm.h"
+
+#define MAX_LEN 257
+#define BUF_SIZE (MAX_LEN * BIQUADS_LANES)
+
+static const int lengths[] = { 1, 2, 3, 16, 17, 100, 256, MAX_LEN };
+
+static double rnd_double(double range)
+{
+    return ((int)(rnd() & 0xffffff) - 0x800000) * range / 0x800000;
+}
+
+static void check_filter(const BiquadsDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(double, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(double, buf1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(double, state0, [4 * BIQUADS_LANES]);
+    LOCAL_ALIGNED_32(double, state1, [4 * BIQUADS_LANES]);
+    double coeffs[5];
+    int i, j;
+
+    declare_func(void, double *buf, int len, double *state, const double *coeffs);
+
+    if (check_func(dsp->filter, "filter")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            /* keep the poles inside the unit circle */
+            coeffs[0] = rnd_double(1.);
+            coeffs[1] = rnd_double(2.);
+            coeffs[2] = rnd_double(1.);
+            coeffs[3] = rnd_double(1.);
+            coeffs[4] = rnd_double(0.4);
+            for (j = 0; j < BUF_SIZE; j++)
+                buf0[j] = buf1[j] = rnd_double(32768.);
+            for (j = 0; j < 4 * BIQUADS_LANES; j++)
+                state0[j] = state1[j] = rnd_double(32768.);
+            call_ref(buf0, lengths[i], state0, coeffs);
+            call_new(buf1, lengths[i], state1, coeffs);
+            if (memcmp(buf0, buf1, BUF_SIZE * sizeof(*buf0)) ||
+                memcmp(state0, state1, 4 * BIQUADS_LANES * sizeof(*state0)))
+                fail();
+        }
+        bench_new(buf1, 256, state1, coeffs);
+    }
+    report("filter");
+}
+
+void checkasm_check_biquads(void)
+{
+    BiquadsDSPContext dsp;
+
+    ff_biquads_init_dsp(&dsp);
+    check_filter(&dsp);
+}
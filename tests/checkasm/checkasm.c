@@ -72,6 +72,7 @@ static const struct {
         { "bswapdsp", checkasm_check_bswapdsp },
     #endif
     #if CONFIG_DCA_DECODER
+        { "dcadsp", checkasm_check_dcadsp },
         { "synth_filter", checkasm_check_synth_filter },
     #endif
     #if CONFIG_FLACDSP
@@ -91,6 +92,10 @@ static const struct {
     #endif
     #if CONFIG_JPEG2000_DECODER
         { "jpeg2000dsp", checkasm_check_jpeg2000dsp },
+        { "jpeg2000dwt", checkasm_check_jpeg2000dwt },
+    #endif
+    #if CONFIG_MLP_DECODER
+        { "mlpdsp", checkasm_check_mlpdsp },
     #endif
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
@@ -106,12 +111,52 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+    #if CONFIG_BIQUAD_FILTER
+        { "af_biquads", checkasm_check_biquads },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
+    #if CONFIG_BOXBLUR_FILTER
+        { "vf_boxblur", checkasm_check_boxblur },
+    #endif
     #if CONFIG_COLORSPACE_FILTER
         { "vf_colorspace", checkasm_check_colorspace },
     #endif
+    #if CONFIG_CONVOLUTION_FILTER
+        { "vf_convolution", checkasm_check_convolution },
+    #endif
+    #if CONFIG_EBUR128_FILTER
+        { "f_ebur128", checkasm_check_ebur128 },
+    #endif
+    #if CONFIG_FRAMERATE_FILTER
+        { "vf_framerate", checkasm_check_framerate },
+    #endif
+    #if CONFIG_LUT_FILTER
+        { "vf_lut", checkasm_check_lut },
+    #endif
+    #if CONFIG_NNEDI_FILTER
+        { "vf_nnedi", checkasm_check_nnedi },
+    #endif
+    #if CONFIG_OVERLAY_FILTER
+        { "vf_overlay", checkasm_check_overlay },
+    #endif
+    #if CONFIG_PALETTEUSE_FILTER
+        { "vf_paletteuse", checkasm_check_paletteuse },
+    #endif
+    #if CONFIG_SSIM_FILTER
+        { "vf_ssim", checkasm_check_ssim },
+    #endif
+    #if CONFIG_UNSHARP_FILTER
+        { "vf_unsharp", checkasm_check_unsharp },
+    #endif
+    #if CONFIG_VECTORSCOPE_FILTER
+        { "vf_vectorscope", checkasm_check_vectorscope },
+    #endif
+#endif
+#if CONFIG_SWSCALE
+    { "sw_rgb", checkasm_check_sw_rgb },
+    { "sw_scale", checkasm_check_sw_scale },
 #endif
     { NULL }
 };
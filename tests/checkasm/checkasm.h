@@ -31,18 +31,35 @@
 #include "libavutil/timer.h"
 
 void checkasm_check_alacdsp(void);
+void checkasm_check_biquads(void);
 void checkasm_check_blend(void);
+void checkasm_check_boxblur(void);
 void checkasm_check_bswapdsp(void);
 void checkasm_check_colorspace(void);
+void checkasm_check_convolution(void);
+void checkasm_check_dcadsp(void);
+void checkasm_check_ebur128(void);
 void checkasm_check_flacdsp(void);
 void checkasm_check_fmtconvert(void);
+void checkasm_check_framerate(void);
 void checkasm_check_h264dsp(void);
 void checkasm_check_h264pred(void);
 void checkasm_check_h264qpel(void);
 void checkasm_check_jpeg2000dsp(void);
+void checkasm_check_jpeg2000dwt(void);
+void checkasm_check_lut(void);
+void checkasm_check_mlpdsp(void);
+void checkasm_check_nnedi(void);
+void checkasm_check_overlay(void);
+void checkasm_check_paletteuse(void);
 void checkasm_check_pixblockdsp(void);
+void checkasm_check_ssim(void);
 void checkasm_check_synth_filter(void);
+void checkasm_check_sw_rgb(void);
+void checkasm_check_sw_scale(void);
+void checkasm_check_unsharp(void);
 void checkasm_check_v210enc(void);
+void checkasm_check_vectorscope(void);
 void checkasm_check_vp9dsp(void);
 void checkasm_check_videodsp(void);
 
@@ -0,0 +1,193 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavcodec/dcadata.h"
+#include "libavcodec/dcadsp.h"
+#include "libavcodec/mathops.h"
+
+#include "checkasm.h"
+
+#define MAX_LEN  512
+/* decimator history in front of the first band */
+#define HISTORY  8
+#define BUF_SIZE (MAX_LEN + HISTORY)
+
+static const int lengths[] = { 1, 7, 8, 31, 64, MAX_LEN };
+
+#define randomize(buf0, buf1, bits)                                 \
+    do {                                                            \
+        int j;                                                      \
+        for (j = 0; j < BUF_SIZE; j++)                              \
+            buf0[j] = buf1[j] = sign_extend(rnd(), bits);           \
+    } while (0)
+
+#define CHECK_BUF(buf0, buf1)                                       \
+    do {                                                            \
+        if (memcmp(buf0, buf1, BUF_SIZE * sizeof(*buf0)))           \
+            fail();                                                 \
+    } while (0)
+
+static void check_xll_mul(const DCADSPContext *s)
+{
+    LOCAL_ALIGNED_32(int32_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src1, [BUF_SIZE]);
+    int i, j;
+
+    static const struct {
+        const char *name;
+        int coeff_bits;
+        size_t offset;
+    } funcs[] = {
+        { "dca_xll_decor",     7, offsetof(DCADSPContext, decor)    },
+        { "dca_xll_dmix_sub", 16, offsetof(DCADSPContext, dmix_sub) },
+        { "dca_xll_dmix_add", 16, offsetof(DCADSPContext, dmix_add) },
+    };
+
+    for (j = 0; j < FF_ARRAY_ELEMS(funcs); j++) {
+        declare_func(void, int32_t *dst, const int32_t *src, int coeff,
+                     ptrdiff_t len);
+        void *func = *(void **)((const uint8_t *)s + funcs[j].offset);
+
+        if (check_func(func, "%s", funcs[j].name)) {
+            for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+                int coeff = sign_extend(rnd(), funcs[j].coeff_bits);
+
+                randomize(dst0, dst1, 24);
+                randomize(src, src1, 24);
+                call_ref(dst0, src, coeff, lengths[i]);
+                call_new(dst1, src, coeff, lengths[i]);
+                CHECK_BUF(dst0, dst1);
+            }
+            bench_new(dst1, src, 0x4000, MAX_LEN);
+        }
+    }
+}
+
+static void check_xll_dmix_scale(const DCADSPContext *s)
+{
+    LOCAL_ALIGNED_32(int32_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [BUF_SIZE]);
+    int i;
+
+    declare_func(void, int32_t *dst, int scale, ptrdiff_t len);
+
+    if (check_func(s->dmix_scale, "dca_xll_dmix_scale")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            int scale = sign_extend(rnd(), 17);
+
+            randomize(dst0, dst1, 24);
+            call_ref(dst0, scale, lengths[i]);
+            call_new(dst1, scale, lengths[i]);
+            CHECK_BUF(dst0, dst1);
+        }
+        bench_new(dst1, 0x8000, MAX_LEN);
+    }
+
+    if (check_func(s->dmix_scale_inv, "dca_xll_dmix_scale_inv")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            int scale_inv = sign_extend(rnd(), 18);
+
+            randomize(dst0, dst1, 24);
+            call_ref(dst0, scale_inv, lengths[i]);
+            call_new(dst1, scale_inv, lengths[i]);
+            CHECK_BUF(dst0, dst1);
+        }
+        bench_new(dst1, 0x10000, MAX_LEN);
+    }
+}
+
+static void check_xll_dmix_sub_xch(const DCADSPContext *s)
+{
+    LOCAL_ALIGNED_32(int32_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst2, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst3, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src1, [BUF_SIZE]);
+    int i;
+
+    declare_func(void, int32_t *dst1, int32_t *dst2,
+                 const int32_t *src, ptrdiff_t len);
+
+    if (check_func(s->dmix_sub_xch, "dca_xll_dmix_sub_xch")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            randomize(dst0, dst1, 24);
+            randomize(dst2, dst3, 24);
+            randomize(src, src1, 24);
+            call_ref(dst0, dst2, src, lengths[i]);
+            call_new(dst1, dst3, src, lengths[i]);
+            CHECK_BUF(dst0, dst1);
+            CHECK_BUF(dst2, dst3);
+        }
+        bench_new(dst1, dst3, src, MAX_LEN);
+    }
+}
+
+static void check_xll_assemble_freq_bands(const DCADSPContext *s)
+{
+    LOCAL_ALIGNED_32(int32_t, dst0,  [2 * MAX_LEN]);
+    LOCAL_ALIGNED_32(int32_t, dst1,  [2 * MAX_LEN]);
+    LOCAL_ALIGNED_32(int32_t, band0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, band1, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, band2, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, band3, [BUF_SIZE]);
+    int i;
+
+    declare_func(void, int32_t *dst, int32_t *src0, int32_t *src1,
+                 const int32_t *coeff, ptrdiff_t len);
+
+    if (check_func(s->assemble_freq_bands, "dca_xll_assemble_freq_bands")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            memset(dst0, 0, 2 * MAX_LEN * sizeof(*dst0));
+            memset(dst1, 0, 2 * MAX_LEN * sizeof(*dst1));
+            randomize(band0, band2, 20);
+            randomize(band1, band3, 20);
+            call_ref(dst0, band0 + HISTORY, band1 + HISTORY,
+                     ff_dca_xll_band_coeff, lengths[i]);
+            call_new(dst1, band2 + HISTORY, band3 + HISTORY,
+                     ff_dca_xll_band_coeff, lengths[i]);
+            if (memcmp(dst0, dst1, 2 * MAX_LEN * sizeof(*dst0)))
+                fail();
+            CHECK_BUF(band0, band2);
+            CHECK_BUF(band1, band3);
+        }
+        bench_new(dst1, band2 + HISTORY, band3 + HISTORY,
+                  ff_dca_xll_band_coeff, MAX_LEN);
+    }
+}
+
+void checkasm_check_dcadsp(void)
+{
+    DCADSPContext s;
+
+    ff_dcadsp_init(&s);
+    check_xll_mul(&s);
+    check_xll_dmix_scale(&s);
+    check_xll_dmix_sub_xch(&s);
+    report("xll_dmix");
+    check_xll_assemble_freq_bands(&s);
+    report("xll_assemble_freq_bands");
+}
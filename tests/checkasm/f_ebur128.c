@@ -0,0 +1,82 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/f_ebur128.h"
+
+#include "checkasm.h"
+
+#define MAX_LEN 4800
+#define MAX_CHANNELS 8
+
+static const int lengths[]  = { 1, 2, 3, 17, 100, MAX_LEN };
+static const int channels[] = { 1, 2, 3, 5, 6, 7, MAX_CHANNELS };
+
+static double rnd_double(double range)
+{
+    return ((int)(rnd() & 0xffffff) - 0x800000) * range / 0x800000;
+}
+
+static void check_filter(const EBUR128DSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(double, samples, [MAX_LEN * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, state0, [MAX_CHANNELS * EBUR128_STATE_SIZE]);
+    LOCAL_ALIGNED_32(double, state1, [MAX_CHANNELS * EBUR128_STATE_SIZE]);
+    LOCAL_ALIGNED_32(double, energy0, [MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(double, energy1, [MAX_CHANNELS]);
+    int i, j, k;
+
+    declare_func(void, const double *samples, int len, int stride, int nb_channels,
+                 double *state, double *energy);
+
+    for (j = 0; j < MAX_LEN * MAX_CHANNELS; j++)
+        samples[j] = rnd_double(1.);
+
+    if (check_func(dsp->filter, "k_weighting")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {
+            for (k = 0; k < FF_ARRAY_ELEMS(channels); k++) {
+                const int nb_channels = channels[k];
+
+                for (j = 0; j < MAX_CHANNELS * EBUR128_STATE_SIZE; j++)
+                    state0[j] = state1[j] = rnd_double(1.);
+                for (j = 0; j < MAX_CHANNELS; j++)
+                    energy0[j] = energy1[j] = rnd_double(100.) + 100.;
+                call_ref(samples, lengths[i], nb_channels, nb_channels, state0, energy0);
+                call_new(samples, lengths[i], nb_channels, nb_channels, state1, energy1);
+                if (memcmp(state0, state1, MAX_CHANNELS * EBUR128_STATE_SIZE * sizeof(*state0)) ||
+                    memcmp(energy0, energy1, MAX_CHANNELS * sizeof(*energy0)))
+                    fail();
+            }
+        }
+        bench_new(samples, MAX_LEN, 6, 6, state1, energy1);
+    }
+    report("k_weighting");
+}
+
+void checkasm_check_ebur128(void)
+{
+    EBUR128DSPContext dsp;
+
+    ff_ebur128_init_dsp(&dsp);
+    check_filter(&dsp);
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavcodec/jpeg2000dwt.h"
+#include "libavcodec/mathops.h"
+
+#include "checkasm.h"
+
+#define MAX_LEN 256
+/* 5 extended samples on each side, plus room for the odd start */
+#define BUF_SIZE ((MAX_LEN + 12) * FF_DWT_LANES)
+
+static const int lengths[] = { 2, 3, 4, 5, 17, 64, MAX_LEN - 1 };
+
+/* the coefficients of the integer transforms are upscaled by 8 bits */
+static void randomize_int(int32_t *buf0, int32_t *buf1)
+{
+    int j;
+
+    for (j = 0; j < BUF_SIZE; j++)
+        buf0[j] = buf1[j] = sign_extend(rnd(), 24);
+}
+
+static void randomize_float(float *buf0, float *buf1)
+{
+    int j;
+
+    for (j = 0; j < BUF_SIZE; j++)
+        buf0[j] = buf1[j] = sign_extend(rnd(), 16) / 128.0f;
+}
+
+#define CHECK_LIFTING(type, func, name, randomize)                          \
+    do {                                                                    \
+        declare_func(void, type *p, int i0, int i1);                        \
+        int i, i0;                                                          \
+                                                                            \
+        if (check_func(func, name)) {                                       \
+            for (i = 0; i < FF_ARRAY_ELEMS(lengths); i++) {                 \
+                for (i0 = 0; i0 < 2; i0++) {                                \
+                    randomize(buf0, buf1);                                  \
+                    call_ref(buf0 + 5 * FF_DWT_LANES, i0, i0 + lengths[i]); \
+                    call_new(buf1 + 5 * FF_DWT_LANES, i0, i0 + lengths[i]); \
+                    if (memcmp(buf0, buf1, BUF_SIZE * sizeof(*buf0)))       \
+                        fail();                                             \
+                }                                                           \
+            }                                                               \
+            bench_new(buf1 + 5 * FF_DWT_LANES, 0, MAX_LEN);                 \
+        }                                                                   \
+    } while (0)
+
+static void check_float(const DWTDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, buf1, [BUF_SIZE]);
+
+    CHECK_LIFTING(float, dsp->sr_1d97_float, "jpeg2000_sr_1d97_float", randomize_float);
+}
+
+static void check_int(const DWTDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(int32_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, buf1, [BUF_SIZE]);
+
+    CHECK_LIFTING(int32_t, dsp->sr_1d97_int, "jpeg2000_sr_1d97_int", randomize_int);
+    CHECK_LIFTING(int32_t, dsp->sr_1d53, "jpeg2000_sr_1d53", randomize_int);
+}
+
+void checkasm_check_jpeg2000dwt(void)
+{
+    DWTDSPContext dsp;
+
+    ff_dwtdsp_init(&dsp);
+    check_float(&dsp);
+    check_int(&dsp);
+    report("dwt_lifting");
+}
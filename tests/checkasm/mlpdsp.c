@@ -0,0 +1,153 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavcodec/mathops.h"
+#include "libavcodec/mlp.h"
+#include "libavcodec/mlpdsp.h"
+
+#include "checkasm.h"
+
+/* one spare row, so writes past the last sample are caught */
+#define BUF_ROWS  (MAX_BLOCKSIZE + 1)
+#define OUT_SIZE  (MAX_BLOCKSIZE * MAX_CHANNELS * 4 + 64)
+
+static void randomize_params(ChannelParams *cp0, ChannelParams *cp1,
+                             uint8_t *quant_step_size)
+{
+    int ch, k;
+
+    for (ch = 0; ch < MAX_CHANNELS; ch++) {
+        ChannelParams *cp = &cp0[ch];
+        int order = rnd() % (MAX_FIR_ORDER + 1);
+
+        memset(cp, 0, sizeof(*cp));
+        cp->filter_params[FIR].order = order;
+        cp->filter_params[IIR].order = FFMIN(rnd() % (MAX_IIR_ORDER + 1),
+                                             MAX_FIR_ORDER - order);
+        cp->filter_params[FIR].shift = rnd() % 16;
+        for (k = 0; k < MAX_FIR_ORDER; k++) {
+            cp->filter_params[FIR].state[k] = sign_extend(rnd(), 24);
+            cp->filter_params[IIR].state[k] = sign_extend(rnd(), 24);
+            cp->coeff[FIR][k] = sign_extend(rnd(), 16);
+            cp->coeff[IIR][k] = sign_extend(rnd(), 16);
+        }
+        quant_step_size[ch] = rnd() % 16;
+        memcpy(&cp1[ch], cp, sizeof(*cp));
+    }
+}
+
+static void check_filter_channels(const MLPDSPContext *c)
+{
+    LOCAL_ALIGNED_32(int32_t, buf0, [BUF_ROWS * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(int32_t, buf1, [BUF_ROWS * MAX_CHANNELS]);
+    ChannelParams cp0[MAX_CHANNELS], cp1[MAX_CHANNELS];
+    uint8_t quant_step_size[MAX_CHANNELS];
+    int i, first, nb_channels;
+
+    declare_func(void, ChannelParams *cp, const uint8_t *quant_step_size,
+                 int nb_channels, int blocksize, int32_t *sample_buffer);
+
+    if (check_func(c->mlp_filter_channels, "mlp_filter_channels")) {
+        for (nb_channels = 1; nb_channels <= MAX_CHANNELS; nb_channels++) {
+            int blocksize = 8 + rnd() % (MAX_BLOCKSIZE - 7);
+
+            first = rnd() % (MAX_CHANNELS - nb_channels + 1);
+            randomize_params(cp0, cp1, quant_step_size);
+            for (i = 0; i < BUF_ROWS * MAX_CHANNELS; i++)
+                buf0[i] = buf1[i] = sign_extend(rnd(), 24);
+
+            call_ref(&cp0[first], &quant_step_size[first], nb_channels,
+                     blocksize, &buf0[first]);
+            call_new(&cp1[first], &quant_step_size[first], nb_channels,
+                     blocksize, &buf1[first]);
+            if (memcmp(buf0, buf1, BUF_ROWS * MAX_CHANNELS * sizeof(*buf0)) ||
+                memcmp(cp0, cp1, sizeof(cp0)))
+                fail();
+        }
+        bench_new(cp1, quant_step_size, MAX_CHANNELS, MAX_BLOCKSIZE, buf1);
+    }
+}
+
+static void check_pack_output(const MLPDSPContext *c)
+{
+    static const uint8_t max_channels[] = { 1, 5, 7 };
+    LOCAL_ALIGNED_32(int32_t, samples, [BUF_ROWS * MAX_CHANNELS]);
+    LOCAL_ALIGNED_32(uint8_t, out0, [OUT_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, out1, [OUT_SIZE]);
+    uint8_t ch_assign[MAX_CHANNELS];
+    int8_t output_shift[MAX_CHANNELS];
+    int i, j, is32;
+
+    declare_func(int32_t, int32_t lossless_check_data, uint16_t blockpos,
+                 int32_t (*sample_buffer)[MAX_CHANNELS], void *data,
+                 uint8_t *ch_assign, int8_t *output_shift,
+                 uint8_t max_matrix_channel, int is32);
+
+    for (is32 = 0; is32 < 2; is32++) {
+        for (i = 0; i < FF_ARRAY_ELEMS(max_channels); i++) {
+            int max_matrix_channel = max_channels[i];
+            int blockpos = 1 + rnd() % MAX_BLOCKSIZE;
+            int32_t check0, check1, init = rnd();
+
+            for (j = 0; j < MAX_CHANNELS; j++) {
+                ch_assign[j] = j;
+                output_shift[j] = rnd() % 8;
+            }
+            for (j = max_matrix_channel; j > 0; j--)
+                FFSWAP(uint8_t, ch_assign[j], ch_assign[rnd() % (j + 1)]);
+            for (j = 0; j < BUF_ROWS * MAX_CHANNELS; j++)
+                samples[j] = sign_extend(rnd(), 24);
+
+            if (check_func(c->mlp_select_pack_output(ch_assign, output_shift,
+                                                     max_matrix_channel, is32),
+                           "mlp_pack_output_%dch_%s", max_matrix_channel + 1,
+                           is32 ? "s32" : "s16")) {
+                memset(out0, 0, OUT_SIZE);
+                memset(out1, 0, OUT_SIZE);
+                check0 = call_ref(init, blockpos, (int32_t (*)[MAX_CHANNELS])samples,
+                                  out0, ch_assign, output_shift,
+                                  max_matrix_channel, is32);
+                check1 = call_new(init, blockpos, (int32_t (*)[MAX_CHANNELS])samples,
+                                  out1, ch_assign, output_shift,
+                                  max_matrix_channel, is32);
+                if (check0 != check1 || memcmp(out0, out1, OUT_SIZE))
+                    fail();
+                bench_new(init, MAX_BLOCKSIZE, (int32_t (*)[MAX_CHANNELS])samples,
+                          out1, ch_assign, output_shift,
+                          max_matrix_channel, is32);
+            }
+        }
+    }
+}
+
+void checkasm_check_mlpdsp(void)
+{
+    MLPDSPContext c;
+
+    ff_mlpdsp_init(&c);
+    check_filter_channels(&c);
+    report("mlp_filter_channels");
+    check_pack_output(&c);
+    report("mlp_pack_output");
+}
@@ -0,0 +1,214 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libswscale/rgb2rgb.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1923
+#define PLANE     (MAX_WIDTH + 16)
+
+static const int widths[] = { 1, 15, 16, 67, MAX_WIDTH };
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            (buf)[j] = rnd();                   \
+    } while (0)
+
+static void check_planar3topacked(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src_buf, [3 * PLANE]);
+    LOCAL_ALIGNED_16(uint8_t, dst0, [MAX_WIDTH * 4 + 16]);
+    LOCAL_ALIGNED_16(uint8_t, dst1, [MAX_WIDTH * 4 + 16]);
+    const uint8_t *src[3] = { src_buf, src_buf + PLANE, src_buf + 2 * PLANE };
+    int i, a;
+
+    declare_func(void, const uint8_t *src0, const uint8_t *src1,
+                 const uint8_t *src2, uint8_t *dst, int width);
+
+    randomize_buffers(src_buf, 3 * PLANE);
+
+    if (check_func(planar3topacked24, "planar3topacked24")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, MAX_WIDTH * 4 + 16);
+            memset(dst1, 0, MAX_WIDTH * 4 + 16);
+            call_ref(src[0], src[1], src[2], dst0, widths[i]);
+            call_new(src[0], src[1], src[2], dst1, widths[i]);
+            if (memcmp(dst0, dst1, MAX_WIDTH * 4 + 16))
+                fail();
+        }
+        bench_new(src[0], src[1], src[2], dst1, MAX_WIDTH);
+    }
+
+    for (a = 0; a < 2; a++) {
+        declare_func(void, const uint8_t *src0, const uint8_t *src1,
+                     const uint8_t *src2, uint8_t *dst, int width, int alpha_first);
+
+        if (!check_func(planar3topacked32, "planar3topacked32_%s",
+                        a ? "alpha_first" : "alpha_last"))
+            continue;
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, MAX_WIDTH * 4 + 16);
+            memset(dst1, 0, MAX_WIDTH * 4 + 16);
+            call_ref(src[0], src[1], src[2], dst0, widths[i], a);
+            call_new(src[0], src[1], src[2], dst1, widths[i], a);
+            if (memcmp(dst0, dst1, MAX_WIDTH * 4 + 16))
+                fail();
+        }
+        bench_new(src[0], src[1], src[2], dst1, MAX_WIDTH, a);
+    }
+}
+
+static void check_packedtoplanar3(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src, [MAX_WIDTH * 4 + 16]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_buf, [3 * PLANE]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_buf, [3 * PLANE]);
+    uint8_t *dst0[3] = { dst0_buf, dst0_buf + PLANE, dst0_buf + 2 * PLANE };
+    uint8_t *dst1[3] = { dst1_buf, dst1_buf + PLANE, dst1_buf + 2 * PLANE };
+    int i, a;
+
+    declare_func(void, const uint8_t *src, uint8_t *dst0,
+                 uint8_t *dst1, uint8_t *dst2, int width);
+
+    randomize_buffers(src, MAX_WIDTH * 4 + 16);
+
+    if (check_func(packed24toplanar3, "packed24toplanar3")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0_buf, 0, 3 * PLANE);
+            memset(dst1_buf, 0, 3 * PLANE);
+            call_ref(src, dst0[0], dst0[1], dst0[2], widths[i]);
+            call_new(src, dst1[0], dst1[1], dst1[2], widths[i]);
+            if (memcmp(dst0_buf, dst1_buf, 3 * PLANE))
+                fail();
+        }
+        bench_new(src, dst1[0], dst1[1], dst1[2], MAX_WIDTH);
+    }
+
+    for (a = 0; a < 2; a++) {
+        declare_func(void, const uint8_t *src, uint8_t *dst0,
+                     uint8_t *dst1, uint8_t *dst2, int width, int alpha_first);
+
+        if (!check_func(packed32toplanar3, "packed32toplanar3_%s",
+                        a ? "alpha_first" : "alpha_last"))
+            continue;
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0_buf, 0, 3 * PLANE);
+            memset(dst1_buf, 0, 3 * PLANE);
+            call_ref(src, dst0[0], dst0[1], dst0[2], widths[i], a);
+            call_new(src, dst1[0], dst1[1], dst1[2], widths[i], a);
+            if (memcmp(dst0_buf, dst1_buf, 3 * PLANE))
+                fail();
+        }
+        bench_new(src, dst1[0], dst1[1], dst1[2], MAX_WIDTH, a);
+    }
+}
+
+static void check_packed16toplanar16(void)
+{
+    LOCAL_ALIGNED_16(uint16_t, src, [MAX_WIDTH * 4 + 8]);
+    LOCAL_ALIGNED_16(uint16_t, dst0_buf, [4 * PLANE]);
+    LOCAL_ALIGNED_16(uint16_t, dst1_buf, [4 * PLANE]);
+    static const int shifts[] = { 0, 4, 6 };
+    int i, src_alpha, dst_alpha, swap, s;
+
+    declare_func(void, const uint16_t *src, uint16_t *dst[4],
+                 int width, int src_alpha, int swap, int shift);
+
+    randomize_buffers((uint8_t *)src, sizeof(src[0]) * (MAX_WIDTH * 4 + 8));
+
+    for (src_alpha = 0; src_alpha < 2; src_alpha++)
+    for (dst_alpha = 0; dst_alpha < 2; dst_alpha++)
+    for (swap = 0; swap < 4; swap++)
+    for (s = 0; s < FF_ARRAY_ELEMS(shifts); s++) {
+        uint16_t *d0[4] = { dst0_buf, dst0_buf + PLANE, dst0_buf + 2 * PLANE,
+                            dst_alpha ? dst0_buf + 3 * PLANE : NULL };
+        uint16_t *d1[4] = { dst1_buf, dst1_buf + PLANE, dst1_buf + 2 * PLANE,
+                            dst_alpha ? dst1_buf + 3 * PLANE : NULL };
+
+        if (!check_func(packed16toplanar16, "packed16toplanar16_%d_to_%d_swap%d_shift%d",
+                        3 + src_alpha, 3 + dst_alpha, swap, shifts[s]))
+            continue;
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0_buf, 0, 4 * PLANE * sizeof(*dst0_buf));
+            memset(dst1_buf, 0, 4 * PLANE * sizeof(*dst1_buf));
+            call_ref(src, d0, widths[i], src_alpha, swap, shifts[s]);
+            call_new(src, d1, widths[i], src_alpha, swap, shifts[s]);
+            if (memcmp(dst0_buf, dst1_buf, 4 * PLANE * sizeof(*dst0_buf)))
+                fail();
+        }
+        bench_new(src, d1, MAX_WIDTH, src_alpha, swap, shifts[s]);
+    }
+}
+
+static void check_planar16topacked16(void)
+{
+    LOCAL_ALIGNED_16(uint16_t, src, [4 * PLANE]);
+    LOCAL_ALIGNED_16(uint16_t, dst0, [MAX_WIDTH * 4 + 8]);
+    LOCAL_ALIGNED_16(uint16_t, dst1, [MAX_WIDTH * 4 + 8]);
+    static const int depths[] = { 9, 10, 12, 16 };
+    int i, alpha, src_alpha, swap, b;
+
+    declare_func(void, const uint16_t *src[4], uint16_t *dst,
+                 int width, int alpha, int swap, int bpp);
+
+    randomize_buffers((uint8_t *)src, 4 * PLANE * sizeof(*src));
+
+    for (alpha = 0; alpha < 2; alpha++)
+    for (src_alpha = 0; src_alpha <= alpha; src_alpha++)
+    for (swap = 0; swap < 4; swap++)
+    for (b = 0; b < FF_ARRAY_ELEMS(depths); b++) {
+        const uint16_t *s[4] = { src, src + PLANE, src + 2 * PLANE,
+                                 src_alpha ? src + 3 * PLANE : NULL };
+
+        if (!check_func(planar16topacked16, "planar16topacked16_%d_to_%d_swap%d_%dbit",
+                        3 + src_alpha, 3 + alpha, swap, depths[b]))
+            continue;
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, sizeof(dst0[0]) * (MAX_WIDTH * 4 + 8));
+            memset(dst1, 0, sizeof(dst1[0]) * (MAX_WIDTH * 4 + 8));
+            call_ref(s, dst0, widths[i], alpha, swap, depths[b]);
+            call_new(s, dst1, widths[i], alpha, swap, depths[b]);
+            if (memcmp(dst0, dst1, sizeof(dst0[0]) * (MAX_WIDTH * 4 + 8)))
+                fail();
+        }
+        bench_new(s, dst1, MAX_WIDTH, alpha, swap, depths[b]);
+    }
+}
+
+void checkasm_check_sw_rgb(void)
+{
+    ff_sws_rgb2rgb_init();
+
+    check_planar3topacked();
+    report("planar3topacked");
+    check_packedtoplanar3();
+    report("packedtoplanar3");
+    check_packed16toplanar16();
+    report("packed16toplanar16");
+    check_planar16topacked16();
+    report("planar16topacked16");
+}
@@ -0,0 +1,355 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define SRC_PIXELS 512
+#define DST_PIXELS 509
+#define MAX_TAPS   40
+#define LINE_SIZE  (SRC_PIXELS + 64)
+
+#define randomize_buffers(buf, size, mask)       \
+    do {                                         \
+        int j;                                   \
+        for (j = 0; j < size; j++)               \
+            buf[j] = rnd() & (mask);             \
+    } while (0)
+
+static void check_hscale(void)
+{
+    static const struct {
+        enum AVPixelFormat src_fmt, dst_fmt;
+        int src_bpc, dst_bpc;
+    } formats[] = {
+        { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P,      8,  8 },
+        { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P16LE,  8, 16 },
+        { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P,     10,  8 },
+        { AV_PIX_FMT_YUV420P12LE, AV_PIX_FMT_YUV420P16LE, 12, 16 },
+        { AV_PIX_FMT_YUV420P16LE, AV_PIX_FMT_YUV420P,     16,  8 },
+        { AV_PIX_FMT_YUV420P16LE, AV_PIX_FMT_YUV420P16LE, 16, 16 },
+    };
+    static const int filter_sizes[] = { 4, 8, 12, 16, MAX_TAPS };
+
+    LOCAL_ALIGNED_32(uint16_t, src, [SRC_PIXELS + MAX_TAPS]);
+    LOCAL_ALIGNED_32(int32_t, dst0, [DST_PIXELS + 8]);
+    LOCAL_ALIGNED_32(int32_t, dst1, [DST_PIXELS + 8]);
+    LOCAL_ALIGNED_32(int16_t, filter, [(DST_PIXELS + 8) * MAX_TAPS]);
+    LOCAL_ALIGNED_32(int32_t, filter_pos, [DST_PIXELS + 8]);
+    SwsContext *ctx;
+    int fmt, fsi, i, j;
+
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    ctx = sws_alloc_context();
+    if (!ctx)
+        return;
+
+    for (fmt = 0; fmt < FF_ARRAY_ELEMS(formats); fmt++) {
+        for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+            int taps = filter_sizes[fsi];
+
+            ctx->srcFormat      = formats[fmt].src_fmt;
+            ctx->dstFormat      = formats[fmt].dst_fmt;
+            ctx->srcBpc         = formats[fmt].src_bpc;
+            ctx->dstBpc         = formats[fmt].dst_bpc;
+            ctx->hLumFilterSize = ctx->hChrFilterSize = taps;
+            ff_getSwsFunc(ctx);
+
+            if (!check_func(ctx->hyScale, "hscale_%d_to_%d_%d",
+                            formats[fmt].src_bpc, ctx->dstBpc > 14 ? 19 : 15, taps))
+                continue;
+
+            if (formats[fmt].src_bpc == 8) {
+                for (i = 0; i < SRC_PIXELS + MAX_TAPS; i++)
+                    ((uint8_t *)src)[i] = rnd();
+            } else {
+                randomize_buffers(src, SRC_PIXELS + MAX_TAPS,
+                                  (1 << formats[fmt].src_bpc) - 1);
+            }
+
+            /* coefficients summing up to about 1 << 14 with a single
+             * dominant tap, as produced by initFilter() */
+            for (i = 0; i < DST_PIXELS + 8; i++) {
+                filter_pos[i] = rnd() % (SRC_PIXELS - taps + 1);
+                for (j = 0; j < taps; j++)
+                    filter[i * taps + j] = -((1 << 14) / (taps - 1));
+                filter[i * taps + rnd() % taps] = (1 << 15) - 1;
+            }
+
+            memset(dst0, 0, sizeof(*dst0) * (DST_PIXELS + 8));
+            memset(dst1, 0, sizeof(*dst1) * (DST_PIXELS + 8));
+
+            call_ref(ctx, (int16_t *)dst0, DST_PIXELS, (const uint8_t *)src,
+                     filter, filter_pos, taps);
+            call_new(ctx, (int16_t *)dst1, DST_PIXELS, (const uint8_t *)src,
+                     filter, filter_pos, taps);
+            if (memcmp(dst0, dst1, DST_PIXELS * (ctx->dstBpc > 14 ? 4 : 2)))
+                fail();
+            bench_new(ctx, (int16_t *)dst1, DST_PIXELS, (const uint8_t *)src,
+                      filter, filter_pos, taps);
+        }
+    }
+
+    sws_freeContext(ctx);
+}
+
+/* Reference for the vertical scalers taking their filter in the MMX layout:
+ * { source line pointer, 4 copies of the 16-bit coefficient } per tap,
+ * terminated by a NULL line pointer. */
+static void yuv2yuvX_ref(const int16_t *filter, int filterSize,
+                         const int16_t **src, uint8_t *dest, int dstW,
+                         const uint8_t *dither, int offset)
+{
+    const int32_t *mmx_filter = (const int32_t *)filter;
+    int i, j;
+
+    for (i = 0; i < dstW; i++) {
+        int16_t val = (dither[(i + (offset ? 3 : 0)) & 7] + (filterSize - 1) * 8) >> 4;
+
+        for (j = 0; *(const int16_t * const *)&mmx_filter[4 * j]; j++) {
+            const int16_t *line = *(const int16_t * const *)&mmx_filter[4 * j];
+            int16_t coeff       = mmx_filter[4 * j + 2];
+
+            val += (line[i + offset] * coeff) >> 16;
+        }
+        dest[i] = av_clip_uint8(val >> 3);
+    }
+}
+
+static void check_yuv2yuvX(void)
+{
+    static const int filter_sizes[] = { 2, 3, 4, 8, 13, 16 };
+    static const int offsets[] = { 0, 8, 64 };
+    LOCAL_ALIGNED_32(int16_t, src_pixels, [16 * LINE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [SRC_PIXELS + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [SRC_PIXELS + 32]);
+    LOCAL_ALIGNED_16(int32_t, mmx_filter, [4 * 17]);
+    const int16_t *src[16];
+    uint8_t dither[8];
+    SwsContext *ctx;
+    yuv2planarX_fn func;
+    int fsi, osi, i;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const int16_t *filter, int filterSize,
+                      const int16_t **src, uint8_t *dest, int dstW,
+                      const uint8_t *dither, int offset);
+
+    ctx = sws_alloc_context();
+    if (!ctx)
+        return;
+
+    ctx->srcFormat = ctx->dstFormat = AV_PIX_FMT_YUV420P;
+    ctx->srcBpc    = ctx->dstBpc    = 8;
+    ctx->flags     = SWS_BICUBIC;
+    ff_getSwsFunc(ctx);
+
+    /* the C code takes the filter in a different layout, test against a
+     * C version of the MMX filter instead */
+    func = ctx->use_mmx_vfilter ? ctx->yuv2planeX : yuv2yuvX_ref;
+
+    for (i = 0; i < 16; i++)
+        src[i] = src_pixels + i * LINE_SIZE;
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+    randomize_buffers(src_pixels, 16 * LINE_SIZE, 0x7fff);
+
+    for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+        for (osi = 0; osi < FF_ARRAY_ELEMS(offsets); osi++) {
+            int taps   = filter_sizes[fsi];
+            int offset = offsets[osi];
+            int width  = SRC_PIXELS - offset - (rnd() & 31);
+
+            if (!check_func(func, "yuv2yuvX_%d_%d", taps, offset))
+                continue;
+
+            for (i = 0; i < taps; i++) {
+                *(const void **)&mmx_filter[4 * i] = src[i];
+                mmx_filter[4 * i + 2] =
+                mmx_filter[4 * i + 3] = ((uint16_t)(rnd() & 0x1fff)) * 0x10001U;
+            }
+            *(const void **)&mmx_filter[4 * taps] = NULL;
+
+            memset(dst0, 0, SRC_PIXELS + 32);
+            memset(dst1, 0, SRC_PIXELS + 32);
+
+            call_ref((const int16_t *)mmx_filter, taps, src, dst0, width, dither, offset);
+            call_new((const int16_t *)mmx_filter, taps, src, dst1, width, dither, offset);
+            emms_c();
+            if (memcmp(dst0, dst1, width))
+                fail();
+            bench_new((const int16_t *)mmx_filter, taps, src, dst1, width, dither, offset);
+            emms_c();
+        }
+    }
+
+    sws_freeContext(ctx);
+}
+
+static const enum AVPixelFormat planar_formats[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P9LE, AV_PIX_FMT_YUV420P10LE,
+    AV_PIX_FMT_YUV420P12LE, AV_PIX_FMT_YUV420P14LE, AV_PIX_FMT_YUV420P16LE,
+};
+
+static void init_planar_output(SwsContext *ctx, enum AVPixelFormat fmt)
+{
+    ctx->srcFormat = AV_PIX_FMT_YUV420P;
+    ctx->dstFormat = fmt;
+    ctx->srcBpc    = 8;
+    ctx->dstBpc    = av_pix_fmt_desc_get(fmt)->comp[0].depth;
+    ctx->flags     = SWS_BICUBIC | SWS_BITEXACT;
+    ff_getSwsFunc(ctx);
+}
+
+static void check_yuv2plane1(void)
+{
+    LOCAL_ALIGNED_32(int16_t, src16, [LINE_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src32, [LINE_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * SRC_PIXELS]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * SRC_PIXELS]);
+    uint8_t dither[8];
+    SwsContext *ctx;
+    int fmt, i;
+
+    declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    ctx = sws_alloc_context();
+    if (!ctx)
+        return;
+
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+    /* 16 bit output is made from 19 bit intermediates, test clipping at
+     * both ends */
+    for (i = 0; i < LINE_SIZE; i++) {
+        src16[i] = rnd();
+        src32[i] = (int)(rnd() & 0xfffff) - 0x40000;
+    }
+
+    for (fmt = 0; fmt < FF_ARRAY_ELEMS(planar_formats); fmt++) {
+        init_planar_output(ctx, planar_formats[fmt]);
+
+        if (check_func(ctx->yuv2plane1, "yuv2plane1_%d", ctx->dstBpc)) {
+            const int16_t *src = ctx->dstBpc == 16 ? (const int16_t *)src32 : src16;
+            int width  = SRC_PIXELS - (rnd() & 31);
+            int offset = rnd() & 1 ? 0 : 3;
+            int bytes  = ctx->dstBpc > 8 ? 2 : 1;
+
+            memset(dst0, 0, 2 * SRC_PIXELS);
+            memset(dst1, 0, 2 * SRC_PIXELS);
+
+            call_ref(src, dst0, width, dither, offset);
+            call_new(src, dst1, width, dither, offset);
+            if (memcmp(dst0, dst1, width * bytes))
+                fail();
+            bench_new(src, dst1, width, dither, offset);
+        }
+    }
+
+    sws_freeContext(ctx);
+}
+
+static void check_yuv2planeX(void)
+{
+    static const int filter_sizes[] = { 2, 3, 4, 7, 16 };
+    LOCAL_ALIGNED_32(int16_t, src_pixels, [16 * LINE_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, src_pixels32, [16 * LINE_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, filter, [16]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * SRC_PIXELS]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * SRC_PIXELS]);
+    const int16_t *src16[16], *src32[16];
+    uint8_t dither[8];
+    SwsContext *ctx;
+    int fmt, fsi, i;
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    ctx = sws_alloc_context();
+    if (!ctx)
+        return;
+
+    for (i = 0; i < 16; i++) {
+        src16[i] = src_pixels + i * LINE_SIZE;
+        src32[i] = (const int16_t *)(src_pixels32 + i * LINE_SIZE);
+    }
+    for (i = 0; i < 8; i++)
+        dither[i] = rnd() & 0x7f;
+    randomize_buffers(src_pixels, 16 * LINE_SIZE, 0x7fff);
+    randomize_buffers(src_pixels32, 16 * LINE_SIZE, 0x7ffff);
+
+    for (fmt = 0; fmt < FF_ARRAY_ELEMS(planar_formats); fmt++) {
+        init_planar_output(ctx, planar_formats[fmt]);
+
+        for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+            const int16_t **src = ctx->dstBpc == 16 ? src32 : src16;
+            int taps   = filter_sizes[fsi];
+            int width  = SRC_PIXELS - (rnd() & 31);
+            int offset = rnd() & 1 ? 0 : 3;
+            int bytes  = ctx->dstBpc > 8 ? 2 : 1;
+            int sum    = 0;
+
+            if (!check_func(ctx->yuv2planeX, "yuv2planeX_%d_%d", ctx->dstBpc, taps))
+                continue;
+
+            /* coefficients summing up to 1 << 12 */
+            for (i = 0; i < taps - 1; i++) {
+                filter[i] = (rnd() & 0x1fff) - 0x800;
+                sum += filter[i];
+            }
+            filter[taps - 1] = (1 << 12) - sum;
+
+            memset(dst0, 0, 2 * SRC_PIXELS);
+            memset(dst1, 0, 2 * SRC_PIXELS);
+
+            call_ref(filter, taps, src, dst0, width, dither, offset);
+            call_new(filter, taps, src, dst1, width, dither, offset);
+            if (memcmp(dst0, dst1, width * bytes))
+                fail();
+            bench_new(filter, taps, src, dst1, width, dither, offset);
+        }
+    }
+
+    sws_freeContext(ctx);
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    report("hscale");
+    check_yuv2yuvX();
+    report("yuv2yuvX");
+    check_yuv2plane1();
+    report("yuv2plane1");
+    check_yuv2planeX();
+    report("yuv2planeX");
+}
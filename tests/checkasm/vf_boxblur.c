@@ -0,0 +1,91 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_boxblur.h"
+
+#include "checkasm.h"
+
+#define WIDTH 67
+
+static const int widths[] = { 1, 7, 8, 15, 16, 33, 64, WIDTH };
+
+static void randomize_buffer(uint8_t *buf, int depth)
+{
+    int i;
+
+    if (depth > 8) {
+        uint16_t *buf16 = (uint16_t *)buf;
+        for (i = 0; i < WIDTH; i++)
+            buf16[i] = rnd() & ((1 << depth) - 1);
+    } else {
+        for (i = 0; i < WIDTH; i++)
+            buf[i] = rnd();
+    }
+}
+
+static void check_vblur_row(int depth)
+{
+    LOCAL_ALIGNED_32(uint8_t, add, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, sub, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH * 2 + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH * 2 + 32]);
+    LOCAL_ALIGNED_32(int, sums0, [WIDTH]);
+    LOCAL_ALIGNED_32(int, sums1, [WIDTH]);
+    BoxBlurDSPContext dsp;
+    int i, x;
+
+    declare_func(void, uint8_t *dst, const uint8_t *add, const uint8_t *sub,
+                 int *sums, int width, int inv);
+
+    ff_boxblur_init_dsp(&dsp, depth);
+    if (!check_func(dsp.vblur_row, "vblur_row_%dbit", depth))
+        return;
+
+    randomize_buffer(add, depth);
+    randomize_buffer(sub, depth);
+    for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        /* radius 1 to 255, with sums in the range of a box sum */
+        const int length = (rnd() % 255) * 2 + 3;
+        const int inv = ((1 << 16) + length / 2) / length;
+
+        for (x = 0; x < WIDTH; x++)
+            sums0[x] = sums1[x] = (rnd() & ((1U << depth) - 1)) * length * inv + (1 << 15);
+        memset(dst0, 0, WIDTH * 2 + 32);
+        memset(dst1, 0, WIDTH * 2 + 32);
+        call_ref(dst0, add, sub, sums0, widths[i], inv);
+        call_new(dst1, add, sub, sums1, widths[i], inv);
+        if (memcmp(dst0, dst1, WIDTH * 2 + 32) ||
+            memcmp(sums0, sums1, WIDTH * sizeof(*sums0)))
+            fail();
+    }
+    bench_new(dst1, add, sub, sums1, WIDTH, 13107);
+}
+
+void checkasm_check_boxblur(void)
+{
+    check_vblur_row(8);
+    check_vblur_row(10);
+    check_vblur_row(16);
+    report("vblur_row");
+}
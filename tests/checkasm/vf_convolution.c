@@ -0,0 +1,147 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_convolution.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1923
+#define STRIDE (MAX_WIDTH + 64)
+
+static const int widths[] = { 1, 7, 8, 15, 16, 33, 67, MAX_WIDTH };
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            (buf)[j] = rnd();                   \
+    } while (0)
+
+/* mostly small coefficients, as in sharpening and edge detection kernels */
+static int rnd_coef(void)
+{
+    return (int)(rnd() % 33) - 16;
+}
+
+static void check_filter_row(const ConvolutionDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [5 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH + 32]);
+    const uint8_t *c[25];
+    int matrix[25];
+    int i, j, size;
+
+    declare_func(void, uint8_t *dst, int width, float rdiv, float bias,
+                 const int *matrix, const uint8_t *c[], int nb_taps);
+
+    randomize_buffers(src, 5 * STRIDE);
+
+    for (size = 3; size <= 5; size += 2) {
+        const float rdiv = 1.0f / 9;
+        const float bias = 17.0f;
+
+        if (!check_func(dsp->filter_row, "filter_row_%dx%d", size, size))
+            continue;
+
+        for (j = 0; j < size * size; j++) {
+            c[j] = src + 16 + (j / size) * STRIDE + j % size;
+            matrix[j] = rnd_coef();
+        }
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, MAX_WIDTH + 32);
+            memset(dst1, 0, MAX_WIDTH + 32);
+            call_ref(dst0, widths[i], rdiv, bias, matrix, c, size * size);
+            call_new(dst1, widths[i], rdiv, bias, matrix, c, size * size);
+            if (memcmp(dst0, dst1, MAX_WIDTH + 32))
+                fail();
+        }
+        bench_new(dst1, MAX_WIDTH, rdiv, bias, matrix, c, size * size);
+    }
+}
+
+static void check_separable(const ConvolutionDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [STRIDE]);
+    LOCAL_ALIGNED_32(int16_t, rows, [5 * STRIDE]);
+    LOCAL_ALIGNED_32(int16_t, hdst0, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(int16_t, hdst1, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH + 32]);
+    static const int coef[5] = { 1, 4, 6, 4, 1 };
+    const int16_t *c[5];
+    int vcoef[5];
+    int i, j;
+
+    randomize_buffers(src, STRIDE);
+    for (j = 0; j < 5 * STRIDE; j++)
+        rows[j] = (int)(rnd() % 4081);
+    for (j = 0; j < 5; j++) {
+        c[j] = rows + j * STRIDE;
+        vcoef[j] = rnd_coef();
+    }
+
+    if (check_func(dsp->hfilter_row5, "hfilter_row5")) {
+        declare_func(void, int16_t *dst, const uint8_t *src, int width, const int *coef);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(hdst0, 0, sizeof(*hdst0) * (MAX_WIDTH + 32));
+            memset(hdst1, 0, sizeof(*hdst1) * (MAX_WIDTH + 32));
+            call_ref(hdst0, src + 16, widths[i], coef);
+            call_new(hdst1, src + 16, widths[i], coef);
+            if (memcmp(hdst0, hdst1, sizeof(*hdst0) * (MAX_WIDTH + 32)))
+                fail();
+        }
+        bench_new(hdst1, src + 16, MAX_WIDTH, coef);
+    }
+
+    if (check_func(dsp->vfilter_row5, "vfilter_row5")) {
+        declare_func(void, uint8_t *dst, int width, float rdiv, float bias,
+                     const int *coef, const int16_t *c[]);
+        const float rdiv = 1.0f / 256;
+        const float bias = 3.0f;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            memset(dst0, 0, MAX_WIDTH + 32);
+            memset(dst1, 0, MAX_WIDTH + 32);
+            call_ref(dst0, widths[i], rdiv, bias, vcoef, c);
+            call_new(dst1, widths[i], rdiv, bias, vcoef, c);
+            if (memcmp(dst0, dst1, MAX_WIDTH + 32))
+                fail();
+        }
+        bench_new(dst1, MAX_WIDTH, rdiv, bias, vcoef, c);
+    }
+}
+
+void checkasm_check_convolution(void)
+{
+    ConvolutionDSPContext dsp;
+
+    ff_convolution_init_dsp(&dsp);
+
+    check_filter_row(&dsp);
+    report("filter_row");
+    check_separable(&dsp);
+    report("separable");
+}
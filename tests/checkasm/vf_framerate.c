@@ -0,0 +1,111 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_framerate.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1927
+
+static const int widths[] = { 1, 7, 8, 15, 16, 31, 33, 64, MAX_WIDTH };
+
+static void randomize_buffer(uint8_t *buf, int bitdepth)
+{
+    int i;
+
+    if (bitdepth > 8) {
+        uint16_t *buf16 = (uint16_t *)buf;
+        for (i = 0; i < MAX_WIDTH; i++)
+            buf16[i] = rnd() & ((1 << bitdepth) - 1);
+    } else {
+        for (i = 0; i < MAX_WIDTH; i++)
+            buf[i] = rnd();
+    }
+}
+
+static void check_blend_row(int bitdepth)
+{
+    LOCAL_ALIGNED_32(uint8_t, src1, [MAX_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, src2, [MAX_WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH * 2 + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH * 2 + 32]);
+    FrameRateDSPContext dsp;
+    const int shift = FFMAX(bitdepth, 8);
+    const int max = 1 << shift;
+    int i;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src1, const uint8_t *src2,
+                 int width, int factor1, int factor2, int half, int shift);
+
+    ff_framerate_init_dsp(&dsp, bitdepth);
+    if (!check_func(dsp.blend_row, "blend_row_%dbit", bitdepth))
+        return;
+
+    randomize_buffer(src1, bitdepth);
+    randomize_buffer(src2, bitdepth);
+    for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        const int factor2 = i ? rnd() % (max + 1) : max;
+
+        memset(dst0, 0, MAX_WIDTH * 2 + 32);
+        memset(dst1, 0, MAX_WIDTH * 2 + 32);
+        call_ref(dst0, src1, src2, widths[i], max - factor2, factor2, max / 2, shift);
+        call_new(dst1, src1, src2, widths[i], max - factor2, factor2, max / 2, shift);
+        if (memcmp(dst0, dst1, MAX_WIDTH * 2 + 32))
+            fail();
+    }
+    bench_new(dst1, src1, src2, MAX_WIDTH, max / 3, max - max / 3, max / 2, shift);
+}
+
+static void check_sad_row16(int bitdepth)
+{
+    LOCAL_ALIGNED_32(uint16_t, src1, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, src2, [MAX_WIDTH]);
+    FrameRateDSPContext dsp;
+    int i;
+
+    declare_func(int64_t, const uint16_t *src1, const uint16_t *src2, int width);
+
+    ff_framerate_init_dsp(&dsp, bitdepth);
+    if (!check_func(dsp.sad_row16, "sad_row16_%dbit", bitdepth))
+        return;
+
+    randomize_buffer((uint8_t *)src1, bitdepth);
+    randomize_buffer((uint8_t *)src2, bitdepth);
+    for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        if (call_ref(src1, src2, widths[i]) != call_new(src1, src2, widths[i]))
+            fail();
+    }
+    bench_new(src1, src2, MAX_WIDTH);
+}
+
+void checkasm_check_framerate(void)
+{
+    check_blend_row(8);
+    check_blend_row(10);
+    check_blend_row(12);
+    report("blend_row");
+    check_sad_row16(10);
+    check_sad_row16(12);
+    report("sad_row16");
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_lut.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1923
+
+static const int widths[] = { 1, 15, 16, 17, 33, 64, 100, MAX_WIDTH };
+static const int depths[] = { 9, 10, 12, 16 };
+
+void checkasm_check_lut(void)
+{
+    LutDSPContext dsp;
+    LOCAL_ALIGNED_32(uint16_t, src, [MAX_WIDTH + 16]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_WIDTH + 16]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_WIDTH + 16]);
+    uint16_t *tab = av_malloc((65536 + 1) * sizeof(*tab));
+    int i, j, k;
+
+    if (!tab)
+        return;
+
+    ff_lut_init_dsp(&dsp);
+
+    for (j = 0; j < 65536; j++)
+        tab[j] = rnd();
+    tab[65536] = 0;
+
+    if (check_func(dsp.lut_row16, "lut_row16")) {
+        declare_func(void, uint16_t *dst, const uint16_t *src, const uint16_t *tab, int w);
+
+        for (k = 0; k < FF_ARRAY_ELEMS(depths); k++) {
+            const unsigned mask = (1 << depths[k]) - 1;
+
+            for (j = 0; j < MAX_WIDTH + 16; j++)
+                src[j] = rnd() & mask;
+            /* values outside of the bit depth must not read out of bounds */
+            src[5] = 65535;
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                memset(dst0, 0, sizeof(*dst0) * (MAX_WIDTH + 16));
+                memset(dst1, 0, sizeof(*dst1) * (MAX_WIDTH + 16));
+                call_ref(dst0 + 1, src + 1, tab, widths[i]);
+                call_new(dst1 + 1, src + 1, tab, widths[i]);
+                if (memcmp(dst0, dst1, sizeof(*dst0) * (MAX_WIDTH + 16)))
+                    fail();
+            }
+        }
+        bench_new(dst1, src, tab, MAX_WIDTH);
+    }
+    report("lut_row16");
+
+    av_free(tab);
+}
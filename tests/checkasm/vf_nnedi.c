@@ -0,0 +1,160 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_nnedi.h"
+
+#include "checkasm.h"
+
+#define MAX_NNS  256
+#define MAX_SIZE 288
+
+/* neural network sizes actually used by the filter */
+static const int nns_sizes[] = { 16, 32, 64, 128, 256 };
+static const int in_sizes[]  = { 32, 48, 64, 96, 128, 192, 288 };
+
+static float rnd_float(float range)
+{
+    return range * ((float)rnd() / UINT_MAX - 0.5f);
+}
+
+static void check_dot_prod(const NNEDIDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, data, [MAX_SIZE]);
+    LOCAL_ALIGNED_32(float, vals0, [2 * MAX_NNS]);
+    LOCAL_ALIGNED_32(float, vals1, [2 * MAX_NNS]);
+    float *weights = av_malloc_array(2 * MAX_NNS * (MAX_SIZE + 1), sizeof(*weights));
+    int16_t *data16 = (int16_t *)data;
+    int16_t *weights16 = (int16_t *)weights;
+    int i, j, k;
+
+    declare_func(void, const float *data, const float *weights, float *vals,
+                 const int n, const int len, const float scale);
+
+    if (!weights)
+        return;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(nns_sizes); i++) {
+        for (j = 0; j < FF_ARRAY_ELEMS(in_sizes); j++) {
+            const int n = 2 * nns_sizes[i], len = in_sizes[j];
+            const float scale = rnd_float(2.0f);
+
+            if (!check_func(dsp->dot_prod, "dot_prod_%dx%d", n, len))
+                continue;
+
+            for (k = 0; k < len; k++)
+                data[k] = rnd() & 0xff;
+            for (k = 0; k < n * (len + 1); k++)
+                weights[k] = rnd_float(1.0f / 64);
+            call_ref(data, weights, vals0, n, len, scale);
+            call_new(data, weights, vals1, n, len, scale);
+            if (!float_near_abs_eps_array(vals0, vals1, 1e-3f, n))
+                fail();
+            bench_new(data, weights, vals1, n, len, scale);
+        }
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(nns_sizes); i++) {
+        for (j = 0; j < FF_ARRAY_ELEMS(in_sizes); j++) {
+            const int n = 2 * nns_sizes[i], len = in_sizes[j];
+            const float scale = rnd_float(2.0f);
+            float *wf = (float *)&weights16[n * len];
+
+            if (!check_func(dsp->dot_prod_i16, "dot_prod_i16_%dx%d", n, len))
+                continue;
+
+            for (k = 0; k < len; k++)
+                data16[k] = rnd() & 0xff;
+            for (k = 0; k < n * len; k++)
+                weights16[k] = rnd();
+            for (k = 0; k < 2 * n; k++)
+                wf[k] = rnd_float(1.0f);
+            call_ref(data, weights, vals0, n, len, scale);
+            call_new(data, weights, vals1, n, len, scale);
+            if (memcmp(vals0, vals1, n * sizeof(*vals0)))
+                fail();
+            bench_new(data, weights, vals1, n, len, scale);
+        }
+    }
+
+    av_free(weights);
+}
+
+static void check_activation(const NNEDIDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, src, [2 * MAX_NNS]);
+    LOCAL_ALIGNED_32(float, dst0, [2 * MAX_NNS]);
+    LOCAL_ALIGNED_32(float, dst1, [2 * MAX_NNS]);
+    int i, k;
+
+    if (check_func(dsp->expfunc, "expfunc")) {
+        declare_func(void, float *s, const int n);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(nns_sizes); i++) {
+            const int n = nns_sizes[i];
+
+            for (k = 0; k < n; k++)
+                src[k] = rnd_float(200.0f);
+            memcpy(dst0, src, n * sizeof(*src));
+            memcpy(dst1, src, n * sizeof(*src));
+            call_ref(dst0, n);
+            call_new(dst1, n);
+            if (!float_near_ulp_array(dst0, dst1, 4, n))
+                fail();
+        }
+        bench_new(dst1, MAX_NNS);
+    }
+
+    if (check_func(dsp->wae5, "wae5")) {
+        declare_func(void, const float *w, const int n, float *mstd);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(nns_sizes); i++) {
+            const int n = nns_sizes[i];
+            float mstd0[4], mstd1[4];
+
+            for (k = 0; k < n; k++) {
+                src[k]     = (float)rnd() / UINT_MAX;
+                src[n + k] = rnd_float(20.0f);
+            }
+            for (k = 0; k < 4; k++)
+                mstd0[k] = mstd1[k] = rnd_float(255.0f);
+            call_ref(src, n, mstd0);
+            call_new(src, n, mstd1);
+            if (!float_near_abs_eps_array(mstd0, mstd1, 1e-3f, 4))
+                fail();
+        }
+        bench_new(src, MAX_NNS, dst1);
+    }
+}
+
+void checkasm_check_nnedi(void)
+{
+    NNEDIDSPContext dsp;
+
+    ff_nnedi_init_dsp(&dsp);
+
+    check_dot_prod(&dsp);
+    report("dot_prod");
+    check_activation(&dsp);
+    report("activation");
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_overlay.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1923
+#define ALPHA_LINESIZE (2 * MAX_WIDTH + 32)
+
+static const int widths[] = { 1, 7, 8, 15, 16, 33, 67, MAX_WIDTH };
+
+/* mostly transparent or opaque samples, as in logos, with some ramps */
+static uint8_t rnd_alpha(void)
+{
+    unsigned r = rnd();
+
+    switch (r & 3) {
+    case 0:  return 0;
+    case 1:  return 255;
+    default: return r >> 8;
+    }
+}
+
+#define randomize_buffers(buf, size)            \
+    do {                                        \
+        int j;                                  \
+        for (j = 0; j < size; j++)              \
+            (buf)[j] = rnd();                   \
+    } while (0)
+
+static void check_blend_row(const OverlayDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, alpha, [2 * ALPHA_LINESIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH + 32]);
+    int i, j;
+
+    randomize_buffers(src, MAX_WIDTH + 32);
+    for (j = 0; j < 2 * ALPHA_LINESIZE; j++)
+        alpha[j] = rnd_alpha();
+
+    if (check_func(dsp->blend_row, "blend_row")) {
+        declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *alpha, int w);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            randomize_buffers(dst0, MAX_WIDTH + 32);
+            memcpy(dst1, dst0, MAX_WIDTH + 32);
+            call_ref(dst0 + 1, src + 1, alpha + 3, widths[i]);
+            call_new(dst1 + 1, src + 1, alpha + 3, widths[i]);
+            if (memcmp(dst0, dst1, MAX_WIDTH + 32))
+                fail();
+        }
+        bench_new(dst1, src, alpha, MAX_WIDTH);
+    }
+
+    if (check_func(dsp->blend_row_420, "blend_row_420")) {
+        declare_func(void, uint8_t *dst, const uint8_t *src, const uint8_t *alpha,
+                     ptrdiff_t alpha_linesize, int w);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = (widths[i] + 1) >> 1;
+            randomize_buffers(dst0, MAX_WIDTH + 32);
+            memcpy(dst1, dst0, MAX_WIDTH + 32);
+            call_ref(dst0 + 1, src + 1, alpha + 1, ALPHA_LINESIZE, w);
+            call_new(dst1 + 1, src + 1, alpha + 1, ALPHA_LINESIZE, w);
+            if (memcmp(dst0, dst1, MAX_WIDTH + 32))
+                fail();
+        }
+        bench_new(dst1, src, alpha, ALPHA_LINESIZE, MAX_WIDTH / 2);
+    }
+}
+
+static void check_blend_row_rgba(const OverlayDSPContext *dsp)
+{
+    static const uint8_t maps[][4] = {
+        { 0, 1, 2, 3 },     /* rgba */
+        { 1, 2, 3, 0 },     /* argb */
+        { 2, 1, 0, 3 },     /* bgra */
+        { 3, 2, 1, 0 },     /* abgr */
+    };
+    static const char *const names[] = { "rgba", "argb", "bgra", "abgr" };
+    LOCAL_ALIGNED_32(uint8_t, src, [4 * MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [4 * MAX_WIDTH + 32]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [4 * MAX_WIDTH + 32]);
+    int i, j, m, n;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, int w,
+                 const uint8_t *dst_map, const uint8_t *src_map);
+
+    for (m = 0; m < FF_ARRAY_ELEMS(maps); m++)
+    for (n = 0; n < FF_ARRAY_ELEMS(maps); n++) {
+        if (!check_func(dsp->blend_row_rgba, "blend_row_rgba_%s_%s", names[n], names[m]))
+            continue;
+
+        randomize_buffers(src, 4 * MAX_WIDTH + 32);
+        for (j = 0; j < MAX_WIDTH + 8; j++)
+            src[4 * j + maps[n][3]] = rnd_alpha();
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            randomize_buffers(dst0, 4 * MAX_WIDTH + 32);
+            for (j = 0; j < MAX_WIDTH + 8; j++)
+                dst0[4 * j + maps[m][3]] = rnd_alpha();
+            memcpy(dst1, dst0, 4 * MAX_WIDTH + 32);
+            call_ref(dst0 + 4, src + 4, widths[i] - 1, maps[m], maps[n]);
+            call_new(dst1 + 4, src + 4, widths[i] - 1, maps[m], maps[n]);
+            if (memcmp(dst0, dst1, 4 * MAX_WIDTH + 32))
+                fail();
+        }
+        bench_new(dst1, src, MAX_WIDTH, maps[m], maps[n]);
+    }
+}
+
+void checkasm_check_overlay(void)
+{
+    OverlayDSPContext dsp;
+
+    ff_overlay_init_dsp(&dsp);
+
+    check_blend_row(&dsp);
+    report("blend_row");
+    check_blend_row_rgba(&dsp);
+    report("blend_row_rgba");
+}
@@ -0,0 +1,76 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_paletteuse.h"
+
+#include "checkasm.h"
+
+#define NB_COLORS 1024
+
+/* a coarse palette, so that some colors are at the same distance of two
+ * entries, with a few skipped entries */
+static void init_table(PaletteTable *tab, int nb_skipped)
+{
+    int i;
+
+    for (i = 0; i < AVPALETTE_COUNT; i++) {
+        tab->rg[2*i    ] = rnd() & 0xf0;
+        tab->rg[2*i + 1] = rnd() & 0xf0;
+        tab->b [2*i    ] = rnd() & 0xf0;
+        tab->b [2*i + 1] = 0;
+        tab->id[i] = i < nb_skipped || !(rnd() & 15) ? i | PALETTE_TABLE_SKIP : i;
+    }
+}
+
+void checkasm_check_paletteuse(void)
+{
+    PaletteTable *tab = av_malloc(sizeof(*tab));
+    PaletteUseDSPContext dsp;
+    uint32_t colors[NB_COLORS];
+    int i, n;
+
+    declare_func(int, const PaletteTable *tab, uint32_t color);
+
+    ff_paletteuse_init_dsp(&dsp);
+
+    if (tab && check_func(dsp.nearest_color, "nearest_color")) {
+        for (i = 0; i < NB_COLORS; i++)
+            colors[i] = rnd() & (i & 1 ? 0xf8f8f8 : 0xffffff);
+
+        for (n = 0; n < 2; n++) {
+            init_table(tab, n ? AVPALETTE_COUNT : 0);
+            for (i = 0; i < NB_COLORS; i++) {
+                const int ref = call_ref(tab, colors[i]);
+                const int new = call_new(tab, colors[i]);
+                if (ref != new) {
+                    fail();
+                    break;
+                }
+            }
+        }
+        init_table(tab, 0);
+        bench_new(tab, colors[0]);
+    }
+    report("nearest_color");
+
+    av_free(tab);
+}
@@ -0,0 +1,118 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/ssim.h"
+
+#include "checkasm.h"
+
+#define MAX_BLOCKS 483
+#define STRIDE     (MAX_BLOCKS * 8 + 64)
+
+static const int widths[] = { 1, 2, 3, 4, 5, 7, 8, 31, MAX_BLOCKS };
+
+static void randomize_buffer(uint8_t *buf, int bpp)
+{
+    int i;
+
+    if (bpp > 8) {
+        uint16_t *buf16 = (uint16_t *)buf;
+        for (i = 0; i < 4 * STRIDE / 2; i++)
+            buf16[i] = rnd() & ((1 << bpp) - 1);
+    } else {
+        for (i = 0; i < 4 * STRIDE; i++)
+            buf[i] = rnd();
+    }
+}
+
+static void check_ssim_4x4_line(int bpp)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [4 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [4 * STRIDE]);
+    LOCAL_ALIGNED_32(int, sums0, [(MAX_BLOCKS + 1) * 4]);
+    LOCAL_ALIGNED_32(int, sums1, [(MAX_BLOCKS + 1) * 4]);
+    SSIMDSPContext dsp;
+    int i;
+
+    declare_func(void, const uint8_t *buf, ptrdiff_t buf_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int (*sums)[4], int w);
+
+    ff_ssim_init_dsp(&dsp, bpp);
+    if (!check_func(dsp.ssim_4x4_line, "ssim_4x4_line_%dbit", bpp))
+        return;
+
+    randomize_buffer(buf, bpp);
+    randomize_buffer(ref, bpp);
+    for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        memset(sums0, 0, sizeof(*sums0) * (MAX_BLOCKS + 1) * 4);
+        memset(sums1, 0, sizeof(*sums1) * (MAX_BLOCKS + 1) * 4);
+        call_ref(buf, STRIDE, ref, STRIDE, (int (*)[4])sums0, widths[i]);
+        call_new(buf, STRIDE, ref, STRIDE, (int (*)[4])sums1, widths[i]);
+        if (memcmp(sums0, sums1, sizeof(*sums0) * (MAX_BLOCKS + 1) * 4))
+            fail();
+    }
+    bench_new(buf, STRIDE, ref, STRIDE, (int (*)[4])sums1, MAX_BLOCKS);
+}
+
+static void check_ssim_end_line(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [4 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [4 * STRIDE]);
+    LOCAL_ALIGNED_32(int, sum0, [(MAX_BLOCKS + 1) * 4]);
+    LOCAL_ALIGNED_32(int, sum1, [(MAX_BLOCKS + 1) * 4]);
+    SSIMDSPContext dsp;
+    float res0, res1;
+    int i;
+
+    declare_func(float, const int (*sum0)[4], const int (*sum1)[4], int w);
+
+    ff_ssim_init_dsp(&dsp, 8);
+    if (!check_func(dsp.ssim_end_line, "ssim_end_line"))
+        return;
+
+    /* realistic sums, as the end stage relies on their ranges */
+    randomize_buffer(buf, 8);
+    randomize_buffer(ref, 8);
+    dsp.ssim_4x4_line(buf, STRIDE, ref, STRIDE, (int (*)[4])sum0, MAX_BLOCKS + 1);
+    randomize_buffer(buf, 8);
+    dsp.ssim_4x4_line(buf, STRIDE, ref, STRIDE, (int (*)[4])sum1, MAX_BLOCKS + 1);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        res0 = call_ref((const int (*)[4])sum0, (const int (*)[4])sum1, widths[i]);
+        res1 = call_new((const int (*)[4])sum0, (const int (*)[4])sum1, widths[i]);
+        if (!float_near_abs_eps(res0, res1, 1e-4f * widths[i]))
+            fail();
+    }
+    bench_new((const int (*)[4])sum0, (const int (*)[4])sum1, MAX_BLOCKS);
+}
+
+void checkasm_check_ssim(void)
+{
+    check_ssim_4x4_line(8);
+    check_ssim_4x4_line(10);
+    check_ssim_4x4_line(12);
+    report("ssim_4x4_line");
+    check_ssim_end_line();
+    report("ssim_end_line");
+}
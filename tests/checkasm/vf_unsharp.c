@@ -0,0 +1,138 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/unsharp.h"
+
+#include "checkasm.h"
+
+#define MAX_WIDTH 1927
+#define NB_STAGES 10
+
+static const int widths[] = { 1, 2, 7, 8, 9, 15, 16, 17, 33, 64, MAX_WIDTH };
+
+static void randomize_buffer(uint32_t *buf, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = rnd();
+}
+
+static void check_hsum(const UnsharpDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint32_t, buf0, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, buf1, [MAX_WIDTH]);
+    int i;
+
+    declare_func(void, uint32_t *buf, int len);
+
+    if (check_func(dsp->hsum, "hsum")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            randomize_buffer(buf0, MAX_WIDTH);
+            memcpy(buf1, buf0, MAX_WIDTH * sizeof(*buf0));
+            call_ref(buf0, widths[i]);
+            call_new(buf1, widths[i]);
+            if (memcmp(buf0, buf1, MAX_WIDTH * sizeof(*buf0)))
+                fail();
+        }
+        bench_new(buf1, MAX_WIDTH);
+    }
+    report("hsum");
+}
+
+static void check_vsum(const UnsharpDSPContext *dsp)
+{
+    uint32_t *sc0 = av_malloc_array(NB_STAGES * MAX_WIDTH, sizeof(*sc0));
+    uint32_t *sc1 = av_malloc_array(NB_STAGES * MAX_WIDTH, sizeof(*sc1));
+    LOCAL_ALIGNED_32(uint32_t, sum0, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, sum1, [MAX_WIDTH]);
+    int i;
+
+    declare_func(void, uint32_t *sum, uint32_t *sc, ptrdiff_t stride,
+                 int nb_stages, int width);
+
+    if (sc0 && sc1 && check_func(dsp->vsum, "vsum")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            const int nb_stages = 2 + 2 * (i % (NB_STAGES / 2));
+
+            randomize_buffer(sc0, NB_STAGES * MAX_WIDTH);
+            randomize_buffer(sum0, MAX_WIDTH);
+            memcpy(sc1, sc0, NB_STAGES * MAX_WIDTH * sizeof(*sc0));
+            memcpy(sum1, sum0, MAX_WIDTH * sizeof(*sum0));
+            call_ref(sum0, sc0, widths[i], nb_stages, widths[i]);
+            call_new(sum1, sc1, widths[i], nb_stages, widths[i]);
+            if (memcmp(sum0, sum1, MAX_WIDTH * sizeof(*sum0)) ||
+                memcmp(sc0, sc1, NB_STAGES * MAX_WIDTH * sizeof(*sc0)))
+                fail();
+        }
+        bench_new(sum1, sc1, MAX_WIDTH, 4, MAX_WIDTH);
+    }
+    report("vsum");
+
+    av_free(sc0);
+    av_free(sc1);
+}
+
+static void check_sharpen(const UnsharpDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, src, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, sum, [MAX_WIDTH]);
+    int i, x;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                 int width, int amount, int scalebits, uint32_t halfscale);
+
+    if (check_func(dsp->sharpen, "sharpen")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            /* matrices from 3x3 to 15x15, amounts from -2 to 5 */
+            const int scalebits = 4 + 4 * (i % 7);
+            const int amount = (int)(rnd() % (7 * 65536)) - 2 * 65536;
+
+            for (x = 0; x < MAX_WIDTH; x++) {
+                src[x] = rnd();
+                sum[x] = (rnd() & 0xff) << scalebits | (rnd() & ((1 << scalebits) - 1));
+            }
+            memset(dst0, 0, MAX_WIDTH);
+            memset(dst1, 0, MAX_WIDTH);
+            call_ref(dst0, src, sum, widths[i], amount, scalebits, 1 << (scalebits - 1));
+            call_new(dst1, src, sum, widths[i], amount, scalebits, 1 << (scalebits - 1));
+            if (memcmp(dst0, dst1, MAX_WIDTH))
+                fail();
+        }
+        bench_new(dst1, src, sum, MAX_WIDTH, 65536, 8, 1 << 7);
+    }
+    report("sharpen");
+}
+
+void checkasm_check_unsharp(void)
+{
+    UnsharpDSPContext dsp;
+
+    ff_unsharp_init_dsp(&dsp);
+    check_hsum(&dsp);
+    check_vsum(&dsp);
+    check_sharpen(&dsp);
+}
@@ -0,0 +1,69 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+
+#include "libavfilter/vf_vectorscope.h"
+
+#include "checkasm.h"
+
+#define WIDTH 256
+
+static const int widths[] = { 1, 15, 16, 17, 31, 32, 33, 100, WIDTH };
+
+static void check_accumulate(const VectorscopeDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, dst0, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, counts, [WIDTH]);
+    int i, x;
+
+    declare_func(void, uint8_t *dst, const uint32_t *counts, int width, int intensity);
+
+    if (check_func(dsp->accumulate, "accumulate")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            /* mostly small counts, with a few large ones to test clipping */
+            const int intensity = i ? rnd() & 0xff : 255;
+
+            for (x = 0; x < WIDTH; x++) {
+                const unsigned r = rnd();
+
+                counts[x] = r & 1 ? r & 3 : r & 2 ? (r >> 2) & 0x3ff : (r >> 2) & INT_MAX;
+                dst0[x] = dst1[x] = rnd();
+            }
+            call_ref(dst0, counts, widths[i], intensity);
+            call_new(dst1, counts, widths[i], intensity);
+            if (memcmp(dst0, dst1, WIDTH))
+                fail();
+        }
+        bench_new(dst1, counts, WIDTH, 3);
+    }
+    report("accumulate");
+}
+
+void checkasm_check_vectorscope(void)
+{
+    VectorscopeDSPContext dsp;
+
+    ff_vectorscope_init_dsp(&dsp);
+    check_accumulate(&dsp);
+}